@@ -0,0 +1,20 @@
+#include "Benchmark/HeadlessBenchmark.h"
+#include <stdio.h>
+
+// HeadlessBenchmark -benchmark <frames> [-out results.json] [-baseline baseline.json] [-tolerance percent | -tolerance metric=percent]
+//		[-warmup frames] [-objects count] [-seed seed] [-workers count]
+int main(int argc, char** argv) {
+	Enj::HeadlessBenchmarkSettings settings;
+	settings.frames = 600;
+
+	for (int index = 1; index < argc; ++index) {
+		const int consumed = Enj::HeadlessBenchmark::ParseArgument(settings, argv[index], index + 1 < argc ? argv[index + 1] : nullptr);
+		if (consumed == 0) {
+			fprintf(stderr, "Unknown argument or missing value %s\n", argv[index]);
+			return Enj::HeadlessBenchmark::sExitError;
+		}
+		index += consumed - 1;
+	}
+
+	return Enj::HeadlessBenchmark(settings).Run();
+}
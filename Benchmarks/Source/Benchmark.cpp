@@ -0,0 +1,240 @@
+#include "Benchmark.h"
+#include <Math/SIMD.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <stdio.h>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	double ElapsedNanoseconds(const Clock::time_point start) {
+		return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+	}
+
+	std::string EscapeJson(const std::string& text) {
+		std::string escaped;
+		escaped.reserve(text.size());
+		for (const char character : text) {
+			if (character == '"' || character == '\\') {
+				escaped += '\\';
+			}
+			escaped += character;
+		}
+		return escaped;
+	}
+
+	std::string CompilerName() {
+#if defined(__clang__)
+		return "clang " __clang_version__;
+#elif defined(_MSC_VER)
+		return "MSVC " + std::to_string(_MSC_VER);
+#elif defined(__GNUC__)
+		return "gcc " __VERSION__;
+#else
+		return "unknown";
+#endif
+	}
+
+	std::string InstructionSet() {
+#if defined(OMATH_AVX512)
+		std::string name = "AVX512";
+#elif defined(OMATH_AVX2)
+		std::string name = "AVX2";
+#elif defined(OMATH_AVX)
+		std::string name = "AVX";
+#elif defined(OMATH_SSE)
+		std::string name = "SSE";
+#else
+		std::string name = "None";
+#endif
+#ifdef OMATH_FMA
+		name += "+FMA";
+#endif
+		return name;
+	}
+
+	std::string Timestamp() {
+		const std::time_t now = std::time(nullptr);
+		std::tm utc{};
+#if defined(_WIN32)
+		gmtime_s(&utc, &now);
+#else
+		gmtime_r(&now, &utc);
+#endif
+		char buffer[32];
+		std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+		return buffer;
+	}
+}
+
+Enj::BenchmarkRunner::BenchmarkRunner(const BenchmarkSettings& settings) :
+	mSettings(settings) {}
+
+//*********************************************************************************
+void Enj::BenchmarkRunner::Add(const std::string& name, Function function) {
+	mBenchmarks.push_back({ name, false, 1, std::move(function) });
+}
+
+//*********************************************************************************
+void Enj::BenchmarkRunner::AddBatched(const std::string& name, const uint64_t itemsPerIteration, Function function) {
+	mBenchmarks.push_back({ name, true, itemsPerIteration, std::move(function) });
+}
+
+//*********************************************************************************
+void Enj::BenchmarkRunner::Run() {
+	PinThread(mSettings.core);
+
+	mResults.clear();
+	for (const Benchmark& benchmark : mBenchmarks) {
+		if (!mSettings.filter.empty() && benchmark.mName.find(mSettings.filter) == std::string::npos) {
+			continue;
+		}
+		mResults.push_back(Measure(benchmark));
+
+		const BenchmarkResult& result = mResults.back();
+		fprintf(stderr, "%-48s %10.3f ns\n", result.mName.c_str(), result.mMedianNs);
+	}
+}
+
+//*********************************************************************************
+const std::vector<Enj::BenchmarkResult>& Enj::BenchmarkRunner::GetResults() const {
+	return mResults;
+}
+
+//*********************************************************************************
+void Enj::BenchmarkRunner::PrintTable() const {
+	printf("%-48s %12s %12s %12s %10s %14s\n", "Benchmark", "median ns", "mean ns", "min ns", "stddev %", "items/s");
+	for (const BenchmarkResult& result : mResults) {
+		const double relativeDeviation = result.mMeanNs > 0.0 ? 100.0 * result.mStdDevNs / result.mMeanNs : 0.0;
+		printf("%-48s %12.3f %12.3f %12.3f %10.2f %14.4g\n", result.mName.c_str(), result.mMedianNs, result.mMeanNs,
+			result.mMinNs, relativeDeviation, result.mItemsPerSecond);
+	}
+}
+
+//*********************************************************************************
+bool Enj::BenchmarkRunner::WriteJson(const std::string& path, const std::string& commit) const {
+	std::ofstream file(path);
+	if (!file) {
+		return false;
+	}
+
+	file.precision(9);
+	file << "{\n";
+	file << "\t\"commit\": \"" << EscapeJson(commit) << "\",\n";
+	file << "\t\"timestamp\": \"" << Timestamp() << "\",\n";
+	file << "\t\"compiler\": \"" << EscapeJson(CompilerName()) << "\",\n";
+	file << "\t\"simd\": \"" << InstructionSet() << "\",\n";
+	file << "\t\"settings\": { \"warmupSamples\": " << mSettings.warmupSamples << ", \"samples\": " << mSettings.samples
+		<< ", \"iterations\": " << mSettings.iterations << ", \"core\": " << mSettings.core << " },\n";
+	file << "\t\"benchmarks\": [\n";
+	for (size_t index = 0; index < mResults.size(); ++index) {
+		const BenchmarkResult& result = mResults[index];
+		file << "\t\t{ \"name\": \"" << EscapeJson(result.mName) << "\""
+			<< ", \"batched\": " << (result.mBatched ? "true" : "false")
+			<< ", \"itemsPerIteration\": " << result.mItemsPerIteration
+			<< ", \"iterations\": " << result.mIterations
+			<< ", \"samples\": " << result.mSamples
+			<< ", \"medianNs\": " << result.mMedianNs
+			<< ", \"meanNs\": " << result.mMeanNs
+			<< ", \"minNs\": " << result.mMinNs
+			<< ", \"maxNs\": " << result.mMaxNs
+			<< ", \"stdDevNs\": " << result.mStdDevNs
+			<< ", \"itemsPerSecond\": " << result.mItemsPerSecond << " }"
+			<< (index + 1 < mResults.size() ? ",\n" : "\n");
+	}
+	file << "\t]\n";
+	file << "}\n";
+	return static_cast<bool>(file);
+}
+
+//*********************************************************************************
+uint64_t Enj::BenchmarkRunner::Calibrate(const Benchmark& benchmark) const {
+	if (mSettings.iterations > 0) {
+		return mSettings.iterations;
+	}
+
+	// Doubles until a sample is long enough to time reliably, then scales to the target
+	const double targetNs = mSettings.targetSampleMilliseconds * 1e6;
+	uint64_t iterations = 1;
+	while (true) {
+		const Clock::time_point start = Clock::now();
+		benchmark.mFunction(iterations);
+		const double elapsed = ElapsedNanoseconds(start);
+		if (elapsed >= targetNs * 0.1 || iterations >= (1ull << 40)) {
+			const double scaled = static_cast<double>(iterations) * targetNs / std::max(elapsed, 1.0);
+			return std::max<uint64_t>(1, static_cast<uint64_t>(scaled));
+		}
+		iterations *= 2;
+	}
+}
+
+//*********************************************************************************
+Enj::BenchmarkResult Enj::BenchmarkRunner::Measure(const Benchmark& benchmark) const {
+	const uint64_t iterations = Calibrate(benchmark);
+	for (uint32_t sample = 0; sample < mSettings.warmupSamples; ++sample) {
+		benchmark.mFunction(iterations);
+	}
+
+	const uint32_t sampleCount = std::max(mSettings.samples, 1u);
+	const double items = static_cast<double>(iterations * benchmark.mItemsPerIteration);
+	std::vector<double> perItem(sampleCount);
+	for (uint32_t sample = 0; sample < sampleCount; ++sample) {
+		const Clock::time_point start = Clock::now();
+		benchmark.mFunction(iterations);
+		perItem[sample] = ElapsedNanoseconds(start) / items;
+	}
+
+	double sum = 0.0;
+	for (const double value : perItem) {
+		sum += value;
+	}
+	const double mean = sum / sampleCount;
+	double squares = 0.0;
+	for (const double value : perItem) {
+		squares += (value - mean) * (value - mean);
+	}
+
+	std::sort(perItem.begin(), perItem.end());
+	const double median = sampleCount % 2 == 1 ? perItem[sampleCount / 2] : 0.5 * (perItem[sampleCount / 2 - 1] + perItem[sampleCount / 2]);
+
+	BenchmarkResult result;
+	result.mName = benchmark.mName;
+	result.mBatched = benchmark.mBatched;
+	result.mItemsPerIteration = benchmark.mItemsPerIteration;
+	result.mIterations = iterations;
+	result.mSamples = sampleCount;
+	result.mMeanNs = mean;
+	result.mMedianNs = median;
+	result.mMinNs = perItem.front();
+	result.mMaxNs = perItem.back();
+	result.mStdDevNs = sampleCount > 1 ? std::sqrt(squares / (sampleCount - 1)) : 0.0;
+	result.mItemsPerSecond = median > 0.0 ? 1e9 / median : 0.0;
+	return result;
+}
+
+//*********************************************************************************
+void Enj::BenchmarkRunner::PinThread(const int core) {
+	if (core < 0) {
+		return;
+	}
+#if defined(_WIN32)
+	SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core);
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(core, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
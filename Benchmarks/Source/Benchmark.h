@@ -0,0 +1,94 @@
+#pragma once
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace Enj {
+	struct BenchmarkSettings {
+		uint32_t warmupSamples = 3;
+		uint32_t samples = 25;
+
+		// Iterations per sample, 0 calibrates every benchmark to about targetSampleMilliseconds.
+		// Pin a count to compare runs where calibration would otherwise pick different numbers
+		uint64_t iterations = 0;
+		double targetSampleMilliseconds = 10.0;
+
+		// Core the benchmark thread is pinned to, -1 leaves scheduling to the OS
+		int core = 0;
+
+		// Only benchmarks whose name contains this are run
+		std::string filter;
+	};
+
+	struct BenchmarkResult {
+		std::string mName;
+		bool mBatched;
+		uint64_t mItemsPerIteration;
+		uint64_t mIterations;
+		uint32_t mSamples;
+
+		// Per item, over all samples
+		double mMeanNs;
+		double mMedianNs;
+		double mMinNs;
+		double mMaxNs;
+		double mStdDevNs;
+
+		double mItemsPerSecond;
+	};
+
+	// Runs benchmark(iterations) a number of timed samples after a few untimed warmup samples
+	class BenchmarkRunner {
+	public:
+		using Function = std::function<void(uint64_t iterations)>;
+
+		explicit BenchmarkRunner(const BenchmarkSettings& settings);
+		BenchmarkRunner(const BenchmarkRunner& runner) = delete;
+		void operator=(const BenchmarkRunner& runner) = delete;
+
+		// A scalar benchmark does one operation per iteration, a batched one itemsPerIteration
+		void Add(const std::string& name, Function function);
+		void AddBatched(const std::string& name, const uint64_t itemsPerIteration, Function function);
+
+		void Run();
+
+		const std::vector<BenchmarkResult>& GetResults() const;
+
+		void PrintTable() const;
+		bool WriteJson(const std::string& path, const std::string& commit) const;
+
+	private:
+		struct Benchmark {
+			std::string mName;
+			bool mBatched;
+			uint64_t mItemsPerIteration;
+			Function mFunction;
+		};
+
+		uint64_t Calibrate(const Benchmark& benchmark) const;
+		BenchmarkResult Measure(const Benchmark& benchmark) const;
+
+		static void PinThread(const int core);
+
+		BenchmarkSettings mSettings;
+		std::vector<Benchmark> mBenchmarks;
+		std::vector<BenchmarkResult> mResults;
+	};
+
+	// Forces value to exist in memory, so the work producing it or reading it cannot be optimized away or hoisted
+	template <class T>
+	inline void DoNotOptimize(T& value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+		static void* volatile sSink;
+		sSink = &value;
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : "+m"(value) : : "memory");
+#endif
+	}
+}
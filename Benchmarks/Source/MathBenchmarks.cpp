@@ -0,0 +1,229 @@
+#include "MathBenchmarks.h"
+#include "Benchmark.h"
+#include <Math/FastMath.h>
+#include <Math/Matrix4x4.h>
+#include <Math/TransformBatch.h>
+#include <Math/VectorWide.h>
+#include <memory>
+#include <random>
+
+namespace {
+	// Fits L2 on every target, so batched numbers measure compute rather than memory
+	constexpr size_t sMathBatchSize = 1024;
+
+	constexpr int sWideWidth = OMath::sTransformBatchWidth > 1 ? OMath::sTransformBatchWidth : 4;
+	using FloatW = OMath::FloatWide<sWideWidth>;
+	using Vector3W = OMath::Vector3Wide<sWideWidth>;
+
+	// Inputs shared by every benchmark, filled once from a fixed seed so every run sees the same numbers
+	struct MathData {
+		std::vector<OMath::Matrix4x4f> mMatrices;
+		std::vector<OMath::Matrix4x4f> mOtherMatrices;
+		std::vector<OMath::Matrix4x4f> mOutputMatrices;
+		std::vector<OMath::Vector3f> mRotations;
+		std::vector<OMath::Vector3f> mVectors;
+		std::vector<OMath::Vector3f> mOtherVectors;
+		std::vector<OMath::Vector3f> mOutputVectors;
+		std::vector<OMath::Vector4f> mVectors4;
+		std::vector<OMath::Vector4f> mOutputVectors4;
+
+		// Structure of arrays copies of mVectors and mOtherVectors for the wide types
+		std::vector<float> mX, mY, mZ;
+		std::vector<float> mOtherX, mOtherY, mOtherZ;
+		std::vector<float> mOutputX, mOutputY, mOutputZ;
+	};
+
+	std::shared_ptr<MathData> CreateMathData() {
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+
+		auto data = std::make_shared<MathData>();
+		for (size_t index = 0; index < sMathBatchSize; ++index) {
+			const OMath::Vector3f rotation(angle(random), angle(random), angle(random));
+			const OMath::Vector3f translation(position(random), position(random), position(random));
+
+			// Rigid transforms, so GetFastInverse is valid on them
+			data->mMatrices.push_back(OMath::Matrix4x4f::CreateRotationMatrix(rotation) * OMath::Matrix4x4f::CreateTranslationMatrix(translation));
+			data->mOtherMatrices.push_back(OMath::Matrix4x4f::CreateRotationMatrix(translation) * OMath::Matrix4x4f::CreateTranslationMatrix(rotation));
+			data->mRotations.push_back(rotation);
+			data->mVectors.push_back(translation);
+			data->mOtherVectors.push_back(OMath::Vector3f(position(random), position(random), position(random)));
+			data->mVectors4.push_back(OMath::Vector4f(translation.mX, translation.mY, translation.mZ, 1.0f));
+
+			data->mX.push_back(data->mVectors.back().mX);
+			data->mY.push_back(data->mVectors.back().mY);
+			data->mZ.push_back(data->mVectors.back().mZ);
+			data->mOtherX.push_back(data->mOtherVectors.back().mX);
+			data->mOtherY.push_back(data->mOtherVectors.back().mY);
+			data->mOtherZ.push_back(data->mOtherVectors.back().mZ);
+		}
+		data->mOutputMatrices.resize(sMathBatchSize);
+		data->mOutputVectors.resize(sMathBatchSize);
+		data->mOutputVectors4.resize(sMathBatchSize);
+		data->mOutputX.resize(sMathBatchSize);
+		data->mOutputY.resize(sMathBatchSize);
+		data->mOutputZ.resize(sMathBatchSize);
+		return data;
+	}
+
+	// std::vector only guarantees the alignment of float, so the wide benchmarks load and store unaligned
+	Vector3W LoadWide(const std::vector<float>& x, const std::vector<float>& y, const std::vector<float>& z, const size_t index) {
+		return { FloatW::LoadUnaligned(&x[index]), FloatW::LoadUnaligned(&y[index]), FloatW::LoadUnaligned(&z[index]) };
+	}
+
+	void StoreWide(const Vector3W& vector, std::vector<float>& x, std::vector<float>& y, std::vector<float>& z, const size_t index) {
+		vector.mX.StoreUnaligned(&x[index]);
+		vector.mY.StoreUnaligned(&y[index]);
+		vector.mZ.StoreUnaligned(&z[index]);
+	}
+
+	// Times operation(input) on a single value, the input is reloaded and the result stored every iteration
+	template <class Input, class Operation>
+	Enj::BenchmarkRunner::Function Single(const Input& value, Operation operation) {
+		return [input = value, operation](const uint64_t iterations) mutable {
+			for (uint64_t iteration = 0; iteration < iterations; ++iteration) {
+				Enj::DoNotOptimize(input);
+				auto result = operation(input);
+				Enj::DoNotOptimize(result);
+			}
+		};
+	}
+
+	// Times one call of batch() per iteration, batch processes sMathBatchSize elements
+	template <class Batch>
+	Enj::BenchmarkRunner::Function Streamed(const std::shared_ptr<MathData>& data, Batch batch) {
+		return [data, batch](const uint64_t iterations) {
+			for (uint64_t iteration = 0; iteration < iterations; ++iteration) {
+				batch(*data);
+				Enj::DoNotOptimize(*data);
+			}
+		};
+	}
+}
+
+void Enj::AddMathBenchmarks(BenchmarkRunner& runner) {
+	using namespace OMath;
+
+	const std::shared_ptr<MathData> data = CreateMathData();
+	const Matrix4x4f matrix = data->mMatrices[0];
+	const Matrix4x4f otherMatrix = data->mOtherMatrices[0];
+	const Vector3f vector = data->mVectors[0];
+	const Vector3f otherVector = data->mOtherVectors[0];
+	const Vector4f vector4 = data->mVectors4[0];
+	const Vector3f rotation = data->mRotations[0];
+
+	struct MatrixPair {
+		Matrix4x4f mLeft;
+		Matrix4x4f mRight;
+	};
+	struct VectorPair {
+		Vector3f mLeft;
+		Vector3f mRight;
+	};
+	struct VectorMatrix {
+		Vector4f mVector;
+		Matrix4x4f mMatrix;
+	};
+
+	// Matrix4x4
+	runner.Add("Matrix4x4/Multiply", Single(MatrixPair{ matrix, otherMatrix }, [](const MatrixPair& pair) {
+		return pair.mLeft * pair.mRight;
+	}));
+	runner.Add("Matrix4x4/Multiply/Generic", Single(MatrixPair{ matrix, otherMatrix }, [](const MatrixPair& pair) {
+		return operator*<float>(pair.mLeft, pair.mRight);
+	}));
+	runner.AddBatched("Matrix4x4/Multiply/Batch", sMathBatchSize, Streamed(data, [](MathData& batch) {
+		for (size_t index = 0; index < sMathBatchSize; ++index) {
+			batch.mOutputMatrices[index] = batch.mMatrices[index] * batch.mOtherMatrices[index];
+		}
+	}));
+
+	runner.Add("Matrix4x4/Transpose", Single(matrix, [](const Matrix4x4f& value) {
+		return Matrix4x4f::Transpose(value);
+	}));
+	runner.AddBatched("Matrix4x4/Transpose/Batch", sMathBatchSize, Streamed(data, [](MathData& batch) {
+		for (size_t index = 0; index < sMathBatchSize; ++index) {
+			batch.mOutputMatrices[index] = Matrix4x4f::Transpose(batch.mMatrices[index]);
+		}
+	}));
+
+	runner.Add("Matrix4x4/GetFastInverse", Single(matrix, [](const Matrix4x4f& value) {
+		return Matrix4x4f::GetFastInverse(value);
+	}));
+	runner.AddBatched("Matrix4x4/GetFastInverse/Batch", sMathBatchSize, Streamed(data, [](MathData& batch) {
+		for (size_t index = 0; index < sMathBatchSize; ++index) {
+			batch.mOutputMatrices[index] = Matrix4x4f::GetFastInverse(batch.mMatrices[index]);
+		}
+	}));
+
+	runner.Add("Matrix4x4/Inverse", Single(matrix, [](const Matrix4x4f& value) {
+		return Matrix4x4f::Inverse(value);
+	}));
+	runner.AddBatched("Matrix4x4/Inverse/Batch", sMathBatchSize, Streamed(data, [](MathData& batch) {
+		Matrix4x4f::Inverse(batch.mMatrices, batch.mOutputMatrices);
+	}));
+
+	runner.Add("Matrix4x4/CreateRotationMatrix", Single(rotation, [](const Vector3f& value) {
+		return Matrix4x4f::CreateRotationMatrix(value);
+	}));
+	runner.Add("Matrix4x4/CreateRotationMatrix/Fast", Single(rotation, [](const Vector3f& value) {
+		return Fast::CreateRotationMatrix(value);
+	}));
+	runner.AddBatched("Matrix4x4/CreateRotationMatrices/Accurate", sMathBatchSize, Streamed(data, [](MathData& batch) {
+		Fast::CreateRotationMatrices<Fast::Precision::Accurate>(batch.mRotations, batch.mOutputMatrices);
+	}));
+	runner.AddBatched("Matrix4x4/CreateRotationMatrices/Fast", sMathBatchSize, Streamed(data, [](MathData& batch) {
+		Fast::CreateRotationMatrices<Fast::Precision::Fast>(batch.mRotations, batch.mOutputMatrices);
+	}));
+
+	// Vector * Matrix4x4
+	runner.Add("Vector4*Matrix4x4", Single(VectorMatrix{ vector4, matrix }, [](const VectorMatrix& pair) {
+		return pair.mVector * pair.mMatrix;
+	}));
+	runner.AddBatched("Vector4*Matrix4x4/Loop", sMathBatchSize, Streamed(data, [](MathData& batch) {
+		const Matrix4x4f& transform = batch.mMatrices[0];
+		for (size_t index = 0; index < sMathBatchSize; ++index) {
+			batch.mOutputVectors4[index] = batch.mVectors4[index] * transform;
+		}
+	}));
+	runner.AddBatched("Vector4*Matrix4x4/Transform", sMathBatchSize, Streamed(data, [](MathData& batch) {
+		Transform(batch.mMatrices[0], batch.mVectors4, batch.mOutputVectors4);
+	}));
+	runner.AddBatched("Vector3*Matrix4x4/TransformPoints", sMathBatchSize, Streamed(data, [](MathData& batch) {
+		TransformPoints(batch.mMatrices[0], batch.mVectors, batch.mOutputVectors);
+	}));
+
+	// Vector3
+	runner.Add("Vector3/Normalize", Single(vector, [](Vector3f value) {
+		value.Normalize();
+		return value;
+	}));
+	runner.AddBatched("Vector3/Normalize/Loop", sMathBatchSize, Streamed(data, [](MathData& batch) {
+		for (size_t index = 0; index < sMathBatchSize; ++index) {
+			batch.mOutputVectors[index] = batch.mVectors[index].GetNormalized();
+		}
+	}));
+	runner.AddBatched("Vector3/Normalize/Wide", sMathBatchSize, Streamed(data, [](MathData& batch) {
+		for (size_t index = 0; index < sMathBatchSize; index += sWideWidth) {
+			const Vector3W normalized = LoadWide(batch.mX, batch.mY, batch.mZ, index).GetNormalized();
+			StoreWide(normalized, batch.mOutputX, batch.mOutputY, batch.mOutputZ, index);
+		}
+	}));
+
+	runner.Add("Vector3/Cross", Single(VectorPair{ vector, otherVector }, [](const VectorPair& pair) {
+		return pair.mLeft.Cross(pair.mRight);
+	}));
+	runner.AddBatched("Vector3/Cross/Loop", sMathBatchSize, Streamed(data, [](MathData& batch) {
+		for (size_t index = 0; index < sMathBatchSize; ++index) {
+			batch.mOutputVectors[index] = batch.mVectors[index].Cross(batch.mOtherVectors[index]);
+		}
+	}));
+	runner.AddBatched("Vector3/Cross/Wide", sMathBatchSize, Streamed(data, [](MathData& batch) {
+		for (size_t index = 0; index < sMathBatchSize; index += sWideWidth) {
+			const Vector3W left = LoadWide(batch.mX, batch.mY, batch.mZ, index);
+			const Vector3W right = LoadWide(batch.mOtherX, batch.mOtherY, batch.mOtherZ, index);
+			StoreWide(left.Cross(right), batch.mOutputX, batch.mOutputY, batch.mOutputZ, index);
+		}
+	}));
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+namespace Enj {
+	class BenchmarkRunner;
+
+	// Registers the OMath operator benchmarks. Scalar benchmarks time one call on values kept in memory,
+	// batched ones stream sMathBatchSize elements through the span APIs, or a plain loop where there is none
+	void AddMathBenchmarks(BenchmarkRunner& runner);
+}
@@ -0,0 +1,54 @@
+#include "Benchmark.h"
+#include "MathBenchmarks.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Benchmarks [-out results.json] [-commit hash] [-filter text] [-samples n] [-warmup n] [-iterations n] [-core n] [-sampletime ms]
+int main(int argc, char** argv) {
+	Enj::BenchmarkSettings settings;
+	std::string outputPath;
+	std::string commit;
+
+	for (int index = 1; index < argc; ++index) {
+		const char* argument = argv[index];
+		const char* value = index + 1 < argc ? argv[index + 1] : nullptr;
+		if (value == nullptr) {
+			fprintf(stderr, "Missing value for %s\n", argument);
+			return 1;
+		}
+		++index;
+
+		if (strcmp(argument, "-out") == 0) {
+			outputPath = value;
+		} else if (strcmp(argument, "-commit") == 0) {
+			commit = value;
+		} else if (strcmp(argument, "-filter") == 0) {
+			settings.filter = value;
+		} else if (strcmp(argument, "-samples") == 0) {
+			settings.samples = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+		} else if (strcmp(argument, "-warmup") == 0) {
+			settings.warmupSamples = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+		} else if (strcmp(argument, "-iterations") == 0) {
+			settings.iterations = strtoull(value, nullptr, 10);
+		} else if (strcmp(argument, "-core") == 0) {
+			settings.core = atoi(value);
+		} else if (strcmp(argument, "-sampletime") == 0) {
+			settings.targetSampleMilliseconds = atof(value);
+		} else {
+			fprintf(stderr, "Unknown argument %s\n", argument);
+			return 1;
+		}
+	}
+
+	Enj::BenchmarkRunner runner(settings);
+	Enj::AddMathBenchmarks(runner);
+	runner.Run();
+	runner.PrintTable();
+
+	if (!outputPath.empty() && !runner.WriteJson(outputPath, commit)) {
+		fprintf(stderr, "Could not write %s\n", outputPath.c_str());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,351 @@
+#include "stdafx.h"
+
+#include "AssetLoader.h"
+#include "Profiling/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace {
+	std::string PendingKey(const std::filesystem::path& path, const std::type_index type) {
+		return path.lexically_normal().generic_string() + "\n" + type.name();
+	}
+}
+
+Enj::AssetRequest::AssetRequest(const std::filesystem::path& path, const std::type_index type, AssetDecoder decoder, const float priority) :
+	mPath(path),
+	mType(type),
+	mDecoder(std::move(decoder)),
+	mState(AssetState::Queued),
+	mPriority(priority),
+	mInterest(1),
+	mInReadQueue(false),
+	mInDecodeQueue(false) {}
+
+//*********************************************************************************
+Enj::AssetState Enj::AssetRequest::GetState() const {
+	return mState.load(std::memory_order_acquire);
+}
+
+//*********************************************************************************
+bool Enj::AssetRequest::IsFinished() const {
+	return GetState() >= AssetState::Ready;
+}
+
+//*********************************************************************************
+void Enj::AssetRequest::Wait() const {
+	AssetState state = GetState();
+	while (state < AssetState::Ready) {
+		mState.wait(state, std::memory_order_acquire);
+		state = GetState();
+	}
+}
+
+//*********************************************************************************
+const void* Enj::AssetRequest::GetData() const {
+	return GetState() == AssetState::Ready ? mData.get() : nullptr;
+}
+
+//*********************************************************************************
+const std::string& Enj::AssetRequest::GetError() const {
+	return mError;
+}
+
+//*********************************************************************************
+const std::filesystem::path& Enj::AssetRequest::GetPath() const {
+	return mPath;
+}
+
+//*********************************************************************************
+Enj::AssetLoader::AssetLoader(const AssetLoaderCreationParams& params) :
+	mStop(false),
+	mStats(),
+	mReadSeconds(0.0) {
+	for (uint32_t thread = 0; thread < std::max(params.ioThreadCount, 1u); ++thread) {
+		mThreads.emplace_back(&AssetLoader::IoMain, this, params.onThreadStart);
+	}
+	for (uint32_t thread = 0; thread < std::max(params.decodeThreadCount, 1u); ++thread) {
+		mThreads.emplace_back(&AssetLoader::DecodeMain, this, params.onThreadStart);
+	}
+}
+
+//*********************************************************************************
+Enj::AssetLoader::~AssetLoader() {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+
+		std::vector<std::shared_ptr<AssetRequest>> pending;
+		for (const auto& [key, request] : mPending) {
+			pending.push_back(request);
+		}
+		for (const std::shared_ptr<AssetRequest>& request : pending) {
+			Finish(request, AssetState::Cancelled);
+		}
+		mReadQueue.clear();
+		mDecodeQueue.clear();
+	}
+	mReadReady.notify_all();
+	mDecodeReady.notify_all();
+
+	for (std::thread& thread : mThreads) {
+		thread.join();
+	}
+}
+
+//*********************************************************************************
+Enj::AssetHandle<std::vector<uint8_t>> Enj::AssetLoader::LoadBytes(const std::filesystem::path& path, const float priority) {
+	return Load<std::vector<uint8_t>>(path, priority, [](std::vector<uint8_t>& bytes) { return std::move(bytes); });
+}
+
+//*********************************************************************************
+void Enj::AssetLoader::Cancel(const std::shared_ptr<AssetRequest>& request) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (request->IsFinished() || request->mInterest == 0 || --request->mInterest > 0) {
+		return;
+	}
+
+	// A request that is being read or decoded is dropped by its thread when it is done
+	if (request->mInReadQueue) {
+		mReadQueue.erase(request->mQueuePosition);
+		request->mInReadQueue = false;
+	} else if (request->mInDecodeQueue) {
+		mDecodeQueue.erase(request->mQueuePosition);
+		request->mInDecodeQueue = false;
+	}
+	Finish(request, AssetState::Cancelled);
+}
+
+//*********************************************************************************
+void Enj::AssetLoader::SetPriority(const std::shared_ptr<AssetRequest>& request, const float priority) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	Reprioritize(request, priority);
+}
+
+//*********************************************************************************
+void Enj::AssetLoader::Reprioritize(const std::shared_ptr<AssetRequest>& request, const float priority) {
+	request->mPriority = priority;
+	if (request->mInReadQueue) {
+		mReadQueue.erase(request->mQueuePosition);
+		Enqueue(mReadQueue, request);
+	} else if (request->mInDecodeQueue) {
+		mDecodeQueue.erase(request->mQueuePosition);
+		Enqueue(mDecodeQueue, request);
+	}
+}
+
+//*********************************************************************************
+Enj::AssetLoaderStats Enj::AssetLoader::GetStats() const {
+	std::lock_guard<std::mutex> lock(mMutex);
+	AssetLoaderStats stats = mStats;
+	stats.mReadBytesPerSecond = mReadSeconds > 0.0 ? static_cast<double>(stats.mBytesRead) / mReadSeconds : 0.0;
+	stats.mQueuedReads = static_cast<uint32_t>(mReadQueue.size());
+	stats.mQueuedDecodes = static_cast<uint32_t>(mDecodeQueue.size());
+	return stats;
+}
+
+//*********************************************************************************
+bool Enj::AssetLoader::WriteJson(const std::filesystem::path& path) const {
+	std::ofstream file(path);
+	if (!file) {
+		return false;
+	}
+
+	const AssetLoaderStats stats = GetStats();
+	file << "{\n";
+	file << "\t\"bytesRead\": " << stats.mBytesRead << ",\n";
+	file << "\t\"readBytesPerSecond\": " << stats.mReadBytesPerSecond << ",\n";
+	file << "\t\"queuedReads\": " << stats.mQueuedReads << ",\n";
+	file << "\t\"queuedDecodes\": " << stats.mQueuedDecodes << ",\n";
+	file << "\t\"peakQueueDepth\": " << stats.mPeakQueueDepth << ",\n";
+	file << "\t\"loaded\": " << stats.mLoaded << ",\n";
+	file << "\t\"failed\": " << stats.mFailed << ",\n";
+	file << "\t\"cancelled\": " << stats.mCancelled << ",\n";
+	file << "\t\"coalesced\": " << stats.mCoalesced << "\n";
+	file << "}\n";
+	return static_cast<bool>(file);
+}
+
+//*********************************************************************************
+std::shared_ptr<Enj::AssetRequest> Enj::AssetLoader::Request(const std::filesystem::path& path, const std::type_index type, AssetDecoder decoder, const float priority) {
+	std::unique_lock<std::mutex> lock(mMutex);
+	const std::string key = PendingKey(path, type);
+	const auto pending = mPending.find(key);
+	if (pending != mPending.end()) {
+		std::shared_ptr<AssetRequest> request = pending->second;
+		++request->mInterest;
+		++mStats.mCoalesced;
+
+		// The most important caller decides where the shared request waits
+		if (priority > request->mPriority) {
+			Reprioritize(request, priority);
+		}
+		return request;
+	}
+
+	std::shared_ptr<AssetRequest> request = std::make_shared<AssetRequest>(path, type, std::move(decoder), priority);
+	mPending.emplace(key, request);
+	Enqueue(mReadQueue, request);
+	lock.unlock();
+
+	mReadReady.notify_one();
+	return request;
+}
+
+//*********************************************************************************
+void Enj::AssetLoader::IoMain(std::function<void()> onThreadStart) {
+	ENJ_PROFILE_THREAD("Asset I/O");
+	if (onThreadStart) {
+		onThreadStart();
+	}
+
+	while (true) {
+		std::shared_ptr<AssetRequest> request;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mReadReady.wait(lock, [this]() { return mStop || !mReadQueue.empty(); });
+			if (mStop) {
+				return;
+			}
+			request = Dequeue(mReadQueue);
+			request->mState.store(AssetState::Reading, std::memory_order_release);
+		}
+
+		std::vector<uint8_t> bytes;
+		std::string error;
+		const auto begin = std::chrono::steady_clock::now();
+		try {
+			ENJ_PROFILE_SCOPE("AssetLoader::Read");
+			// A directory can open as a stream, its size is then -1 or garbage
+			std::error_code status;
+			const bool directory = std::filesystem::is_directory(request->mPath, status);
+			std::ifstream file(request->mPath, std::ios::binary | std::ios::ate);
+			const std::streamoff size = file && !directory ? static_cast<std::streamoff>(file.tellg()) : -1;
+			if (!file || directory) {
+				error = "Could not open " + request->mPath.string();
+			} else if (size < 0) {
+				error = "Could not read " + request->mPath.string();
+			} else {
+				bytes.resize(static_cast<size_t>(size));
+				file.seekg(0);
+				if (!file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+					error = "Could not read " + request->mPath.string();
+				}
+			}
+		} catch (const std::exception& exception) {
+			// Too large to hold, or the stream threw, the request fails instead of the thread
+			bytes.clear();
+			error = request->mPath.string() + ": " + exception.what();
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStats.mBytesRead += bytes.size();
+			mReadSeconds += seconds;
+
+			if (request->mState.load(std::memory_order_relaxed) == AssetState::Cancelled) {
+				continue;
+			}
+			if (!error.empty()) {
+				request->mError = std::move(error);
+				Finish(request, AssetState::Failed);
+				continue;
+			}
+
+			request->mBytes = std::move(bytes);
+			request->mState.store(AssetState::Decoding, std::memory_order_release);
+			Enqueue(mDecodeQueue, request);
+		}
+		mDecodeReady.notify_one();
+	}
+}
+
+//*********************************************************************************
+void Enj::AssetLoader::DecodeMain(std::function<void()> onThreadStart) {
+	ENJ_PROFILE_THREAD("Asset Decode");
+	if (onThreadStart) {
+		onThreadStart();
+	}
+
+	while (true) {
+		std::shared_ptr<AssetRequest> request;
+		std::vector<uint8_t> bytes;
+		AssetDecoder decoder;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mDecodeReady.wait(lock, [this]() { return mStop || !mDecodeQueue.empty(); });
+			if (mStop) {
+				return;
+			}
+			request = Dequeue(mDecodeQueue);
+			bytes = std::move(request->mBytes);
+			decoder = std::move(request->mDecoder);
+		}
+
+		std::shared_ptr<const void> data;
+		std::string error;
+		try {
+			ENJ_PROFILE_SCOPE("AssetLoader::Decode");
+			data = decoder(bytes);
+		} catch (const std::exception& exception) {
+			error = request->mPath.string() + ": " + exception.what();
+		} catch (...) {
+			error = request->mPath.string() + ": decoding failed";
+		}
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (request->mState.load(std::memory_order_relaxed) == AssetState::Cancelled) {
+			continue;
+		}
+		if (!error.empty()) {
+			request->mError = std::move(error);
+			Finish(request, AssetState::Failed);
+		} else {
+			request->mData = std::move(data);
+			Finish(request, AssetState::Ready);
+		}
+	}
+}
+
+//*********************************************************************************
+void Enj::AssetLoader::Enqueue(Queue& queue, const std::shared_ptr<AssetRequest>& request) {
+	request->mQueuePosition = queue.emplace(request->mPriority, request);
+	request->mInReadQueue = &queue == &mReadQueue;
+	request->mInDecodeQueue = &queue == &mDecodeQueue;
+	mStats.mPeakQueueDepth = std::max(mStats.mPeakQueueDepth, static_cast<uint32_t>(mReadQueue.size() + mDecodeQueue.size()));
+}
+
+//*********************************************************************************
+std::shared_ptr<Enj::AssetRequest> Enj::AssetLoader::Dequeue(Queue& queue) {
+	std::shared_ptr<AssetRequest> request = std::move(queue.begin()->second);
+	queue.erase(queue.begin());
+	request->mInReadQueue = false;
+	request->mInDecodeQueue = false;
+	return request;
+}
+
+//*********************************************************************************
+void Enj::AssetLoader::Finish(const std::shared_ptr<AssetRequest>& request, const AssetState state) {
+	const auto pending = mPending.find(PendingKey(request->mPath, request->mType));
+	if (pending != mPending.end() && pending->second == request) {
+		mPending.erase(pending);
+	}
+	request->mBytes.clear();
+	request->mBytes.shrink_to_fit();
+
+	switch (state) {
+	case AssetState::Ready:
+		++mStats.mLoaded;
+		break;
+	case AssetState::Failed:
+		++mStats.mFailed;
+		break;
+	default:
+		++mStats.mCancelled;
+		break;
+	}
+
+	request->mState.store(state, std::memory_order_release);
+	request->mState.notify_all();
+}
@@ -0,0 +1,191 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace Enj {
+	class AssetLoader;
+
+	enum class AssetState : uint8_t {
+		Queued,
+		Reading,
+		Decoding,
+		Ready,
+		Failed,
+		Cancelled
+	};
+
+	// Turns the bytes of a file into the asset, throwing fails the load. Runs on a decode thread
+	using AssetDecoder = std::function<std::shared_ptr<const void>(std::vector<uint8_t>& bytes)>;
+
+	// One load shared by every handle that asked for the same path and type
+	class AssetRequest {
+	public:
+		AssetRequest(const std::filesystem::path& path, const std::type_index type, AssetDecoder decoder, const float priority);
+		AssetRequest(const AssetRequest& request) = delete;
+		void operator=(const AssetRequest& request) = delete;
+
+		AssetState GetState() const;
+
+		// Ready, Failed or Cancelled, nothing changes afterwards
+		bool IsFinished() const;
+
+		// Blocks until the load is finished, for loading screens. The frame loop should poll instead
+		void Wait() const;
+
+		// nullptr until Ready
+		const void* GetData() const;
+		// Why the load failed, set once Failed
+		const std::string& GetError() const;
+		const std::filesystem::path& GetPath() const;
+
+	private:
+		friend class AssetLoader;
+
+		const std::filesystem::path mPath;
+		const std::type_index mType;
+		AssetDecoder mDecoder;
+		std::atomic<AssetState> mState;
+		std::shared_ptr<const void> mData;
+		std::string mError;
+
+		// Guarded by the loader's mutex
+		std::vector<uint8_t> mBytes;
+		float mPriority;
+		uint32_t mInterest;		// Load calls that have not cancelled
+		std::multimap<float, std::shared_ptr<AssetRequest>, std::greater<float>>::iterator mQueuePosition;
+		bool mInReadQueue;
+		bool mInDecodeQueue;
+	};
+
+	// Resolves once the asset is loaded, copies share the load
+	template <class T>
+	class AssetHandle {
+	public:
+		AssetHandle() = default;
+		explicit AssetHandle(std::shared_ptr<AssetRequest> request) :
+			mRequest(std::move(request)) {}
+
+		bool IsValid() const {
+			return mRequest != nullptr;
+		}
+
+		AssetState GetState() const {
+			return mRequest->GetState();
+		}
+
+		bool IsReady() const {
+			return mRequest != nullptr && mRequest->GetState() == AssetState::Ready;
+		}
+
+		void Wait() const {
+			mRequest->Wait();
+		}
+
+		// nullptr until ready
+		const T* Get() const {
+			return static_cast<const T*>(mRequest->GetData());
+		}
+
+		const std::string& GetError() const {
+			return mRequest->GetError();
+		}
+
+		const std::shared_ptr<AssetRequest>& GetRequest() const {
+			return mRequest;
+		}
+
+	private:
+		std::shared_ptr<AssetRequest> mRequest;
+	};
+
+	struct AssetLoaderStats {
+		uint64_t mBytesRead;
+		double mReadBytesPerSecond;		// Over the time the I/O threads spent reading
+		uint32_t mQueuedReads;
+		uint32_t mQueuedDecodes;
+		uint32_t mPeakQueueDepth;		// Most reads and decodes queued at once
+		uint64_t mLoaded;
+		uint64_t mFailed;
+		uint64_t mCancelled;
+		uint64_t mCoalesced;			// Loads that joined one already in progress
+	};
+
+	struct AssetLoaderCreationParams {
+		uint32_t ioThreadCount = 1;
+		uint32_t decodeThreadCount = 2;
+		std::function<void()> onThreadStart;	// Runs first on every loader thread, to lower its priority
+	};
+
+	/*	Reads files on I/O threads and decodes them on decode threads, so nothing that loads has to block the frame.
+		Both stages take the highest priority request first, callers pass importance or negated distance and can change
+		it while the request waits. Loading a path and type that is already on its way returns the same request.
+		Finished requests leave the loader, the handles keep the data alive */
+	class AssetLoader {
+	public:
+		explicit AssetLoader(const AssetLoaderCreationParams& params = {});
+		AssetLoader(const AssetLoader& loader) = delete;
+		void operator=(const AssetLoader& loader) = delete;
+
+		// Cancels what has not finished and joins the threads
+		~AssetLoader();
+
+		// decode(bytes) returns the asset
+		template <class T, class Decode>
+		AssetHandle<T> Load(const std::filesystem::path& path, const float priority, Decode&& decode) {
+			AssetDecoder decoder = [decode = std::forward<Decode>(decode)](std::vector<uint8_t>& bytes) -> std::shared_ptr<const void> {
+				return std::make_shared<const T>(decode(bytes));
+			};
+			return AssetHandle<T>(Request(path, std::type_index(typeid(T)), std::move(decoder), priority));
+		}
+
+		// The file as it is on disk, like compiled shaders
+		AssetHandle<std::vector<uint8_t>> LoadBytes(const std::filesystem::path& path, const float priority);
+
+		// Once per Load call. The request is cancelled when every Load that shares it cancelled and it has not finished
+		void Cancel(const std::shared_ptr<AssetRequest>& request);
+
+		// Moves a waiting request in the queue it is in, no effect once it is being read or decoded
+		void SetPriority(const std::shared_ptr<AssetRequest>& request, const float priority);
+
+		AssetLoaderStats GetStats() const;
+		bool WriteJson(const std::filesystem::path& path) const;
+
+	private:
+		using Queue = std::multimap<float, std::shared_ptr<AssetRequest>, std::greater<float>>;
+
+		std::shared_ptr<AssetRequest> Request(const std::filesystem::path& path, const std::type_index type, AssetDecoder decoder, const float priority);
+
+		void IoMain(std::function<void()> onThreadStart);
+		void DecodeMain(std::function<void()> onThreadStart);
+
+		// Expect mMutex to be held
+		void Reprioritize(const std::shared_ptr<AssetRequest>& request, const float priority);
+		void Enqueue(Queue& queue, const std::shared_ptr<AssetRequest>& request);
+		std::shared_ptr<AssetRequest> Dequeue(Queue& queue);
+		void Finish(const std::shared_ptr<AssetRequest>& request, const AssetState state);
+
+		mutable std::mutex mMutex;
+		std::condition_variable mReadReady;
+		std::condition_variable mDecodeReady;
+		Queue mReadQueue;
+		Queue mDecodeQueue;
+		std::unordered_map<std::string, std::shared_ptr<AssetRequest>> mPending;
+		bool mStop;
+
+		AssetLoaderStats mStats;
+		double mReadSeconds;
+
+		std::vector<std::thread> mThreads;
+	};
+}
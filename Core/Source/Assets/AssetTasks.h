@@ -0,0 +1,40 @@
+#pragma once
+#include <coroutine>
+#include <filesystem>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+#include "AssetLoader.h"
+#include "Threading/Task.h"
+
+namespace Enj {
+	// co_await WhenLoaded(scheduler, handle) continues on the main thread in the first Tick after the load finished, with
+	// the handle back. It always suspends, a load that already finished still continues in Tick and not on the caller's thread
+	template <class T>
+	auto WhenLoaded(FrameScheduler& scheduler, AssetHandle<T> handle) {
+		struct Awaiter {
+			bool await_ready() const noexcept {
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> coroutine) {
+				mScheduler.ResumeWhen(coroutine, [](const void* request) {
+					return static_cast<const AssetRequest*>(request)->IsFinished();
+				}, mHandle.GetRequest());
+			}
+
+			AssetHandle<T> await_resume() const noexcept {
+				return mHandle;
+			}
+
+			FrameScheduler& mScheduler;
+			AssetHandle<T> mHandle;
+		};
+		return Awaiter{ scheduler, std::move(handle) };
+	}
+
+	// Reads the file on the loader's I/O threads, the coroutine continues in Tick with a handle to the bytes, or to the error
+	inline auto ReadFile(FrameScheduler& scheduler, AssetLoader& loader, const std::filesystem::path& path, const float priority = 0.0f) {
+		return WhenLoaded(scheduler, loader.LoadBytes(path, priority));
+	}
+}
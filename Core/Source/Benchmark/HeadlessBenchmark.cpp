@@ -0,0 +1,369 @@
+#include "stdafx.h"
+
+#include "HeadlessBenchmark.h"
+#include "Scene/BenchmarkScene.h"
+#include "Threading/JobSystem.h"
+#include "Threading/Task.h"
+#include "Memory/FrameAllocator.h"
+#include "Profiling/Profiler.h"
+#include <Utility/FrameStatistics.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <numeric>
+#include <span>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+	using NamedValues = std::vector<std::pair<std::string, double>>;
+
+	constexpr float sStepTime = 1.0f / 60.0f;
+	// Visible indices per summing task
+	constexpr size_t sSumSliceSize = 4096;
+
+	struct FrameSample {
+		float mFrame;
+		float mSimulate;
+		float mBVH;
+		float mCull;
+		uint32_t mVisible;
+	};
+
+	struct Comparison {
+		std::string mName;
+		double mBaseline;
+		double mCurrent;
+		double mTolerance;	// Percent, negative for counters that have to match exactly
+		bool mRegressed;
+	};
+
+	// Reads the "name": number pairs of a flat object in the files this runner writes, not a general JSON parser
+	bool ReadNumberObject(const std::string& text, const std::string& objectName, std::map<std::string, double>& values) {
+		size_t position = text.find("\"" + objectName + "\"");
+		if (position == std::string::npos) {
+			return false;
+		}
+		position = text.find('{', position);
+		if (position == std::string::npos) {
+			return false;
+		}
+
+		++position;
+		while (true) {
+			position = text.find_first_not_of(" \t\r\n,", position);
+			if (position == std::string::npos) {
+				return false;
+			}
+			if (text[position] == '}') {
+				return true;
+			}
+			if (text[position] != '"') {
+				return false;
+			}
+
+			const size_t keyEnd = text.find('"', position + 1);
+			const size_t colon = keyEnd == std::string::npos ? std::string::npos : text.find(':', keyEnd);
+			if (colon == std::string::npos) {
+				return false;
+			}
+			const std::string key = text.substr(position + 1, keyEnd - position - 1);
+
+			char* numberEnd = nullptr;
+			const double value = strtod(text.c_str() + colon + 1, &numberEnd);
+			if (numberEnd == text.c_str() + colon + 1) {
+				return false;
+			}
+			values[key] = value;
+			position = static_cast<size_t>(numberEnd - text.c_str());
+		}
+	}
+
+	void WriteNumberObject(std::ofstream& file, const char* name, const NamedValues& values, const bool last) {
+		file << "\t\"" << name << "\": {";
+		for (size_t index = 0; index < values.size(); ++index) {
+			file << (index == 0 ? " " : ", ") << "\"" << values[index].first << "\": " << values[index].second;
+		}
+		file << " }" << (last ? "\n" : ",\n");
+	}
+
+	Enj::Task<uint64_t> SumIndices(Enj::JobSystem& jobSystem, const std::span<const uint32_t> indices) {
+		co_await Enj::ResumeOnWorker(jobSystem);
+		co_return std::accumulate(indices.begin(), indices.end(), uint64_t(0));
+	}
+
+	// Adds up the visible indices of every frame in slices on the workers. A culling change that keeps the visible
+	// count but not which objects are visible changes the sum, and the frame scheduler, WhenAll and workers run the
+	// way game code uses them. Each frame continues in that frame's Tick, after the scene's Update, and the Tick after
+	// the last frame finishes it on the main thread
+	Enj::Task<void> SumVisible(Enj::FrameScheduler& scheduler, Enj::JobSystem& jobSystem, const Enj::BenchmarkScene& scene,
+		const uint32_t frameCount, uint64_t& sum) {
+		co_await scheduler.NextFrame();
+		for (uint32_t frame = 0; frame < frameCount; ++frame) {
+			const std::span<const uint32_t> visible = scene.GetLastVisible();
+			std::vector<Enj::Task<uint64_t>> slices;
+			for (size_t begin = 0; begin < visible.size(); begin += sSumSliceSize) {
+				slices.push_back(SumIndices(jobSystem, visible.subspan(begin, std::min(sSumSliceSize, visible.size() - begin))));
+			}
+			for (const uint64_t sliceSum : co_await Enj::WhenAll(std::move(slices))) {
+				sum += sliceSum;
+			}
+			co_await scheduler.NextFrame();
+		}
+	}
+
+	double Mean(const std::vector<FrameSample>& samples, float FrameSample::* member) {
+		double sum = 0.0;
+		for (const FrameSample& sample : samples) {
+			sum += sample.*member;
+		}
+		return samples.empty() ? 0.0 : sum / samples.size();
+	}
+}
+
+Enj::HeadlessBenchmark::HeadlessBenchmark(const HeadlessBenchmarkSettings& settings) :
+	mSettings(settings) {}
+
+//*********************************************************************************
+int Enj::HeadlessBenchmark::ParseArgument(HeadlessBenchmarkSettings& settings, const std::string& argument, const char* value) {
+	if (value == nullptr) {
+		return 0;
+	}
+
+	// Paths come in as UTF-8
+	const auto toPath = [](const char* text) { return std::filesystem::path(reinterpret_cast<const char8_t*>(text)); };
+
+	if (argument == "-benchmark") {
+		settings.frames = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+	} else if (argument == "-out") {
+		settings.outputPath = toPath(value);
+	} else if (argument == "-baseline") {
+		settings.baselinePath = toPath(value);
+	} else if (argument == "-warmup") {
+		settings.warmupFrames = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+	} else if (argument == "-objects") {
+		settings.objectCount = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+	} else if (argument == "-seed") {
+		settings.seed = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+	} else if (argument == "-workers") {
+		settings.threads.workerCount = atoi(value);
+	} else if (argument == "-tolerance") {
+		// "-tolerance 5" sets the default, "-tolerance frame.p99Ms=20" a single metric
+		const char* separator = strchr(value, '=');
+		if (separator == nullptr) {
+			settings.defaultTolerance = static_cast<float>(atof(value));
+		} else {
+			settings.tolerances[std::string(value, separator)] = static_cast<float>(atof(separator + 1));
+		}
+	} else {
+		return 0;
+	}
+	return 2;
+}
+
+//*********************************************************************************
+int Enj::HeadlessBenchmark::Run() {
+	if (mSettings.frames == 0 || mSettings.objectCount == 0) {
+		fprintf(stderr, "Benchmark needs at least one frame and one object\n");
+		return sExitError;
+	}
+
+	ENJ_PROFILE_THREAD("Main");
+	// Same setup as the engine, the scene's dispatches run on the job system
+	const CpuTopology topology = CpuTopology::Detect();
+	const ThreadPlacement placement = ThreadPlacement::Plan(topology, mSettings.threads, false);
+	ConfigureCurrentThread(topology, placement.mMain, mSettings.threads.mainPriority);
+	// Destroyed after the job system, like in the engine
+	FrameScheduler scheduler;
+	JobSystem jobSystem(placement.WorkerCount(), [&](const unsigned int workerIndex) {
+		ConfigureCurrentThread(topology, placement.mWorkers[workerIndex - 1], mSettings.threads.workerPriority);
+	});
+	FrameAllocator frameAllocator;
+	BenchmarkScene scene(mSettings.objectCount, mSettings.seed, jobSystem, frameAllocator);
+
+	for (uint32_t frame = 0; frame < mSettings.warmupFrames; ++frame) {
+		frameAllocator.BeginFrame();
+		scene.Update(sStepTime);
+	}
+
+	// Counters cover the timed frames only
+	const BenchmarkSceneCounters warmupCounters = scene.GetCounters();
+
+	uint64_t visibleIndexSum = 0;
+	scheduler.Spawn(SumVisible(scheduler, jobSystem, scene, mSettings.frames, visibleIndexSum));
+
+	jobSystem.ResetStats();
+
+	std::vector<FrameSample> samples;
+	samples.reserve(mSettings.frames);
+	FrameStatistics statistics(mSettings.frames);
+	for (uint32_t frame = 0; frame < mSettings.frames; ++frame) {
+		const Clock::time_point start = Clock::now();
+		{
+			ENJ_PROFILE_FRAME();
+			frameAllocator.BeginFrame();
+			scene.Update(sStepTime);
+		}
+		const float frameTime = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+		// Untimed. The sum is back waiting in the scheduler before the next frame recycles frame memory or ticks
+		scheduler.Tick();
+		while (scheduler.GetWaitingCount() == 0) {
+			if (!jobSystem.TryRunJob()) {
+				std::this_thread::yield();
+			}
+		}
+
+		const BenchmarkSceneTimings& timings = scene.GetTimings();
+		samples.push_back({ frameTime, timings.mSimulate, timings.mBVH, timings.mCull, scene.GetLastVisibleCount() });
+		statistics.AddFrame(frameTime);
+	}
+
+	// Finishes SumVisible and rethrows what it threw
+	scheduler.Tick();
+
+	const FrameTimeSummary summary = statistics.GetSummary();
+	const NamedValues metrics = {
+		{ "frame.meanMs", summary.mMean },
+		{ "frame.p50Ms", summary.mP50 },
+		{ "frame.p95Ms", summary.mP95 },
+		{ "frame.p99Ms", summary.mP99 },
+		{ "frame.maxMs", summary.mMax },
+		{ "simulate.meanMs", Mean(samples, &FrameSample::mSimulate) },
+		{ "bvh.meanMs", Mean(samples, &FrameSample::mBVH) },
+		{ "cull.meanMs", Mean(samples, &FrameSample::mCull) }
+	};
+	const BenchmarkSceneCounters& counters = scene.GetCounters();
+	const NamedValues counterValues = {
+		{ "culledVisible", static_cast<double>(counters.mCulledVisible - warmupCounters.mCulledVisible) },
+		{ "bvhVisible", static_cast<double>(counters.mBVHVisible - warmupCounters.mBVHVisible) },
+		{ "bvhRebuilds", static_cast<double>(counters.mBVHRebuilds - warmupCounters.mBVHRebuilds) },
+		{ "bvhNodes", static_cast<double>(counters.mBVHNodes) },
+		{ "visibleIndexSum", static_cast<double>(visibleIndexSum) }
+	};
+	const NamedValues settingValues = {
+		{ "frames", mSettings.frames },
+		{ "warmupFrames", mSettings.warmupFrames },
+		{ "objects", mSettings.objectCount },
+		{ "seed", mSettings.seed },
+		{ "workers", jobSystem.WorkerCount() },
+		{ "pinned", mSettings.threads.pinThreads ? 1 : 0 }
+	};
+
+	int exitCode = sExitSuccess;
+	std::vector<Comparison> comparisons;
+	if (!mSettings.baselinePath.empty()) {
+		std::ifstream baselineFile(mSettings.baselinePath);
+		std::stringstream baselineText;
+		baselineText << baselineFile.rdbuf();
+
+		std::map<std::string, double> baselineSettings, baselineMetrics, baselineCounters;
+		if (!baselineFile || !ReadNumberObject(baselineText.str(), "settings", baselineSettings) ||
+			!ReadNumberObject(baselineText.str(), "metrics", baselineMetrics) || !ReadNumberObject(baselineText.str(), "counters", baselineCounters)) {
+			fprintf(stderr, "Could not read baseline %s\n", mSettings.baselinePath.string().c_str());
+			return sExitError;
+		}
+
+		// Different scenes cannot be compared, a different worker count only makes the timings less meaningful
+		for (const char* name : { "frames", "warmupFrames", "objects", "seed" }) {
+			const auto setting = std::find_if(settingValues.begin(), settingValues.end(), [name](const auto& value) { return value.first == name; });
+			if (baselineSettings[name] != setting->second) {
+				fprintf(stderr, "Baseline was run with %s %g, this run uses %g\n", name, baselineSettings[name], setting->second);
+				return sExitError;
+			}
+		}
+		if (baselineSettings["workers"] != jobSystem.WorkerCount()) {
+			fprintf(stderr, "Warning: baseline ran with %g workers, this run has %u\n", baselineSettings["workers"], jobSystem.WorkerCount());
+		}
+		if (baselineSettings["pinned"] != settingValues.back().second) {
+			fprintf(stderr, "Warning: baseline and this run differ in thread pinning\n");
+		}
+
+		for (const auto& [name, current] : metrics) {
+			const auto baseline = baselineMetrics.find(name);
+			if (baseline == baselineMetrics.end()) {
+				continue;
+			}
+			const auto tolerance = mSettings.tolerances.find(name);
+			const double allowed = tolerance != mSettings.tolerances.end() ? tolerance->second : mSettings.defaultTolerance;
+			comparisons.push_back({ name, baseline->second, current, allowed, current > baseline->second * (1.0 + allowed / 100.0) });
+		}
+		for (const auto& [name, current] : counterValues) {
+			const auto baseline = baselineCounters.find(name);
+			if (baseline != baselineCounters.end()) {
+				comparisons.push_back({ name, baseline->second, current, -1.0, current != baseline->second });
+			}
+		}
+
+		for (const Comparison& comparison : comparisons) {
+			if (comparison.mRegressed) {
+				exitCode = sExitRegression;
+			}
+		}
+	}
+
+	printf("%-18s %12s %12s %9s\n", "Metric", "Baseline", "Current", "Change");
+	for (const auto& [name, current] : metrics) {
+		const auto comparison = std::find_if(comparisons.begin(), comparisons.end(), [&name](const Comparison& value) { return value.mName == name; });
+		if (comparison == comparisons.end()) {
+			printf("%-18s %12s %12.4f\n", name.c_str(), "-", current);
+		} else {
+			const double change = comparison->mBaseline > 0.0 ? 100.0 * (current / comparison->mBaseline - 1.0) : 0.0;
+			printf("%-18s %12.4f %12.4f %+8.1f%% %s\n", name.c_str(), comparison->mBaseline, current, change, comparison->mRegressed ? "REGRESSION" : "");
+		}
+	}
+	for (const auto& [name, current] : counterValues) {
+		const auto comparison = std::find_if(comparisons.begin(), comparisons.end(), [&name](const Comparison& value) { return value.mName == name; });
+		printf("%-18s %12s %12.0f %9s %s\n", name.c_str(), comparison == comparisons.end() ? "-" : std::to_string(static_cast<uint64_t>(comparison->mBaseline)).c_str(),
+			current, "", comparison != comparisons.end() && comparison->mRegressed ? "MISMATCH" : "");
+	}
+
+	const std::vector<JobWorkerStats> jobStats = jobSystem.GetStats();
+	printf("\n%-8s %10s %10s %10s\n", "Worker", "Jobs", "Steals", "Idle ms");
+	for (size_t worker = 0; worker < jobStats.size(); ++worker) {
+		printf("%-8zu %10llu %10llu %10.1f\n", worker, static_cast<unsigned long long>(jobStats[worker].mJobsExecuted),
+			static_cast<unsigned long long>(jobStats[worker].mSteals), jobStats[worker].mIdleMilliseconds);
+	}
+
+	if (!mSettings.outputPath.empty()) {
+		std::ofstream file(mSettings.outputPath);
+		if (!file) {
+			fprintf(stderr, "Could not write %s\n", mSettings.outputPath.string().c_str());
+			return sExitError;
+		}
+
+		file.precision(9);
+		file << "{\n";
+		WriteNumberObject(file, "settings", settingValues, false);
+		WriteNumberObject(file, "metrics", metrics, false);
+		// Counters are compared exactly, so every digit is written
+		file.precision(17);
+		WriteNumberObject(file, "counters", counterValues, false);
+		file.precision(9);
+
+		file << "\t\"comparison\": [";
+		for (size_t index = 0; index < comparisons.size(); ++index) {
+			const Comparison& comparison = comparisons[index];
+			file << (index == 0 ? "\n" : ",\n") << "\t\t{ \"name\": \"" << comparison.mName << "\", \"baseline\": " << comparison.mBaseline
+				<< ", \"current\": " << comparison.mCurrent << ", \"tolerancePercent\": " << comparison.mTolerance
+				<< ", \"regressed\": " << (comparison.mRegressed ? "true" : "false") << " }";
+		}
+		file << (comparisons.empty() ? "],\n" : "\n\t],\n");
+
+		file << "\t\"frameColumns\": [\"frameMs\", \"simulateMs\", \"bvhMs\", \"cullMs\", \"visible\"],\n";
+		file << "\t\"frames\": [";
+		for (size_t index = 0; index < samples.size(); ++index) {
+			const FrameSample& sample = samples[index];
+			file << (index == 0 ? "\n" : ",\n") << "\t\t[" << sample.mFrame << ", " << sample.mSimulate << ", " << sample.mBVH << ", "
+				<< sample.mCull << ", " << sample.mVisible << "]";
+		}
+		file << "\n\t]\n";
+		file << "}\n";
+	}
+
+	return exitCode;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <filesystem>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include "Threading/ThreadTopology.h"
+
+namespace Enj {
+	struct HeadlessBenchmarkSettings {
+		uint32_t frames = 0;		// 0 is a normal windowed run
+		uint32_t warmupFrames = 60;	// Run before the timed frames, not reported
+		uint32_t objectCount = 50000;
+		uint32_t seed = 1;
+		ThreadConfiguration threads;	// -workers sets threads.workerCount, the engine fills in the rest
+
+		std::filesystem::path outputPath;
+		std::filesystem::path baselinePath;
+
+		// Allowed slowdown against the baseline in percent, per metric name or defaultTolerance for the rest.
+		// The slowest single frame is too noisy for the default, it only fails when it doubles unless set explicitly
+		float defaultTolerance = 10.0f;
+		std::map<std::string, float> tolerances = { { "frame.maxMs", 100.0f } };
+	};
+
+	/*	Runs the benchmark scene at a fixed 60 Hz step for a number of frames without a window or GPU,
+		then writes per frame timings, percentiles and counters as JSON and compares them with a baseline file
+		written by an earlier run. The exit code gates a build:
+			0 - no regression (or no baseline)
+			1 - a metric is slower than its tolerance allows, or a counter differs
+			2 - bad settings or unreadable files */
+	class HeadlessBenchmark {
+	public:
+		static constexpr int sExitSuccess = 0;
+		static constexpr int sExitRegression = 1;
+		static constexpr int sExitError = 2;
+
+		explicit HeadlessBenchmark(const HeadlessBenchmarkSettings& settings);
+
+		// Parses "-benchmark <frames>" and the options that go with it, returns how many arguments were consumed,
+		// 0 when argument is not a benchmark option. Used by the engine and by the standalone runner
+		static int ParseArgument(HeadlessBenchmarkSettings& settings, const std::string& argument, const char* value);
+
+		int Run();
+
+	private:
+		HeadlessBenchmarkSettings mSettings;
+	};
+}
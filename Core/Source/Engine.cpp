@@ -3,10 +3,67 @@
 #include "Engine.h"
 #include "Window/Window.h"
 #include "Graphics/D12Renderer.h"
+#include "Graphics/RenderThread.h"
+#include "Threading/JobSystem.h"
+#include "Threading/TaskGraph.h"
+#include "Assets/AssetLoader.h"
+#include "Threading/Task.h"
+#include "Memory/FrameAllocator.h"
+#include "Profiling/Profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <stdio.h>
 
 using namespace Microsoft::WRL;
 
-Enj::Engine::Engine() {
+namespace {
+    std::string ToUtf8(const wchar_t* text) {
+        const int size = WideCharToMultiByte(CP_UTF8, 0, text, -1, nullptr, 0, nullptr, nullptr);
+        if (size <= 1) {
+            return std::string();
+        }
+        std::string result(static_cast<size_t>(size - 1), '\0');
+        WideCharToMultiByte(CP_UTF8, 0, text, -1, result.data(), size, nullptr, nullptr);
+        return result;
+    }
+
+    Enj::ThreadPriority ParseThreadPriority(const wchar_t* text) {
+        if (_wcsicmp(text, L"low") == 0) {
+            return Enj::ThreadPriority::Low;
+        }
+        if (_wcsicmp(text, L"high") == 0) {
+            return Enj::ThreadPriority::High;
+        }
+        if (_wcsicmp(text, L"highest") == 0) {
+            return Enj::ThreadPriority::Highest;
+        }
+        return Enj::ThreadPriority::Normal;
+    }
+
+    Enj::CoreType ParseCoreType(const wchar_t* text) {
+        if (_wcsicmp(text, L"p") == 0) {
+            return Enj::CoreType::Performance;
+        }
+        if (_wcsicmp(text, L"e") == 0) {
+            return Enj::CoreType::Efficiency;
+        }
+        return Enj::CoreType::Any;
+    }
+}
+
+Enj::Engine::Engine() :
+    mWindowEventQueue(nullptr),
+    mWindowEventCount(0),
+    mUseWarpDevice(false),
+    mProfileFrames(0),
+    mWriteFrameStats(false),
+    mHitchBudget(1000.0f / 60.0f),
+    mFixedUpdateRate(0.0f),
+    mMaxStepsPerFrame(5),
+    mFpsLimit(0.0f),
+    mVSync(true),
+    mDumpFrameGraph(false),
+    mPipelineDepth(1) {
     // Parse the command line parameters
     int argc;
     LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
@@ -38,27 +95,111 @@ Enj::Engine::Engine() {
 Enj::Engine::~Engine() {}
 
 //*********************************************************************************
-void Enj::Engine::Init(std::shared_ptr<Enj::Window> window) {
+void Enj::Engine::Init(std::shared_ptr<Enj::Window> window, WindowEventQueue& windowEvents) {
     mWindow = std::move(window);
+    mWindowEventQueue = &windowEvents;
+    mWindowEvents.resize(windowEvents.Capacity());
+
+    // Every thread applies its own placement as it starts, this one right away
+    mCpuTopology = CpuTopology::Detect();
+    mThreadPlacement = ThreadPlacement::Plan(mCpuTopology, mThreadConfiguration, mPipelineDepth > 0);
+    ConfigureCurrentThread(mCpuTopology, mThreadPlacement.mMain, mThreadConfiguration.mainPriority);
+    if (mThreadConfiguration.writeTopology) {
+        std::ofstream(mAssetsPath + L"topology.txt") << mCpuTopology.ToText() << "\n" << mThreadPlacement.ToText();
+    }
+
+    // One worker per core besides this thread by default
+    mJobSystem = std::make_unique<JobSystem>(mThreadPlacement.WorkerCount(), [this](const unsigned int workerIndex) {
+        ConfigureCurrentThread(mCpuTopology, mThreadPlacement.mWorkers[workerIndex - 1], mThreadConfiguration.workerPriority);
+    });
+    mFrameGraph = std::make_unique<TaskGraph>(*mJobSystem);
+
+    // Below the frame's threads, loads should never take time from a frame
+    AssetLoaderCreationParams assetLoaderParams;
+    assetLoaderParams.onThreadStart = [this]() {
+        ConfigureCurrentThread(mCpuTopology, {}, ThreadPriority::Low);
+    };
+    mAssetLoader = std::make_unique<AssetLoader>(assetLoaderParams);
+    mFrameScheduler = std::make_unique<FrameScheduler>();
+
+    // The render thread can still be on a frame pipelineDepth + 1 frames behind the one the main thread begins
+    FrameAllocatorCreationParams frameAllocatorParams;
+    frameAllocatorParams.frameCount = std::max<uint32_t>(D12Renderer::sFrameCount, mPipelineDepth + 2);
+    mFrameAllocator = std::make_unique<FrameAllocator>(frameAllocatorParams);
 
     D12RendererCreationParams params;
     params.windowSize = mWindow->WindowSize();
+    params.jobSystem = mJobSystem.get();
+    params.assetLoader = mAssetLoader.get();
+    params.frameAllocator = mFrameAllocator.get();
+    params.shaderPath = mAssetsPath + L"Shaders";
+    params.vsync = mVSync;
     mRenderer = std::make_unique<D12Renderer>(params);
     mRenderer->Init(mWindow->Hwnd());
+    if (mPipelineDepth > 0) {
+        mRenderThread = std::make_unique<RenderThread>(*mRenderer, mPipelineDepth, [this]() {
+            ConfigureCurrentThread(mCpuTopology, mThreadPlacement.mRender, mThreadConfiguration.renderPriority);
+        });
+    }
+
+#if defined(ENJ_PROFILE)
+    Profiler::RequestCapture(mAssetsPath + L"profile.json", mProfileFrames);
+#endif
 }
 
 //*********************************************************************************
 void Enj::Engine::Update(const FrameData& frameData) {
-    mRenderer->Update(frameData);
+    ProcessWindowEvents();
+    frameData;
+}
+
+//*********************************************************************************
+void Enj::Engine::BeginFrame() {
+    mFrameAllocator->BeginFrame();
+}
+
+//*********************************************************************************
+Enj::TaskGraph& Enj::Engine::GetFrameGraph() {
+    return *mFrameGraph;
+}
+
+//*********************************************************************************
+void Enj::Engine::AddRenderStages() {
+    // Render stages only read the scene through the snapshot, whatever the next frame's simulation changes meanwhile
+    mFrameGraph->AddStage("RenderSnapshot", { "Simulation" }, { "RenderSnapshot" }, [this]() {
+        mRenderSnapshot.emplace(mRenderer->TakeSnapshot(*mRenderFrameData, mFrameAllocator->GetFrameIndex()));
+    });
+
+    // The render thread culls, records and presents while the graph already runs the next frame's simulation
+    if (mRenderThread) {
+        mFrameGraph->AddStage("SubmitFrame", { "RenderSnapshot" }, { "RenderQueue" }, [this]() {
+            mRenderThread->Submit(*mRenderSnapshot);
+        }, TaskGraph::Affinity::MainThread);
+        return;
+    }
+
+    // Culling belongs to the rendered frame, with a fixed timestep Update can run any number of times per frame
+    mFrameGraph->AddStage("Culling", { "RenderSnapshot" }, { "VisibleDraws" }, [this]() {
+        mVisibleDraws = mRenderer->Cull(*mRenderSnapshot);
+    });
+    mFrameGraph->AddStage("RecordCommands", { "RenderSnapshot", "VisibleDraws" }, { "CommandList" }, [this]() {
+        mRenderer->RecordCommands(*mRenderSnapshot, mVisibleDraws);
+    });
+    mFrameGraph->AddStage("Present", { "CommandList" }, { "SwapChain" }, [this]() {
+        mRenderer->Present();
+    }, TaskGraph::Affinity::MainThread);
 }
 
 //*********************************************************************************
-void Enj::Engine::Render(const FrameData& frameData) {
-    mRenderer->Render(frameData);
+void Enj::Engine::SetRenderFrameData(const FrameData& frameData) {
+    mRenderFrameData.emplace(frameData);
 }
 
 //*********************************************************************************
-void Enj::Engine::Destroy() {}
+void Enj::Engine::Destroy() {
+    // Renders what is still queued and joins the render thread
+    mRenderThread.reset();
+}
 
 //*********************************************************************************
 const OMath::Vector2ui& Enj::Engine::GetWindowSize() {
@@ -79,13 +220,191 @@ void Enj::Engine::ParseCommandLineArgs(wchar_t* argv[], int argc) {
             mUseWarpDevice = true;
             mTitle = mTitle + L" (WARP)";
         }
+        // -profile <frames> writes that many frames after the first one to profile.json. Builds without ENJ_PROFILE
+        // record no zones, they reject it instead of writing an empty capture
+        else if (_wcsicmp(argv[i], L"-profile") == 0 && i + 1 < argc) {
+#if defined(ENJ_PROFILE)
+            mProfileFrames = static_cast<uint32_t>(wcstoul(argv[++i], nullptr, 10));
+#else
+            ++i;
+            fprintf(stderr, "-profile needs a build with ENJ_PROFILE defined, ignoring it\n");
+            OutputDebugStringW(L"-profile needs a build with ENJ_PROFILE defined, ignoring it\n");
+#endif
+        }
+        // -framestats writes framestats.json, framestats.csv and assetstats.json at shutdown
+        else if (_wcsicmp(argv[i], L"-framestats") == 0) {
+            mWriteFrameStats = true;
+        }
+        // -fixedstep <hz> runs Update at a fixed rate, -maxsteps <n> limits the catch up steps per frame
+        else if (_wcsicmp(argv[i], L"-fixedstep") == 0 && i + 1 < argc) {
+            mFixedUpdateRate = static_cast<float>(_wtof(argv[++i]));
+        }
+        else if (_wcsicmp(argv[i], L"-maxsteps") == 0 && i + 1 < argc) {
+            mMaxStepsPerFrame = static_cast<uint32_t>(wcstoul(argv[++i], nullptr, 10));
+        }
+        // -fpslimit <fps> paces the main loop, usually together with -novsync
+        else if (_wcsicmp(argv[i], L"-fpslimit") == 0 && i + 1 < argc) {
+            mFpsLimit = static_cast<float>(_wtof(argv[++i]));
+        }
+        else if (_wcsicmp(argv[i], L"-novsync") == 0) {
+            mVSync = false;
+        }
+        else if (_wcsicmp(argv[i], L"-framegraph") == 0) {
+            mDumpFrameGraph = true;
+        }
+        // -pipelinedepth <frames> lets the simulation run that many frames ahead of the render thread, 0 for no render thread
+        else if (_wcsicmp(argv[i], L"-pipelinedepth") == 0 && i + 1 < argc) {
+            mPipelineDepth = static_cast<uint32_t>(wcstoul(argv[++i], nullptr, 10));
+        }
+        // -hitchbudget <milliseconds> counts slower frames as hitches
+        else if (_wcsicmp(argv[i], L"-hitchbudget") == 0 && i + 1 < argc) {
+            mHitchBudget = static_cast<float>(_wtof(argv[++i]));
+        }
+        // -pinthreads gives the main, render and worker threads a logical processor each, main and render on the fastest cores
+        else if (_wcsicmp(argv[i], L"-pinthreads") == 0) {
+            mThreadConfiguration.pinThreads = true;
+        }
+        // -nosmt keeps the workers off SMT siblings, one per physical core
+        else if (_wcsicmp(argv[i], L"-nosmt") == 0) {
+            mThreadConfiguration.useSmtSiblings = false;
+        }
+        // -workercores <p|e|any> keeps the workers on one core type of a hybrid CPU
+        else if (_wcsicmp(argv[i], L"-workercores") == 0 && i + 1 < argc) {
+            mThreadConfiguration.workerCores = ParseCoreType(argv[++i]);
+        }
+        // -workers <n> overrides the worker count, also for the benchmark
+        else if (_wcsicmp(argv[i], L"-workers") == 0 && i + 1 < argc) {
+            mThreadConfiguration.workerCount = _wtoi(argv[++i]);
+        }
+        // -mainpriority, -renderpriority and -workerpriority <low|normal|high|highest>
+        else if (_wcsicmp(argv[i], L"-mainpriority") == 0 && i + 1 < argc) {
+            mThreadConfiguration.mainPriority = ParseThreadPriority(argv[++i]);
+        }
+        else if (_wcsicmp(argv[i], L"-renderpriority") == 0 && i + 1 < argc) {
+            mThreadConfiguration.renderPriority = ParseThreadPriority(argv[++i]);
+        }
+        else if (_wcsicmp(argv[i], L"-workerpriority") == 0 && i + 1 < argc) {
+            mThreadConfiguration.workerPriority = ParseThreadPriority(argv[++i]);
+        }
+        // -topology writes the detected cores and where every thread runs to topology.txt
+        else if (_wcsicmp(argv[i], L"-topology") == 0) {
+            mThreadConfiguration.writeTopology = true;
+        }
+        // -benchmark <frames> and its options, see HeadlessBenchmark::ParseArgument
+        else if (i + 1 < argc) {
+            const std::string value = ToUtf8(argv[i + 1]);
+            if (HeadlessBenchmark::ParseArgument(mBenchmarkSettings, ToUtf8(argv[i]), value.c_str()) > 0) {
+                ++i;
+            }
+        }
     }
+
+    mBenchmarkSettings.threads = mThreadConfiguration;
+}
+
+//*********************************************************************************
+bool Enj::Engine::GetWriteFrameStats() const {
+    return mWriteFrameStats;
+}
+
+//*********************************************************************************
+float Enj::Engine::GetHitchBudget() const {
+    return mHitchBudget;
+}
+
+//*********************************************************************************
+float Enj::Engine::GetFixedUpdateRate() const {
+    return mFixedUpdateRate;
+}
+
+//*********************************************************************************
+uint32_t Enj::Engine::GetMaxStepsPerFrame() const {
+    return mMaxStepsPerFrame;
+}
+
+//*********************************************************************************
+float Enj::Engine::GetFpsLimit() const {
+    return mFpsLimit;
+}
+
+//*********************************************************************************
+uint32_t Enj::Engine::GetPipelineDepth() const {
+    return mPipelineDepth;
+}
+
+//*********************************************************************************
+bool Enj::Engine::GetDumpFrameGraph() const {
+    return mDumpFrameGraph;
+}
+
+//*********************************************************************************
+Enj::JobSystem* Enj::Engine::GetJobSystem() const {
+    return mJobSystem.get();
+}
+
+//*********************************************************************************
+Enj::AssetLoader* Enj::Engine::GetAssetLoader() const {
+    return mAssetLoader.get();
+}
+
+//*********************************************************************************
+Enj::FrameScheduler& Enj::Engine::GetFrameScheduler() {
+    return *mFrameScheduler;
+}
+
+//*********************************************************************************
+Enj::FrameAllocator& Enj::Engine::GetFrameAllocator() {
+    return *mFrameAllocator;
+}
+
+//*********************************************************************************
+const Enj::CpuTopology& Enj::Engine::GetCpuTopology() const {
+    return mCpuTopology;
+}
+
+//*********************************************************************************
+const Enj::ThreadPlacement& Enj::Engine::GetThreadPlacement() const {
+    return mThreadPlacement;
+}
+
+//*********************************************************************************
+bool Enj::Engine::IsBenchmarkMode() const {
+    return mBenchmarkSettings.frames > 0;
+}
+
+//*********************************************************************************
+const Enj::HeadlessBenchmarkSettings& Enj::Engine::GetBenchmarkSettings() const {
+    return mBenchmarkSettings;
 }
 
 //*********************************************************************************
 //
 //                                 EVENT HANDLING
 //
+//*********************************************************************************
+std::span<const Enj::WindowEvent> Enj::Engine::GetWindowEvents() const {
+    return std::span<const WindowEvent>(mWindowEvents.data(), mWindowEventCount);
+}
+
+//*********************************************************************************
+void Enj::Engine::ProcessWindowEvents() {
+    ENJ_PROFILE_FUNCTION();
+
+    // Everything queued since the last update in one go, handlers run here on the simulation's thread
+    mWindowEventCount = mWindowEventQueue->TryPopBatch(std::span<WindowEvent>(mWindowEvents));
+    for (const WindowEvent& event : GetWindowEvents()) {
+        switch (event.mType) {
+        case WindowEventType::Resize:
+            if (event.mCode == 0) {
+                OnResize({ static_cast<uint32_t>(event.mX), static_cast<uint32_t>(event.mY) });
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 //*********************************************************************************
 void Enj::Engine::OnResize(const OMath::Vector2ui windowSize) {
     windowSize;
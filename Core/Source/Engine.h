@@ -1,5 +1,10 @@
 #pragma once
 #include <Math/Vector2.h>
+#include <optional>
+#include "Benchmark/HeadlessBenchmark.h"
+#include "Graphics/RenderSnapshot.h"
+#include "Threading/ThreadTopology.h"
+#include "Window/WindowEvent.h"
 
 struct IDXGIAdapter1;
 struct IDXGIFactory1;
@@ -7,10 +12,19 @@ struct IDXGIFactory1;
 namespace Enj {
 	class Window;
 	class D12Renderer;
-
+	class JobSystem;
+	class TaskGraph;
+	class RenderThread;
+	class AssetLoader;
+	class FrameScheduler;
+	class FrameAllocator;
+
+	/*	Update gets the step time and the simulated time, the render stages the real frame time and wall time.
+		mAlpha is how far rendering is between the previous and the latest simulated state, 1 without a fixed timestep */
 	struct FrameData {
 		const float mDeltaTime;
 		const float mTotalTime;
+		const float mAlpha;
 	};
 
 
@@ -21,16 +35,66 @@ namespace Enj {
 		void operator=(const Engine& engine) = delete;
 		~Engine();
 
-		void Init(std::shared_ptr<Enj::Window> window);
+		// windowEvents is filled by the thread that owns the window, Update drains it
+		void Init(std::shared_ptr<Enj::Window> window, WindowEventQueue& windowEvents);
 		void Update(const FrameData& frameData);
-		void Render(const FrameData& frameData);
 		void Destroy();
 
+		// Recycles the frame memory of the oldest frame in flight, the main loop calls it before running the frame graph
+		void BeginFrame();
+
+		// Stages of a frame, the application adds its input and simulation stages, then AddRenderStages, then compiles it
+		TaskGraph& GetFrameGraph();
+		void AddRenderStages();
+
+		// Frame data the render stages use this frame, set by the simulation stage
+		void SetRenderFrameData(const FrameData& frameData);
+
 		const OMath::Vector2ui& GetWindowSize();
 		const std::wstring& GetTitle() const;
 
 		void ParseCommandLineArgs(_In_reads_(argc) wchar_t* argv[], int argc);
 
+		// Frame statistics settings from the command line
+		bool GetWriteFrameStats() const;
+		float GetHitchBudget() const;
+
+		// Simulation rate of the fixed timestep loop, 0 updates once per rendered frame with its delta time
+		float GetFixedUpdateRate() const;
+		uint32_t GetMaxStepsPerFrame() const;
+
+		// Frame rate the main loop is limited to, 0 for no limit
+		float GetFpsLimit() const;
+
+		// Frames the simulation can run ahead of the render thread, 0 renders on the frame graph without a render thread
+		uint32_t GetPipelineDepth() const;
+
+		// -framegraph writes the compiled frame graph to framegraph.txt and framegraph.dot
+		bool GetDumpFrameGraph() const;
+
+		// Cores found at Init and the threads' places on them
+		const CpuTopology& GetCpuTopology() const;
+		const ThreadPlacement& GetThreadPlacement() const;
+
+		// Owned by the engine from Init, loads in the background at low priority
+		AssetLoader* GetAssetLoader() const;
+
+		// Resumes coroutines on the main thread, ticked by the frame graph before the simulation
+		FrameScheduler& GetFrameScheduler();
+
+		// Memory for what lives no longer than a frame, valid until the render thread is done with the frame
+		FrameAllocator& GetFrameAllocator();
+
+		// Owned by the engine from Init, its stats show how busy the workers are
+		JobSystem* GetJobSystem() const;
+
+		// -benchmark <frames> runs the headless benchmark instead of opening a window
+		bool IsBenchmarkMode() const;
+		const HeadlessBenchmarkSettings& GetBenchmarkSettings() const;
+
+		// Window events drained by the last Update, oldest first
+		std::span<const WindowEvent> GetWindowEvents() const;
+
 		// event handling
 		void OnResize(const OMath::Vector2ui windowSize);
 
@@ -43,11 +107,48 @@ namespace Enj {
 
 		void SetCustomWindowText(const std::wstring& text);
 
+		void ProcessWindowEvents();
+
 		std::shared_ptr<Window> mWindow;
+		WindowEventQueue* mWindowEventQueue;
+		std::vector<WindowEvent> mWindowEvents;
+		uint32_t mWindowEventCount;
+		// Destroyed after the job system, which joins the workers its coroutines resume on
+		std::unique_ptr<FrameScheduler> mFrameScheduler;
+		std::unique_ptr<JobSystem> mJobSystem;
+		std::unique_ptr<TaskGraph> mFrameGraph;
+		std::unique_ptr<AssetLoader> mAssetLoader;
+		std::unique_ptr<FrameAllocator> mFrameAllocator;
 		std::unique_ptr<D12Renderer> mRenderer;
+		std::unique_ptr<RenderThread> mRenderThread;
+		std::optional<FrameData> mRenderFrameData;
+		// The render stages of the frame graph, without a render thread
+		std::optional<RenderSnapshot> mRenderSnapshot;
+		std::span<const uint32_t> mVisibleDraws;
 
 		bool mUseWarpDevice;
 
+		// Frames to capture with the profiler from startup, 0 for none
+		uint32_t mProfileFrames;
+
+		bool mWriteFrameStats;
+		float mHitchBudget;
+
+		float mFixedUpdateRate;
+		uint32_t mMaxStepsPerFrame;
+
+		float mFpsLimit;
+		bool mVSync;
+
+		bool mDumpFrameGraph;
+		uint32_t mPipelineDepth;
+
+		ThreadConfiguration mThreadConfiguration;
+		CpuTopology mCpuTopology;
+		ThreadPlacement mThreadPlacement;
+
+		HeadlessBenchmarkSettings mBenchmarkSettings;
+
 		std::wstring mAssetsPath;
 		std::wstring mTitle;
 	};
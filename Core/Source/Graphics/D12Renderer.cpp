@@ -3,6 +3,9 @@
 #include "D12Renderer.h"
 #include "Utility/HrExceptionHelper.h"
 #include "Engine.h" // including FrameData, should be its own file or a util file
+#include "Profiling/Profiler.h"
+#include "Memory/FrameAllocator.h"
+#include <algorithm>
 
 Enj::D12Renderer::D12Renderer(const D12RendererCreationParams& params) :
 mFrameIndex(0),
@@ -10,26 +13,57 @@ mWindowSize(params.windowSize),
 mViewport(0.0f, 0.0f, static_cast<float>(params.windowSize.mX), static_cast<float>(params.windowSize.mY)),
 mScissorRect(0, 0, static_cast<LONG>(params.windowSize.mX), static_cast<LONG>(params.windowSize.mY)),
 mFenceValue(0),
-mRTVDescSize(0) {}
+mRTVDescSize(0),
+mSyncInterval(params.vsync ? 1 : 0),
+mFrameAllocator(params.frameAllocator),
+mAssetLoader(params.assetLoader),
+mShaderPath(params.shaderPath),
+mCuller(params.jobSystem) {}
 
 void Enj::D12Renderer::Init(const HWND& hwnd) {
 	LoadPipeline(hwnd);
 	LoadAssets();
 }
 
-void Enj::D12Renderer::Update(const Enj::FrameData& frameData) {
+Enj::RenderSnapshot Enj::D12Renderer::TakeSnapshot(const FrameData& frameData, const uint64_t frame) const {
+	ENJ_PROFILE_FUNCTION();
+
+	const std::span<DrawItem> draws = mFrameAllocator->AllocateArray<DrawItem>(mDraws.size(), frame);
+	std::copy(mDraws.begin(), mDraws.end(), draws.begin());
+	const std::span<OMath::Spheref> drawBounds = mFrameAllocator->AllocateArray<OMath::Spheref>(mDrawBounds.size(), frame);
+	std::copy(mDrawBounds.begin(), mDrawBounds.end(), drawBounds.begin());
+
+	return { frame, frameData.mDeltaTime, frameData.mTotalTime, frameData.mAlpha, mViewProjection, draws, drawBounds };
+}
+
+std::span<const uint32_t> Enj::D12Renderer::Cull(const RenderSnapshot& snapshot) {
+	ENJ_PROFILE_FUNCTION();
+
+	// Cleared and refilled, the batch keeps its capacity from frame to frame
+	mCullBounds.Clear();
+	for (const OMath::Spheref& bounds : snapshot.mDrawBounds) {
+		mCullBounds.Add(bounds);
+	}
+
+	// Reject invisible draws before anything is recorded
+	const OMath::Frustumf frustum = OMath::Frustumf::CreateFromViewProjection(snapshot.mViewProjection);
+	return mCuller.Cull(frustum, mCullBounds, mFrameAllocator->AllocateArray<uint32_t>(mCullBounds.Size(), snapshot.mFrameIndex));
 }
 
-void Enj::D12Renderer::Render(const Enj::FrameData& frameData) {
+void Enj::D12Renderer::RecordCommands(const RenderSnapshot& snapshot, const std::span<const uint32_t> visibleDraws) {
 	// Record all the commands we need to render the scene into the command list.
-	PopulateCommandList(frameData);
+	PopulateCommandList(snapshot, visibleDraws);
+}
+
+void Enj::D12Renderer::Present() {
+	ENJ_PROFILE_FUNCTION();
 
 	// Execute the command list.
 	ID3D12CommandList* ppCommandLists[] = { mCommandList.Get() };
 	mCommandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
 
 	// Present the frame.
-	ThrowIfFailed(mSwapChain->Present(1, 0));
+	ThrowIfFailed(mSwapChain->Present(mSyncInterval, 0));
 
 	WaitForPreviousFrame();
 }
@@ -44,6 +78,10 @@ void Enj::D12Renderer::Destroy() {
 void Enj::D12Renderer::OnResize(const OMath::Vector2ui /*windowSize*/) {
 }
 
+const Enj::CullingStats& Enj::D12Renderer::GetCullingStats() const {
+	return mCuller.GetStats();
+}
+
 void Enj::D12Renderer::LoadPipeline(const HWND& hwnd) {
 
 	UINT dxgiFactoryFlags = 0;
@@ -158,7 +196,7 @@ void Enj::D12Renderer::LoadPipeline(const HWND& hwnd) {
 	ThrowIfFailed(mDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&mCommandAllocator)));
 }
 
-// Todo -> Create asset manager to handle this
+// Shaders come from the asset loader, the triangle is small enough to build here
 void Enj::D12Renderer::LoadAssets() {
 	// Create an empty root signature.
 	{
@@ -171,49 +209,12 @@ void Enj::D12Renderer::LoadAssets() {
 		ThrowIfFailed(mDevice->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&mRootSignature)));
 	}
 
-	// Create the pipeline state, which includes compiling and loading shaders.
-	{
-		ComPtr<ID3DBlob> vertexShader;
-		ComPtr<ID3DBlob> pixelShader;
-
-#ifdef _DEBUG
-		// Enable better shader debugging with the graphics debugging tools.
-		UINT compileflags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#else
-		UINT compileFlags = 0;
-#endif // defined(_DEBUG)
-
-		auto vsPath = L"C:\\Repos\\Enjinn\\Core\\Source\\Graphics\\Shaders\\triangleVS.hlsl";
-		auto psPath = L"C:\\Repos\\Enjinn\\Core\\Source\\Graphics\\Shaders\\trianglePS.hlsl";
-
-		ThrowIfFailed(D3DCompileFromFile(vsPath, nullptr, nullptr, "main", "vs_5_0", compileflags, 0, &vertexShader, nullptr));
-		ThrowIfFailed(D3DCompileFromFile(psPath, nullptr, nullptr, "main", "ps_5_0", compileflags, 0, &pixelShader, nullptr));
-
-		// Define the vertex input layour.
-		D3D12_INPUT_ELEMENT_DESC inputElementDesc[] = {
-			{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-			{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-		};
-
-		D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
-		psoDesc.InputLayout = { inputElementDesc, _countof(inputElementDesc) };
-		psoDesc.pRootSignature = mRootSignature.Get();
-		psoDesc.VS = { reinterpret_cast<UINT8*>(vertexShader->GetBufferPointer()), vertexShader->GetBufferSize() };
-		psoDesc.PS = { reinterpret_cast<UINT8*>(pixelShader->GetBufferPointer()), pixelShader->GetBufferSize() };
-		psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
-		psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
-		psoDesc.DepthStencilState.DepthEnable = FALSE;
-		psoDesc.DepthStencilState.StencilEnable = FALSE;
-		psoDesc.SampleMask = UINT_MAX;
-		psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-		psoDesc.NumRenderTargets = 1;
-		psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
-		psoDesc.SampleDesc.Count = 1;
-		ThrowIfFailed(mDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&mPipelineState)));
-	}
+	// Shaders are compiled by the build, the pipeline state is created once both are read
+	mVertexShader = mAssetLoader->LoadBytes(mShaderPath / L"triangleVS.cso", sShaderLoadPriority);
+	mPixelShader = mAssetLoader->LoadBytes(mShaderPath / L"trianglePS.cso", sShaderLoadPriority);
 
 	// Create Command List.
-	ThrowIfFailed(mDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, mCommandAllocator.Get(), mPipelineState.Get(), IID_PPV_ARGS(&mCommandList)));
+	ThrowIfFailed(mDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, mCommandAllocator.Get(), nullptr, IID_PPV_ARGS(&mCommandList)));
 
 	// Command lists are created in the recording state, but there is nothing
 	// to record yet. The main loop expects it to be closed, so close it now.
@@ -221,8 +222,8 @@ void Enj::D12Renderer::LoadAssets() {
 
 	// Create the vertex buffer
 	{
-		// Define the geometry for a triangle
-		Vertex triangleVertices[] = {
+		// Define the geometry for a triangle, constexpr so it is baked into read only data
+		static constexpr Vertex triangleVertices[] = {
 			{ { 0.0f, 0.25f, 0.0f }, { 1.0f, 0.0f, 0.0f, 1.0f } },
 			{ { 0.25f, -0.25f, 0.0f }, { 0.0f, 1.0f, 0.0f, 1.0f } },
 			{ { -0.25f, -0.25f, 0.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } }
@@ -256,6 +257,13 @@ void Enj::D12Renderer::LoadAssets() {
 		mVertexBufferView.BufferLocation = mVertexBuffer->GetGPUVirtualAddress();
 		mVertexBufferView.StrideInBytes = sizeof(Vertex);
 		mVertexBufferView.SizeInBytes = vertexBufferSize;
+
+		OMath::Vector3f positions[_countof(triangleVertices)];
+		for (size_t vertex = 0; vertex < _countof(triangleVertices); ++vertex) {
+			positions[vertex] = triangleVertices[vertex].mPosition;
+		}
+		mDraws.push_back({ static_cast<uint32_t>(_countof(triangleVertices)), 0 });
+		mDrawBounds.push_back(OMath::Spheref::CreateFromPoints(positions));
 	}
 
 	// Create synchronization objects and wait until assets have been uploaded to the GPU.
@@ -276,7 +284,52 @@ void Enj::D12Renderer::LoadAssets() {
 	}
 }
 
-void Enj::D12Renderer::PopulateCommandList(const Enj::FrameData& frameData) {
+void Enj::D12Renderer::CreatePipelineState() {
+	if (mVertexShader.GetState() == AssetState::Failed || mPixelShader.GetState() == AssetState::Failed) {
+		throw std::runtime_error(mVertexShader.GetState() == AssetState::Failed ? mVertexShader.GetError() : mPixelShader.GetError());
+	}
+	if (!mVertexShader.IsReady() || !mPixelShader.IsReady()) {
+		return;
+	}
+	ENJ_PROFILE_FUNCTION();
+
+	// Define the vertex input layour.
+	D3D12_INPUT_ELEMENT_DESC inputElementDesc[] = {
+		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, offsetof(Vertex, mColor), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+	};
+
+	const std::vector<uint8_t>& vertexShader = *mVertexShader.Get();
+	const std::vector<uint8_t>& pixelShader = *mPixelShader.Get();
+
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
+	psoDesc.InputLayout = { inputElementDesc, _countof(inputElementDesc) };
+	psoDesc.pRootSignature = mRootSignature.Get();
+	psoDesc.VS = { vertexShader.data(), vertexShader.size() };
+	psoDesc.PS = { pixelShader.data(), pixelShader.size() };
+	psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+	psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+	psoDesc.DepthStencilState.DepthEnable = FALSE;
+	psoDesc.DepthStencilState.StencilEnable = FALSE;
+	psoDesc.SampleMask = UINT_MAX;
+	psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+	psoDesc.NumRenderTargets = 1;
+	psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+	psoDesc.SampleDesc.Count = 1;
+	ThrowIfFailed(mDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&mPipelineState)));
+
+	// The bytecode is not needed once the pipeline state exists
+	mVertexShader = {};
+	mPixelShader = {};
+}
+
+void Enj::D12Renderer::PopulateCommandList(const RenderSnapshot& snapshot, const std::span<const uint32_t> visibleDraws) {
+	ENJ_PROFILE_FUNCTION();
+
+	if (!mPipelineState) {
+		CreatePipelineState();
+	}
+
 	// Command list allocators can only be reset when the associated 
 		// command lists have finished execution on the GPU; apps should use 
 		// fences to determine GPU execution progress.
@@ -304,7 +357,12 @@ void Enj::D12Renderer::PopulateCommandList(const Enj::FrameData& frameData) {
 	mCommandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
 	mCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	mCommandList->IASetVertexBuffers(0, 1, &mVertexBufferView);
-	mCommandList->DrawInstanced(3, 1, 0, 0);
+	if (mPipelineState) {
+		for (const uint32_t drawIndex : visibleDraws) {
+			const DrawItem& draw = snapshot.mDraws[drawIndex];
+			mCommandList->DrawInstanced(draw.mVertexCount, 1, draw.mStartVertex, 0);
+		}
+	}
 
 	// Indicate that the back buffer will now be used to present.
 	barrier = CD3DX12_RESOURCE_BARRIER::Transition(mRenderTargets[mFrameIndex].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
@@ -314,6 +372,8 @@ void Enj::D12Renderer::PopulateCommandList(const Enj::FrameData& frameData) {
 }
 
 void Enj::D12Renderer::WaitForPreviousFrame() {
+	ENJ_PROFILE_FUNCTION();
+
 	// WAITING FOR THE FRAME TO COMPLETE BEFORE CONTINUING IS NOT BEST PRACTICE.
 	// This is code implemented as such for simplicity. More advanced samples 
 	// illustrate how to use fences for efficient resource usage.
@@ -2,7 +2,12 @@
 #include "Math/Vector2.h"
 #include "Math/Vector3.h"
 #include "Math/Vector4.h"
+#include "Math/Matrix4x4.h"
+#include "Math/BoundsWide.h"
 #include "ConstantBuffer.h"
+#include "FrustumCuller.h"
+#include "RenderSnapshot.h"
+#include "Assets/AssetLoader.h"
 
 using namespace Microsoft::WRL;
 
@@ -19,32 +24,54 @@ struct ID3D12Fence;
 
 namespace Enj {
 	struct FrameData;
+	class JobSystem;
+	class FrameAllocator;
 
 	struct D12RendererCreationParams {
 		OMath::Vector2ui windowSize;
+		JobSystem* jobSystem = nullptr;
+		AssetLoader* assetLoader = nullptr;
+		FrameAllocator* frameAllocator = nullptr;	// Holds the visible draws of a frame
+		std::filesystem::path shaderPath;	// Where the build puts the compiled shaders
+		bool vsync = true;
 	};
 
 	class D12Renderer {
 	public:
+		// Back buffers, frame memory has to stay alive for at least as many frames
+		static constexpr UINT sFrameCount = 2;
+
 		D12Renderer(const D12RendererCreationParams& params);
 		D12Renderer(const D12Renderer& renderer) = delete;
 		void operator=(const D12Renderer& renderer) = delete;
 
 		void Init(const HWND& hwnd);
-		void Update(const Enj::FrameData& frameData);
-		void Render(const Enj::FrameData& frameData);
 		void Destroy();
 
+		// Copies the camera and the draws into the frame memory of frame, on the thread that owns the scene
+		RenderSnapshot TakeSnapshot(const FrameData& frameData, const uint64_t frame) const;
+
+		// Frame stages in the order they run, they only read the scene through the snapshot. The visible draws are in
+		// the snapshot's frame memory
+		std::span<const uint32_t> Cull(const RenderSnapshot& snapshot);
+		void RecordCommands(const RenderSnapshot& snapshot, const std::span<const uint32_t> visibleDraws);
+		void Present();
+
 		void OnResize(const OMath::Vector2ui windowSize);
+
+		const CullingStats& GetCullingStats() const;
 	private:
 		void LoadPipeline(const HWND& hwnd);
 		void LoadAssets();
+		// Once the shaders are loaded, frames before that only clear
+		void CreatePipelineState();
 		void PopulateCommandList();
-		void PopulateCommandList(const Enj::FrameData& frameData);
+		void PopulateCommandList(const RenderSnapshot& snapshot, const std::span<const uint32_t> visibleDraws);
 		void WaitForPreviousFrame();
 
 	private:
-		static const UINT sFrameCount = 2;
+		// Nothing draws without the shaders, they go before anything a scene streams in
+		static constexpr float sShaderLoadPriority = 1000.0f;
 
 		struct Vertex {
 			OMath::Vector3f mPosition;
@@ -69,11 +96,30 @@ namespace Enj {
 		ComPtr<ID3D12PipelineState> mPipelineState;
 		ComPtr<ID3D12GraphicsCommandList> mCommandList;
 		UINT mRTVDescSize;
+		UINT mSyncInterval;	// 0 presents without waiting for vblank
+
+		FrameAllocator* mFrameAllocator;
+
+		// Shader bytecode loaded in the background
+		AssetLoader* mAssetLoader;
+		std::filesystem::path mShaderPath;
+		AssetHandle<std::vector<uint8_t>> mVertexShader;
+		AssetHandle<std::vector<uint8_t>> mPixelShader;
 
 		// App Resources
 		ComPtr<ID3D12Resource> mVertexBuffer;
 		D3D12_VERTEX_BUFFER_VIEW mVertexBufferView;
 
+		// The scene, set up in Init and snapshotted every frame. mDrawBounds[i] bounds mDraws[i]. Identity until there
+		// is a camera, the frustum is then clip space
+		OMath::Matrix4x4f mViewProjection;
+		std::vector<OMath::Spheref> mDrawBounds;
+		std::vector<DrawItem> mDraws;
+
+		// Only used by Cull, the snapshot's bounds as the structure of arrays the culler takes
+		OMath::SphereBatch mCullBounds;
+		FrustumCuller mCuller;
+
 		// Sync objects
 		UINT mFrameIndex;
 		HANDLE mFenceEvent;
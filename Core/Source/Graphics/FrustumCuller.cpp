@@ -0,0 +1,67 @@
+#include "stdafx.h"
+
+#include "FrustumCuller.h"
+#include "Threading/ParallelAlgorithms.h"
+#include "Profiling/Profiler.h"
+#include <cassert>
+#include <chrono>
+
+Enj::FrustumCuller::FrustumCuller(JobSystem* jobSystem) :
+	mJobSystem(jobSystem),
+	mStats{ 0, 0, 0.0f } {}
+
+//*********************************************************************************
+void Enj::FrustumCuller::SetJobSystem(JobSystem* jobSystem) {
+	mJobSystem = jobSystem;
+}
+
+//*********************************************************************************
+void Enj::FrustumCuller::Cull(const OMath::Frustumf& frustum, const OMath::SphereBatch& bounds, std::vector<uint32_t>& visible) {
+	visible.resize(bounds.Size());
+	visible.resize(CullBatch(frustum, bounds, std::span<uint32_t>(visible)).size());
+}
+
+//*********************************************************************************
+std::span<uint32_t> Enj::FrustumCuller::Cull(const OMath::Frustumf& frustum, const OMath::SphereBatch& bounds, std::span<uint32_t> visible) {
+	return CullBatch(frustum, bounds, visible);
+}
+
+//*********************************************************************************
+void Enj::FrustumCuller::Cull(const OMath::Frustumf& frustum, const OMath::AABBBatch& bounds, std::vector<uint32_t>& visible) {
+	visible.resize(bounds.Size());
+	visible.resize(CullBatch(frustum, bounds, std::span<uint32_t>(visible)).size());
+}
+
+//*********************************************************************************
+std::span<uint32_t> Enj::FrustumCuller::Cull(const OMath::Frustumf& frustum, const OMath::AABBBatch& bounds, std::span<uint32_t> visible) {
+	return CullBatch(frustum, bounds, visible);
+}
+
+//*********************************************************************************
+const Enj::CullingStats& Enj::FrustumCuller::GetStats() const {
+	return mStats;
+}
+
+//*********************************************************************************
+template <class Batch>
+std::span<uint32_t> Enj::FrustumCuller::CullBatch(const OMath::Frustumf& frustum, const Batch& bounds, std::span<uint32_t> visible) {
+	ENJ_PROFILE_SCOPE("FrustumCuller::Cull");
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	const size_t count = bounds.Size();
+	assert(visible.size() >= count && "Culling needs room for every index");
+
+	const auto cullRange = [&frustum, &bounds](const size_t begin, const size_t end, std::span<uint32_t> output) {
+		return OMath::Cull(frustum, bounds, begin, end, output);
+	};
+	size_t visibleCount = 0;
+	if (mJobSystem == nullptr || count < sParallelThreshold) {
+		visibleCount = cullRange(0, count, visible);
+	} else {
+		visibleCount = Parallel::CompactRanges(*mJobSystem, count, cullRange, visible, mChunkCounts, OMath::sBoundsBatchWidth, sChunkSize).size();
+	}
+
+	const std::chrono::duration<float, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	mStats = { count, visibleCount, elapsed.count() };
+	return visible.first(visibleCount);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <span>
+#include <vector>
+#include <Math/Frustum.h>
+
+namespace Enj {
+	class JobSystem;
+
+	struct CullingStats {
+		size_t mTested;
+		size_t mVisible;
+		float mMilliseconds;
+	};
+
+	// Culls SoA bounds against a frustum into a compact, ascending list of visible indices.
+	// Large arrays are split in chunks across the job system's workers
+	class FrustumCuller {
+	public:
+		// Arrays smaller than this are culled on the calling thread, waking the workers costs more than it saves
+		static constexpr size_t sParallelThreshold = 16384;
+
+		// Fewest objects per task, chunks are rounded to whole batches
+		static constexpr size_t sChunkSize = 4096;
+
+		explicit FrustumCuller(JobSystem* jobSystem = nullptr);
+		FrustumCuller(const FrustumCuller& culler) = delete;
+		void operator=(const FrustumCuller& culler) = delete;
+
+		void SetJobSystem(JobSystem* jobSystem);
+
+		// visible is resized to hold exactly the visible indices
+		void Cull(const OMath::Frustumf& frustum, const OMath::SphereBatch& bounds, std::vector<uint32_t>& visible);
+		void Cull(const OMath::Frustumf& frustum, const OMath::AABBBatch& bounds, std::vector<uint32_t>& visible);
+
+		// visible needs room for every object, like frame memory. Returns the front of it that holds the visible indices
+		std::span<uint32_t> Cull(const OMath::Frustumf& frustum, const OMath::SphereBatch& bounds, std::span<uint32_t> visible);
+		std::span<uint32_t> Cull(const OMath::Frustumf& frustum, const OMath::AABBBatch& bounds, std::span<uint32_t> visible);
+
+		// Counters of the last Cull call
+		const CullingStats& GetStats() const;
+
+	private:
+		template <class Batch>
+		std::span<uint32_t> CullBatch(const OMath::Frustumf& frustum, const Batch& bounds, std::span<uint32_t> visible);
+
+		JobSystem* mJobSystem;
+		std::vector<size_t> mChunkCounts;
+		CullingStats mStats;
+	};
+}
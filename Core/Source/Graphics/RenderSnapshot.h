@@ -0,0 +1,27 @@
+#pragma once
+#include <span>
+#include <stdint.h>
+#include <Math/Matrix4x4.h>
+#include <Math/Sphere.h>
+
+namespace Enj {
+	// A range of the renderer's vertex buffer
+	struct DrawItem {
+		uint32_t mVertexCount;
+		uint32_t mStartVertex;
+	};
+
+	/*	Everything culling and recording read for one frame, taken on the main thread once the simulation is done. The
+		draws are copied into the frame memory of mFrameIndex, so the simulation can change the scene for the next frame
+		while the render thread still works on this one. mDrawBounds[i] bounds mDraws[i] */
+	struct RenderSnapshot {
+		uint64_t mFrameIndex;	// The frame allocator's frame, what the render thread allocates belongs to it
+		float mDeltaTime;
+		float mTotalTime;
+		float mAlpha;
+
+		OMath::Matrix4x4f mViewProjection;
+		std::span<const DrawItem> mDraws;
+		std::span<const OMath::Spheref> mDrawBounds;
+	};
+}
@@ -0,0 +1,60 @@
+#include "stdafx.h"
+
+#include "RenderThread.h"
+#include "D12Renderer.h"
+#include "Profiling/Profiler.h"
+
+Enj::RenderThread::RenderThread(D12Renderer& renderer, const uint32_t pipelineDepth, std::function<void()> onStart) :
+	mRenderer(renderer),
+	mQueue(pipelineDepth),
+	mFramesRendered(0),
+	mFailed(false),
+	mThread(&RenderThread::ThreadMain, this, std::move(onStart)) {}
+
+//*********************************************************************************
+Enj::RenderThread::~RenderThread() {
+	mQueue.Close();
+	mThread.join();
+}
+
+//*********************************************************************************
+void Enj::RenderThread::Submit(const RenderSnapshot& snapshot) {
+	ENJ_PROFILE_FUNCTION();
+	if (mFailed.load(std::memory_order_acquire)) {
+		std::rethrow_exception(mException);
+	}
+	mQueue.Push(snapshot);
+}
+
+//*********************************************************************************
+uint64_t Enj::RenderThread::GetFramesRendered() const {
+	return mFramesRendered.load(std::memory_order_relaxed);
+}
+
+//*********************************************************************************
+void Enj::RenderThread::ThreadMain(std::function<void()> onStart) {
+	ENJ_PROFILE_THREAD("Render");
+	if (onStart) {
+		onStart();
+	}
+
+	RenderSnapshot snapshot;
+	while (mQueue.Pop(snapshot)) {
+		// Keeps emptying the queue after a failure so Submit never waits for a frame that will not be rendered
+		if (mFailed.load(std::memory_order_relaxed)) {
+			continue;
+		}
+
+		ENJ_PROFILE_SCOPE("RenderThread::Frame");
+		try {
+			// Only the snapshot is read, the main thread is already changing the scene for the next frame
+			const std::span<const uint32_t> visibleDraws = mRenderer.Cull(snapshot);
+			mRenderer.RecordCommands(snapshot, visibleDraws);
+			mRenderer.Present();
+			mFramesRendered.fetch_add(1, std::memory_order_relaxed);
+		} catch (...) {
+			mException = std::current_exception();
+			mFailed.store(true, std::memory_order_release);
+		}
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <stdint.h>
+#include <thread>
+#include "RenderSnapshot.h"
+#include "Threading/BoundedQueue.h"
+
+namespace Enj {
+	class D12Renderer;
+
+	/*	Culls, records and presents submitted snapshots on its own thread, including the wait for the GPU, so the next
+		frame is simulated meanwhile. Submit blocks while pipelineDepth snapshots are already waiting, which bounds how
+		far the simulation runs ahead of what is on screen.
+		Presenting off the window thread is safe as long as DXGI does not message the window, the renderer turns off
+		Alt+Enter fullscreen switching for that */
+	class RenderThread {
+	public:
+		// onStart runs on the render thread before its first frame, to pin it or set its priority
+		RenderThread(D12Renderer& renderer, const uint32_t pipelineDepth, std::function<void()> onStart = nullptr);
+		RenderThread(const RenderThread& renderThread) = delete;
+		void operator=(const RenderThread& renderThread) = delete;
+
+		// Renders what was submitted, then stops the thread
+		~RenderThread();
+
+		// Rethrows what a frame on the render thread threw, frames after that are dropped
+		void Submit(const RenderSnapshot& snapshot);
+
+		uint64_t GetFramesRendered() const;
+
+	private:
+		void ThreadMain(std::function<void()> onStart);
+
+		D12Renderer& mRenderer;
+		BoundedQueue<RenderSnapshot> mQueue;
+		std::atomic<uint64_t> mFramesRendered;
+		std::atomic<bool> mFailed;
+		std::exception_ptr mException;
+		std::thread mThread;
+	};
+}
@@ -0,0 +1,184 @@
+#include "stdafx.h"
+
+#include "FrameAllocator.h"
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+
+namespace {
+	// The chunk the calling thread bumps through, of one allocator and one frame
+	struct ThreadChunk {
+		uint64_t mAllocator;
+		uint64_t mFrameIndex;
+		std::byte* mCursor;
+		std::byte* mEnd;
+	};
+
+	std::atomic<uint64_t> sNextAllocatorId = 1;
+	thread_local ThreadChunk sThreadChunk = { 0, 0, nullptr, nullptr };
+
+	// nullptr when [cursor, end) is too small
+	std::byte* Bump(std::byte*& cursor, std::byte* end, const size_t size, const size_t alignment) {
+		const uintptr_t address = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+		std::byte* aligned = reinterpret_cast<std::byte*>(address);
+		if (cursor == nullptr || aligned > end || static_cast<size_t>(end - aligned) < size) {
+			return nullptr;
+		}
+		cursor = aligned + size;
+		return aligned;
+	}
+}
+
+Enj::FrameAllocator::FrameAllocator(const FrameAllocatorCreationParams& params) :
+	mId(sNextAllocatorId.fetch_add(1, std::memory_order_relaxed)),
+	mFrameCount(std::max(params.frameCount, 1u)),
+	mArenaSize(params.arenaSize),
+	mChunkSize(std::max(params.chunkSize, sChunkAlignment)),
+	mArenas(std::make_unique<Arena[]>(mFrameCount)),
+	mFrameIndex(0),
+	mFrameBytes(0),
+	mHighWaterBytes(0),
+	mOverflowAllocations(0),
+	mOverflowBytes(0) {
+	for (uint32_t arena = 0; arena < mFrameCount; ++arena) {
+		mArenas[arena].mMemory = std::make_unique_for_overwrite<std::byte[]>(mArenaSize);
+		mArenas[arena].mOffset.store(0, std::memory_order_relaxed);
+		mArenas[arena].mOverflowBytes = 0;
+	}
+}
+
+//*********************************************************************************
+Enj::FrameAllocator::~FrameAllocator() {}
+
+//*********************************************************************************
+void Enj::FrameAllocator::BeginFrame() {
+	const uint64_t frameIndex = mFrameIndex.load(std::memory_order_relaxed) + 1;
+	Arena& arena = mArenas[frameIndex % mFrameCount];
+
+	// The arena still holds the frame frameCount frames ago, which is done
+	size_t frameBytes = std::min(arena.mOffset.exchange(0, std::memory_order_relaxed), mArenaSize);
+	{
+		std::lock_guard<std::mutex> lock(arena.mOverflowMutex);
+		frameBytes += arena.mOverflowBytes;
+		arena.mOverflow.clear();
+		arena.mOverflowBytes = 0;
+	}
+	mFrameBytes.store(frameBytes, std::memory_order_relaxed);
+	mHighWaterBytes.store(std::max(mHighWaterBytes.load(std::memory_order_relaxed), frameBytes), std::memory_order_relaxed);
+	mFrameIndex.store(frameIndex, std::memory_order_release);
+}
+
+//*********************************************************************************
+uint64_t Enj::FrameAllocator::GetFrameIndex() const {
+	return mFrameIndex.load(std::memory_order_acquire);
+}
+
+//*********************************************************************************
+uint32_t Enj::FrameAllocator::GetFrameCount() const {
+	return mFrameCount;
+}
+
+//*********************************************************************************
+void* Enj::FrameAllocator::Allocate(const size_t size, const size_t alignment) {
+	return Allocate(size, alignment, GetFrameIndex());
+}
+
+//*********************************************************************************
+void* Enj::FrameAllocator::Allocate(const size_t size, const size_t alignment, const uint64_t frameIndex) {
+	assert(frameIndex <= GetFrameIndex() && frameIndex + mFrameCount > GetFrameIndex() && "The frame's arena was already recycled");
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "Alignment has to be a power of two");
+	Arena& arena = mArenas[frameIndex % mFrameCount];
+
+	// Large allocations would leave most of a chunk unused
+	if (size > mChunkSize / 4 || alignment > sChunkAlignment) {
+		return AllocateFromArena(arena, size, alignment);
+	}
+
+	ThreadChunk& chunk = sThreadChunk;
+	if (chunk.mAllocator == mId && chunk.mFrameIndex == frameIndex) {
+		if (std::byte* memory = Bump(chunk.mCursor, chunk.mEnd, size, alignment)) {
+			return memory;
+		}
+	}
+
+	std::byte* begin = static_cast<std::byte*>(AllocateFromArena(arena, mChunkSize, sChunkAlignment));
+	chunk = { mId, frameIndex, begin, begin + mChunkSize };
+	return Bump(chunk.mCursor, chunk.mEnd, size, alignment);
+}
+
+//*********************************************************************************
+template <class Char>
+std::basic_string_view<Char> Enj::FrameAllocator::Copy(const std::basic_string_view<Char> text) {
+	const std::span<Char> copy = AllocateArray<Char>(text.size() + 1);
+	std::copy(text.begin(), text.end(), copy.begin());
+	copy[text.size()] = Char();
+	return { copy.data(), text.size() };
+}
+
+//*********************************************************************************
+std::string_view Enj::FrameAllocator::CopyString(const std::string_view text) {
+	return Copy(text);
+}
+
+//*********************************************************************************
+std::wstring_view Enj::FrameAllocator::CopyString(const std::wstring_view text) {
+	return Copy(text);
+}
+
+//*********************************************************************************
+Enj::FrameAllocatorStats Enj::FrameAllocator::GetStats() const {
+	return {
+		mArenaSize,
+		mFrameBytes.load(std::memory_order_relaxed),
+		mHighWaterBytes.load(std::memory_order_relaxed),
+		mOverflowAllocations.load(std::memory_order_relaxed),
+		mOverflowBytes.load(std::memory_order_relaxed)
+	};
+}
+
+//*********************************************************************************
+bool Enj::FrameAllocator::WriteJson(const std::filesystem::path& path) const {
+	std::ofstream file(path);
+	if (!file) {
+		return false;
+	}
+
+	const FrameAllocatorStats stats = GetStats();
+	file << "{\n";
+	file << "\t\"frameCount\": " << mFrameCount << ",\n";
+	file << "\t\"arenaSize\": " << stats.mArenaSize << ",\n";
+	file << "\t\"frameBytes\": " << stats.mFrameBytes << ",\n";
+	file << "\t\"highWaterBytes\": " << stats.mHighWaterBytes << ",\n";
+	file << "\t\"overflowAllocations\": " << stats.mOverflowAllocations << ",\n";
+	file << "\t\"overflowBytes\": " << stats.mOverflowBytes << "\n";
+	file << "}\n";
+	return static_cast<bool>(file);
+}
+
+//*********************************************************************************
+void* Enj::FrameAllocator::AllocateFromArena(Arena& arena, const size_t size, const size_t alignment) {
+	// Reserving the worst case padding keeps this a single atomic add
+	const size_t reserved = size + alignment - 1;
+	const size_t offset = arena.mOffset.fetch_add(reserved, std::memory_order_relaxed);
+	if (offset + reserved <= mArenaSize) {
+		std::byte* cursor = arena.mMemory.get() + offset;
+		return Bump(cursor, arena.mMemory.get() + offset + reserved, size, alignment);
+	}
+	return AllocateOverflow(arena, size, alignment);
+}
+
+//*********************************************************************************
+void* Enj::FrameAllocator::AllocateOverflow(Arena& arena, const size_t size, const size_t alignment) {
+	// The frame still gets its memory, from the heap until the arena is recycled
+	const size_t reserved = size + alignment - 1;
+	std::unique_ptr<std::byte[]> memory = std::make_unique_for_overwrite<std::byte[]>(reserved);
+	std::byte* cursor = memory.get();
+	std::byte* allocation = Bump(cursor, memory.get() + reserved, size, alignment);
+
+	std::lock_guard<std::mutex> lock(arena.mOverflowMutex);
+	arena.mOverflow.push_back(std::move(memory));
+	arena.mOverflowBytes += reserved;
+	mOverflowAllocations.fetch_add(1, std::memory_order_relaxed);
+	mOverflowBytes.fetch_add(reserved, std::memory_order_relaxed);
+	return allocation;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdint.h>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace Enj {
+	struct FrameAllocatorStats {
+		size_t mArenaSize;
+		size_t mFrameBytes;				// What the frame recycled by the last BeginFrame took, chunk slack included
+		size_t mHighWaterBytes;			// Most any recycled frame took
+		uint64_t mOverflowAllocations;	// Did not fit in their arena and went to the heap, raise arenaSize when this is not 0
+		uint64_t mOverflowBytes;
+	};
+
+	struct FrameAllocatorCreationParams {
+		uint32_t frameCount = 2;				// Frames whose memory is alive at once, one arena each
+		size_t arenaSize = 4 * 1024 * 1024;
+		size_t chunkSize = 64 * 1024;			// What a thread takes from the arena at a time
+	};
+
+	/*	Bump pointer memory for what lives no longer than a frame. Every frame in flight has its own arena, BeginFrame
+		starts the next frame and recycles the arena of the frame frameCount frames ago, so memory a frame allocated stays
+		valid while later frames run. Each thread bumps through a chunk it took from the arena, only taking a chunk touches
+		shared state. Nothing is ever destructed, only trivially destructible types go in */
+	class FrameAllocator {
+	public:
+		// Chunks start on their own cache line, threads never write next to each other
+		static constexpr size_t sChunkAlignment = 64;
+
+		explicit FrameAllocator(const FrameAllocatorCreationParams& params = {});
+		FrameAllocator(const FrameAllocator& allocator) = delete;
+		void operator=(const FrameAllocator& allocator) = delete;
+		~FrameAllocator();
+
+		// Called by the thread that drives the frames, before anything allocates for the new frame. Nothing may use
+		// memory of the frame frameCount frames ago anymore
+		void BeginFrame();
+
+		// Frames before the first BeginFrame are frame 0
+		uint64_t GetFrameIndex() const;
+		uint32_t GetFrameCount() const;
+
+		// Valid until frameIndex + frameCount begins. A thread keeps one chunk, alternating between frames wastes the rest of it
+		void* Allocate(const size_t size, const size_t alignment = alignof(std::max_align_t));
+		void* Allocate(const size_t size, const size_t alignment, const uint64_t frameIndex);
+
+		template <class T>
+		std::span<T> AllocateArray(const size_t count) {
+			return AllocateArray<T>(count, GetFrameIndex());
+		}
+
+		// Default initialized, so trivial types are left uninitialized
+		template <class T>
+		std::span<T> AllocateArray(const size_t count, const uint64_t frameIndex) {
+			static_assert(std::is_trivially_destructible_v<T>, "Frame memory is recycled without running destructors");
+			T* data = static_cast<T*>(Allocate(count * sizeof(T), alignof(T), frameIndex));
+			std::uninitialized_default_construct_n(data, count);
+			return { data, count };
+		}
+
+		// Zero terminated copies, for names and labels put together during a frame
+		std::string_view CopyString(const std::string_view text);
+		std::wstring_view CopyString(const std::wstring_view text);
+
+		FrameAllocatorStats GetStats() const;
+		bool WriteJson(const std::filesystem::path& path) const;
+
+	private:
+		struct alignas(64) Arena {
+			std::unique_ptr<std::byte[]> mMemory;
+			std::atomic<size_t> mOffset;	// Can run past the arena size, what did not fit overflowed
+
+			std::mutex mOverflowMutex;
+			std::vector<std::unique_ptr<std::byte[]>> mOverflow;
+			size_t mOverflowBytes;
+		};
+
+		template <class Char>
+		std::basic_string_view<Char> Copy(const std::basic_string_view<Char> text);
+
+		void* AllocateFromArena(Arena& arena, const size_t size, const size_t alignment);
+		void* AllocateOverflow(Arena& arena, const size_t size, const size_t alignment);
+
+		const uint64_t mId;		// Never reused, a thread's chunk of a destroyed allocator cannot match a new one
+		const uint32_t mFrameCount;
+		const size_t mArenaSize;
+		const size_t mChunkSize;
+		std::unique_ptr<Arena[]> mArenas;
+		std::atomic<uint64_t> mFrameIndex;
+
+		std::atomic<size_t> mFrameBytes;
+		std::atomic<size_t> mHighWaterBytes;
+		std::atomic<uint64_t> mOverflowAllocations;
+		std::atomic<uint64_t> mOverflowBytes;
+	};
+}
@@ -1,63 +1,108 @@
 #include "stdafx.h"
 
 #include "WindowsApplication.h"
+#include "WindowsMessageThread.h"
 #include "Engine.h"
 #include "Window/Window.h"
+#include "Profiling/Profiler.h"
+#include "Threading/TaskGraph.h"
+#include "Threading/Task.h"
+#include "Assets/AssetLoader.h"
+#include "Memory/FrameAllocator.h"
+#include <Utility/FixedTimestep.h>
+#include <Utility/FrameLimiter.h>
 #include <Utility/Timer.h>
+#include <fstream>
 
 
 int WindowsApplication::Run(HINSTANCE hInstance, int cmdShow) {
     Enj::Engine engine;
 
+    // Headless runs report through the exit code and never open a window
+    if (engine.IsBenchmarkMode()) {
+        return Enj::HeadlessBenchmark(engine.GetBenchmarkSettings()).Run();
+    }
+
     Enj::WindowCreationParams windowCreationParams;
     windowCreationParams.cmdShow = cmdShow;
     windowCreationParams.hInstance = hInstance;
-    windowCreationParams.engine = &engine;
     windowCreationParams.windowName = L"Enjinn Engine";
     windowCreationParams.windowSize = {1280,720};
-    windowCreationParams.windowProc = WindowProc;
-    
-    auto window = std::make_shared<Enj::Window>(windowCreationParams);
-    
-    engine.Init(std::move(window));
 
-    Enj::Timer timer;
+    // Creates the window and pumps its messages, the engine only sees the events it queues
+    WindowsMessageThread messageThread(windowCreationParams);
 
+    engine.Init(messageThread.GetWindow(), messageThread.GetEventQueue());
 
-    MSG msg = {};
-    while (msg.message != WM_QUIT) {
-        // Process queued messages
-        if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
-        }
-        timer.Update();
+    Enj::Timer timer;
+    timer.Statistics().SetHitchBudget(engine.GetHitchBudget());
 
-        Enj::FrameData frameData = { timer.DeltaTime(), timer.TotalTime() };
+    const bool useFixedTimestep = engine.GetFixedUpdateRate() > 0.0f;
+    Enj::FixedTimestep timestep(useFixedTimestep ? engine.GetFixedUpdateRate() : 60.0f, engine.GetMaxStepsPerFrame());
 
-        engine.Update(frameData);
-        engine.Render(frameData);
-    }
+    Enj::FrameLimiter limiter(engine.GetFpsLimit());
 
-    engine.Destroy();
+    ENJ_PROFILE_THREAD("Main");
 
-    return static_cast<char>(msg.wParam);
-}
+    Enj::TaskGraph& frameGraph = engine.GetFrameGraph();
+    frameGraph.AddStage("FrameTime", {}, { "FrameTime" }, [&timer]() {
+        timer.Update();
+    }, Enj::TaskGraph::Affinity::MainThread);
+    // Coroutines waiting for a frame or a file continue here, before the simulation they may change
+    frameGraph.AddStage("Coroutines", { "FrameTime" }, { "Coroutines" }, [&engine]() {
+        engine.GetFrameScheduler().Tick();
+    }, Enj::TaskGraph::Affinity::MainThread);
+    // Engine::Update drains the window events, so the simulation owns input and the window state
+    frameGraph.AddStage("Simulation", { "FrameTime", "Coroutines" }, { "Simulation", "Input", "Window" }, [&engine, &timer, &timestep, useFixedTimestep]() {
+        if (useFixedTimestep) {
+            timestep.Accumulate(timer.DeltaTime());
+            while (timestep.Step()) {
+                ENJ_PROFILE_SCOPE("Engine::Update");
+                const Enj::FrameData stepData = { timestep.StepTime(), static_cast<float>(timestep.SimulationTime()), 1.0f };
+                engine.Update(stepData);
+            }
+        } else {
+            ENJ_PROFILE_SCOPE("Engine::Update");
+            const Enj::FrameData frameData = { timer.DeltaTime(), timer.TotalTime(), 1.0f };
+            engine.Update(frameData);
+        }
+        engine.SetRenderFrameData({ timer.DeltaTime(), timer.TotalTime(), useFixedTimestep ? timestep.Alpha() : 1.0f });
+    });
+    engine.AddRenderStages();
+    frameGraph.Compile();
 
-LRESULT WindowsApplication::WindowProc(HWND hWND, UINT message, WPARAM wParam, LPARAM lParam) {
+    if (engine.GetDumpFrameGraph()) {
+        std::ofstream(L"framegraph.txt") << frameGraph.ToText();
+        std::ofstream(L"framegraph.dot") << frameGraph.ToDot();
+    }
 
-    Enj::Engine* engine = reinterpret_cast<Enj::Engine*>(GetWindowLongPtr(hWND, GWLP_USERDATA));
+    // The close flag rather than the Close event, a full event queue may drop the event
+    while (!messageThread.IsCloseRequested() && !messageThread.HasQuit()) {
+        {
+            ENJ_PROFILE_FRAME();
+            engine.BeginFrame();
+            frameGraph.Execute();
+        }
 
-    switch (message) {
-    case WM_DESTROY: {
-        PostQuitMessage(0);
-        return 0;
-    }
-    case WM_SIZE: {
-        engine->OnResize({LOWORD(lParam), HIWORD(lParam)});
+        if (limiter.IsEnabled()) {
+            ENJ_PROFILE_SCOPE("FrameLimiter::Wait");
+            timer.AddPacingSample(limiter.Wait());
+        }
     }
+
+    // Nothing presents to the window after this, so it can go
+    engine.Destroy();
+    messageThread.DestroyWindow();
+
+    if (engine.GetWriteFrameStats()) {
+        timer.Statistics().WriteJson(L"framestats.json");
+        timer.Statistics().WriteCsv(L"framestats.csv");
+        engine.GetAssetLoader()->WriteJson(L"assetstats.json");
+        engine.GetFrameAllocator().WriteJson(L"framememory.json");
+        if (limiter.IsEnabled()) {
+            timer.PacingStatistics().WriteJson(L"framepacing.json");
+        }
     }
 
-    // Handle any messages the switch statement didn't.
-    return DefWindowProc(hWND, message, wParam, lParam);
+    return static_cast<char>(messageThread.GetExitCode());
 }
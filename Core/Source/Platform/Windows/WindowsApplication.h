@@ -7,8 +7,5 @@ namespace Enj {
 class WindowsApplication {
 public:
 	int Run(HINSTANCE hInstance, int cmdShow);
-
-private:
-	static LRESULT CALLBACK WindowProc(HWND hWND, UINT message, WPARAM wParam, LPARAM lParam);
 };
 
@@ -0,0 +1,230 @@
+#include "stdafx.h"
+
+#include "WindowsMessageThread.h"
+#include "Profiling/Profiler.h"
+#include <windowsx.h>
+
+WindowsMessageThread::WindowsMessageThread(const Enj::WindowCreationParams& creationParams) :
+    mEvents(sEventCapacity),
+    mDroppedEvents(0),
+    mCloseRequested(false),
+    mPendingMouseMove(),
+    mMouseMovePending(false),
+    mQueuedMouseMoveEnd(0),
+    mWindowCreated(false),
+    mQuit(false),
+    mExitCode(0),
+    mException() {
+    mThread = std::thread(&WindowsMessageThread::ThreadMain, this, creationParams);
+
+    // The window has to be created by the thread that pumps its messages
+    mWindowCreated.wait(false, std::memory_order_acquire);
+    if (mException) {
+        // The thread already returned, no destructor runs for a constructor that throws
+        mThread.join();
+        std::rethrow_exception(mException);
+    }
+}
+
+//*********************************************************************************
+WindowsMessageThread::~WindowsMessageThread() {
+    DestroyWindow();
+}
+
+//*********************************************************************************
+void WindowsMessageThread::DestroyWindow() {
+    if (!mThread.joinable()) {
+        return;
+    }
+    if (!mQuit.load(std::memory_order_acquire)) {
+        PostMessage(mWindow->Hwnd(), sDestroyMessage, 0, 0);
+    }
+    mThread.join();
+}
+
+//*********************************************************************************
+std::shared_ptr<Enj::Window> WindowsMessageThread::GetWindow() const {
+    return mWindow;
+}
+
+//*********************************************************************************
+Enj::WindowEventQueue& WindowsMessageThread::GetEventQueue() {
+    return mEvents;
+}
+
+//*********************************************************************************
+bool WindowsMessageThread::IsCloseRequested() const {
+    return mCloseRequested.load(std::memory_order_acquire);
+}
+
+//*********************************************************************************
+bool WindowsMessageThread::HasQuit() const {
+    return mQuit.load(std::memory_order_acquire);
+}
+
+//*********************************************************************************
+int WindowsMessageThread::GetExitCode() const {
+    return mExitCode;
+}
+
+//*********************************************************************************
+uint64_t WindowsMessageThread::GetDroppedEvents() const {
+    return mDroppedEvents.load(std::memory_order_relaxed);
+}
+
+//*********************************************************************************
+void WindowsMessageThread::ThreadMain(Enj::WindowCreationParams creationParams) {
+    ENJ_PROFILE_THREAD("Messages");
+
+    creationParams.windowProc = WindowProc;
+    creationParams.userData = this;
+    try {
+        mWindow = std::make_shared<Enj::Window>(creationParams);
+    } catch (...) {
+        // Escaping the thread would terminate, the constructor rethrows it instead
+        mException = std::current_exception();
+        mQuit.store(true, std::memory_order_release);
+    }
+    mWindowCreated.store(true, std::memory_order_release);
+    mWindowCreated.notify_all();
+    if (mException) {
+        return;
+    }
+
+    // Blocks until there is a message, unlike the old PeekMessage once per frame. A coalesced mouse move wakes it up
+    // every millisecond until the engine took the one before it
+    MSG msg = {};
+    while (true) {
+        if (mMouseMovePending && MsgWaitForMultipleObjects(0, nullptr, FALSE, 1, QS_ALLINPUT) == WAIT_TIMEOUT) {
+            FlushMouseMove(false);
+            continue;
+        }
+        if (GetMessage(&msg, NULL, 0, 0) <= 0) {
+            break;
+        }
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+
+    mExitCode = static_cast<int>(msg.wParam);
+    mQuit.store(true, std::memory_order_release);
+}
+
+//*********************************************************************************
+void WindowsMessageThread::PushEvent(const Enj::WindowEventType type, const uint32_t code, const int32_t x, const int32_t y) {
+    // The newest position goes first, so a click still comes after the move to where it happened
+    FlushMouseMove(true);
+
+    // Waiting here would stall the window, a full queue means the engine is far behind anyway
+    if (!mEvents.TryPush({ type, code, x, y, static_cast<uint32_t>(GetMessageTime()) })) {
+        mDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+//*********************************************************************************
+void WindowsMessageThread::PushMouseMove(const int32_t x, const int32_t y) {
+    // A move the engine has not taken yet is replaced by the next one instead of filling the queue
+    mPendingMouseMove = { Enj::WindowEventType::MouseMove, 0, x, y, static_cast<uint32_t>(GetMessageTime()) };
+    mMouseMovePending = true;
+    FlushMouseMove(false);
+}
+
+//*********************************************************************************
+void WindowsMessageThread::FlushMouseMove(const bool force) {
+    if (!mMouseMovePending || (!force && mEvents.GetPopCount() < mQueuedMouseMoveEnd)) {
+        return;
+    }
+    if (!mEvents.TryPush(mPendingMouseMove)) {
+        mDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+    }
+    mQueuedMouseMoveEnd = mEvents.GetPushCount();
+    mMouseMovePending = false;
+}
+
+//*********************************************************************************
+LRESULT WindowsMessageThread::WindowProc(HWND hWND, UINT message, WPARAM wParam, LPARAM lParam) {
+    if (message == WM_NCCREATE) {
+        const CREATESTRUCT* createStruct = reinterpret_cast<const CREATESTRUCT*>(lParam);
+        SetWindowLongPtr(hWND, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(createStruct->lpCreateParams));
+    }
+
+    WindowsMessageThread* thread = reinterpret_cast<WindowsMessageThread*>(GetWindowLongPtr(hWND, GWLP_USERDATA));
+    if (thread == nullptr) {
+        return DefWindowProc(hWND, message, wParam, lParam);
+    }
+
+    using Enj::WindowEventType;
+    switch (message) {
+    case WM_DESTROY: {
+        PostQuitMessage(0);
+        return 0;
+    }
+    case WM_CLOSE: {
+        // The render thread may still present to the window, the application destroys it once it stopped
+        thread->mCloseRequested.store(true, std::memory_order_release);
+        thread->PushEvent(WindowEventType::Close, 0, 0, 0);
+        return 0;
+    }
+    case sDestroyMessage: {
+        ::DestroyWindow(hWND);
+        return 0;
+    }
+    case WM_SIZE: {
+        thread->PushEvent(WindowEventType::Resize, wParam == SIZE_MINIMIZED ? 1 : 0, LOWORD(lParam), HIWORD(lParam));
+        break;
+    }
+    case WM_SETFOCUS: {
+        thread->PushEvent(WindowEventType::FocusGained, 0, 0, 0);
+        break;
+    }
+    case WM_KILLFOCUS: {
+        thread->PushEvent(WindowEventType::FocusLost, 0, 0, 0);
+        break;
+    }
+    case WM_KEYDOWN:
+    case WM_SYSKEYDOWN: {
+#ifdef ENJ_PROFILE
+        // Dumps whatever the profiler still holds, about the last few seconds
+        if (wParam == VK_F11) {
+            Enj::Profiler::WriteChromeTrace(L"profile.json");
+        }
+#endif
+        thread->PushEvent(WindowEventType::KeyDown, static_cast<uint32_t>(wParam), (lParam & (1 << 30)) != 0 ? 1 : 0, 0);
+        break;
+    }
+    case WM_KEYUP:
+    case WM_SYSKEYUP: {
+        thread->PushEvent(WindowEventType::KeyUp, static_cast<uint32_t>(wParam), 0, 0);
+        break;
+    }
+    case WM_CHAR: {
+        thread->PushEvent(WindowEventType::Character, static_cast<uint32_t>(wParam), 0, 0);
+        return 0;
+    }
+    case WM_MOUSEMOVE: {
+        thread->PushMouseMove(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+        return 0;
+    }
+    case WM_LBUTTONDOWN:
+    case WM_RBUTTONDOWN:
+    case WM_MBUTTONDOWN: {
+        const uint32_t button = message == WM_LBUTTONDOWN ? 0 : message == WM_RBUTTONDOWN ? 1 : 2;
+        thread->PushEvent(WindowEventType::MouseButtonDown, button, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+        return 0;
+    }
+    case WM_LBUTTONUP:
+    case WM_RBUTTONUP:
+    case WM_MBUTTONUP: {
+        const uint32_t button = message == WM_LBUTTONUP ? 0 : message == WM_RBUTTONUP ? 1 : 2;
+        thread->PushEvent(WindowEventType::MouseButtonUp, button, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+        return 0;
+    }
+    case WM_MOUSEWHEEL: {
+        thread->PushEvent(WindowEventType::MouseWheel, 0, GET_WHEEL_DELTA_WPARAM(wParam), 0);
+        return 0;
+    }
+    }
+
+    // Handle any messages the switch statement didn't.
+    return DefWindowProc(hWND, message, wParam, lParam);
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+#include "Window/Window.h"
+#include "Window/WindowEvent.h"
+
+/*	Owns the window and pumps its messages on a thread of its own, so a modal move or resize loop or a burst of input
+	never holds up a frame. Messages are translated into WindowEvents, the engine drains them at the start of Update */
+class WindowsMessageThread {
+public:
+	// Events that can wait between two updates, more are dropped and counted
+	static constexpr uint32_t sEventCapacity = 1024;
+
+	// Returns once the window exists, throws what creating the window threw
+	explicit WindowsMessageThread(const Enj::WindowCreationParams& creationParams);
+	WindowsMessageThread(const WindowsMessageThread& thread) = delete;
+	void operator=(const WindowsMessageThread& thread) = delete;
+
+	// Destroys the window if it is still open and joins the thread
+	~WindowsMessageThread();
+
+	std::shared_ptr<Enj::Window> GetWindow() const;
+	Enj::WindowEventQueue& GetEventQueue();
+
+	// Closing the window only sets IsCloseRequested and queues a Close event, the window stays until this is called.
+	// Call it once nothing presents to the window anymore, it returns when the thread quit
+	void DestroyWindow();
+
+	// Set when the user closes the window, unlike the Close event it cannot be dropped from a full queue
+	bool IsCloseRequested() const;
+
+	// True once the window is gone and the thread got WM_QUIT
+	bool HasQuit() const;
+	int GetExitCode() const;
+
+	uint64_t GetDroppedEvents() const;
+
+private:
+	void ThreadMain(Enj::WindowCreationParams creationParams);
+	void PushEvent(const Enj::WindowEventType type, const uint32_t code, const int32_t x, const int32_t y);
+	void PushMouseMove(const int32_t x, const int32_t y);
+	// Queues the newest mouse position once the engine took the one queued before it, or always when force is set
+	void FlushMouseMove(const bool force);
+
+	static LRESULT CALLBACK WindowProc(HWND hWND, UINT message, WPARAM wParam, LPARAM lParam);
+
+	// Posted by DestroyWindow, windows can only be destroyed by the thread that created them
+	static constexpr UINT sDestroyMessage = WM_APP;
+
+	std::shared_ptr<Enj::Window> mWindow;
+	Enj::WindowEventQueue mEvents;
+	std::atomic<uint64_t> mDroppedEvents;
+	std::atomic<bool> mCloseRequested;
+
+	// Mouse moves are coalesced, at most one waits in the queue and the newest position waits here. Message thread only
+	Enj::WindowEvent mPendingMouseMove;
+	bool mMouseMovePending;
+	uint64_t mQueuedMouseMoveEnd;	// Push count right after the queued move, it is taken once the pop count gets there
+
+	std::atomic<bool> mWindowCreated;
+	std::atomic<bool> mQuit;
+	int mExitCode;
+	std::exception_ptr mException;	// Set by the thread when creating the window threw
+	std::thread mThread;
+};
@@ -0,0 +1,230 @@
+#include "stdafx.h"
+
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+
+namespace {
+	// Every field is atomic so a capture can read a ring while its thread keeps recording into it
+	struct Zone {
+		std::atomic<const char*> mName;
+		std::atomic<uint64_t> mBegin;
+		std::atomic<uint64_t> mEnd;
+		std::atomic<uint32_t> mDepth;
+	};
+
+	struct ThreadBuffer {
+		std::unique_ptr<Zone[]> mZones;
+		std::atomic<uint64_t> mWritten{ 0 };
+		uint32_t mDepth = 0;	// Only touched by the owning thread
+		uint32_t mThreadIndex = 0;
+		std::string mName;		// Guarded by sMutex
+	};
+
+	struct ZoneCopy {
+		const char* mName;
+		uint64_t mBegin;
+		uint64_t mEnd;
+		uint32_t mDepth;
+		uint32_t mThreadIndex;
+	};
+
+	std::mutex sMutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> sBuffers;
+	thread_local ThreadBuffer* sThreadBuffer = nullptr;
+
+	std::atomic<uint64_t> sFrameIndex{ 0 };
+
+	// Capture requested with RequestCapture, guarded by sMutex. sCapturePending keeps EndFrame lock free without one
+	std::atomic<bool> sCapturePending{ false };
+	std::filesystem::path sCapturePath;
+	uint32_t sCaptureFrames = 0;
+	uint32_t sCaptureRemaining = 0;
+	uint64_t sCaptureBegin = 0;
+
+	ThreadBuffer& GetThreadBuffer() {
+		if (sThreadBuffer == nullptr) {
+			auto buffer = std::make_unique<ThreadBuffer>();
+			buffer->mZones = std::make_unique<Zone[]>(Enj::Profiler::sRingCapacity);
+
+			std::lock_guard<std::mutex> lock(sMutex);
+			buffer->mThreadIndex = static_cast<uint32_t>(sBuffers.size());
+			buffer->mName = "Thread " + std::to_string(buffer->mThreadIndex);
+			sThreadBuffer = buffer.get();
+			sBuffers.push_back(std::move(buffer));
+		}
+		return *sThreadBuffer;
+	}
+
+	void Record(const char* name, const uint64_t begin, const uint64_t end) {
+		ThreadBuffer& buffer = GetThreadBuffer();
+		--buffer.mDepth;
+
+		const uint64_t index = buffer.mWritten.load(std::memory_order_relaxed);
+		Zone& zone = buffer.mZones[index % Enj::Profiler::sRingCapacity];
+		zone.mName.store(name, std::memory_order_relaxed);
+		zone.mBegin.store(begin, std::memory_order_relaxed);
+		zone.mEnd.store(end, std::memory_order_relaxed);
+		zone.mDepth.store(buffer.mDepth, std::memory_order_relaxed);
+		buffer.mWritten.store(index + 1, std::memory_order_release);
+	}
+
+	// Copies the zones inside [begin, end] out of every ring, sMutex has to be held
+	std::vector<ZoneCopy> CopyZones(const uint64_t begin, const uint64_t end) {
+		std::vector<ZoneCopy> zones;
+		for (const std::unique_ptr<ThreadBuffer>& buffer : sBuffers) {
+			const uint64_t written = buffer->mWritten.load(std::memory_order_acquire);
+			const uint64_t first = written > Enj::Profiler::sRingCapacity ? written - Enj::Profiler::sRingCapacity : 0;
+			const size_t copyBegin = zones.size();
+			for (uint64_t index = first; index < written; ++index) {
+				const Zone& zone = buffer->mZones[index % Enj::Profiler::sRingCapacity];
+				zones.push_back({
+					zone.mName.load(std::memory_order_relaxed),
+					zone.mBegin.load(std::memory_order_relaxed),
+					zone.mEnd.load(std::memory_order_relaxed),
+					zone.mDepth.load(std::memory_order_relaxed),
+					buffer->mThreadIndex
+				});
+			}
+
+			// The owner kept recording while copying, drop the slots it may have overwritten, including the one it may be writing
+			const uint64_t writtenAfter = buffer->mWritten.load(std::memory_order_acquire);
+			const uint64_t valid = writtenAfter + 1 > Enj::Profiler::sRingCapacity ? writtenAfter + 1 - Enj::Profiler::sRingCapacity : 0;
+			if (valid > first) {
+				const size_t overwritten = static_cast<size_t>(std::min(valid - first, written - first));
+				zones.erase(zones.begin() + copyBegin, zones.begin() + copyBegin + overwritten);
+			}
+		}
+
+		zones.erase(std::remove_if(zones.begin(), zones.end(), [begin, end](const ZoneCopy& zone) {
+			return zone.mBegin < begin || zone.mEnd > end;
+		}), zones.end());
+
+		// Parents before children, so viewers nest zones that start on the same tick correctly
+		std::sort(zones.begin(), zones.end(), [](const ZoneCopy& a, const ZoneCopy& b) {
+			if (a.mThreadIndex != b.mThreadIndex) {
+				return a.mThreadIndex < b.mThreadIndex;
+			}
+			return a.mBegin != b.mBegin ? a.mBegin < b.mBegin : a.mDepth < b.mDepth;
+		});
+		return zones;
+	}
+
+	void WriteEscaped(std::ofstream& file, const char* text) {
+		for (; *text != '\0'; ++text) {
+			if (*text == '"' || *text == '\\') {
+				file << '\\';
+			}
+			file << *text;
+		}
+	}
+
+	// sMutex has to be held
+	bool WriteTrace(const std::filesystem::path& path, const uint64_t begin, const uint64_t end) {
+		const std::vector<ZoneCopy> zones = CopyZones(begin, end);
+
+		std::ofstream file(path);
+		if (!file) {
+			return false;
+		}
+
+		uint64_t origin = UINT64_MAX;
+		for (const ZoneCopy& zone : zones) {
+			origin = std::min(origin, zone.mBegin);
+		}
+
+		file << std::fixed;
+		file.precision(3);
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		bool first = true;
+		for (const std::unique_ptr<ThreadBuffer>& buffer : sBuffers) {
+			file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->mThreadIndex << ",\"args\":{\"name\":\"";
+			WriteEscaped(file, buffer->mName.c_str());
+			file << "\"}}";
+			first = false;
+		}
+		for (const ZoneCopy& zone : zones) {
+			// Microseconds from the first zone
+			file << ",\n{\"name\":\"";
+			WriteEscaped(file, zone.mName);
+			file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << zone.mThreadIndex
+				<< ",\"ts\":" << static_cast<double>(zone.mBegin - origin) / 1000.0
+				<< ",\"dur\":" << static_cast<double>(zone.mEnd - zone.mBegin) / 1000.0 << "}";
+		}
+		file << "\n]}\n";
+		return static_cast<bool>(file);
+	}
+}
+
+//*********************************************************************************
+uint64_t Enj::Profiler::Now() {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+//*********************************************************************************
+void Enj::Profiler::BeginZone() {
+	++GetThreadBuffer().mDepth;
+}
+
+//*********************************************************************************
+void Enj::Profiler::EndZone(const char* name, const uint64_t begin) {
+	Record(name, begin, Now());
+}
+
+//*********************************************************************************
+void Enj::Profiler::EndFrame(const uint64_t begin) {
+	const uint64_t end = Now();
+	Record("Frame", begin, end);
+	sFrameIndex.fetch_add(1, std::memory_order_relaxed);
+
+	if (!sCapturePending.load(std::memory_order_acquire)) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(sMutex);
+	if (sCaptureBegin == 0) {
+		// Requested during this frame, the capture starts with the next one
+		sCaptureBegin = end;
+		sCaptureRemaining = sCaptureFrames;
+		return;
+	}
+	if (--sCaptureRemaining == 0) {
+		WriteTrace(sCapturePath, sCaptureBegin, end);
+		sCaptureBegin = 0;
+		sCapturePending.store(false, std::memory_order_release);
+	}
+}
+
+//*********************************************************************************
+void Enj::Profiler::SetThreadName(const char* name) {
+	ThreadBuffer& buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> lock(sMutex);
+	buffer.mName = name;
+}
+
+//*********************************************************************************
+bool Enj::Profiler::WriteChromeTrace(const std::filesystem::path& path) {
+	std::lock_guard<std::mutex> lock(sMutex);
+	return WriteTrace(path, 0, UINT64_MAX);
+}
+
+//*********************************************************************************
+void Enj::Profiler::RequestCapture(const std::filesystem::path& path, const uint32_t frameCount) {
+	if (frameCount == 0) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(sMutex);
+	sCapturePath = path;
+	sCaptureFrames = frameCount;
+	sCaptureBegin = 0;
+	sCapturePending.store(true, std::memory_order_release);
+}
+
+//*********************************************************************************
+uint64_t Enj::Profiler::GetFrameIndex() {
+	return sFrameIndex.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <filesystem>
+#include <stdint.h>
+
+/*	CPU zone profiler. Zones record begin/end timestamps into a ring buffer owned by the recording thread, so recording
+	never takes a lock. Captures are written in the Chrome trace format, open them in chrome://tracing or ui.perfetto.dev
+
+	ENJ_PROFILE turns the macros on, it is defined for Debug builds and can be defined for Release as well.
+	Without it every macro expands to nothing */
+#if defined(ENJ_PROFILE)
+#define ENJ_PROFILE_CONCAT_INNER(a, b) a##b
+#define ENJ_PROFILE_CONCAT(a, b) ENJ_PROFILE_CONCAT_INNER(a, b)
+
+// Times the rest of the enclosing scope, name has to be a string literal
+#define ENJ_PROFILE_SCOPE(name) const Enj::ProfileScope ENJ_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define ENJ_PROFILE_FUNCTION() ENJ_PROFILE_SCOPE(__FUNCTION__)
+
+// Times the rest of the enclosing scope as one frame, once per iteration of the main loop
+#define ENJ_PROFILE_FRAME() const Enj::ProfileFrameScope ENJ_PROFILE_CONCAT(profileFrame, __LINE__)
+
+// Names the calling thread in captures
+#define ENJ_PROFILE_THREAD(name) Enj::Profiler::SetThreadName(name)
+#else
+#define ENJ_PROFILE_SCOPE(name)
+#define ENJ_PROFILE_FUNCTION()
+#define ENJ_PROFILE_FRAME()
+#define ENJ_PROFILE_THREAD(name)
+#endif
+
+namespace Enj {
+	class Profiler {
+	public:
+		// Zones kept per thread, older zones are overwritten. A capture of N frames has to fit in it
+		static constexpr uint32_t sRingCapacity = 1 << 16;
+
+		static uint64_t Now();
+
+		static void BeginZone();
+		static void EndZone(const char* name, const uint64_t begin);
+
+		// Closes a frame and writes a requested capture once its last frame has ended
+		static void EndFrame(const uint64_t begin);
+
+		static void SetThreadName(const char* name);
+
+		// Writes every zone still held by the ring buffers. Returns false when the file could not be written
+		static bool WriteChromeTrace(const std::filesystem::path& path);
+
+		// Writes the next frameCount frames to path once they have ended
+		static void RequestCapture(const std::filesystem::path& path, const uint32_t frameCount);
+
+		static uint64_t GetFrameIndex();
+	};
+
+	class ProfileScope {
+	public:
+		explicit ProfileScope(const char* name) : mName(name), mBegin(Profiler::Now()) {
+			Profiler::BeginZone();
+		}
+		~ProfileScope() {
+			Profiler::EndZone(mName, mBegin);
+		}
+		ProfileScope(const ProfileScope& scope) = delete;
+		void operator=(const ProfileScope& scope) = delete;
+
+	private:
+		const char* mName;
+		uint64_t mBegin;
+	};
+
+	class ProfileFrameScope {
+	public:
+		ProfileFrameScope() : mBegin(Profiler::Now()) {
+			Profiler::BeginZone();
+		}
+		~ProfileFrameScope() {
+			Profiler::EndFrame(mBegin);
+		}
+		ProfileFrameScope(const ProfileFrameScope& scope) = delete;
+		void operator=(const ProfileFrameScope& scope) = delete;
+
+	private:
+		uint64_t mBegin;
+	};
+}
@@ -0,0 +1,539 @@
+#include "stdafx.h"
+
+#include "BVH.h"
+#include "Threading/ParallelAlgorithms.h"
+#include "Profiling/Profiler.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+Enj::BVH::BVH() :
+	mBuildCost(0.0f),
+	mCost(0.0f) {}
+
+//*********************************************************************************
+void Enj::BVH::Build(std::span<const OMath::AABBf> bounds, JobSystem* jobSystem) {
+	ENJ_PROFILE_FUNCTION();
+	Clear();
+	if (bounds.empty()) {
+		return;
+	}
+	assert(bounds.size() < sLeaf && "Too many primitives for 32 bit indices");
+
+	const uint32_t count = static_cast<uint32_t>(bounds.size());
+	mBounds.assign(bounds.begin(), bounds.end());
+	mPrimitiveIndices.resize(count);
+	std::iota(mPrimitiveIndices.begin(), mPrimitiveIndices.end(), 0);
+
+	// The build scratch keeps its capacity, rebuilds of the same scene do not allocate
+	std::vector<OMath::Vector3f>& centroids = mBuildCentroids;
+	centroids.resize(count);
+	const auto computeCentroids = [&](const size_t begin, const size_t end) {
+		for (size_t index = begin; index < end; ++index) {
+			assert(bounds[index].IsValid() && "BVH primitives need valid bounds");
+			centroids[index] = bounds[index].GetCenter();
+		}
+	};
+	if (jobSystem != nullptr) {
+		Parallel::ForRange(*jobSystem, count, computeCentroids);
+	} else {
+		computeCentroids(0, count);
+	}
+
+	std::vector<BuildNode>& nodes = mBuildNodes;
+	nodes.clear();
+	nodes.reserve(2 * static_cast<size_t>(count));
+	nodes.push_back({ ComputeBounds(0, count), sLeaf, sLeaf, 0, count });
+
+	// The upper levels are split here until every remaining subtree is small enough to be one task
+	std::vector<BuildTask>& tasks = mBuildTasks;
+	tasks.clear();
+	const bool parallel = jobSystem != nullptr && jobSystem->WorkerCount() > 0 && count >= sParallelThreshold;
+	if (parallel) {
+		const uint32_t grain = std::max(count / (4 * (jobSystem->WorkerCount() + 1)), sMinTaskSize);
+		SplitTop(nodes, tasks, centroids, 0, 0, grain);
+	} else {
+		tasks.push_back({ 0, 0, 0 });
+	}
+
+	// A subtree over n primitives has at most 2n - 2 nodes below its root, so every task gets its own range
+	uint32_t nodeOffset = static_cast<uint32_t>(nodes.size());
+	for (BuildTask& task : tasks) {
+		task.mNodeOffset = nodeOffset;
+		nodeOffset += 2 * nodes[task.mNode].mCount;
+	}
+	nodes.resize(nodeOffset);
+
+	const auto buildTask = [&](const uint32_t taskIndex) {
+		const BuildTask& task = tasks[taskIndex];
+		uint32_t nodeCursor = task.mNodeOffset;
+		BuildSubtree(nodes, centroids, task.mNode, nodeCursor, task.mDepth);
+	};
+	if (parallel) {
+		jobSystem->Dispatch(static_cast<uint32_t>(tasks.size()), [&buildTask](const uint32_t taskIndex) { buildTask(taskIndex); });
+	} else {
+		buildTask(0);
+	}
+
+	mNodes.reserve(nodes.size() / 2 + 1);
+	Collapse(nodes, 0);
+
+	mBuildCost = ComputeCost();
+	mCost = mBuildCost;
+}
+
+//*********************************************************************************
+void Enj::BVH::Refit(std::span<const OMath::AABBf> bounds) {
+	ENJ_PROFILE_FUNCTION();
+	assert(bounds.size() == mBounds.size() && "Refit needs the primitives the tree was built with");
+	std::copy(bounds.begin(), bounds.end(), mBounds.begin());
+
+	// Children always come after their parent, so walking backwards updates them first
+	for (size_t index = mNodes.size(); index-- > 0;) {
+		Node& node = mNodes[index];
+		for (uint32_t slot = 0; slot < node.mChildCount; ++slot) {
+			const OMath::AABBf childBounds = node.mChildren[slot] == sLeaf ?
+				ComputeBounds(node.mFirst[slot], node.mCount[slot]) :
+				GetNodeBounds(mNodes[node.mChildren[slot]]);
+			SetChildBounds(node, slot, childBounds);
+		}
+	}
+	mCost = ComputeCost();
+}
+
+//*********************************************************************************
+void Enj::BVH::Clear() {
+	mNodes.clear();
+	mPrimitiveIndices.clear();
+	mBounds.clear();
+	mBuildCost = 0.0f;
+	mCost = 0.0f;
+}
+
+//*********************************************************************************
+bool Enj::BVH::NeedsRebuild() const {
+	return mBuildCost > 0.0f && mCost > mBuildCost * sRebuildRatio;
+}
+
+//*********************************************************************************
+bool Enj::BVH::IsEmpty() const {
+	return mNodes.empty();
+}
+
+//*********************************************************************************
+size_t Enj::BVH::GetNodeCount() const {
+	return mNodes.size();
+}
+
+//*********************************************************************************
+size_t Enj::BVH::GetPrimitiveCount() const {
+	return mPrimitiveIndices.size();
+}
+
+//*********************************************************************************
+OMath::AABBf Enj::BVH::GetBounds() const {
+	return mNodes.empty() ? OMath::AABBf() : GetNodeBounds(mNodes[0]);
+}
+
+//*********************************************************************************
+void Enj::BVH::QueryFrustum(const OMath::Frustumf& frustum, std::vector<uint32_t>& results) const {
+	if (mNodes.empty()) {
+		return;
+	}
+
+	// The far corner along a normal decides intersection, the near corner decides containment
+	constexpr int planeCount = OMath::Frustumf::PlaneCount;
+	Float4 planes[planeCount][4];
+	bool useMax[planeCount][3];
+	for (int plane = 0; plane < planeCount; ++plane) {
+		const OMath::Vector4f& p = frustum.mPlanes[plane];
+		planes[plane][0] = Float4(p.mX);
+		planes[plane][1] = Float4(p.mY);
+		planes[plane][2] = Float4(p.mZ);
+		planes[plane][3] = Float4(p.mW);
+		useMax[plane][0] = p.mX >= 0.0f;
+		useMax[plane][1] = p.mY >= 0.0f;
+		useMax[plane][2] = p.mZ >= 0.0f;
+	}
+
+	const Float4 zero(0.0f);
+	const Float4 allLanes = zero >= zero;
+
+	uint32_t stack[sStackSize];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const Node& node = mNodes[stack[--stackSize]];
+		const Float4 min[3] = { Float4::Load(node.mMinX), Float4::Load(node.mMinY), Float4::Load(node.mMinZ) };
+		const Float4 max[3] = { Float4::Load(node.mMaxX), Float4::Load(node.mMaxY), Float4::Load(node.mMaxZ) };
+
+		Float4 intersects = allLanes;
+		Float4 contained = allLanes;
+		for (int plane = 0; plane < planeCount; ++plane) {
+			const Float4& farX = useMax[plane][0] ? max[0] : min[0];
+			const Float4& farY = useMax[plane][1] ? max[1] : min[1];
+			const Float4& farZ = useMax[plane][2] ? max[2] : min[2];
+			const Float4& nearX = useMax[plane][0] ? min[0] : max[0];
+			const Float4& nearY = useMax[plane][1] ? min[1] : max[1];
+			const Float4& nearZ = useMax[plane][2] ? min[2] : max[2];
+
+			const Float4 farDistance = MulAdd(planes[plane][2], farZ, MulAdd(planes[plane][1], farY, MulAdd(planes[plane][0], farX, planes[plane][3])));
+			const Float4 nearDistance = MulAdd(planes[plane][2], nearZ, MulAdd(planes[plane][1], nearY, MulAdd(planes[plane][0], nearX, planes[plane][3])));
+			intersects = intersects & (farDistance >= zero);
+			contained = contained & (nearDistance >= zero);
+		}
+
+		uint32_t mask = intersects.MoveMask() & ((1u << node.mChildCount) - 1u);
+		const uint32_t containedMask = contained.MoveMask() & mask;
+		while (mask != 0) {
+			const uint32_t slot = static_cast<uint32_t>(std::countr_zero(mask));
+			mask &= mask - 1;
+
+			if (containedMask & (1u << slot)) {
+				AppendRange(node.mFirst[slot], node.mCount[slot], results);
+			} else if (node.mChildren[slot] == sLeaf) {
+				for (uint32_t index = node.mFirst[slot]; index < node.mFirst[slot] + node.mCount[slot]; ++index) {
+					if (frustum.Intersects(mBounds[mPrimitiveIndices[index]])) {
+						results.push_back(mPrimitiveIndices[index]);
+					}
+				}
+			} else {
+				assert(stackSize < sStackSize && "BVH traversal stack overflow");
+				stack[stackSize++] = node.mChildren[slot];
+			}
+		}
+	}
+}
+
+//*********************************************************************************
+void Enj::BVH::QueryOverlap(const OMath::AABBf& aabb, std::vector<uint32_t>& results) const {
+	if (mNodes.empty() || !aabb.IsValid()) {
+		return;
+	}
+
+	const OMath::Vector3Wide<4> queryMin(aabb.mMin);
+	const OMath::Vector3Wide<4> queryMax(aabb.mMax);
+
+	uint32_t stack[sStackSize];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const Node& node = mNodes[stack[--stackSize]];
+		const OMath::AABBWide<4> children(
+			{ Float4::Load(node.mMinX), Float4::Load(node.mMinY), Float4::Load(node.mMinZ) },
+			{ Float4::Load(node.mMaxX), Float4::Load(node.mMaxY), Float4::Load(node.mMaxZ) }
+		);
+
+		uint32_t mask = children.Overlaps(aabb).MoveMask() & ((1u << node.mChildCount) - 1u);
+		const Float4 contained =
+			(children.mMin.mX >= queryMin.mX) & (children.mMin.mY >= queryMin.mY) & (children.mMin.mZ >= queryMin.mZ) &
+			(children.mMax.mX <= queryMax.mX) & (children.mMax.mY <= queryMax.mY) & (children.mMax.mZ <= queryMax.mZ);
+		const uint32_t containedMask = contained.MoveMask() & mask;
+
+		while (mask != 0) {
+			const uint32_t slot = static_cast<uint32_t>(std::countr_zero(mask));
+			mask &= mask - 1;
+
+			if (containedMask & (1u << slot)) {
+				AppendRange(node.mFirst[slot], node.mCount[slot], results);
+			} else if (node.mChildren[slot] == sLeaf) {
+				for (uint32_t index = node.mFirst[slot]; index < node.mFirst[slot] + node.mCount[slot]; ++index) {
+					if (mBounds[mPrimitiveIndices[index]].Overlaps(aabb)) {
+						results.push_back(mPrimitiveIndices[index]);
+					}
+				}
+			} else {
+				assert(stackSize < sStackSize && "BVH traversal stack overflow");
+				stack[stackSize++] = node.mChildren[slot];
+			}
+		}
+	}
+}
+
+//*********************************************************************************
+void Enj::BVH::QueryOverlap(const OMath::Spheref& sphere, std::vector<uint32_t>& results) const {
+	if (mNodes.empty() || !sphere.IsValid()) {
+		return;
+	}
+
+	uint32_t stack[sStackSize];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const Node& node = mNodes[stack[--stackSize]];
+		const OMath::AABBWide<4> children(
+			{ Float4::Load(node.mMinX), Float4::Load(node.mMinY), Float4::Load(node.mMinZ) },
+			{ Float4::Load(node.mMaxX), Float4::Load(node.mMaxY), Float4::Load(node.mMaxZ) }
+		);
+
+		uint32_t mask = children.Overlaps(sphere).MoveMask() & ((1u << node.mChildCount) - 1u);
+		while (mask != 0) {
+			const uint32_t slot = static_cast<uint32_t>(std::countr_zero(mask));
+			mask &= mask - 1;
+
+			if (node.mChildren[slot] == sLeaf) {
+				for (uint32_t index = node.mFirst[slot]; index < node.mFirst[slot] + node.mCount[slot]; ++index) {
+					if (sphere.Overlaps(mBounds[mPrimitiveIndices[index]])) {
+						results.push_back(mPrimitiveIndices[index]);
+					}
+				}
+			} else {
+				assert(stackSize < sStackSize && "BVH traversal stack overflow");
+				stack[stackSize++] = node.mChildren[slot];
+			}
+		}
+	}
+}
+
+//*********************************************************************************
+bool Enj::BVH::Raycast(const OMath::Rayf& ray, const float maxDistance, RayHit& hit) const {
+	return Raycast(ray, maxDistance, [this](const uint32_t primitive, const OMath::Rayf& primitiveRay, float) {
+		float distance = -1.0f;
+		return primitiveRay.Intersects(mBounds[primitive], distance) ? distance : -1.0f;
+	}, hit);
+}
+
+//*********************************************************************************
+bool Enj::BVH::Split(std::span<const OMath::Vector3f> centroids, const uint32_t first, const uint32_t count, const uint32_t depth, uint32_t& leftCount) {
+	// A full leaf costs about the same to test as a full 4 wide node, so small ranges never split
+	if (count <= sMaxLeafSize) {
+		return false;
+	}
+
+	const auto begin = mPrimitiveIndices.begin() + first;
+	const auto end = begin + count;
+
+	OMath::AABBf centroidBounds;
+	for (auto it = begin; it != end; ++it) {
+		centroidBounds.Merge(centroids[*it]);
+	}
+	const float minimum[3] = { centroidBounds.mMin.mX, centroidBounds.mMin.mY, centroidBounds.mMin.mZ };
+	const OMath::Vector3f size = centroidBounds.GetSize();
+	const float extent[3] = { size.mX, size.mY, size.mZ };
+	const float scale[3] = {
+		extent[0] > 0.0f ? static_cast<float>(sBinCount) / extent[0] : 0.0f,
+		extent[1] > 0.0f ? static_cast<float>(sBinCount) / extent[1] : 0.0f,
+		extent[2] > 0.0f ? static_cast<float>(sBinCount) / extent[2] : 0.0f
+	};
+
+	const auto component = [&centroids](const uint32_t primitive, const int axis) {
+		const OMath::Vector3f& centroid = centroids[primitive];
+		return axis == 0 ? centroid.mX : (axis == 1 ? centroid.mY : centroid.mZ);
+	};
+	const auto binIndex = [&](const uint32_t primitive, const int axis) {
+		const uint32_t bin = static_cast<uint32_t>((component(primitive, axis) - minimum[axis]) * scale[axis]);
+		return std::min(bin, sBinCount - 1);
+	};
+
+	int bestAxis = -1;
+	uint32_t bestBin = 0;
+	float bestCost = std::numeric_limits<float>::max();
+	for (int axis = 0; axis < 3 && depth < sMaxDepth; ++axis) {
+		if (extent[axis] <= 0.0f) {
+			continue;
+		}
+
+		struct Bin {
+			OMath::AABBf mBounds;
+			uint32_t mCount = 0;
+		};
+		Bin bins[sBinCount];
+		for (auto it = begin; it != end; ++it) {
+			Bin& bin = bins[binIndex(*it, axis)];
+			bin.mBounds.Merge(mBounds[*it]);
+			++bin.mCount;
+		}
+
+		// Split after bin i puts bins [0, i] on the left, sweep from the right first to get the right side areas
+		float rightArea[sBinCount - 1];
+		uint32_t rightCount[sBinCount - 1];
+		OMath::AABBf accumulated;
+		uint32_t accumulatedCount = 0;
+		for (uint32_t bin = sBinCount - 1; bin > 0; --bin) {
+			accumulated.Merge(bins[bin].mBounds);
+			accumulatedCount += bins[bin].mCount;
+			rightArea[bin - 1] = accumulated.GetSurfaceArea();
+			rightCount[bin - 1] = accumulatedCount;
+		}
+
+		accumulated = OMath::AABBf();
+		accumulatedCount = 0;
+		for (uint32_t bin = 0; bin < sBinCount - 1; ++bin) {
+			accumulated.Merge(bins[bin].mBounds);
+			accumulatedCount += bins[bin].mCount;
+			if (accumulatedCount == 0 || rightCount[bin] == 0) {
+				continue;
+			}
+			const float cost = accumulated.GetSurfaceArea() * accumulatedCount + rightArea[bin] * rightCount[bin];
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = bin;
+			}
+		}
+	}
+
+	if (bestAxis >= 0) {
+		const auto middle = std::partition(begin, end, [&](const uint32_t primitive) { return binIndex(primitive, bestAxis) <= bestBin; });
+		leftCount = static_cast<uint32_t>(middle - begin);
+		if (leftCount != 0 && leftCount != count) {
+			return true;
+		}
+	}
+
+	// No useful SAH split (coincident centroids or too deep), halve along the widest axis
+	const int axis = extent[0] >= extent[1] && extent[0] >= extent[2] ? 0 : (extent[1] >= extent[2] ? 1 : 2);
+	leftCount = count / 2;
+	std::nth_element(begin, begin + leftCount, end, [&](const uint32_t a, const uint32_t b) { return component(a, axis) < component(b, axis); });
+	return true;
+}
+
+//*********************************************************************************
+OMath::AABBf Enj::BVH::ComputeBounds(const uint32_t first, const uint32_t count) const {
+	OMath::AABBf result;
+	for (uint32_t index = first; index < first + count; ++index) {
+		result.Merge(mBounds[mPrimitiveIndices[index]]);
+	}
+	return result;
+}
+
+//*********************************************************************************
+void Enj::BVH::BuildSubtree(std::vector<BuildNode>& nodes, std::span<const OMath::Vector3f> centroids, const uint32_t nodeIndex, uint32_t& nodeCursor, const uint32_t depth) {
+	// nodes is sized up front, so references stay valid while other tasks fill their own ranges
+	BuildNode& node = nodes[nodeIndex];
+	uint32_t leftCount = 0;
+	if (!Split(centroids, node.mFirst, node.mCount, depth, leftCount)) {
+		return;
+	}
+
+	const uint32_t left = nodeCursor;
+	nodeCursor += 2;
+	nodes[left] = { ComputeBounds(node.mFirst, leftCount), sLeaf, sLeaf, node.mFirst, leftCount };
+	nodes[left + 1] = { ComputeBounds(node.mFirst + leftCount, node.mCount - leftCount), sLeaf, sLeaf, node.mFirst + leftCount, node.mCount - leftCount };
+	node.mLeft = left;
+	node.mRight = left + 1;
+
+	BuildSubtree(nodes, centroids, left, nodeCursor, depth + 1);
+	BuildSubtree(nodes, centroids, left + 1, nodeCursor, depth + 1);
+}
+
+//*********************************************************************************
+void Enj::BVH::SplitTop(std::vector<BuildNode>& nodes, std::vector<BuildTask>& tasks, std::span<const OMath::Vector3f> centroids, const uint32_t nodeIndex, const uint32_t depth, const uint32_t grain) {
+	const uint32_t first = nodes[nodeIndex].mFirst;
+	const uint32_t count = nodes[nodeIndex].mCount;
+	uint32_t leftCount = 0;
+	if (count <= grain || !Split(centroids, first, count, depth, leftCount)) {
+		tasks.push_back({ nodeIndex, depth, 0 });
+		return;
+	}
+
+	const uint32_t left = static_cast<uint32_t>(nodes.size());
+	nodes.push_back({ ComputeBounds(first, leftCount), sLeaf, sLeaf, first, leftCount });
+	nodes.push_back({ ComputeBounds(first + leftCount, count - leftCount), sLeaf, sLeaf, first + leftCount, count - leftCount });
+	nodes[nodeIndex].mLeft = left;
+	nodes[nodeIndex].mRight = left + 1;
+
+	SplitTop(nodes, tasks, centroids, left, depth + 1, grain);
+	SplitTop(nodes, tasks, centroids, left + 1, depth + 1, grain);
+}
+
+//*********************************************************************************
+uint32_t Enj::BVH::Collapse(const std::vector<BuildNode>& nodes, const uint32_t buildIndex) {
+	const uint32_t nodeIndex = static_cast<uint32_t>(mNodes.size());
+	mNodes.emplace_back();
+
+	// Start from the two children and keep opening the largest inner one until the node is full
+	uint32_t slots[4];
+	uint32_t slotCount = 0;
+	const BuildNode& root = nodes[buildIndex];
+	if (root.mLeft == sLeaf) {
+		slots[slotCount++] = buildIndex;
+	} else {
+		slots[slotCount++] = root.mLeft;
+		slots[slotCount++] = root.mRight;
+	}
+
+	while (slotCount < 4) {
+		int largest = -1;
+		float largestArea = -1.0f;
+		for (uint32_t slot = 0; slot < slotCount; ++slot) {
+			const BuildNode& child = nodes[slots[slot]];
+			if (child.mLeft != sLeaf && child.mBounds.GetSurfaceArea() > largestArea) {
+				largestArea = child.mBounds.GetSurfaceArea();
+				largest = static_cast<int>(slot);
+			}
+		}
+		if (largest < 0) {
+			break;
+		}
+		const BuildNode& opened = nodes[slots[largest]];
+		slots[largest] = opened.mLeft;
+		slots[slotCount++] = opened.mRight;
+	}
+
+	Node node = {};
+	node.mChildCount = slotCount;
+	for (uint32_t slot = 0; slot < 4; ++slot) {
+		if (slot >= slotCount) {
+			SetChildBounds(node, slot, OMath::AABBf());
+			node.mChildren[slot] = sLeaf;
+			continue;
+		}
+		const BuildNode& child = nodes[slots[slot]];
+		SetChildBounds(node, slot, child.mBounds);
+		node.mFirst[slot] = child.mFirst;
+		node.mCount[slot] = child.mCount;
+		node.mChildren[slot] = child.mLeft == sLeaf ? sLeaf : Collapse(nodes, slots[slot]);
+	}
+	mNodes[nodeIndex] = node;
+	return nodeIndex;
+}
+
+//*********************************************************************************
+void Enj::BVH::SetChildBounds(Node& node, const uint32_t slot, const OMath::AABBf& bounds) {
+	node.mMinX[slot] = bounds.mMin.mX;
+	node.mMinY[slot] = bounds.mMin.mY;
+	node.mMinZ[slot] = bounds.mMin.mZ;
+	node.mMaxX[slot] = bounds.mMax.mX;
+	node.mMaxY[slot] = bounds.mMax.mY;
+	node.mMaxZ[slot] = bounds.mMax.mZ;
+}
+
+//*********************************************************************************
+OMath::AABBf Enj::BVH::GetChildBounds(const Node& node, const uint32_t slot) const {
+	return { { node.mMinX[slot], node.mMinY[slot], node.mMinZ[slot] }, { node.mMaxX[slot], node.mMaxY[slot], node.mMaxZ[slot] } };
+}
+
+//*********************************************************************************
+OMath::AABBf Enj::BVH::GetNodeBounds(const Node& node) const {
+	OMath::AABBf result;
+	for (uint32_t slot = 0; slot < node.mChildCount; ++slot) {
+		result.Merge(GetChildBounds(node, slot));
+	}
+	return result;
+}
+
+//*********************************************************************************
+float Enj::BVH::ComputeCost() const {
+	if (mNodes.empty()) {
+		return 0.0f;
+	}
+
+	const float rootArea = GetNodeBounds(mNodes[0]).GetSurfaceArea();
+	if (rootArea <= 0.0f) {
+		return 0.0f;
+	}
+
+	float area = 0.0f;
+	for (const Node& node : mNodes) {
+		for (uint32_t slot = 0; slot < node.mChildCount; ++slot) {
+			area += GetChildBounds(node, slot).GetSurfaceArea();
+		}
+	}
+	return area / rootArea;
+}
+
+//*********************************************************************************
+void Enj::BVH::AppendRange(const uint32_t first, const uint32_t count, std::vector<uint32_t>& results) const {
+	results.insert(results.end(), mPrimitiveIndices.begin() + first, mPrimitiveIndices.begin() + first + count);
+}
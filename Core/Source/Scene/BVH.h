@@ -0,0 +1,247 @@
+#pragma once
+#include <assert.h>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <stdint.h>
+#include <vector>
+#include <Math/AABB.h>
+#include <Math/FloatWide.h>
+#include <Math/Frustum.h>
+#include <Math/Ray.h>
+#include <Math/Sphere.h>
+
+namespace Enj {
+	class JobSystem;
+
+	struct RayHit {
+		uint32_t mPrimitive;
+		float mDistance;
+	};
+
+	/*	Bounding volume hierarchy over AABBs, the primitive index of a box is its position in the span given to Build.
+		Built as a binary tree with binned SAH and collapsed to 4 wide nodes, so every traversal step tests four child
+		boxes at once. Static content is built once, dynamic content is refit every frame and rebuilt when NeedsRebuild() */
+	class BVH {
+	public:
+		static constexpr uint32_t sMaxLeafSize = 4;
+		static constexpr uint32_t sBinCount = 16;
+
+		// Cost growth from refits before a rebuild pays off
+		static constexpr float sRebuildRatio = 1.5f;
+
+		BVH();
+		BVH(const BVH& bvh) = delete;
+		void operator=(const BVH& bvh) = delete;
+		BVH(BVH&& bvh) = default;
+		BVH& operator=(BVH&& bvh) = default;
+
+		// Large inputs build their upper subtrees in parallel when a job system is given
+		void Build(std::span<const OMath::AABBf> bounds, JobSystem* jobSystem = nullptr);
+
+		// Moves the boxes of the same primitives without changing the tree. Quality drops as primitives move apart
+		void Refit(std::span<const OMath::AABBf> bounds);
+
+		void Clear();
+
+		// True when refits have made the tree sRebuildRatio more expensive to traverse than it was when built
+		bool NeedsRebuild() const;
+
+		bool IsEmpty() const;
+		size_t GetNodeCount() const;
+		size_t GetPrimitiveCount() const;
+		OMath::AABBf GetBounds() const;
+
+		// The queries append primitive indices to results in no particular order
+		void QueryFrustum(const OMath::Frustumf& frustum, std::vector<uint32_t>& results) const;
+		void QueryOverlap(const OMath::AABBf& aabb, std::vector<uint32_t>& results) const;
+		void QueryOverlap(const OMath::Spheref& sphere, std::vector<uint32_t>& results) const;
+
+		// Nearest primitive box hit within maxDistance
+		bool Raycast(const OMath::Rayf& ray, const float maxDistance, RayHit& hit) const;
+
+		// Nearest hit within maxDistance where hitTest(primitive, ray, closestDistance) returns the distance to the
+		// primitive itself, or a negative value when it is missed
+		template <class HitTest>
+		bool Raycast(const OMath::Rayf& ray, const float maxDistance, HitTest&& hitTest, RayHit& hit) const;
+
+	private:
+		static constexpr uint32_t sLeaf = 0xFFFFFFFF;
+		static constexpr uint32_t sStackSize = 384;
+
+		// Below this depth SAH decides, past it every split is a median split so the depth stays bounded
+		static constexpr uint32_t sMaxDepth = 64;
+
+		// Inputs smaller than this are built on the calling thread
+		static constexpr uint32_t sParallelThreshold = 8192;
+		static constexpr uint32_t sMinTaskSize = 1024;
+
+		// Four children as structure of arrays, only the first mChildCount slots are used
+		struct alignas(64) Node {
+			float mMinX[4];
+			float mMinY[4];
+			float mMinZ[4];
+			float mMaxX[4];
+			float mMaxY[4];
+			float mMaxZ[4];
+			uint32_t mChildren[4];	// Node index, or sLeaf
+			uint32_t mFirst[4];		// All primitives below a child are mPrimitiveIndices[mFirst, mFirst + mCount)
+			uint32_t mCount[4];
+			uint32_t mChildCount;
+		};
+
+		struct BuildNode {
+			OMath::AABBf mBounds;
+			uint32_t mLeft;
+			uint32_t mRight;
+			uint32_t mFirst;
+			uint32_t mCount;
+		};
+
+		// A subtree built by one thread, its nodes go to [mNodeOffset, mNodeOffset + 2 * count)
+		struct BuildTask {
+			uint32_t mNode;
+			uint32_t mDepth;
+			uint32_t mNodeOffset;
+		};
+
+		using Float4 = OMath::FloatWide<4>;
+
+		// Binned SAH split of [first, first + count), partitions mPrimitiveIndices. Returns false when the range stays a leaf
+		bool Split(std::span<const OMath::Vector3f> centroids, const uint32_t first, const uint32_t count, const uint32_t depth, uint32_t& leftCount);
+		OMath::AABBf ComputeBounds(const uint32_t first, const uint32_t count) const;
+		void BuildSubtree(std::vector<BuildNode>& nodes, std::span<const OMath::Vector3f> centroids, const uint32_t nodeIndex, uint32_t& nodeCursor, const uint32_t depth);
+		void SplitTop(std::vector<BuildNode>& nodes, std::vector<BuildTask>& tasks, std::span<const OMath::Vector3f> centroids, const uint32_t nodeIndex, const uint32_t depth, const uint32_t grain);
+		uint32_t Collapse(const std::vector<BuildNode>& nodes, const uint32_t buildIndex);
+
+		void SetChildBounds(Node& node, const uint32_t slot, const OMath::AABBf& bounds);
+		OMath::AABBf GetChildBounds(const Node& node, const uint32_t slot) const;
+		OMath::AABBf GetNodeBounds(const Node& node) const;
+
+		// Sum of the child box areas relative to the root, the expected traversal cost
+		float ComputeCost() const;
+
+		/*	Ray distances to one axis' slabs of the four children. A ray parallel to the slabs, with an infinite inverse,
+			gets an unbounded interval and its children outside the slabs are added to missMask. Multiplying by the
+			infinite inverse would give NaN for an origin on a slab plane, which the min/max drop or keep by operand order */
+		static void Slab(const float* minimum, const float* maximum, const Float4& origin, const Float4& inverse, const bool parallel,
+			Float4& nearDistance, Float4& farDistance, uint32_t& missMask);
+
+		void AppendRange(const uint32_t first, const uint32_t count, std::vector<uint32_t>& results) const;
+
+		std::vector<Node> mNodes;
+		std::vector<uint32_t> mPrimitiveIndices;
+		std::vector<OMath::AABBf> mBounds;
+		float mBuildCost;
+		float mCost;
+
+		// Build scratch
+		std::vector<OMath::Vector3f> mBuildCentroids;
+		std::vector<BuildNode> mBuildNodes;
+		std::vector<BuildTask> mBuildTasks;
+	};
+
+	template <class HitTest>
+	inline bool BVH::Raycast(const OMath::Rayf& ray, const float maxDistance, HitTest&& hitTest, RayHit& hit) const {
+		if (mNodes.empty()) {
+			return false;
+		}
+
+		const OMath::Vector3f inverse = ray.GetInverseDirection();
+		const Float4 originX(ray.mOrigin.mX), originY(ray.mOrigin.mY), originZ(ray.mOrigin.mZ);
+		const Float4 inverseX(inverse.mX), inverseY(inverse.mY), inverseZ(inverse.mZ);
+		const bool parallelX = std::isinf(inverse.mX), parallelY = std::isinf(inverse.mY), parallelZ = std::isinf(inverse.mZ);
+		const Float4 zero(0.0f);
+
+		struct Entry {
+			uint32_t mNode;
+			float mDistance;
+		};
+		Entry stack[sStackSize];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = { 0, 0.0f };
+
+		float closest = maxDistance;
+		bool found = false;
+		while (stackSize > 0) {
+			const Entry entry = stack[--stackSize];
+			if (entry.mDistance > closest) {
+				continue;
+			}
+
+			// Slab test against the four children
+			const Node& node = mNodes[entry.mNode];
+			Float4 nearX, farX, nearY, farY, nearZ, farZ;
+			uint32_t parallelMiss = 0;
+			Slab(node.mMinX, node.mMaxX, originX, inverseX, parallelX, nearX, farX, parallelMiss);
+			Slab(node.mMinY, node.mMaxY, originY, inverseY, parallelY, nearY, farY, parallelMiss);
+			Slab(node.mMinZ, node.mMaxZ, originZ, inverseZ, parallelZ, nearZ, farZ, parallelMiss);
+
+			const Float4 entryDistance = Max(Max(Min(nearX, farX), Min(nearY, farY)), Max(Min(nearZ, farZ), zero));
+			const Float4 exitDistance = Min(Min(Max(nearX, farX), Max(nearY, farY)), Min(Max(nearZ, farZ), Float4(closest)));
+			uint32_t mask = (entryDistance <= exitDistance).MoveMask() & ~parallelMiss & ((1u << node.mChildCount) - 1u);
+			if (mask == 0) {
+				continue;
+			}
+
+			alignas(16) float distances[4];
+			entryDistance.Store(distances);
+
+			// Sort the hit slots far to near, the stack then pops the nearest child first
+			Entry hits[4];
+			uint32_t hitCount = 0;
+			while (mask != 0) {
+				const uint32_t slot = static_cast<uint32_t>(std::countr_zero(mask));
+				mask &= mask - 1;
+				Entry child = { slot, distances[slot] };
+				uint32_t position = hitCount++;
+				while (position > 0 && hits[position - 1].mDistance < child.mDistance) {
+					hits[position] = hits[position - 1];
+					--position;
+				}
+				hits[position] = child;
+			}
+
+			// Leaves near to far so closest shrinks as early as possible, then the inner nodes far to near
+			for (uint32_t hitIndex = hitCount; hitIndex-- > 0;) {
+				const uint32_t slot = hits[hitIndex].mNode;
+				if (node.mChildren[slot] != sLeaf || hits[hitIndex].mDistance > closest) {
+					continue;
+				}
+				for (uint32_t index = node.mFirst[slot]; index < node.mFirst[slot] + node.mCount[slot]; ++index) {
+					const uint32_t primitive = mPrimitiveIndices[index];
+					const float distance = hitTest(primitive, ray, closest);
+					if (distance >= 0.0f && distance <= closest) {
+						closest = distance;
+						hit = { primitive, distance };
+						found = true;
+					}
+				}
+			}
+			for (uint32_t hitIndex = 0; hitIndex < hitCount; ++hitIndex) {
+				const uint32_t slot = hits[hitIndex].mNode;
+				if (node.mChildren[slot] != sLeaf) {
+					assert(stackSize < sStackSize && "BVH traversal stack overflow");
+					stack[stackSize++] = { node.mChildren[slot], hits[hitIndex].mDistance };
+				}
+			}
+		}
+		return found;
+	}
+
+	inline void BVH::Slab(const float* minimum, const float* maximum, const Float4& origin, const Float4& inverse, const bool parallel,
+		Float4& nearDistance, Float4& farDistance, uint32_t& missMask) {
+		const Float4 minimumValues = Float4::Load(minimum);
+		const Float4 maximumValues = Float4::Load(maximum);
+		if (parallel) {
+			constexpr float infinity = std::numeric_limits<float>::infinity();
+			nearDistance = Float4(-infinity);
+			farDistance = Float4(infinity);
+			missMask |= ((minimumValues > origin) | (maximumValues < origin)).MoveMask();
+		} else {
+			nearDistance = (minimumValues - origin) * inverse;
+			farDistance = (maximumValues - origin) * inverse;
+		}
+	}
+}
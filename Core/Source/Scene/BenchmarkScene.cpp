@@ -0,0 +1,199 @@
+#include "stdafx.h"
+
+#include "BenchmarkScene.h"
+#include "Threading/JobSystem.h"
+#include "Memory/FrameAllocator.h"
+#include "Profiling/Profiler.h"
+#include <Math/FastMath.h>
+#include <chrono>
+#include <random>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	float ElapsedMilliseconds(const Clock::time_point start) {
+		return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+	}
+
+	// Left handed look at and perspective with D3D depth, for row vectors like the rest of OMath
+	OMath::Matrix4x4f CreateViewProjection(const OMath::Vector3f& eye, const OMath::Vector3f& target, const float fovY, const float aspect, const float nearZ, const float farZ) {
+		const OMath::Vector3f zAxis = (target - eye).GetNormalized();
+		const OMath::Vector3f xAxis = OMath::Vector3f(0.0f, 1.0f, 0.0f).Cross(zAxis).GetNormalized();
+		const OMath::Vector3f yAxis = zAxis.Cross(xAxis);
+
+		OMath::Matrix4x4f view;
+		view(1, 1) = xAxis.mX; view(1, 2) = yAxis.mX; view(1, 3) = zAxis.mX;
+		view(2, 1) = xAxis.mY; view(2, 2) = yAxis.mY; view(2, 3) = zAxis.mY;
+		view(3, 1) = xAxis.mZ; view(3, 2) = yAxis.mZ; view(3, 3) = zAxis.mZ;
+		view(4, 1) = -xAxis.Dot(eye);
+		view(4, 2) = -yAxis.Dot(eye);
+		view(4, 3) = -zAxis.Dot(eye);
+
+		const float yScale = 1.0f / std::tan(fovY * 0.5f);
+		const float range = farZ / (farZ - nearZ);
+		OMath::Matrix4x4f projection;
+		projection(1, 1) = yScale / aspect;
+		projection(2, 2) = yScale;
+		projection(3, 3) = range;
+		projection(3, 4) = 1.0f;
+		projection(4, 3) = -nearZ * range;
+		projection(4, 4) = 0.0f;
+
+		return view * projection;
+	}
+}
+
+Enj::BenchmarkScene::BenchmarkScene(const uint32_t objectCount, const uint32_t seed, JobSystem& jobSystem, FrameAllocator& frameAllocator) :
+	mJobSystem(jobSystem),
+	mFrameAllocator(frameAllocator),
+	mObjectCount(objectCount),
+	mTime(0.0f),
+	mCuller(&jobSystem),
+	mCounters{ 0, 0, 0, 0 },
+	mTimings{ 0.0f, 0.0f, 0.0f } {
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> position(-sWorldExtent, sWorldExtent);
+	std::uniform_real_distribution<float> velocity(-20.0f, 20.0f);
+	std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+	std::uniform_real_distribution<float> spin(-2.0f, 2.0f);
+	std::uniform_real_distribution<float> extent(0.5f, 4.0f);
+
+	mPositions.reserve(objectCount);
+	mVelocities.reserve(objectCount);
+	mRotations.reserve(objectCount);
+	mAngularVelocities.reserve(objectCount);
+	mExtents.reserve(objectCount);
+	for (uint32_t object = 0; object < objectCount; ++object) {
+		mPositions.emplace_back(position(random), position(random), position(random));
+		mVelocities.emplace_back(velocity(random), velocity(random), velocity(random));
+		mRotations.emplace_back(angle(random), angle(random), angle(random));
+		mAngularVelocities.emplace_back(spin(random), spin(random), spin(random));
+		mExtents.emplace_back(extent(random), extent(random), extent(random));
+	}
+
+	mRotationMatrices.resize(objectCount);
+	mWorldBounds.resize(objectCount);
+	mWorldSpheres.Reserve(objectCount);
+	for (uint32_t object = 0; object < objectCount; ++object) {
+		mWorldSpheres.Add(OMath::Spheref());
+	}
+
+	SimulateRange(0, objectCount, 0.0f);
+	mBVH.Build(mWorldBounds, &mJobSystem);
+	mCounters.mBVHNodes = static_cast<uint32_t>(mBVH.GetNodeCount());
+}
+
+//*********************************************************************************
+void Enj::BenchmarkScene::Update(const float deltaTime) {
+	ENJ_PROFILE_FUNCTION();
+
+	mTime += deltaTime;
+
+	Clock::time_point start = Clock::now();
+	Simulate(deltaTime);
+	mTimings.mSimulate = ElapsedMilliseconds(start);
+
+	start = Clock::now();
+	UpdateBVH();
+	mTimings.mBVH = ElapsedMilliseconds(start);
+
+	start = Clock::now();
+	Cull();
+	mTimings.mCull = ElapsedMilliseconds(start);
+}
+
+//*********************************************************************************
+const Enj::BenchmarkSceneCounters& Enj::BenchmarkScene::GetCounters() const {
+	return mCounters;
+}
+
+//*********************************************************************************
+const Enj::BenchmarkSceneTimings& Enj::BenchmarkScene::GetTimings() const {
+	return mTimings;
+}
+
+//*********************************************************************************
+uint32_t Enj::BenchmarkScene::GetLastVisibleCount() const {
+	return static_cast<uint32_t>(mVisible.size());
+}
+
+//*********************************************************************************
+std::span<const uint32_t> Enj::BenchmarkScene::GetLastVisible() const {
+	return mVisible;
+}
+
+//*********************************************************************************
+void Enj::BenchmarkScene::Simulate(const float deltaTime) {
+	ENJ_PROFILE_FUNCTION();
+
+	const uint32_t chunkCount = (mObjectCount + sChunkSize - 1) / sChunkSize;
+	const auto simulateChunk = [this, deltaTime](const uint32_t chunk) {
+		SimulateRange(chunk * sChunkSize, std::min((chunk + 1) * sChunkSize, mObjectCount), deltaTime);
+	};
+	mJobSystem.Dispatch(chunkCount, simulateChunk);
+}
+
+//*********************************************************************************
+void Enj::BenchmarkScene::SimulateRange(const uint32_t begin, const uint32_t end, const float deltaTime) {
+	const OMath::Vector3f step(deltaTime, deltaTime, deltaTime);
+	for (uint32_t object = begin; object < end; ++object) {
+		OMath::Vector3f& position = mPositions[object];
+		OMath::Vector3f& velocity = mVelocities[object];
+		position += velocity * step;
+
+		// Bounce off the walls of the world box
+		if (position.mX < -sWorldExtent || position.mX > sWorldExtent) { velocity.mX = -velocity.mX; }
+		if (position.mY < -sWorldExtent || position.mY > sWorldExtent) { velocity.mY = -velocity.mY; }
+		if (position.mZ < -sWorldExtent || position.mZ > sWorldExtent) { velocity.mZ = -velocity.mZ; }
+
+		mRotations[object] += mAngularVelocities[object] * step;
+	}
+
+	const size_t count = end - begin;
+	OMath::Fast::CreateRotationMatrices<OMath::Fast::Precision::Fast>(
+		std::span<const OMath::Vector3f>(mRotations).subspan(begin, count),
+		std::span<OMath::Matrix4x4f>(mRotationMatrices).subspan(begin, count));
+
+	// The world box of a rotated box, every world axis gathers |R| * extents
+	for (uint32_t object = begin; object < end; ++object) {
+		const OMath::Matrix4x4f& rotation = mRotationMatrices[object];
+		const OMath::Vector3f& extents = mExtents[object];
+		const OMath::Vector3f worldExtents(
+			std::abs(rotation(1, 1)) * extents.mX + std::abs(rotation(2, 1)) * extents.mY + std::abs(rotation(3, 1)) * extents.mZ,
+			std::abs(rotation(1, 2)) * extents.mX + std::abs(rotation(2, 2)) * extents.mY + std::abs(rotation(3, 2)) * extents.mZ,
+			std::abs(rotation(1, 3)) * extents.mX + std::abs(rotation(2, 3)) * extents.mY + std::abs(rotation(3, 3)) * extents.mZ);
+		mWorldBounds[object] = OMath::AABBf::CreateFromCenterExtents(mPositions[object], worldExtents);
+		mWorldSpheres.Set(object, OMath::Spheref(mPositions[object], extents.Length()));
+	}
+}
+
+//*********************************************************************************
+void Enj::BenchmarkScene::UpdateBVH() {
+	ENJ_PROFILE_FUNCTION();
+
+	mBVH.Refit(mWorldBounds);
+	if (mBVH.NeedsRebuild()) {
+		mBVH.Build(mWorldBounds, &mJobSystem);
+		++mCounters.mBVHRebuilds;
+	}
+	mCounters.mBVHNodes = static_cast<uint32_t>(mBVH.GetNodeCount());
+}
+
+//*********************************************************************************
+void Enj::BenchmarkScene::Cull() {
+	ENJ_PROFILE_FUNCTION();
+
+	// Orbits the world from outside, looking at the center
+	const float orbitAngle = mTime * 0.25f;
+	const float orbitRadius = sWorldExtent * 1.5f;
+	const OMath::Vector3f eye(std::cos(orbitAngle) * orbitRadius, sWorldExtent * 0.5f, std::sin(orbitAngle) * orbitRadius);
+	const OMath::Matrix4x4f viewProjection = CreateViewProjection(eye, OMath::Vector3f(), 1.0f, 16.0f / 9.0f, 1.0f, sWorldExtent * 4.0f);
+	const OMath::Frustumf frustum = OMath::Frustumf::CreateFromViewProjection(viewProjection);
+
+	mVisible = mCuller.Cull(frustum, mWorldSpheres, mFrameAllocator.AllocateArray<uint32_t>(mObjectCount));
+	mCounters.mCulledVisible += mVisible.size();
+
+	mBVHVisible.clear();
+	mBVH.QueryFrustum(frustum, mBVHVisible);
+	mCounters.mBVHVisible += mBVHVisible.size();
+}
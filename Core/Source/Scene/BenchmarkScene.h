@@ -0,0 +1,80 @@
+#pragma once
+#include <span>
+#include <stdint.h>
+#include <vector>
+#include <Math/AABB.h>
+#include <Math/BoundsWide.h>
+#include <Math/Matrix4x4.h>
+#include "Graphics/FrustumCuller.h"
+#include "Scene/BVH.h"
+
+namespace Enj {
+	class JobSystem;
+	class FrameAllocator;
+
+	struct BenchmarkSceneCounters {
+		uint64_t mCulledVisible;	// Sum over frames of the objects the frustum culler kept
+		uint64_t mBVHVisible;		// Sum over frames of the objects the BVH frustum query returned
+		uint32_t mBVHRebuilds;
+		uint32_t mBVHNodes;
+	};
+
+	// Time spent in each part of the last Update, in milliseconds
+	struct BenchmarkSceneTimings {
+		float mSimulate;
+		float mBVH;
+		float mCull;
+	};
+
+	/*	Deterministic CPU workload for the headless benchmark, no window or GPU involved. Objects tumble and bounce in
+		a box from a fixed seed, every update transforms their bounds, refits or rebuilds the BVH and culls them
+		against an orbiting camera with both the culler and the BVH. Equal seeds and step times give equal counters.
+		The visible list is frame memory, the caller begins a frame on frameAllocator before every Update */
+	class BenchmarkScene {
+	public:
+		BenchmarkScene(const uint32_t objectCount, const uint32_t seed, JobSystem& jobSystem, FrameAllocator& frameAllocator);
+		BenchmarkScene(const BenchmarkScene& scene) = delete;
+		void operator=(const BenchmarkScene& scene) = delete;
+
+		void Update(const float deltaTime);
+
+		const BenchmarkSceneCounters& GetCounters() const;
+		const BenchmarkSceneTimings& GetTimings() const;
+		uint32_t GetLastVisibleCount() const;
+		// What the culler kept in the last Update, in no particular order. Frame memory of that Update's frame
+		std::span<const uint32_t> GetLastVisible() const;
+
+	private:
+		// Objects per simulate task
+		static constexpr uint32_t sChunkSize = 2048;
+		static constexpr float sWorldExtent = 500.0f;
+
+		void Simulate(const float deltaTime);
+		void SimulateRange(const uint32_t begin, const uint32_t end, const float deltaTime);
+		void UpdateBVH();
+		void Cull();
+
+		JobSystem& mJobSystem;
+		FrameAllocator& mFrameAllocator;
+		uint32_t mObjectCount;
+		float mTime;
+
+		std::vector<OMath::Vector3f> mPositions;
+		std::vector<OMath::Vector3f> mVelocities;
+		std::vector<OMath::Vector3f> mRotations;
+		std::vector<OMath::Vector3f> mAngularVelocities;
+		std::vector<OMath::Vector3f> mExtents;
+		std::vector<OMath::Matrix4x4f> mRotationMatrices;
+
+		std::vector<OMath::AABBf> mWorldBounds;
+		OMath::SphereBatch mWorldSpheres;
+
+		BVH mBVH;
+		FrustumCuller mCuller;
+		std::span<uint32_t> mVisible;
+		std::vector<uint32_t> mBVHVisible;
+
+		BenchmarkSceneCounters mCounters;
+		BenchmarkSceneTimings mTimings;
+	};
+}
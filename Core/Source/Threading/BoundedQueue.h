@@ -0,0 +1,122 @@
+#pragma once
+#include <assert.h>
+#include <atomic>
+#include <span>
+#include <stdint.h>
+#include <vector>
+
+namespace Enj {
+	/*	Fixed capacity ring for one producer and one consumer thread. Push and Pop never lock, they only block on the
+		other side's index with std::atomic wait when the ring is full or empty. Close, from the producer, makes Pop return
+		false once everything pushed before it is consumed */
+	template <class T>
+	class BoundedQueue {
+	public:
+		explicit BoundedQueue(const uint32_t capacity) :
+			mSlots(capacity),
+			mHead(0),
+			mTail(0) {
+			assert(capacity > 0 && "Queue needs room for at least one element");
+		}
+		BoundedQueue(const BoundedQueue& queue) = delete;
+		void operator=(const BoundedQueue& queue) = delete;
+
+		uint32_t Capacity() const {
+			return static_cast<uint32_t>(mSlots.size());
+		}
+
+		// Elements pushed and popped so far, the producer can tell whether the consumer took what it pushed
+		uint64_t GetPushCount() const {
+			return mTail.load(std::memory_order_acquire) & ~sClosedBit;
+		}
+
+		uint64_t GetPopCount() const {
+			return mHead.load(std::memory_order_acquire);
+		}
+
+		// Waits while the queue is full
+		void Push(const T& value) {
+			const uint64_t tail = mTail.load(std::memory_order_relaxed) & ~sClosedBit;
+			uint64_t head = mHead.load(std::memory_order_acquire);
+			while (tail - head >= mSlots.size()) {
+				mHead.wait(head, std::memory_order_acquire);
+				head = mHead.load(std::memory_order_acquire);
+			}
+			Publish(tail, value);
+		}
+
+		bool TryPush(const T& value) {
+			const uint64_t tail = mTail.load(std::memory_order_relaxed) & ~sClosedBit;
+			if (tail - mHead.load(std::memory_order_acquire) >= mSlots.size()) {
+				return false;
+			}
+			Publish(tail, value);
+			return true;
+		}
+
+		// Waits while the queue is empty, false once it is closed and empty
+		bool Pop(T& value) {
+			const uint64_t head = mHead.load(std::memory_order_relaxed);
+			uint64_t tail = mTail.load(std::memory_order_acquire);
+			while ((tail & ~sClosedBit) == head) {
+				if ((tail & sClosedBit) != 0) {
+					return false;
+				}
+				mTail.wait(tail, std::memory_order_acquire);
+				tail = mTail.load(std::memory_order_acquire);
+			}
+			Consume(head, value);
+			return true;
+		}
+
+		bool TryPop(T& value) {
+			const uint64_t head = mHead.load(std::memory_order_relaxed);
+			if ((mTail.load(std::memory_order_acquire) & ~sClosedBit) == head) {
+				return false;
+			}
+			Consume(head, value);
+			return true;
+		}
+
+		// Takes up to values.size() elements at once, returns how many
+		uint32_t TryPopBatch(std::span<T> values) {
+			const uint64_t head = mHead.load(std::memory_order_relaxed);
+			const uint64_t available = (mTail.load(std::memory_order_acquire) & ~sClosedBit) - head;
+			const uint32_t count = static_cast<uint32_t>(available < values.size() ? available : values.size());
+			if (count == 0) {
+				return 0;
+			}
+			for (uint32_t index = 0; index < count; ++index) {
+				values[index] = mSlots[(head + index) % mSlots.size()];
+			}
+			mHead.store(head + count, std::memory_order_release);
+			mHead.notify_one();
+			return count;
+		}
+
+		void Close() {
+			mTail.fetch_or(sClosedBit, std::memory_order_release);
+			mTail.notify_all();
+		}
+
+	private:
+		// Top bit of mTail, so a consumer waiting on mTail wakes up for it
+		static constexpr uint64_t sClosedBit = uint64_t(1) << 63;
+
+		void Publish(const uint64_t tail, const T& value) {
+			mSlots[tail % mSlots.size()] = value;
+			mTail.store(tail + 1, std::memory_order_release);
+			mTail.notify_one();
+		}
+
+		void Consume(const uint64_t head, T& value) {
+			value = mSlots[head % mSlots.size()];
+			mHead.store(head + 1, std::memory_order_release);
+			mHead.notify_one();
+		}
+
+		std::vector<T> mSlots;
+		alignas(64) std::atomic<uint64_t> mHead;
+		alignas(64) std::atomic<uint64_t> mTail;
+	};
+}
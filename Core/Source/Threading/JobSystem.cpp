@@ -0,0 +1,510 @@
+#include "stdafx.h"
+
+#include "JobSystem.h"
+#include "Profiling/Profiler.h"
+#include <chrono>
+#include <utility>
+
+namespace Enj {
+	struct Job {
+		JobSystem::Function mFunction;
+		JobCounter* mCounter;
+		Job* mNext;					// Next continuation of the same counter, next queued or next free pooled job
+		std::atomic<bool> mInUse;	// Ring slots stay taken until the job has run
+		bool mPooled;				// Ring was full or the thread is not a worker
+	};
+}
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	// Rounds of looking for work before a worker goes to sleep
+	constexpr uint32_t sSpinRounds = 64;
+
+	thread_local const Enj::JobSystem* sCurrentSystem = nullptr;
+	thread_local unsigned int sCurrentWorker = 0;
+}
+
+/*	Chase-Lev deque with a fixed buffer, after "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013).
+	The owner pushes and pops at the bottom, thieves take from the top, only the last job needs a CAS between them */
+class Enj::JobSystem::JobDeque {
+public:
+	JobDeque() :
+		mTop(0),
+		mBottom(0),
+		mBuffer(sQueueCapacity) {}
+
+	bool Push(Job* job) {
+		const int64_t bottom = mBottom.load(std::memory_order_relaxed);
+		const int64_t top = mTop.load(std::memory_order_acquire);
+		if (bottom - top >= static_cast<int64_t>(sQueueCapacity)) {
+			return false;
+		}
+		mBuffer[bottom & sMask].store(job, std::memory_order_relaxed);
+		mBottom.store(bottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	Job* Pop() {
+		const int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+		mBottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = mTop.load(std::memory_order_relaxed);
+
+		if (top > bottom) {
+			mBottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Job* job = mBuffer[bottom & sMask].load(std::memory_order_relaxed);
+		if (top == bottom) {
+			// Last job, race the thieves for it
+			if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				job = nullptr;
+			}
+			mBottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	Job* Steal() {
+		int64_t top = mTop.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t bottom = mBottom.load(std::memory_order_acquire);
+		if (top >= bottom) {
+			return nullptr;
+		}
+
+		Job* job = mBuffer[top & sMask].load(std::memory_order_relaxed);
+		if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+		return job;
+	}
+
+private:
+	static constexpr int64_t sMask = sQueueCapacity - 1;
+	static_assert((sQueueCapacity & (sQueueCapacity - 1)) == 0, "Queue capacity has to be a power of two");
+
+	alignas(64) std::atomic<int64_t> mTop;
+	alignas(64) std::atomic<int64_t> mBottom;
+	std::vector<std::atomic<Job*>> mBuffer;
+};
+
+struct alignas(64) Enj::JobSystem::Worker {
+	JobDeque mDeque;
+
+	// Only the worker's own thread allocates from its ring
+	std::unique_ptr<Job[]> mJobs;
+	uint32_t mNextJob;
+	uint32_t mRandom;
+
+	// Written by the worker, read by anyone asking for stats
+	std::atomic<uint64_t> mJobsExecuted;
+	std::atomic<uint64_t> mSteals;
+	std::atomic<uint64_t> mIdleNanoseconds;
+};
+
+//*********************************************************************************
+Enj::JobCounter::JobCounter() :
+	mValue(0),
+	mContinuations(nullptr) {}
+
+//*********************************************************************************
+bool Enj::JobCounter::IsDone() const {
+	return mValue.load(std::memory_order_acquire) == 0;
+}
+
+//*********************************************************************************
+uint32_t Enj::JobCounter::GetValue() const {
+	return mValue.load(std::memory_order_acquire);
+}
+
+//*********************************************************************************
+Enj::JobSystem::JobSystem(const unsigned int workerCount, const WorkerStartFunction& onWorkerStart) :
+	mExternalHead(nullptr),
+	mExternalTail(nullptr),
+	mExternalJobCount(0),
+	mFreeJobs(nullptr),
+	mQueuedJobs(0),
+	mSleepers(0),
+	mStop(false) {
+	mWorkers.reserve(workerCount + 1);
+	for (unsigned int worker = 0; worker <= workerCount; ++worker) {
+		std::unique_ptr<Worker> state = std::make_unique<Worker>();
+		state->mJobs = std::make_unique<Job[]>(sQueueCapacity);
+		state->mNextJob = 0;
+		state->mRandom = 0x9E3779B9u * (worker + 1);
+		state->mJobsExecuted.store(0, std::memory_order_relaxed);
+		state->mSteals.store(0, std::memory_order_relaxed);
+		state->mIdleNanoseconds.store(0, std::memory_order_relaxed);
+		mWorkers.push_back(std::move(state));
+	}
+
+	sCurrentSystem = this;
+	sCurrentWorker = 0;
+
+	mThreads.reserve(workerCount);
+	for (unsigned int worker = 1; worker <= workerCount; ++worker) {
+		mThreads.emplace_back(&JobSystem::WorkerMain, this, worker, onWorkerStart);
+	}
+}
+
+//*********************************************************************************
+Enj::JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mStop.store(true, std::memory_order_seq_cst);
+	}
+	mWake.notify_all();
+
+	for (std::thread& thread : mThreads) {
+		thread.join();
+	}
+
+	if (sCurrentSystem == this) {
+		sCurrentSystem = nullptr;
+	}
+}
+
+//*********************************************************************************
+unsigned int Enj::JobSystem::DefaultWorkerCount() {
+	const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+//*********************************************************************************
+unsigned int Enj::JobSystem::WorkerCount() const {
+	return static_cast<unsigned int>(mThreads.size());
+}
+
+//*********************************************************************************
+void Enj::JobSystem::Run(Function function, JobCounter* counter) {
+	Submit(Allocate(std::move(function), counter));
+}
+
+//*********************************************************************************
+void Enj::JobSystem::Run(Function function, JobCounter* counter, JobCounter& dependency) {
+	Job* job = Allocate(std::move(function), counter);
+	{
+		// Finish takes the continuations under the same lock after the count reached zero, so none get lost
+		std::lock_guard<std::mutex> lock(dependency.mMutex);
+		if (dependency.mValue.load(std::memory_order_acquire) != 0) {
+			job->mNext = dependency.mContinuations;
+			dependency.mContinuations = job;
+			return;
+		}
+	}
+	Submit(job);
+}
+
+//*********************************************************************************
+void Enj::JobSystem::Wait(const JobCounter& counter) {
+	Worker* worker = CurrentWorker();
+
+	Clock::time_point idleStart;
+	bool idle = false;
+	while (!counter.IsDone()) {
+		Job* job = FindJob(worker);
+		if (job != nullptr) {
+			if (idle && worker != nullptr) {
+				worker->mIdleNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - idleStart).count(), std::memory_order_relaxed);
+			}
+			idle = false;
+			Execute(job, worker);
+		} else {
+			if (!idle) {
+				idleStart = Clock::now();
+				idle = true;
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	if (idle && worker != nullptr) {
+		worker->mIdleNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - idleStart).count(), std::memory_order_relaxed);
+	}
+
+	// The job that brought the counter to zero may still hold its lock, wait for it before the caller can destroy the counter
+	std::lock_guard<std::mutex> lock(counter.mMutex);
+}
+
+//*********************************************************************************
+bool Enj::JobSystem::TryRunJob() {
+	Worker* worker = CurrentWorker();
+	Job* job = FindJob(worker);
+	if (job == nullptr) {
+		return false;
+	}
+	Execute(job, worker);
+	return true;
+}
+
+//*********************************************************************************
+void Enj::JobSystem::Dispatch(const uint32_t taskCount, const std::function<void(uint32_t)>& task) {
+	if (taskCount == 0) {
+		return;
+	}
+	if (mThreads.empty() || taskCount == 1) {
+		for (uint32_t taskIndex = 0; taskIndex < taskCount; ++taskIndex) {
+			task(taskIndex);
+		}
+		return;
+	}
+
+	// A job per helping worker that pulls indices until none are left, instead of a job per index
+	struct DispatchState {
+		const std::function<void(uint32_t)>& mTask;
+		const uint32_t mTaskCount;
+		std::atomic<uint32_t> mNextTask;
+	} state{ task, taskCount, 0 };
+
+	const auto runTasks = [&state]() {
+		uint32_t taskIndex = state.mNextTask.fetch_add(1, std::memory_order_relaxed);
+		while (taskIndex < state.mTaskCount) {
+			state.mTask(taskIndex);
+			taskIndex = state.mNextTask.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+
+	JobCounter counter;
+	const uint32_t helpers = std::min(taskCount - 1, WorkerCount());
+	for (uint32_t helper = 0; helper < helpers; ++helper) {
+		Run(runTasks, &counter);
+	}
+	runTasks();
+	Wait(counter);
+}
+
+//*********************************************************************************
+std::vector<Enj::JobWorkerStats> Enj::JobSystem::GetStats() const {
+	std::vector<JobWorkerStats> stats;
+	stats.reserve(mWorkers.size());
+	for (const std::unique_ptr<Worker>& worker : mWorkers) {
+		stats.push_back({
+			worker->mJobsExecuted.load(std::memory_order_relaxed),
+			worker->mSteals.load(std::memory_order_relaxed),
+			worker->mIdleNanoseconds.load(std::memory_order_relaxed) / 1.0e6 });
+	}
+	return stats;
+}
+
+//*********************************************************************************
+void Enj::JobSystem::ResetStats() {
+	for (const std::unique_ptr<Worker>& worker : mWorkers) {
+		worker->mJobsExecuted.store(0, std::memory_order_relaxed);
+		worker->mSteals.store(0, std::memory_order_relaxed);
+		worker->mIdleNanoseconds.store(0, std::memory_order_relaxed);
+	}
+}
+
+//*********************************************************************************
+void Enj::JobSystem::WorkerMain(const unsigned int workerIndex, WorkerStartFunction onWorkerStart) {
+	ENJ_PROFILE_THREAD("Job Worker");
+	if (onWorkerStart) {
+		onWorkerStart(workerIndex);
+	}
+
+	sCurrentSystem = this;
+	sCurrentWorker = workerIndex;
+	Worker* worker = mWorkers[workerIndex].get();
+
+	while (!mStop.load(std::memory_order_relaxed)) {
+		Job* job = FindJob(worker);
+		if (job != nullptr) {
+			Execute(job, worker);
+			continue;
+		}
+
+		const Clock::time_point idleStart = Clock::now();
+		for (uint32_t round = 0; round < sSpinRounds && job == nullptr; ++round) {
+			std::this_thread::yield();
+			job = FindJob(worker);
+		}
+
+		if (job == nullptr) {
+			std::unique_lock<std::mutex> lock(mSleepMutex);
+			mSleepers.fetch_add(1, std::memory_order_seq_cst);
+			mWake.wait(lock, [this]() { return mStop.load(std::memory_order_seq_cst) || mQueuedJobs.load(std::memory_order_seq_cst) > 0; });
+			mSleepers.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		worker->mIdleNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - idleStart).count(), std::memory_order_relaxed);
+		if (job != nullptr) {
+			Execute(job, worker);
+		}
+	}
+}
+
+//*********************************************************************************
+Enj::Job* Enj::JobSystem::Allocate(Function&& function, JobCounter* counter) {
+	if (counter != nullptr) {
+		counter->mValue.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	Worker* worker = CurrentWorker();
+	Job* job = nullptr;
+	if (worker != nullptr) {
+		Job& slot = worker->mJobs[worker->mNextJob & (sQueueCapacity - 1)];
+		if (!slot.mInUse.load(std::memory_order_acquire)) {
+			++worker->mNextJob;
+			job = &slot;
+			job->mPooled = false;
+		}
+	}
+	if (job == nullptr) {
+		job = AllocatePooled();
+		job->mPooled = true;
+	}
+
+	job->mFunction = std::move(function);
+	job->mCounter = counter;
+	job->mNext = nullptr;
+	job->mInUse.store(true, std::memory_order_relaxed);
+	return job;
+}
+
+//*********************************************************************************
+Enj::Job* Enj::JobSystem::AllocatePooled() {
+	std::lock_guard<std::mutex> lock(mExternalMutex);
+	if (mFreeJobs == nullptr) {
+		std::unique_ptr<Job[]> block = std::make_unique<Job[]>(sPoolBlockSize);
+		for (uint32_t index = 0; index < sPoolBlockSize; ++index) {
+			block[index].mNext = mFreeJobs;
+			mFreeJobs = &block[index];
+		}
+		mPoolBlocks.push_back(std::move(block));
+	}
+	return std::exchange(mFreeJobs, mFreeJobs->mNext);
+}
+
+//*********************************************************************************
+void Enj::JobSystem::ReleasePooled(Job* job) {
+	std::lock_guard<std::mutex> lock(mExternalMutex);
+	job->mNext = mFreeJobs;
+	mFreeJobs = job;
+}
+
+//*********************************************************************************
+void Enj::JobSystem::Submit(Job* job) {
+	mQueuedJobs.fetch_add(1, std::memory_order_seq_cst);
+
+	Worker* worker = CurrentWorker();
+	if (worker != nullptr) {
+		if (!worker->mDeque.Push(job)) {
+			mQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			Execute(job, worker);
+			return;
+		}
+	} else {
+		std::lock_guard<std::mutex> lock(mExternalMutex);
+		job->mNext = nullptr;
+		if (mExternalTail != nullptr) {
+			mExternalTail->mNext = job;
+		} else {
+			mExternalHead = job;
+		}
+		mExternalTail = job;
+		mExternalJobCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Taking the lock orders this with a worker that checked mQueuedJobs and is about to wait
+	if (mSleepers.load(std::memory_order_seq_cst) > 0) {
+		{
+			std::lock_guard<std::mutex> lock(mSleepMutex);
+		}
+		mWake.notify_one();
+	}
+}
+
+//*********************************************************************************
+Enj::Job* Enj::JobSystem::FindJob(Worker* worker) {
+	Job* job = worker != nullptr ? worker->mDeque.Pop() : nullptr;
+
+	if (job == nullptr && mExternalJobCount.load(std::memory_order_relaxed) > 0) {
+		std::lock_guard<std::mutex> lock(mExternalMutex);
+		if (mExternalHead != nullptr) {
+			job = std::exchange(mExternalHead, mExternalHead->mNext);
+			if (mExternalHead == nullptr) {
+				mExternalTail = nullptr;
+			}
+			mExternalJobCount.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	if (job == nullptr) {
+		// Start at a random victim so thieves spread out
+		const uint32_t workerCount = static_cast<uint32_t>(mWorkers.size());
+		uint32_t start = 0;
+		if (worker != nullptr) {
+			worker->mRandom ^= worker->mRandom << 13;
+			worker->mRandom ^= worker->mRandom >> 17;
+			worker->mRandom ^= worker->mRandom << 5;
+			start = worker->mRandom % workerCount;
+		}
+		for (uint32_t offset = 0; offset < workerCount && job == nullptr; ++offset) {
+			Worker* victim = mWorkers[(start + offset) % workerCount].get();
+			if (victim != worker) {
+				job = victim->mDeque.Steal();
+			}
+		}
+		if (job != nullptr && worker != nullptr) {
+			worker->mSteals.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	if (job != nullptr) {
+		mQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+//*********************************************************************************
+void Enj::JobSystem::Execute(Job* job, Worker* worker) {
+	job->mFunction();
+
+	// Drop the captures before anyone waiting on the counter can see it reach zero
+	JobCounter* counter = job->mCounter;
+	job->mFunction = nullptr;
+	if (job->mPooled) {
+		ReleasePooled(job);
+	} else {
+		job->mInUse.store(false, std::memory_order_release);
+	}
+
+	if (worker != nullptr) {
+		worker->mJobsExecuted.fetch_add(1, std::memory_order_relaxed);
+	}
+	if (counter != nullptr) {
+		Finish(counter);
+	}
+}
+
+//*********************************************************************************
+void Enj::JobSystem::Finish(JobCounter* counter) {
+	uint32_t value = counter->mValue.load(std::memory_order_relaxed);
+	while (value > 1) {
+		if (counter->mValue.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+			return;
+		}
+	}
+
+	// Probably the last job, Run with a dependency and Wait take the same lock so the counter stays alive until it is released
+	Job* continuation = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(counter->mMutex);
+		if (counter->mValue.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			continuation = std::exchange(counter->mContinuations, nullptr);
+		}
+	}
+	while (continuation != nullptr) {
+		Job* next = continuation->mNext;
+		Submit(continuation);
+		continuation = next;
+	}
+}
+
+//*********************************************************************************
+Enj::JobSystem::Worker* Enj::JobSystem::CurrentWorker() const {
+	return sCurrentSystem == this ? mWorkers[sCurrentWorker].get() : nullptr;
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Enj {
+	class JobSystem;
+	struct Job;
+
+	/*	Number of unfinished jobs that were run with it. Wait for it with JobSystem::Wait, or queue jobs behind it
+		that start once it reaches zero. It has to outlive those jobs and can go once Wait on it returned */
+	class JobCounter {
+	public:
+		JobCounter();
+		JobCounter(const JobCounter& counter) = delete;
+		void operator=(const JobCounter& counter) = delete;
+
+		bool IsDone() const;
+		uint32_t GetValue() const;
+
+	private:
+		friend class JobSystem;
+
+		std::atomic<uint32_t> mValue;
+		mutable std::mutex mMutex;
+		Job* mContinuations;	// Linked through the jobs, waiting for zero does not allocate
+	};
+
+	struct JobWorkerStats {
+		uint64_t mJobsExecuted;
+		uint64_t mSteals;
+		double mIdleMilliseconds;	// Time spent looking for work or asleep
+	};
+
+	/*	One worker per core that pull jobs from their own Chase-Lev deque and steal from the others' when it runs dry.
+		The thread that creates the system takes part as worker 0, it runs jobs while it waits in Wait or Dispatch.
+		Jobs come from a ring per thread. Threads outside the system, and workers whose ring is full, take theirs from a
+		shared pool that only grows, so submitting stops allocating once it covers the most jobs ever in flight at once.
+		Threads outside the system queue theirs on a shared locked list */
+	class JobSystem {
+	public:
+		using Function = std::function<void()>;
+
+		// Called on every background worker before it takes its first job, to pin it or set its priority
+		using WorkerStartFunction = std::function<void(unsigned int workerIndex)>;
+
+		// Jobs a thread can have queued at once, pushing more runs them on the spot
+		static constexpr uint32_t sQueueCapacity = 4096;
+
+		explicit JobSystem(const unsigned int workerCount = DefaultWorkerCount(), const WorkerStartFunction& onWorkerStart = nullptr);
+		JobSystem(const JobSystem& jobSystem) = delete;
+		void operator=(const JobSystem& jobSystem) = delete;
+		~JobSystem();
+
+		// One worker per hardware thread, minus the thread that owns the system
+		static unsigned int DefaultWorkerCount();
+
+		// Background workers, without the owning thread
+		unsigned int WorkerCount() const;
+
+		// counter is incremented now and decremented once function returns
+		void Run(Function function, JobCounter* counter = nullptr);
+
+		// function starts once dependency reaches zero
+		void Run(Function function, JobCounter* counter, JobCounter& dependency);
+
+		// Runs jobs until counter reaches zero instead of blocking
+		void Wait(const JobCounter& counter);
+
+		// Runs one queued job on the calling thread, false when there was none
+		bool TryRunJob();
+
+		// Calls task(taskIndex) for every taskIndex in [0, taskCount) across the workers and returns when all have finished
+		void Dispatch(const uint32_t taskCount, const std::function<void(uint32_t)>& task);
+
+		// Index 0 is the owning thread
+		std::vector<JobWorkerStats> GetStats() const;
+		void ResetStats();
+
+	private:
+		// Jobs per block the pool grows by
+		static constexpr uint32_t sPoolBlockSize = 256;
+
+		class JobDeque;
+		struct Worker;
+
+		void WorkerMain(const unsigned int workerIndex, WorkerStartFunction onWorkerStart);
+
+		Job* Allocate(Function&& function, JobCounter* counter);
+		Job* AllocatePooled();
+		void ReleasePooled(Job* job);
+		void Submit(Job* job);
+		Job* FindJob(Worker* worker);
+		void Execute(Job* job, Worker* worker);
+		void Finish(JobCounter* counter);
+
+		// nullptr on threads that are not part of this system
+		Worker* CurrentWorker() const;
+
+		std::vector<std::unique_ptr<Worker>> mWorkers;
+		std::vector<std::thread> mThreads;
+
+		// Guards the queue of threads outside the system and the pool, both linked through the jobs
+		std::mutex mExternalMutex;
+		Job* mExternalHead;
+		Job* mExternalTail;
+		std::atomic<uint32_t> mExternalJobCount;
+		std::vector<std::unique_ptr<Job[]>> mPoolBlocks;
+		Job* mFreeJobs;
+
+		// Queued and not yet taken jobs, sleeping workers wake up when it goes above zero
+		std::atomic<int64_t> mQueuedJobs;
+		std::atomic<uint32_t> mSleepers;
+		std::mutex mSleepMutex;
+		std::condition_variable mWake;
+		std::atomic<bool> mStop;
+	};
+}
@@ -0,0 +1,114 @@
+#include "stdafx.h"
+
+#include "ParallelAlgorithms.h"
+
+namespace {
+	constexpr uint32_t sRadixBits = 8;
+	constexpr uint32_t sRadixSize = 1u << sRadixBits;
+
+	template <class Key>
+	void RadixSortKeys(Enj::JobSystem& jobSystem, std::span<Key> keys, std::span<uint32_t> values) {
+		assert((values.empty() || values.size() == keys.size()) && "Radix sort needs a value for every key");
+
+		const size_t count = keys.size();
+		if (count < 2) {
+			return;
+		}
+
+		const bool hasValues = !values.empty();
+		const uint32_t chunkCount = Enj::Parallel::ChunkCount(jobSystem, count);
+		const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+		std::vector<Key> keyBuffer(count);
+		std::vector<uint32_t> valueBuffer(hasValues ? count : 0);
+		std::span<Key> sourceKeys = keys;
+		std::span<Key> destinationKeys = keyBuffer;
+		std::span<uint32_t> sourceValues = values;
+		std::span<uint32_t> destinationValues = valueBuffer;
+
+		// histograms[chunk * sRadixSize + digit], turned into each chunk's first output position per digit
+		std::vector<size_t> histograms(size_t(chunkCount) * sRadixSize);
+		const auto forEachChunk = [&jobSystem, chunkCount](const auto& function) {
+			if (chunkCount == 1) {
+				function(0u);
+			} else {
+				jobSystem.Dispatch(chunkCount, function);
+			}
+		};
+
+		for (uint32_t shift = 0; shift < sizeof(Key) * 8; shift += sRadixBits) {
+			forEachChunk([&, shift](const uint32_t chunk) {
+				size_t* histogram = histograms.data() + size_t(chunk) * sRadixSize;
+				std::fill(histogram, histogram + sRadixSize, size_t(0));
+				const size_t end = std::min((chunk + 1) * chunkSize, count);
+				for (size_t index = chunk * chunkSize; index < end; ++index) {
+					++histogram[(sourceKeys[index] >> shift) & (sRadixSize - 1)];
+				}
+			});
+
+			// Digit major, chunk minor, so every chunk scatters after the chunks before it and the sort stays stable
+			size_t offset = 0;
+			bool singleDigit = false;
+			for (uint32_t digit = 0; digit < sRadixSize && !singleDigit; ++digit) {
+				size_t digitCount = 0;
+				for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+					size_t& entry = histograms[size_t(chunk) * sRadixSize + digit];
+					const size_t chunkDigitCount = entry;
+					entry = offset;
+					offset += chunkDigitCount;
+					digitCount += chunkDigitCount;
+				}
+				singleDigit = digitCount == count;
+			}
+			if (singleDigit) {
+				continue;
+			}
+
+			forEachChunk([&, shift](const uint32_t chunk) {
+				size_t* positions = histograms.data() + size_t(chunk) * sRadixSize;
+				const size_t end = std::min((chunk + 1) * chunkSize, count);
+				for (size_t index = chunk * chunkSize; index < end; ++index) {
+					const size_t position = positions[(sourceKeys[index] >> shift) & (sRadixSize - 1)]++;
+					destinationKeys[position] = sourceKeys[index];
+					if (hasValues) {
+						destinationValues[position] = sourceValues[index];
+					}
+				}
+			});
+
+			std::swap(sourceKeys, destinationKeys);
+			std::swap(sourceValues, destinationValues);
+		}
+
+		if (sourceKeys.data() != keys.data()) {
+			Enj::Parallel::ForRange(jobSystem, count, [&](const size_t begin, const size_t end) {
+				std::copy(sourceKeys.begin() + begin, sourceKeys.begin() + end, keys.begin() + begin);
+				if (hasValues) {
+					std::copy(sourceValues.begin() + begin, sourceValues.begin() + end, values.begin() + begin);
+				}
+			});
+		}
+	}
+}
+
+//*********************************************************************************
+uint32_t Enj::Parallel::ChunkCount(const JobSystem& jobSystem, const size_t count, const size_t minChunkSize) {
+	const unsigned int workerCount = jobSystem.WorkerCount();
+	if (workerCount == 0 || count < sSerialThreshold) {
+		return 1;
+	}
+
+	const size_t chunksBySize = count / std::max(minChunkSize, size_t(1));
+	const size_t chunksByWorkers = size_t(workerCount + 1) * sChunksPerWorker;
+	return static_cast<uint32_t>(std::max(std::min(chunksBySize, chunksByWorkers), size_t(1)));
+}
+
+//*********************************************************************************
+void Enj::Parallel::RadixSort(JobSystem& jobSystem, std::span<uint32_t> keys, std::span<uint32_t> values) {
+	RadixSortKeys(jobSystem, keys, values);
+}
+
+//*********************************************************************************
+void Enj::Parallel::RadixSort(JobSystem& jobSystem, std::span<uint64_t> keys, std::span<uint32_t> values) {
+	RadixSortKeys(jobSystem, keys, values);
+}
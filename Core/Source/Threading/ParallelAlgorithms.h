@@ -0,0 +1,250 @@
+#pragma once
+#include <algorithm>
+#include <assert.h>
+#include <span>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "JobSystem.h"
+
+/*	Data parallel building blocks on top of the job system, std::execution is not there on every toolchain we build with.
+	Work is cut in chunks, a few per worker so uneven chunks even out, and everything below sSerialThreshold elements
+	or without workers runs on the calling thread. Chunking depends on the worker count, so floating point reductions
+	and scans can round differently between machines */
+namespace Enj::Parallel {
+	// Elements below which an algorithm does not wake the workers
+	constexpr size_t sSerialThreshold = 4096;
+
+	// Chunks per worker, more balances uneven work better but costs more jobs
+	constexpr uint32_t sChunksPerWorker = 4;
+
+	// Number of chunks of at least minChunkSize elements to split count elements in, 1 to run serially
+	uint32_t ChunkCount(const JobSystem& jobSystem, const size_t count, const size_t minChunkSize = sSerialThreshold / 4);
+
+	// Calls function(begin, end) over chunks covering [0, count)
+	template <class Function>
+	void ForRange(JobSystem& jobSystem, const size_t count, Function&& function, const size_t minChunkSize = sSerialThreshold / 4) {
+		const uint32_t chunkCount = ChunkCount(jobSystem, count, minChunkSize);
+		if (chunkCount <= 1) {
+			if (count > 0) {
+				function(size_t(0), count);
+			}
+			return;
+		}
+
+		const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+		jobSystem.Dispatch(chunkCount, [&function, count, chunkSize](const uint32_t chunk) {
+			const size_t begin = chunk * chunkSize;
+			function(begin, std::min(begin + chunkSize, count));
+		});
+	}
+
+	// Calls function(index) for every index in [0, count)
+	template <class Function>
+	void For(JobSystem& jobSystem, const size_t count, Function&& function, const size_t minChunkSize = sSerialThreshold / 4) {
+		ForRange(jobSystem, count, [&function](const size_t begin, const size_t end) {
+			for (size_t index = begin; index < end; ++index) {
+				function(index);
+			}
+		}, minChunkSize);
+	}
+
+	// combine(identity, transform(index)) over [0, count). combine has to be associative, identity its neutral element
+	template <class T, class Transform, class Combine>
+	T TransformReduce(JobSystem& jobSystem, const size_t count, const T& identity, Transform&& transform, Combine&& combine) {
+		const uint32_t chunkCount = ChunkCount(jobSystem, count);
+		const size_t chunkSize = chunkCount > 0 ? (count + chunkCount - 1) / chunkCount : 0;
+
+		std::vector<T> partials(chunkCount, identity);
+		ForRange(jobSystem, count, [&](const size_t begin, const size_t end) {
+			T partial = identity;
+			for (size_t index = begin; index < end; ++index) {
+				partial = combine(partial, transform(index));
+			}
+			partials[begin / std::max(chunkSize, size_t(1))] = partial;
+		});
+
+		// Partials are combined in order, so a non commutative combine still works
+		T result = identity;
+		for (const T& partial : partials) {
+			result = combine(result, partial);
+		}
+		return result;
+	}
+
+	template <class T, class Combine>
+	T Reduce(JobSystem& jobSystem, std::span<const T> values, const T& identity, Combine&& combine) {
+		return TransformReduce(jobSystem, values.size(), identity, [values](const size_t index) -> const T& { return values[index]; }, combine);
+	}
+
+	/*	output[i] = combine(input[0], ..., input[i]) for Inclusive, combine(identity, input[0], ..., input[i - 1]) for Exclusive.
+		output can be input. Scans chunk totals first, then every chunk again from its offset */
+	template <bool Inclusive, class T, class Combine>
+	void Scan(JobSystem& jobSystem, std::span<const T> input, std::span<T> output, const T& identity, Combine&& combine) {
+		assert(output.size() >= input.size() && "Scan output is too small");
+
+		const size_t count = input.size();
+		const uint32_t chunkCount = ChunkCount(jobSystem, count);
+		if (chunkCount <= 1) {
+			T running = identity;
+			for (size_t index = 0; index < count; ++index) {
+				const T value = input[index];
+				if constexpr (Inclusive) {
+					running = combine(running, value);
+					output[index] = running;
+				} else {
+					output[index] = running;
+					running = combine(running, value);
+				}
+			}
+			return;
+		}
+
+		const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+		std::vector<T> offsets(chunkCount, identity);
+		jobSystem.Dispatch(chunkCount, [&](const uint32_t chunk) {
+			const size_t end = std::min((chunk + 1) * chunkSize, count);
+			T total = identity;
+			for (size_t index = chunk * chunkSize; index < end; ++index) {
+				total = combine(total, input[index]);
+			}
+			offsets[chunk] = total;
+		});
+
+		T running = identity;
+		for (T& offset : offsets) {
+			const T total = offset;
+			offset = running;
+			running = combine(running, total);
+		}
+
+		jobSystem.Dispatch(chunkCount, [&](const uint32_t chunk) {
+			const size_t end = std::min((chunk + 1) * chunkSize, count);
+			T chunkRunning = offsets[chunk];
+			for (size_t index = chunk * chunkSize; index < end; ++index) {
+				const T value = input[index];
+				if constexpr (Inclusive) {
+					chunkRunning = combine(chunkRunning, value);
+					output[index] = chunkRunning;
+				} else {
+					output[index] = chunkRunning;
+					chunkRunning = combine(chunkRunning, value);
+				}
+			}
+		});
+	}
+
+	template <class T, class Combine>
+	void InclusiveScan(JobSystem& jobSystem, std::span<const T> input, std::span<T> output, const T& identity, Combine&& combine) {
+		Scan<true>(jobSystem, input, output, identity, combine);
+	}
+
+	template <class T, class Combine>
+	void ExclusiveScan(JobSystem& jobSystem, std::span<const T> input, std::span<T> output, const T& identity, Combine&& combine) {
+		Scan<false>(jobSystem, input, output, identity, combine);
+	}
+
+	/*	Compact over whole ranges, for predicates that test many indices at once. compactRange(begin, end, output) writes
+		the kept indices of [begin, end) in order to the front of output, which has room for all of them, and returns how
+		many it kept. Chunks start at multiples of alignment, so SIMD batches stay whole. indices needs room for count,
+		the front of it that holds the kept indices is returned. keptCounts is scratch, it keeps its capacity */
+	template <class CompactRange>
+	std::span<uint32_t> CompactRanges(JobSystem& jobSystem, const size_t count, CompactRange&& compactRange, std::span<uint32_t> indices,
+		std::vector<size_t>& keptCounts, const size_t alignment = 1, const size_t minChunkSize = sSerialThreshold / 4) {
+		assert(indices.size() >= count && "Compaction needs room for every index");
+
+		const uint32_t targetChunkCount = ChunkCount(jobSystem, count, minChunkSize);
+		if (targetChunkCount <= 1) {
+			return indices.first(count > 0 ? compactRange(size_t(0), count, indices.first(count)) : 0);
+		}
+
+		// Every chunk writes its kept indices to the start of its own range, then they are moved down in order.
+		// Rounding the chunks up to the alignment can leave fewer of them
+		const size_t chunkSize = ((count + targetChunkCount - 1) / targetChunkCount + alignment - 1) / alignment * alignment;
+		const uint32_t chunkCount = static_cast<uint32_t>((count + chunkSize - 1) / chunkSize);
+		keptCounts.resize(chunkCount);
+		const auto compactChunk = [&](const uint32_t chunk) {
+			const size_t begin = chunk * chunkSize;
+			const size_t end = std::min(begin + chunkSize, count);
+			keptCounts[chunk] = compactRange(begin, end, indices.subspan(begin, end - begin));
+		};
+		// A single reference fits in std::function without a heap allocation
+		jobSystem.Dispatch(chunkCount, [&compactChunk](const uint32_t chunk) { compactChunk(chunk); });
+
+		size_t total = 0;
+		for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+			memmove(indices.data() + total, indices.data() + chunk * chunkSize, keptCounts[chunk] * sizeof(uint32_t));
+			total += keptCounts[chunk];
+		}
+		return indices.first(total);
+	}
+
+	// The ascending indices in [0, count) that predicate(index) keeps, like a visibility list. indices is resized to fit
+	template <class Predicate>
+	void Compact(JobSystem& jobSystem, const uint32_t count, Predicate&& predicate, std::vector<uint32_t>& indices) {
+		const auto compactRange = [&predicate](const size_t begin, const size_t end, std::span<uint32_t> output) {
+			size_t kept = 0;
+			for (size_t index = begin; index < end; ++index) {
+				if (predicate(static_cast<uint32_t>(index))) {
+					output[kept++] = static_cast<uint32_t>(index);
+				}
+			}
+			return kept;
+		};
+
+		indices.resize(count);
+		std::vector<size_t> keptCounts;
+		indices.resize(CompactRanges(jobSystem, count, compactRange, std::span<uint32_t>(indices), keptCounts).size());
+	}
+
+	/*	Stable LSD radix sort of keys, 8 bits a pass. values, when given, are moved along with their keys, which sorts
+		draw indices by draw key. Passes where every key has the same digit are skipped */
+	void RadixSort(JobSystem& jobSystem, std::span<uint32_t> keys, std::span<uint32_t> values = {});
+	void RadixSort(JobSystem& jobSystem, std::span<uint64_t> keys, std::span<uint32_t> values = {});
+
+	// Sorts chunks with std::stable_sort, then merges pairs of runs in parallel until one is left
+	template <class T, class Less>
+	void StableSort(JobSystem& jobSystem, std::span<T> values, Less&& less) {
+		const size_t count = values.size();
+		const uint32_t chunkCount = ChunkCount(jobSystem, count);
+		if (chunkCount <= 1) {
+			std::stable_sort(values.begin(), values.end(), less);
+			return;
+		}
+
+		const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+		jobSystem.Dispatch(chunkCount, [&](const uint32_t chunk) {
+			const size_t begin = std::min(chunk * chunkSize, count);
+			const size_t end = std::min(begin + chunkSize, count);
+			std::stable_sort(values.begin() + begin, values.begin() + end, less);
+		});
+
+		// Merging left run before right keeps equal elements in order
+		std::vector<T> buffer(count);
+		std::span<T> source = values;
+		std::span<T> destination = buffer;
+		for (size_t runSize = chunkSize; runSize < count; runSize *= 2) {
+			const uint32_t mergeCount = static_cast<uint32_t>((count + 2 * runSize - 1) / (2 * runSize));
+			jobSystem.Dispatch(mergeCount, [&, runSize](const uint32_t merge) {
+				const size_t begin = merge * 2 * runSize;
+				const size_t middle = std::min(begin + runSize, count);
+				const size_t end = std::min(begin + 2 * runSize, count);
+				std::merge(std::make_move_iterator(source.begin() + begin), std::make_move_iterator(source.begin() + middle),
+					std::make_move_iterator(source.begin() + middle), std::make_move_iterator(source.begin() + end),
+					destination.begin() + begin, less);
+			});
+			std::swap(source, destination);
+		}
+
+		if (source.data() != values.data()) {
+			ForRange(jobSystem, count, [&](const size_t begin, const size_t end) {
+				std::move(source.begin() + begin, source.begin() + end, values.begin() + begin);
+			});
+		}
+	}
+
+	template <class T>
+	void StableSort(JobSystem& jobSystem, std::span<T> values) {
+		StableSort(jobSystem, values, std::less<T>());
+	}
+}
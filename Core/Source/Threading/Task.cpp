@@ -0,0 +1,98 @@
+#include "stdafx.h"
+
+#include "Task.h"
+#include "Profiling/Profiler.h"
+#include <algorithm>
+#include <iterator>
+
+Enj::FrameScheduler::FrameScheduler() :
+	mFrameIndex(0) {}
+
+//*********************************************************************************
+Enj::FrameScheduler::~FrameScheduler() {
+	// Coroutines still waiting are never resumed, the spawned tasks that own them free their frames. The job system is
+	// gone by now, so none of them runs on a worker anymore
+	mConditionWaits.clear();
+	mFrameWaits.clear();
+	mSpawned.clear();
+}
+
+//*********************************************************************************
+void Enj::FrameScheduler::Spawn(Task<void> task) {
+	// Moving a started task only moves the handle, the coroutine can already be running elsewhere
+	task.Start();
+	std::lock_guard<std::mutex> lock(mMutex);
+	mSpawned.push_back(std::move(task));
+}
+
+//*********************************************************************************
+void Enj::FrameScheduler::Tick() {
+	ENJ_PROFILE_FUNCTION();
+	const uint64_t frame = mFrameIndex.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (const FrameWait& wait : mFrameWaits) {
+			if (wait.mFrame <= frame) {
+				mResumeNow.push_back(wait.mCoroutine);
+			}
+		}
+		std::erase_if(mFrameWaits, [frame](const FrameWait& wait) { return wait.mFrame <= frame; });
+
+		// Checked once, a condition that turns true in between must not drop its coroutine
+		std::erase_if(mConditionWaits, [this](const ConditionWait& wait) {
+			if (!wait.mIsReady(wait.mState.get())) {
+				return false;
+			}
+			mResumeNow.push_back(wait.mCoroutine);
+			return true;
+		});
+	}
+
+	// Resumed coroutines can wait again or spawn, which takes the lock
+	for (const std::coroutine_handle<> coroutine : mResumeNow) {
+		coroutine.resume();
+	}
+	mResumeNow.clear();
+
+	// A spawned task has nobody to rethrow to, so its exception surfaces here
+	std::vector<Task<void>> finished;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		const auto running = std::partition(mSpawned.begin(), mSpawned.end(), [](const Task<void>& task) { return !task.IsDone(); });
+		std::move(running, mSpawned.end(), std::back_inserter(finished));
+		mSpawned.erase(running, mSpawned.end());
+	}
+	for (Task<void>& task : finished) {
+		task.GetResult();
+	}
+}
+
+//*********************************************************************************
+uint64_t Enj::FrameScheduler::GetFrameIndex() const {
+	return mFrameIndex.load(std::memory_order_acquire);
+}
+
+//*********************************************************************************
+uint32_t Enj::FrameScheduler::GetWaitingCount() const {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return static_cast<uint32_t>(mFrameWaits.size() + mConditionWaits.size());
+}
+
+//*********************************************************************************
+uint32_t Enj::FrameScheduler::GetSpawnedCount() const {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return static_cast<uint32_t>(mSpawned.size());
+}
+
+//*********************************************************************************
+void Enj::FrameScheduler::ResumeWhen(std::coroutine_handle<> coroutine, bool (*isReady)(const void* state), std::shared_ptr<const void> state) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mConditionWaits.push_back({ coroutine, isReady, std::move(state) });
+}
+
+//*********************************************************************************
+void Enj::FrameScheduler::ResumeAfter(std::coroutine_handle<> coroutine, const uint32_t frameCount) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mFrameWaits.push_back({ coroutine, mFrameIndex.load(std::memory_order_acquire) + frameCount });
+}
@@ -0,0 +1,381 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "JobSystem.h"
+
+namespace Enj {
+	template <class T = void>
+	class Task;
+
+	namespace Detail {
+		struct TaskPromiseBase {
+			// Hands the thread to whoever awaits the task, nothing resumes when it was started on its own
+			struct FinalAwaiter {
+				bool await_ready() const noexcept {
+					return false;
+				}
+
+				template <class Promise>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> coroutine) noexcept {
+					TaskPromiseBase& promise = coroutine.promise();
+					const std::coroutine_handle<> continuation = promise.mContinuation;
+					promise.mFinished.store(true, std::memory_order_release);
+					return continuation ? continuation : std::noop_coroutine();
+				}
+
+				void await_resume() const noexcept {}
+			};
+
+			std::suspend_always initial_suspend() const noexcept {
+				return {};
+			}
+
+			FinalAwaiter final_suspend() const noexcept {
+				return {};
+			}
+
+			void unhandled_exception() {
+				mException = std::current_exception();
+			}
+
+			void RethrowIfFailed() const {
+				if (mException) {
+					std::rethrow_exception(mException);
+				}
+			}
+
+			std::coroutine_handle<> mContinuation;
+			std::exception_ptr mException;
+			std::atomic<bool> mFinished = false;
+		};
+
+		template <class T>
+		struct TaskPromise : TaskPromiseBase {
+			Task<T> get_return_object();
+
+			template <class Value>
+			void return_value(Value&& value) {
+				mValue.emplace(std::forward<Value>(value));
+			}
+
+			T& Result() {
+				RethrowIfFailed();
+				return *mValue;
+			}
+
+			std::optional<T> mValue;
+		};
+
+		template <>
+		struct TaskPromise<void> : TaskPromiseBase {
+			Task<void> get_return_object();
+
+			void return_void() const {}
+
+			void Result() const {
+				RethrowIfFailed();
+			}
+		};
+	}
+
+	/*	Coroutine that starts when it is awaited and resumes its awaiter on the thread it finishes on. Exceptions travel
+		to the awaiter. A task that nobody awaits is started with Start, or handed to FrameScheduler::Spawn, and has to
+		stay alive until IsDone, destroying a suspended task does not cancel the work it is waiting for */
+	template <class T>
+	class Task {
+	public:
+		using promise_type = Detail::TaskPromise<T>;
+
+		Task() = default;
+		explicit Task(std::coroutine_handle<promise_type> coroutine) :
+			mCoroutine(coroutine) {}
+		Task(Task&& task) noexcept :
+			mCoroutine(std::exchange(task.mCoroutine, nullptr)) {}
+		Task& operator=(Task&& task) noexcept {
+			if (this != &task) {
+				Destroy();
+				mCoroutine = std::exchange(task.mCoroutine, nullptr);
+			}
+			return *this;
+		}
+		Task(const Task& task) = delete;
+		void operator=(const Task& task) = delete;
+
+		~Task() {
+			Destroy();
+		}
+
+		bool IsValid() const {
+			return static_cast<bool>(mCoroutine);
+		}
+
+		// Safe to poll from any thread
+		bool IsDone() const {
+			return !mCoroutine || mCoroutine.promise().mFinished.load(std::memory_order_acquire);
+		}
+
+		// Runs the task on this thread until it first suspends
+		void Start() {
+			mCoroutine.resume();
+		}
+
+		// Once IsDone, rethrows what the task threw
+		decltype(auto) GetResult() {
+			return mCoroutine.promise().Result();
+		}
+
+		// Awaits the task without taking its result or exception, they stay for GetResult
+		auto WhenDone() noexcept {
+			struct Awaiter {
+				bool await_ready() const noexcept {
+					return !mCoroutine || mCoroutine.done();
+				}
+
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+					mCoroutine.promise().mContinuation = awaiter;
+					return mCoroutine;
+				}
+
+				void await_resume() const noexcept {}
+
+				std::coroutine_handle<promise_type> mCoroutine;
+			};
+			return Awaiter{ mCoroutine };
+		}
+
+		auto operator co_await() && noexcept {
+			struct Awaiter {
+				bool await_ready() const noexcept {
+					return !mCoroutine || mCoroutine.done();
+				}
+
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+					mCoroutine.promise().mContinuation = awaiter;
+					return mCoroutine;
+				}
+
+				// By value, the awaited task is often a temporary that is gone before its result would be used
+				T await_resume() {
+					if constexpr (std::is_void_v<T>) {
+						mCoroutine.promise().Result();
+					} else {
+						return std::move(mCoroutine.promise().Result());
+					}
+				}
+
+				std::coroutine_handle<promise_type> mCoroutine;
+			};
+			return Awaiter{ mCoroutine };
+		}
+
+	private:
+		void Destroy() {
+			if (mCoroutine) {
+				mCoroutine.destroy();
+				mCoroutine = nullptr;
+			}
+		}
+
+		std::coroutine_handle<promise_type> mCoroutine;
+	};
+
+	template <class T>
+	Task<T> Detail::TaskPromise<T>::get_return_object() {
+		return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+	}
+
+	inline Task<void> Detail::TaskPromise<void>::get_return_object() {
+		return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+	}
+
+	/*	Resumes coroutines on the main thread at the start of a frame, after a number of frames or once a condition
+		holds, and keeps spawned tasks alive until they finish. Tick runs once per frame on the main thread, the awaitables can
+		be used from any thread. Destroy the JobSystem the coroutines resume on first, destroying the scheduler frees the
+		spawned coroutines and none may be running or queued on a worker then */
+	class FrameScheduler {
+	public:
+		FrameScheduler();
+		FrameScheduler(const FrameScheduler& scheduler) = delete;
+		void operator=(const FrameScheduler& scheduler) = delete;
+		~FrameScheduler();
+
+		// Starts the task now and releases it once it is done
+		void Spawn(Task<void> task);
+
+		// Resumes what is due this frame, then frees finished spawned tasks and rethrows the first exception one threw
+		void Tick();
+
+		uint64_t GetFrameIndex() const;
+		// Coroutines waiting for a frame or a condition, and spawned tasks still running
+		uint32_t GetWaitingCount() const;
+		uint32_t GetSpawnedCount() const;
+
+		// co_await scheduler.WaitFrames(1) continues in the next frame's Tick, 0 does not suspend
+		auto WaitFrames(const uint32_t frameCount) {
+			struct Awaiter {
+				bool await_ready() const noexcept {
+					return mFrameCount == 0;
+				}
+
+				void await_suspend(std::coroutine_handle<> coroutine) {
+					mScheduler.ResumeAfter(coroutine, mFrameCount);
+				}
+
+				void await_resume() const noexcept {}
+
+				FrameScheduler& mScheduler;
+				uint32_t mFrameCount;
+			};
+			return Awaiter{ *this, frameCount };
+		}
+
+		auto NextFrame() {
+			return WaitFrames(1);
+		}
+
+		// Continues the coroutine in the first Tick in which isReady(state) holds, state is kept alive until then. Lets
+		// other systems plug in their waits, like the asset reads of Assets/AssetTasks.h
+		void ResumeWhen(std::coroutine_handle<> coroutine, bool (*isReady)(const void* state), std::shared_ptr<const void> state);
+
+	private:
+		struct FrameWait {
+			std::coroutine_handle<> mCoroutine;
+			uint64_t mFrame;
+		};
+
+		struct ConditionWait {
+			std::coroutine_handle<> mCoroutine;
+			bool (*mIsReady)(const void* state);
+			std::shared_ptr<const void> mState;
+		};
+
+		void ResumeAfter(std::coroutine_handle<> coroutine, const uint32_t frameCount);
+
+		mutable std::mutex mMutex;
+		std::vector<FrameWait> mFrameWaits;
+		std::vector<ConditionWait> mConditionWaits;
+		std::vector<Task<void>> mSpawned;
+		std::atomic<uint64_t> mFrameIndex;
+
+		// Tick's scratch, kept to not allocate every frame
+		std::vector<std::coroutine_handle<>> mResumeNow;
+	};
+
+	// co_await ResumeOnWorker(jobSystem) continues the coroutine as a job
+	inline auto ResumeOnWorker(JobSystem& jobSystem) {
+		struct Awaiter {
+			bool await_ready() const noexcept {
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> coroutine) {
+				mJobSystem.Run([coroutine]() { coroutine.resume(); });
+			}
+
+			void await_resume() const noexcept {}
+
+			JobSystem& mJobSystem;
+		};
+		return Awaiter{ jobSystem };
+	}
+
+	namespace Detail {
+		// Counts the tasks of a WhenAll down, the last one to finish resumes the awaiter
+		struct WhenAllCounter {
+			explicit WhenAllCounter(const size_t count) :
+				mRemaining(count + 1) {}
+
+			// The awaiter's own count, false when every task already finished and it should not suspend
+			bool Suspend(std::coroutine_handle<> awaiter) {
+				mAwaiter = awaiter;
+				return mRemaining.fetch_sub(1, std::memory_order_acq_rel) > 1;
+			}
+
+			void Finish() {
+				if (mRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+					mAwaiter.resume();
+				}
+			}
+
+			std::atomic<size_t> mRemaining;
+			std::coroutine_handle<> mAwaiter;
+		};
+
+		// Runs one task of a WhenAll and frees itself when it is done
+		struct WhenAllStarter {
+			struct promise_type {
+				WhenAllStarter get_return_object() {
+					return { std::coroutine_handle<promise_type>::from_promise(*this) };
+				}
+				std::suspend_always initial_suspend() const noexcept {
+					return {};
+				}
+				std::suspend_never final_suspend() const noexcept {
+					return {};
+				}
+				void return_void() const noexcept {}
+				void unhandled_exception() const noexcept {}
+			};
+
+			std::coroutine_handle<promise_type> mCoroutine;
+		};
+
+		template <class T>
+		WhenAllStarter StartForWhenAll(Task<T>& task, WhenAllCounter& counter) {
+			co_await task.WhenDone();
+			counter.Finish();
+		}
+
+		template <class T>
+		auto WaitForAll(std::vector<Task<T>>& tasks) {
+			struct Awaiter {
+				bool await_ready() const noexcept {
+					return mTasks.empty();
+				}
+
+				bool await_suspend(std::coroutine_handle<> awaiter) {
+					for (Task<T>& task : mTasks) {
+						StartForWhenAll(task, mCounter).mCoroutine.resume();
+					}
+					return mCounter.Suspend(awaiter);
+				}
+
+				void await_resume() const noexcept {}
+
+				std::vector<Task<T>>& mTasks;
+				WhenAllCounter mCounter;
+			};
+			return Awaiter{ tasks, WhenAllCounter(tasks.size()) };
+		}
+	}
+
+	// Runs the tasks concurrently and continues once all of them are done, the results are in the order of tasks.
+	// The first exception a task threw is rethrown after all of them finished
+	template <class T>
+	Task<std::vector<T>> WhenAll(std::vector<Task<T>> tasks) {
+		co_await Detail::WaitForAll(tasks);
+
+		std::vector<T> results;
+		results.reserve(tasks.size());
+		for (Task<T>& task : tasks) {
+			results.push_back(std::move(task.GetResult()));
+		}
+		co_return results;
+	}
+
+	inline Task<void> WhenAll(std::vector<Task<void>> tasks) {
+		co_await Detail::WaitForAll(tasks);
+
+		for (Task<void>& task : tasks) {
+			task.GetResult();
+		}
+	}
+}
@@ -0,0 +1,211 @@
+#include "stdafx.h"
+
+#include "TaskGraph.h"
+#include "JobSystem.h"
+#include "Profiling/Profiler.h"
+#include <algorithm>
+#include <assert.h>
+#include <sstream>
+#include <string.h>
+#include <thread>
+
+Enj::TaskGraph::TaskGraph(JobSystem& jobSystem) :
+	mJobSystem(jobSystem),
+	mCompiled(false),
+	mMainThreadQueueEnd(0),
+	mRemainingStages(0),
+	mFailed(false) {}
+
+//*********************************************************************************
+Enj::TaskGraph::~TaskGraph() {}
+
+//*********************************************************************************
+void Enj::TaskGraph::AddStage(const char* name, std::initializer_list<const char*> reads, std::initializer_list<const char*> writes,
+	StageFunction function, const Affinity affinity) {
+	assert(!mCompiled && "Stages have to be added before Compile");
+
+	Stage stage;
+	stage.mName = name;
+	stage.mFunction = std::move(function);
+	stage.mAffinity = affinity;
+	for (const char* resource : reads) {
+		stage.mReads.push_back(FindOrAddResource(resource));
+	}
+	for (const char* resource : writes) {
+		stage.mWrites.push_back(FindOrAddResource(resource));
+	}
+	mStages.push_back(std::move(stage));
+}
+
+//*********************************************************************************
+void Enj::TaskGraph::Compile() {
+	constexpr uint32_t noStage = UINT32_MAX;
+	std::vector<uint32_t> lastWriter(mResources.size(), noStage);
+	std::vector<std::vector<uint32_t>> readersSinceWrite(mResources.size());
+
+	for (uint32_t stageIndex = 0; stageIndex < mStages.size(); ++stageIndex) {
+		Stage& stage = mStages[stageIndex];
+		const auto dependOn = [&stage, stageIndex](const uint32_t dependency) {
+			if (dependency != noStage && dependency != stageIndex &&
+				std::find(stage.mDependencies.begin(), stage.mDependencies.end(), dependency) == stage.mDependencies.end()) {
+				stage.mDependencies.push_back(dependency);
+			}
+		};
+
+		for (const uint32_t resource : stage.mReads) {
+			dependOn(lastWriter[resource]);
+		}
+		for (const uint32_t resource : stage.mWrites) {
+			dependOn(lastWriter[resource]);
+			for (const uint32_t reader : readersSinceWrite[resource]) {
+				dependOn(reader);
+			}
+		}
+
+		for (const uint32_t resource : stage.mReads) {
+			readersSinceWrite[resource].push_back(stageIndex);
+		}
+		for (const uint32_t resource : stage.mWrites) {
+			lastWriter[resource] = stageIndex;
+			readersSinceWrite[resource].clear();
+		}
+
+		std::sort(stage.mDependencies.begin(), stage.mDependencies.end());
+		for (const uint32_t dependency : stage.mDependencies) {
+			mStages[dependency].mDependents.push_back(stageIndex);
+		}
+	}
+
+	mPendingDependencies = std::make_unique<std::atomic<uint32_t>[]>(mStages.size());
+	mMainThreadQueue = std::make_unique<std::atomic<uint32_t>[]>(mStages.size());
+	mCompiled = true;
+}
+
+//*********************************************************************************
+void Enj::TaskGraph::Execute() {
+	assert(mCompiled && "Compile the graph before executing it");
+	ENJ_PROFILE_FUNCTION();
+
+	const uint32_t stageCount = static_cast<uint32_t>(mStages.size());
+	for (uint32_t stageIndex = 0; stageIndex < stageCount; ++stageIndex) {
+		mPendingDependencies[stageIndex].store(static_cast<uint32_t>(mStages[stageIndex].mDependencies.size()), std::memory_order_relaxed);
+		mMainThreadQueue[stageIndex].store(0, std::memory_order_relaxed);
+	}
+	mMainThreadQueueEnd.store(0, std::memory_order_relaxed);
+	mRemainingStages.store(stageCount, std::memory_order_relaxed);
+	mFailed.store(false, std::memory_order_relaxed);
+	mException = nullptr;
+
+	for (uint32_t stageIndex = 0; stageIndex < stageCount; ++stageIndex) {
+		if (mStages[stageIndex].mDependencies.empty()) {
+			Launch(stageIndex);
+		}
+	}
+
+	// Main thread stages run here as they become ready, in between this thread helps with the other stages
+	uint32_t mainThreadQueueBegin = 0;
+	while (mRemainingStages.load(std::memory_order_acquire) > 0) {
+		if (mainThreadQueueBegin < mMainThreadQueueEnd.load(std::memory_order_acquire)) {
+			const uint32_t entry = mMainThreadQueue[mainThreadQueueBegin].load(std::memory_order_acquire);
+			if (entry != 0) {
+				++mainThreadQueueBegin;
+				RunStage(entry - 1);
+				continue;
+			}
+		}
+		if (!mJobSystem.TryRunJob()) {
+			std::this_thread::yield();
+		}
+	}
+
+	if (mException) {
+		std::rethrow_exception(mException);
+	}
+}
+
+//*********************************************************************************
+std::string Enj::TaskGraph::ToText() const {
+	std::ostringstream text;
+	for (const Stage& stage : mStages) {
+		text << stage.mName << (stage.mAffinity == Affinity::MainThread ? " [main thread]" : "");
+
+		const auto writeList = [&text](const char* label, const std::vector<uint32_t>& indices, const auto& nameOf) {
+			if (!indices.empty()) {
+				text << " " << label;
+				for (size_t index = 0; index < indices.size(); ++index) {
+					text << (index == 0 ? " " : ", ") << nameOf(indices[index]);
+				}
+			}
+		};
+		const auto resourceName = [this](const uint32_t resource) { return mResources[resource]; };
+		const auto stageName = [this](const uint32_t stageIndex) { return mStages[stageIndex].mName; };
+		writeList("reads", stage.mReads, resourceName);
+		writeList("writes", stage.mWrites, resourceName);
+		writeList("after", stage.mDependencies, stageName);
+		text << "\n";
+	}
+	return text.str();
+}
+
+//*********************************************************************************
+std::string Enj::TaskGraph::ToDot() const {
+	std::ostringstream dot;
+	dot << "digraph FrameGraph {\n";
+	dot << "\trankdir=LR;\n";
+	for (uint32_t stageIndex = 0; stageIndex < mStages.size(); ++stageIndex) {
+		const Stage& stage = mStages[stageIndex];
+		dot << "\tstage" << stageIndex << " [label=\"" << stage.mName << "\"" << (stage.mAffinity == Affinity::MainThread ? ", shape=box" : "") << "];\n";
+	}
+	for (uint32_t stageIndex = 0; stageIndex < mStages.size(); ++stageIndex) {
+		for (const uint32_t dependent : mStages[stageIndex].mDependents) {
+			dot << "\tstage" << stageIndex << " -> stage" << dependent << ";\n";
+		}
+	}
+	dot << "}\n";
+	return dot.str();
+}
+
+//*********************************************************************************
+uint32_t Enj::TaskGraph::FindOrAddResource(const char* name) {
+	for (uint32_t resource = 0; resource < mResources.size(); ++resource) {
+		if (mResources[resource] == name) {
+			return resource;
+		}
+	}
+	mResources.push_back(name);
+	return static_cast<uint32_t>(mResources.size() - 1);
+}
+
+//*********************************************************************************
+void Enj::TaskGraph::RunStage(const uint32_t stageIndex) {
+	const Stage& stage = mStages[stageIndex];
+	if (!mFailed.load(std::memory_order_acquire)) {
+		ENJ_PROFILE_SCOPE(stage.mName);
+		try {
+			stage.mFunction();
+		} catch (...) {
+			if (!mFailed.exchange(true, std::memory_order_acq_rel)) {
+				mException = std::current_exception();
+			}
+		}
+	}
+
+	for (const uint32_t dependent : stage.mDependents) {
+		if (mPendingDependencies[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			Launch(dependent);
+		}
+	}
+
+	// Last access to the graph from this stage, Execute can return once every stage got here
+	mRemainingStages.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+//*********************************************************************************
+void Enj::TaskGraph::Launch(const uint32_t stageIndex) {
+	if (mStages[stageIndex].mAffinity == Affinity::MainThread) {
+		const uint32_t slot = mMainThreadQueueEnd.fetch_add(1, std::memory_order_acq_rel);
+		mMainThreadQueue[slot].store(stageIndex + 1, std::memory_order_release);
+	} else {
+		mJobSystem.Run([this, stageIndex]() { RunStage(stageIndex); });
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Enj {
+	class JobSystem;
+
+	/*	Stages of a frame and the frame state they read and write, built once and executed every frame.
+		A stage runs after the last earlier stage that wrote what it reads or writes, and after the earlier readers of what
+		it writes, so the order stages are added in is the order conflicting stages run in. Stages without a conflict run
+		in parallel on the job system. Executing allocates nothing, stage functions should keep their captures small
+		enough for std::function to store them inline */
+	class TaskGraph {
+	public:
+		using StageFunction = std::function<void()>;
+
+		enum class Affinity {
+			AnyThread,
+			MainThread	// The thread that calls Execute, for window messages and presenting
+		};
+
+		explicit TaskGraph(JobSystem& jobSystem);
+		TaskGraph(const TaskGraph& graph) = delete;
+		void operator=(const TaskGraph& graph) = delete;
+		~TaskGraph();
+
+		// The stage name is kept as a pointer, the profiler labels the stage with it, so it has to outlive the graph like a
+		// string literal. Resource names are copied, a resource is created by the first stage naming it
+		void AddStage(const char* name, std::initializer_list<const char*> reads, std::initializer_list<const char*> writes,
+			StageFunction function, const Affinity affinity = Affinity::AnyThread);
+
+		// Works out the dependencies, stages cannot be added afterwards
+		void Compile();
+
+		// Runs every stage once and returns when all have finished. The first exception a stage throws is rethrown
+		// here, the stages after it are skipped
+		void Execute();
+
+		// One line per stage with its thread, accesses and the stages it waits for
+		std::string ToText() const;
+		// Graphviz, render with dot -Tsvg
+		std::string ToDot() const;
+
+	private:
+		struct Stage {
+			const char* mName;
+			StageFunction mFunction;
+			Affinity mAffinity;
+			std::vector<uint32_t> mReads;
+			std::vector<uint32_t> mWrites;
+			std::vector<uint32_t> mDependencies;
+			std::vector<uint32_t> mDependents;
+		};
+
+		uint32_t FindOrAddResource(const char* name);
+		void RunStage(const uint32_t stageIndex);
+		void Launch(const uint32_t stageIndex);
+
+		JobSystem& mJobSystem;
+		std::vector<Stage> mStages;
+		std::vector<std::string> mResources;
+		bool mCompiled;
+
+		// Per frame state, sized by Compile
+		std::unique_ptr<std::atomic<uint32_t>[]> mPendingDependencies;
+		std::unique_ptr<std::atomic<uint32_t>[]> mMainThreadQueue;	// Stage index + 1 once ready, 0 while empty
+		std::atomic<uint32_t> mMainThreadQueueEnd;
+		std::atomic<uint32_t> mRemainingStages;
+		std::atomic<bool> mFailed;
+		std::exception_ptr mException;
+	};
+}
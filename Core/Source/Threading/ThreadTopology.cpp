@@ -0,0 +1,315 @@
+#include "stdafx.h"
+
+#include "ThreadTopology.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#if defined(__linux__)
+	// "0-3,8,10-11" as in /sys/devices/system/cpu/online
+	std::vector<uint32_t> ReadCpuList(const std::string& path) {
+		std::vector<uint32_t> cpus;
+		std::ifstream file(path);
+		std::string list;
+		if (!std::getline(file, list)) {
+			return cpus;
+		}
+
+		std::istringstream ranges(list);
+		std::string range;
+		while (std::getline(ranges, range, ',')) {
+			const size_t dash = range.find('-');
+			const uint32_t first = static_cast<uint32_t>(strtoul(range.c_str(), nullptr, 10));
+			const uint32_t last = dash == std::string::npos ? first : static_cast<uint32_t>(strtoul(range.c_str() + dash + 1, nullptr, 10));
+			for (uint32_t cpu = first; cpu <= last; ++cpu) {
+				cpus.push_back(cpu);
+			}
+		}
+		return cpus;
+	}
+
+	// -1 when the file is not there
+	long ReadNumber(const std::string& path) {
+		std::ifstream file(path);
+		long value = -1;
+		file >> value;
+		return file ? value : -1;
+	}
+#endif
+}
+
+//*********************************************************************************
+Enj::CpuTopology Enj::CpuTopology::Detect() {
+	CpuTopology topology;
+	std::vector<LogicalProcessor>& processors = topology.mProcessors;
+
+#if defined(_WIN32)
+	DWORD size = 0;
+	GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &size);
+	std::vector<uint8_t> buffer(size);
+	if (size > 0 && GetLogicalProcessorInformationEx(RelationProcessorCore,
+		reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data()), &size)) {
+		for (DWORD offset = 0; offset < size;) {
+			const auto* information = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+			const PROCESSOR_RELATIONSHIP& core = information->Processor;
+			bool firstOfCore = true;
+			for (WORD group = 0; group < core.GroupCount; ++group) {
+				for (uint16_t number = 0; number < sizeof(KAFFINITY) * 8; ++number) {
+					if ((core.GroupMask[group].Mask & (KAFFINITY(1) << number)) != 0) {
+						processors.push_back({ core.GroupMask[group].Group, number, topology.mCoreCount, core.EfficiencyClass, !firstOfCore });
+						firstOfCore = false;
+					}
+				}
+			}
+			++topology.mCoreCount;
+			offset += information->Size;
+		}
+	}
+#elif defined(__linux__)
+	// cpu_capacity ranks the cores of big.LITTLE CPUs, cpu_core lists the P-cores of hybrid Intel CPUs
+	const std::string cpuPath = "/sys/devices/system/cpu/";
+	const std::vector<uint32_t> performanceCpus = ReadCpuList("/sys/devices/cpu_core/cpus");
+	std::vector<std::pair<long, long>> coreIds;
+	std::vector<long> capacities;
+	for (const uint32_t cpu : ReadCpuList(cpuPath + "online")) {
+		const std::string topologyPath = cpuPath + "cpu" + std::to_string(cpu) + "/topology/";
+		const std::pair<long, long> coreId(ReadNumber(topologyPath + "physical_package_id"), ReadNumber(topologyPath + "core_id"));
+		const auto existing = std::find(coreIds.begin(), coreIds.end(), coreId);
+		const uint32_t core = static_cast<uint32_t>(existing - coreIds.begin());
+		const bool smtSibling = existing != coreIds.end();
+		if (!smtSibling) {
+			coreIds.push_back(coreId);
+		}
+
+		LogicalProcessor processor = { 0, static_cast<uint16_t>(cpu), core, 0, smtSibling };
+		if (!performanceCpus.empty()) {
+			processor.mEfficiencyClass = std::find(performanceCpus.begin(), performanceCpus.end(), cpu) != performanceCpus.end() ? 1 : 0;
+		}
+		processors.push_back(processor);
+		capacities.push_back(ReadNumber(cpuPath + "cpu" + std::to_string(cpu) + "/cpu_capacity"));
+	}
+	topology.mCoreCount = static_cast<uint32_t>(coreIds.size());
+
+	if (performanceCpus.empty()) {
+		std::vector<long> distinctCapacities = capacities;
+		std::sort(distinctCapacities.begin(), distinctCapacities.end());
+		distinctCapacities.erase(std::unique(distinctCapacities.begin(), distinctCapacities.end()), distinctCapacities.end());
+		for (size_t index = 0; index < processors.size(); ++index) {
+			const auto rank = std::lower_bound(distinctCapacities.begin(), distinctCapacities.end(), capacities[index]);
+			processors[index].mEfficiencyClass = static_cast<uint8_t>(rank - distinctCapacities.begin());
+		}
+	}
+#endif
+
+	// Nothing detected, every hardware thread counts as a core of its own
+	if (processors.empty()) {
+		const unsigned int hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		for (unsigned int index = 0; index < hardwareThreads; ++index) {
+			processors.push_back({ 0, static_cast<uint16_t>(index), index, 0, false });
+		}
+		topology.mCoreCount = hardwareThreads;
+	}
+
+	for (const LogicalProcessor& processor : processors) {
+		topology.mPerformanceClass = std::max(topology.mPerformanceClass, processor.mEfficiencyClass);
+	}
+	return topology;
+}
+
+//*********************************************************************************
+const std::vector<Enj::LogicalProcessor>& Enj::CpuTopology::GetLogicalProcessors() const {
+	return mProcessors;
+}
+
+//*********************************************************************************
+uint32_t Enj::CpuTopology::GetCoreCount() const {
+	return mCoreCount;
+}
+
+//*********************************************************************************
+bool Enj::CpuTopology::IsHybrid() const {
+	for (const LogicalProcessor& processor : mProcessors) {
+		if (processor.mEfficiencyClass != mPerformanceClass) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//*********************************************************************************
+std::vector<uint32_t> Enj::CpuTopology::Order(const CoreType coreType, const bool includeSmtSiblings) const {
+	std::vector<uint32_t> order;
+	for (uint32_t index = 0; index < mProcessors.size(); ++index) {
+		const LogicalProcessor& processor = mProcessors[index];
+		const bool performance = processor.mEfficiencyClass == mPerformanceClass;
+		if ((includeSmtSiblings || !processor.mSmtSibling) &&
+			(coreType == CoreType::Any || performance == (coreType == CoreType::Performance))) {
+			order.push_back(index);
+		}
+	}
+
+	std::stable_sort(order.begin(), order.end(), [this](const uint32_t left, const uint32_t right) {
+		const LogicalProcessor& a = mProcessors[left];
+		const LogicalProcessor& b = mProcessors[right];
+		// A core of its own beats sharing a faster one
+		if (a.mSmtSibling != b.mSmtSibling) {
+			return b.mSmtSibling;
+		}
+		return a.mEfficiencyClass > b.mEfficiencyClass;
+	});
+	return order;
+}
+
+//*********************************************************************************
+std::string Enj::CpuTopology::ToText() const {
+	std::ostringstream text;
+	text << mCoreCount << " cores, " << mProcessors.size() << " logical processors" << (IsHybrid() ? ", hybrid" : "") << "\n";
+	for (uint32_t index = 0; index < mProcessors.size(); ++index) {
+		const LogicalProcessor& processor = mProcessors[index];
+		text << index << ": group " << processor.mGroup << " number " << processor.mNumber << " core " << processor.mCore
+			<< " class " << int(processor.mEfficiencyClass) << (processor.mEfficiencyClass == mPerformanceClass ? " (performance)" : " (efficiency)")
+			<< (processor.mSmtSibling ? " smt sibling" : "") << "\n";
+	}
+	return text.str();
+}
+
+//*********************************************************************************
+Enj::ThreadPlacement Enj::ThreadPlacement::Plan(const CpuTopology& topology, const ThreadConfiguration& configuration, const bool hasRenderThread) {
+	ThreadPlacement placement;
+	const std::vector<LogicalProcessor>& processors = topology.GetLogicalProcessors();
+
+	std::vector<uint32_t> reservedCores;
+	if (configuration.pinThreads) {
+		const std::vector<uint32_t> fastest = topology.Order(CoreType::Performance, false);
+		placement.mMain.push_back(fastest[0]);
+		reservedCores.push_back(processors[fastest[0]].mCore);
+		if (hasRenderThread && fastest.size() > 1) {
+			placement.mRender.push_back(fastest[1]);
+			reservedCores.push_back(processors[fastest[1]].mCore);
+		}
+	}
+
+	const auto available = [&](const CoreType coreType) {
+		std::vector<uint32_t> order = topology.Order(coreType, configuration.useSmtSiblings);
+		std::erase_if(order, [&](const uint32_t index) {
+			return std::find(reservedCores.begin(), reservedCores.end(), processors[index].mCore) != reservedCores.end();
+		});
+		return order;
+	};
+
+	// Asking for E-cores on a CPU without them, or a machine with no core left besides main and render, uses what is there
+	std::vector<uint32_t> workerProcessors = available(configuration.workerCores);
+	if (workerProcessors.empty()) {
+		workerProcessors = available(CoreType::Any);
+	}
+	if (workerProcessors.empty()) {
+		reservedCores.clear();
+		workerProcessors = available(CoreType::Any);
+	}
+
+	const bool restricted = !configuration.useSmtSiblings || configuration.workerCores != CoreType::Any;
+	unsigned int workerCount = 0;
+	if (configuration.workerCount >= 0) {
+		workerCount = static_cast<unsigned int>(configuration.workerCount);
+	} else if (configuration.pinThreads) {
+		workerCount = static_cast<unsigned int>(workerProcessors.size());
+	} else if (restricted) {
+		// The main thread can still land in the set
+		workerCount = static_cast<unsigned int>(workerProcessors.size() - 1);
+	} else {
+		workerCount = JobSystem::DefaultWorkerCount();
+	}
+
+	placement.mWorkers.resize(workerCount);
+	for (unsigned int worker = 0; worker < workerCount; ++worker) {
+		if (configuration.pinThreads) {
+			placement.mWorkers[worker].push_back(workerProcessors[worker % workerProcessors.size()]);
+		} else if (restricted) {
+			placement.mWorkers[worker] = workerProcessors;
+		}
+	}
+	return placement;
+}
+
+//*********************************************************************************
+unsigned int Enj::ThreadPlacement::WorkerCount() const {
+	return static_cast<unsigned int>(mWorkers.size());
+}
+
+//*********************************************************************************
+std::string Enj::ThreadPlacement::ToText() const {
+	std::ostringstream text;
+	const auto writeThread = [&text](const std::string& name, const std::vector<uint32_t>& processors) {
+		text << name << ":";
+		if (processors.empty()) {
+			text << " any";
+		}
+		for (const uint32_t processor : processors) {
+			text << " " << processor;
+		}
+		text << "\n";
+	};
+	writeThread("Main", mMain);
+	writeThread("Render", mRender);
+	for (size_t worker = 0; worker < mWorkers.size(); ++worker) {
+		writeThread("Worker " + std::to_string(worker + 1), mWorkers[worker]);
+	}
+	return text.str();
+}
+
+//*********************************************************************************
+bool Enj::ConfigureCurrentThread(const CpuTopology& topology, std::span<const uint32_t> processors, const ThreadPriority priority) {
+	const std::vector<LogicalProcessor>& logicalProcessors = topology.GetLogicalProcessors();
+	bool configured = true;
+
+#if defined(_WIN32)
+	const HANDLE thread = GetCurrentThread();
+	if (!processors.empty()) {
+		GROUP_AFFINITY affinity = {};
+		affinity.Group = logicalProcessors[processors[0]].mGroup;
+		for (const uint32_t index : processors) {
+			if (logicalProcessors[index].mGroup == affinity.Group) {
+				affinity.Mask |= KAFFINITY(1) << logicalProcessors[index].mNumber;
+			}
+		}
+		configured = SetThreadGroupAffinity(thread, &affinity, nullptr) != 0;
+	}
+
+	// Normal leaves the priority the thread started with alone
+	if (priority != ThreadPriority::Normal) {
+		const int values[] = { THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL, THREAD_PRIORITY_ABOVE_NORMAL, THREAD_PRIORITY_HIGHEST };
+		configured = ::SetThreadPriority(thread, values[static_cast<int>(priority)]) != 0 && configured;
+	}
+#elif defined(__linux__)
+	if (!processors.empty()) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (const uint32_t index : processors) {
+			CPU_SET(logicalProcessors[index].mNumber, &set);
+		}
+		configured = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+	}
+
+	// Nice values are per thread on Linux, below 0 needs CAP_SYS_NICE
+	if (priority != ThreadPriority::Normal) {
+		const int values[] = { 5, 0, -5, -10 };
+		configured = setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), values[static_cast<int>(priority)]) == 0 && configured;
+	}
+#else
+	(void)logicalProcessors;
+	configured = processors.empty() && priority == ThreadPriority::Normal;
+#endif
+
+	return configured;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <span>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Enj {
+	struct LogicalProcessor {
+		uint16_t mGroup;			// Windows processor group, 0 elsewhere
+		uint16_t mNumber;			// Within the group, the CPU number elsewhere
+		uint32_t mCore;				// Physical core, shared by SMT siblings
+		uint8_t mEfficiencyClass;	// Higher is faster, all 0 on CPUs with one core type
+		bool mSmtSibling;			// Not the first logical processor of its core
+	};
+
+	enum class CoreType {
+		Any,
+		Performance,	// The fastest efficiency class, every core on CPUs with one core type
+		Efficiency		// The other classes, none on CPUs with one core type
+	};
+
+	enum class ThreadPriority {
+		Low,
+		Normal,
+		High,
+		Highest
+	};
+
+	// Cores and logical processors of the machine, detected once at startup
+	class CpuTopology {
+	public:
+		static CpuTopology Detect();
+
+		const std::vector<LogicalProcessor>& GetLogicalProcessors() const;
+		uint32_t GetCoreCount() const;
+
+		// More than one efficiency class, like P-cores and E-cores
+		bool IsHybrid() const;
+
+		// Logical processor indices of the cores of a type, the first logical processor of every core before any SMT
+		// sibling, faster cores first within those
+		std::vector<uint32_t> Order(const CoreType coreType, const bool includeSmtSiblings) const;
+
+		// One line per logical processor
+		std::string ToText() const;
+
+	private:
+		std::vector<LogicalProcessor> mProcessors;
+		uint32_t mCoreCount = 0;
+		uint8_t mPerformanceClass = 0;
+	};
+
+	// How the engine spreads its threads over the cores, from the command line
+	struct ThreadConfiguration {
+		bool pinThreads = false;		// Main, render and every worker on a logical processor of its own
+		bool useSmtSiblings = true;		// false keeps workers off the second logical processor of a core
+		CoreType workerCores = CoreType::Any;
+		int workerCount = -1;			// -1 for one per logical processor the workers can use
+		ThreadPriority mainPriority = ThreadPriority::Normal;
+		ThreadPriority renderPriority = ThreadPriority::Normal;
+		ThreadPriority workerPriority = ThreadPriority::Normal;
+		bool writeTopology = false;		// -topology writes topology.txt
+	};
+
+	/*	Logical processors each thread may run on, empty for anywhere. Pinned main and render threads get the first
+		logical processor of the two fastest cores and the workers stay off those cores entirely, so an SMT sibling
+		never slows the frame's critical path down. Unpinned workers restricted to a core type or to one logical
+		processor per core may run anywhere in that set */
+	struct ThreadPlacement {
+		std::vector<uint32_t> mMain;
+		std::vector<uint32_t> mRender;
+		std::vector<std::vector<uint32_t>> mWorkers;	// Per background worker, worker 1 first
+
+		static ThreadPlacement Plan(const CpuTopology& topology, const ThreadConfiguration& configuration, const bool hasRenderThread);
+
+		unsigned int WorkerCount() const;
+		std::string ToText() const;
+	};
+
+	/*	Restricts the calling thread to processors and sets its priority, threads apply their own placement when they
+		start. Best effort, false when the system refused, raising the priority can need rights the user does not have.
+		On Windows a set is limited to the processor group of its first processor */
+	bool ConfigureCurrentThread(const CpuTopology& topology, std::span<const uint32_t> processors, const ThreadPriority priority);
+}
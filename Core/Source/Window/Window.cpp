@@ -4,7 +4,8 @@
 
 Enj::Window::Window(const WindowCreationParams& creationParams) :
     mWindowSize(creationParams.windowSize),
-    mTitle(creationParams.windowName) {
+    mTitle(creationParams.windowName),
+    mText(creationParams.windowName) {
     mAspectRatio = static_cast<float>(mWindowSize.mX) / static_cast<float>(mWindowSize.mY);
 
     // Initialize the window class.
@@ -34,7 +35,7 @@ Enj::Window::Window(const WindowCreationParams& creationParams) :
         nullptr,        // We have no parent window.
         nullptr,        // We aren't using menus.
         creationParams.hInstance,
-        creationParams.engine);
+        creationParams.userData);
 
     ShowWindow(mHWND, creationParams.cmdShow);
 
@@ -58,13 +59,13 @@ void Enj::Window::SetWindowTitle(const std::wstring& windowName) {
 }
 
 void Enj::Window::SetWindowCustomText(const std::wstring& text) {
-    mCustomText = L": " + text;
+    mCustomText.assign(L": ").append(text);
 
     ApplyWindowText();
 }
 
-const std::wstring Enj::Window::WindowName() const {
-    return mTitle + L": " + mCustomText;
+const std::wstring& Enj::Window::WindowName() const {
+    return mText;
 }
 
 HWND Enj::Window::Hwnd() {
@@ -72,6 +73,6 @@ HWND Enj::Window::Hwnd() {
 }
 
 void Enj::Window::ApplyWindowText() {
-    std::wstring windowText = mTitle + mCustomText;
-    SetWindowText(mHWND, windowText.c_str());
+    mText.assign(mTitle).append(mCustomText);
+    SetWindowText(mHWND, mText.c_str());
 }
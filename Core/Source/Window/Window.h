@@ -2,14 +2,12 @@
 #include <Math/Vector2.h>
 
 namespace Enj {
-	class Engine;
-
 	struct WindowCreationParams {
 		OMath::Vector2ui windowSize;
 		std::wstring windowName;
 		HINSTANCE hInstance;
 		int cmdShow;
-		Engine* engine;
+		void* userData;		// lpCreateParams of WM_NCCREATE
 		WNDPROC windowProc;
 	};
 
@@ -24,7 +22,8 @@ namespace Enj {
 
 		void SetWindowTitle(const std::wstring& windowTitle);
 		void SetWindowCustomText(const std::wstring& text);
-		const std::wstring WindowName() const;
+		// The title and custom text as the window shows them
+		const std::wstring& WindowName() const;
 
 		HWND Hwnd();
 
@@ -33,6 +32,7 @@ namespace Enj {
 
 		std::wstring mTitle;
 		std::wstring mCustomText;
+		std::wstring mText;		// Kept so updating the text reuses its memory
 		OMath::Vector2ui mWindowSize;
 		float mAspectRatio;
 		HWND mHWND;
@@ -0,0 +1,31 @@
+#pragma once
+#include <stdint.h>
+#include "Threading/BoundedQueue.h"
+
+namespace Enj {
+	enum class WindowEventType : uint8_t {
+		Resize,				// mX, mY client size, mCode 1 when minimized
+		KeyDown,			// mCode virtual key, mX 1 for auto repeat
+		KeyUp,				// mCode virtual key
+		Character,			// mCode UTF-16 code unit
+		MouseMove,			// mX, mY client position
+		MouseButtonDown,	// mCode 0 left, 1 right, 2 middle, mX, mY client position
+		MouseButtonUp,
+		MouseWheel,			// mX wheel delta, 120 per notch
+		FocusGained,
+		FocusLost,
+		Close
+	};
+
+	// Window message translated on the message thread, mTime is the message time in milliseconds
+	struct WindowEvent {
+		WindowEventType mType;
+		uint32_t mCode;
+		int32_t mX;
+		int32_t mY;
+		uint32_t mTime;
+	};
+
+	// Message thread to engine, the message thread drops events rather than wait when it is full
+	using WindowEventQueue = BoundedQueue<WindowEvent>;
+}
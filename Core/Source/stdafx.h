@@ -1,5 +1,7 @@
 #pragma once
 
+// The headless benchmark also builds on platforms without DirectX
+#if defined(_WIN32)
 // DirectX
 #include <d3d12.h>
 #include <dxgi1_4.h>
@@ -13,10 +15,14 @@
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
 #endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
 
 #include <Windows.h>
 #include <wrl/client.h>
 #include <windef.h>
+#endif
 
 // std
 #include <vector>
@@ -0,0 +1,207 @@
+#pragma once
+#include <limits>
+#include <span>
+#include "OMath.h"
+#include "Vector3.h"
+#include "Matrix4x4.h"
+
+namespace OMath {
+	// Axis aligned bounding box. The default box is empty (min > max), merging anything into it gives that thing
+	template <class T>
+	class AABB {
+	public:
+		constexpr AABB();
+		constexpr AABB(const Vector3<T>& min, const Vector3<T>& max);
+		constexpr AABB(const AABB<T>& aabb) = default;
+		~AABB() = default;
+
+		constexpr AABB<T>& operator=(const AABB<T>& aabb) = default;
+
+		static constexpr AABB<T> CreateFromCenterExtents(const Vector3<T>& center, const Vector3<T>& extents);
+
+		// Returns the smallest box around all points, empty if there are none
+		static constexpr AABB<T> CreateFromPoints(std::span<const Vector3<T>> points);
+
+		// Returns false for the empty box
+		constexpr bool IsValid() const;
+
+		constexpr Vector3<T> GetCenter() const;
+
+		// Returns half the size on every axis
+		constexpr Vector3<T> GetExtents() const;
+
+		constexpr Vector3<T> GetSize() const;
+
+		constexpr T GetSurfaceArea() const;
+
+		constexpr T GetVolume() const;
+
+		// Grows the box to contain the point
+		constexpr void Merge(const Vector3<T>& point);
+
+		// Grows the box to contain the given box
+		constexpr void Merge(const AABB<T>& aabb);
+
+		// Returns the box around this and the given box
+		constexpr AABB<T> GetMerged(const AABB<T>& aabb) const;
+
+		// Returns the box around this box transformed as points (w = 1) by the matrix
+		constexpr AABB<T> GetTransformed(const Matrix4x4<T>& transform) const;
+
+		// Returns the point in or on the box closest to the given point
+		constexpr Vector3<T> ClosestPoint(const Vector3<T>& point) const;
+
+		// Returns the squared distance from the point to the box, zero inside
+		constexpr T DistanceSqrd(const Vector3<T>& point) const;
+
+		constexpr bool Contains(const Vector3<T>& point) const;
+		constexpr bool Contains(const AABB<T>& aabb) const;
+
+		// Touching boxes overlap
+		constexpr bool Overlaps(const AABB<T>& aabb) const;
+
+		Vector3<T> mMin;
+		Vector3<T> mMax;
+	};
+
+	template <class T>
+	constexpr AABB<T>::AABB() :
+		mMin(std::numeric_limits<T>::max(), std::numeric_limits<T>::max(), std::numeric_limits<T>::max()),
+		mMax(std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest()) {}
+
+	template <class T>
+	constexpr AABB<T>::AABB(const Vector3<T>& min, const Vector3<T>& max) : mMin(min), mMax(max) {}
+
+	template <class T>
+	constexpr AABB<T> AABB<T>::CreateFromCenterExtents(const Vector3<T>& center, const Vector3<T>& extents) {
+		return { center - extents, center + extents };
+	}
+
+	template <class T>
+	constexpr AABB<T> AABB<T>::CreateFromPoints(std::span<const Vector3<T>> points) {
+		AABB<T> result;
+		for (const Vector3<T>& point : points) {
+			result.Merge(point);
+		}
+		return result;
+	}
+
+	template <class T>
+	constexpr bool AABB<T>::IsValid() const {
+		return mMin.mX <= mMax.mX && mMin.mY <= mMax.mY && mMin.mZ <= mMax.mZ;
+	}
+
+	template <class T>
+	constexpr Vector3<T> AABB<T>::GetCenter() const {
+		return { (mMin.mX + mMax.mX) / 2, (mMin.mY + mMax.mY) / 2, (mMin.mZ + mMax.mZ) / 2 };
+	}
+
+	template <class T>
+	constexpr Vector3<T> AABB<T>::GetExtents() const {
+		return { (mMax.mX - mMin.mX) / 2, (mMax.mY - mMin.mY) / 2, (mMax.mZ - mMin.mZ) / 2 };
+	}
+
+	template <class T>
+	constexpr Vector3<T> AABB<T>::GetSize() const {
+		return mMax - mMin;
+	}
+
+	template <class T>
+	constexpr T AABB<T>::GetSurfaceArea() const {
+		if (!IsValid()) {
+			return 0;
+		}
+		const Vector3<T> size = GetSize();
+		return 2 * (size.mX * size.mY + size.mY * size.mZ + size.mZ * size.mX);
+	}
+
+	template <class T>
+	constexpr T AABB<T>::GetVolume() const {
+		if (!IsValid()) {
+			return 0;
+		}
+		const Vector3<T> size = GetSize();
+		return size.mX * size.mY * size.mZ;
+	}
+
+	template <class T>
+	constexpr void AABB<T>::Merge(const Vector3<T>& point) {
+		mMin = { Min(mMin.mX, point.mX), Min(mMin.mY, point.mY), Min(mMin.mZ, point.mZ) };
+		mMax = { Max(mMax.mX, point.mX), Max(mMax.mY, point.mY), Max(mMax.mZ, point.mZ) };
+	}
+
+	template <class T>
+	constexpr void AABB<T>::Merge(const AABB<T>& aabb) {
+		mMin = { Min(mMin.mX, aabb.mMin.mX), Min(mMin.mY, aabb.mMin.mY), Min(mMin.mZ, aabb.mMin.mZ) };
+		mMax = { Max(mMax.mX, aabb.mMax.mX), Max(mMax.mY, aabb.mMax.mY), Max(mMax.mZ, aabb.mMax.mZ) };
+	}
+
+	template <class T>
+	constexpr AABB<T> AABB<T>::GetMerged(const AABB<T>& aabb) const {
+		AABB<T> result(*this);
+		result.Merge(aabb);
+		return result;
+	}
+
+	template <class T>
+	constexpr AABB<T> AABB<T>::GetTransformed(const Matrix4x4<T>& transform) const {
+		if (!IsValid()) {
+			return *this;
+		}
+
+		// Arvo: the new extents on every axis are the extents projected by the absolute rotation and scale
+		const Vector3<T> center = GetCenter();
+		const Vector3<T> extents = GetExtents();
+		const Matrix4x4<T>& m = transform;
+
+		const Vector3<T> newCenter(
+			center.mX * m(1, 1) + center.mY * m(2, 1) + center.mZ * m(3, 1) + m(4, 1),
+			center.mX * m(1, 2) + center.mY * m(2, 2) + center.mZ * m(3, 2) + m(4, 2),
+			center.mX * m(1, 3) + center.mY * m(2, 3) + center.mZ * m(3, 3) + m(4, 3)
+		);
+		const Vector3<T> newExtents(
+			extents.mX * Abs(m(1, 1)) + extents.mY * Abs(m(2, 1)) + extents.mZ * Abs(m(3, 1)),
+			extents.mX * Abs(m(1, 2)) + extents.mY * Abs(m(2, 2)) + extents.mZ * Abs(m(3, 2)),
+			extents.mX * Abs(m(1, 3)) + extents.mY * Abs(m(2, 3)) + extents.mZ * Abs(m(3, 3))
+		);
+		return CreateFromCenterExtents(newCenter, newExtents);
+	}
+
+	template <class T>
+	constexpr Vector3<T> AABB<T>::ClosestPoint(const Vector3<T>& point) const {
+		return { Clamp(point.mX, mMin.mX, mMax.mX), Clamp(point.mY, mMin.mY, mMax.mY), Clamp(point.mZ, mMin.mZ, mMax.mZ) };
+	}
+
+	template <class T>
+	constexpr T AABB<T>::DistanceSqrd(const Vector3<T>& point) const {
+		return (point - ClosestPoint(point)).LengthSqrd();
+	}
+
+	template <class T>
+	constexpr bool AABB<T>::Contains(const Vector3<T>& point) const {
+		return point.mX >= mMin.mX && point.mX <= mMax.mX &&
+			point.mY >= mMin.mY && point.mY <= mMax.mY &&
+			point.mZ >= mMin.mZ && point.mZ <= mMax.mZ;
+	}
+
+	template <class T>
+	constexpr bool AABB<T>::Contains(const AABB<T>& aabb) const {
+		return aabb.IsValid() && Contains(aabb.mMin) && Contains(aabb.mMax);
+	}
+
+	template <class T>
+	constexpr bool AABB<T>::Overlaps(const AABB<T>& aabb) const {
+		return mMin.mX <= aabb.mMax.mX && mMax.mX >= aabb.mMin.mX &&
+			mMin.mY <= aabb.mMax.mY && mMax.mY >= aabb.mMin.mY &&
+			mMin.mZ <= aabb.mMax.mZ && mMax.mZ >= aabb.mMin.mZ;
+	}
+
+	template <class T>
+	constexpr bool operator==(const AABB<T>& aabb0, const AABB<T>& aabb1) {
+		return aabb0.mMin.mX == aabb1.mMin.mX && aabb0.mMin.mY == aabb1.mMin.mY && aabb0.mMin.mZ == aabb1.mMin.mZ &&
+			aabb0.mMax.mX == aabb1.mMax.mX && aabb0.mMax.mY == aabb1.mMax.mY && aabb0.mMax.mZ == aabb1.mMax.mZ;
+	}
+
+	typedef AABB<float> AABBf;
+	typedef AABB<double> AABBd;
+}
@@ -0,0 +1,425 @@
+#pragma once
+#include <assert.h>
+#include <bit>
+#include <limits>
+#include <span>
+#include <stdint.h>
+#include <vector>
+#include "FloatWide.h"
+#include "VectorWide.h"
+#include "AABB.h"
+#include "Sphere.h"
+
+namespace OMath {
+	// Width AABB<float> stored as structure of arrays, every test returns a lane mask
+	template <int Width>
+	class AABBWide {
+	public:
+		using Float = FloatWide<Width>;
+
+		AABBWide() = default;
+		AABBWide(const Vector3Wide<Width>& min, const Vector3Wide<Width>& max);
+
+		// Transposes count (<= Width) boxes into lanes, the remaining lanes are empty boxes
+		static AABBWide<Width> Gather(const AABB<float>* source, const int count = Width);
+
+		// Every lane that overlaps the box, touching counts
+		Float Overlaps(const AABB<float>& aabb) const;
+
+		// Every lane that overlaps the sphere
+		Float Overlaps(const Sphere<float>& sphere) const;
+
+		// Every lane that contains the point
+		Float Contains(const Vector3<float>& point) const;
+
+		Vector3Wide<Width> mMin;
+		Vector3Wide<Width> mMax;
+	};
+
+	// Width Sphere<float> stored as structure of arrays, every test returns a lane mask
+	template <int Width>
+	class SphereWide {
+	public:
+		using Float = FloatWide<Width>;
+
+		SphereWide() = default;
+		SphereWide(const Vector3Wide<Width>& center, const Float& radius);
+
+		// Transposes count (<= Width) spheres into lanes, the remaining lanes are empty spheres
+		static SphereWide<Width> Gather(const Sphere<float>* source, const int count = Width);
+
+		// Every lane that overlaps the sphere, touching counts
+		Float Overlaps(const Sphere<float>& sphere) const;
+
+		// Every lane that overlaps the box
+		Float Overlaps(const AABB<float>& aabb) const;
+
+		// Every lane that contains the point
+		Float Contains(const Vector3<float>& point) const;
+
+		Vector3Wide<Width> mCenter;
+		Float mRadius;
+	};
+
+	template <int Width>
+	inline AABBWide<Width>::AABBWide(const Vector3Wide<Width>& min, const Vector3Wide<Width>& max) : mMin(min), mMax(max) {}
+
+	template <int Width>
+	inline AABBWide<Width> AABBWide<Width>::Gather(const AABB<float>* source, const int count) {
+		alignas(64) float components[6][Width];
+		for (int lane = 0; lane < Width; ++lane) {
+			const AABB<float> aabb = lane < count ? source[lane] : AABB<float>();
+			components[0][lane] = aabb.mMin.mX;
+			components[1][lane] = aabb.mMin.mY;
+			components[2][lane] = aabb.mMin.mZ;
+			components[3][lane] = aabb.mMax.mX;
+			components[4][lane] = aabb.mMax.mY;
+			components[5][lane] = aabb.mMax.mZ;
+		}
+		return {
+			Vector3Wide<Width>::Load(components[0], components[1], components[2]),
+			Vector3Wide<Width>::Load(components[3], components[4], components[5])
+		};
+	}
+
+	template <int Width>
+	inline typename AABBWide<Width>::Float AABBWide<Width>::Overlaps(const AABB<float>& aabb) const {
+		return (mMin.mX <= Float(aabb.mMax.mX)) & (mMax.mX >= Float(aabb.mMin.mX)) &
+			(mMin.mY <= Float(aabb.mMax.mY)) & (mMax.mY >= Float(aabb.mMin.mY)) &
+			(mMin.mZ <= Float(aabb.mMax.mZ)) & (mMax.mZ >= Float(aabb.mMin.mZ));
+	}
+
+	template <int Width>
+	inline typename AABBWide<Width>::Float AABBWide<Width>::Overlaps(const Sphere<float>& sphere) const {
+		// Distance from the center to every box, the max against zero clamps the center into the box
+		const Vector3Wide<Width> center(sphere.mCenter);
+		const Float zero(0.0f);
+		const Float dx = Max(Max(mMin.mX - center.mX, center.mX - mMax.mX), zero);
+		const Float dy = Max(Max(mMin.mY - center.mY, center.mY - mMax.mY), zero);
+		const Float dz = Max(Max(mMin.mZ - center.mZ, center.mZ - mMax.mZ), zero);
+		const Float distanceSqrd = MulAdd(dz, dz, MulAdd(dy, dy, dx * dx));
+
+		// An empty box has min > max, which the distance alone does not catch
+		const Float valid = sphere.IsValid() ? (mMin.mX <= mMax.mX) & (mMin.mY <= mMax.mY) & (mMin.mZ <= mMax.mZ) : zero;
+		return valid & (distanceSqrd <= Float(sphere.mRadius * sphere.mRadius));
+	}
+
+	template <int Width>
+	inline typename AABBWide<Width>::Float AABBWide<Width>::Contains(const Vector3<float>& point) const {
+		return (mMin.mX <= Float(point.mX)) & (mMax.mX >= Float(point.mX)) &
+			(mMin.mY <= Float(point.mY)) & (mMax.mY >= Float(point.mY)) &
+			(mMin.mZ <= Float(point.mZ)) & (mMax.mZ >= Float(point.mZ));
+	}
+
+	template <int Width>
+	inline SphereWide<Width>::SphereWide(const Vector3Wide<Width>& center, const Float& radius) : mCenter(center), mRadius(radius) {}
+
+	template <int Width>
+	inline SphereWide<Width> SphereWide<Width>::Gather(const Sphere<float>* source, const int count) {
+		alignas(64) float components[4][Width];
+		for (int lane = 0; lane < Width; ++lane) {
+			const Sphere<float> sphere = lane < count ? source[lane] : Sphere<float>();
+			components[0][lane] = sphere.mCenter.mX;
+			components[1][lane] = sphere.mCenter.mY;
+			components[2][lane] = sphere.mCenter.mZ;
+			components[3][lane] = sphere.mRadius;
+		}
+		return { Vector3Wide<Width>::Load(components[0], components[1], components[2]), Float::Load(components[3]) };
+	}
+
+	template <int Width>
+	inline typename SphereWide<Width>::Float SphereWide<Width>::Overlaps(const Sphere<float>& sphere) const {
+		const Float radiusSum = mRadius + Float(sphere.mRadius);
+		const Float distanceSqrd = (mCenter - Vector3Wide<Width>(sphere.mCenter)).LengthSqrd();
+
+		// Both radii have to be valid, a negative sum would pass the squared compare
+		const Float zero(0.0f);
+		return (distanceSqrd <= radiusSum * radiusSum) & (mRadius >= zero) & (Float(sphere.mRadius) >= zero);
+	}
+
+	template <int Width>
+	inline typename SphereWide<Width>::Float SphereWide<Width>::Overlaps(const AABB<float>& aabb) const {
+		const Float zero(0.0f);
+		const Float dx = Max(Max(Float(aabb.mMin.mX) - mCenter.mX, mCenter.mX - Float(aabb.mMax.mX)), zero);
+		const Float dy = Max(Max(Float(aabb.mMin.mY) - mCenter.mY, mCenter.mY - Float(aabb.mMax.mY)), zero);
+		const Float dz = Max(Max(Float(aabb.mMin.mZ) - mCenter.mZ, mCenter.mZ - Float(aabb.mMax.mZ)), zero);
+		const Float distanceSqrd = MulAdd(dz, dz, MulAdd(dy, dy, dx * dx));
+
+		const Float valid = aabb.IsValid() ? (mRadius >= zero) : zero;
+		return valid & (distanceSqrd <= mRadius * mRadius);
+	}
+
+	template <int Width>
+	inline typename SphereWide<Width>::Float SphereWide<Width>::Contains(const Vector3<float>& point) const {
+		const Float distanceSqrd = (mCenter - Vector3Wide<Width>(point)).LengthSqrd();
+		return (distanceSqrd <= mRadius * mRadius) & (mRadius >= Float(0.0f));
+	}
+
+#if defined(OMATH_AVX512)
+	constexpr int sBoundsBatchWidth = 16;
+#elif defined(OMATH_AVX)
+	constexpr int sBoundsBatchWidth = 8;
+#else
+	constexpr int sBoundsBatchWidth = 4;
+#endif
+
+	namespace SIMD {
+		// Appends base + lane for every set bit of the lane mask, returns the new count
+		inline size_t AppendLaneIndices(uint32_t mask, const uint32_t base, uint32_t* indices, size_t count) {
+			while (mask != 0) {
+				indices[count++] = base + static_cast<uint32_t>(std::countr_zero(mask));
+				mask &= mask - 1;
+			}
+			return count;
+		}
+	}
+
+	/*	Many AABB<float> kept as structure of arrays so the queries stream sBoundsBatchWidth boxes per instruction.
+		The arrays are padded with empty boxes to a whole number of the widest batch */
+	class AABBBatch {
+	public:
+		static constexpr size_t sPadding = 16;
+
+		AABBBatch() = default;
+
+		void Reserve(const size_t count);
+		void Clear();
+		size_t Size() const;
+
+		// Returns the index of the added box
+		uint32_t Add(const AABB<float>& aabb);
+		void Set(const uint32_t index, const AABB<float>& aabb);
+		AABB<float> Get(const uint32_t index) const;
+
+		// Loads the Width boxes starting at index, index must be a multiple of Width
+		template <int Width>
+		AABBWide<Width> Load(const size_t index) const;
+
+		// Writes the indices of every box that overlaps the query, returns how many were written.
+		// indices.size() must be >= Size()
+		size_t Overlapping(const AABB<float>& aabb, std::span<uint32_t> indices) const;
+		size_t Overlapping(const Sphere<float>& sphere, std::span<uint32_t> indices) const;
+
+	private:
+		template <class Volume>
+		size_t Collect(const Volume& query, std::span<uint32_t> indices) const;
+
+		void Pad();
+
+		std::vector<float> mMinX;
+		std::vector<float> mMinY;
+		std::vector<float> mMinZ;
+		std::vector<float> mMaxX;
+		std::vector<float> mMaxY;
+		std::vector<float> mMaxZ;
+		size_t mCount = 0;
+	};
+
+	inline void AABBBatch::Reserve(const size_t count) {
+		const size_t padded = (count + sPadding - 1) / sPadding * sPadding;
+		for (std::vector<float>* component : { &mMinX, &mMinY, &mMinZ, &mMaxX, &mMaxY, &mMaxZ }) {
+			component->reserve(padded);
+		}
+	}
+
+	inline void AABBBatch::Clear() {
+		for (std::vector<float>* component : { &mMinX, &mMinY, &mMinZ, &mMaxX, &mMaxY, &mMaxZ }) {
+			component->clear();
+		}
+		mCount = 0;
+	}
+
+	inline size_t AABBBatch::Size() const {
+		return mCount;
+	}
+
+	inline uint32_t AABBBatch::Add(const AABB<float>& aabb) {
+		const uint32_t index = static_cast<uint32_t>(mCount++);
+		Pad();
+		Set(index, aabb);
+		return index;
+	}
+
+	inline void AABBBatch::Set(const uint32_t index, const AABB<float>& aabb) {
+		assert(index < mCount && "Index out of range");
+		mMinX[index] = aabb.mMin.mX;
+		mMinY[index] = aabb.mMin.mY;
+		mMinZ[index] = aabb.mMin.mZ;
+		mMaxX[index] = aabb.mMax.mX;
+		mMaxY[index] = aabb.mMax.mY;
+		mMaxZ[index] = aabb.mMax.mZ;
+	}
+
+	inline AABB<float> AABBBatch::Get(const uint32_t index) const {
+		assert(index < mCount && "Index out of range");
+		return { { mMinX[index], mMinY[index], mMinZ[index] }, { mMaxX[index], mMaxY[index], mMaxZ[index] } };
+	}
+
+	template <int Width>
+	inline AABBWide<Width> AABBBatch::Load(const size_t index) const {
+		using Float = FloatWide<Width>;
+		assert(index % Width == 0 && index < mMinX.size() && "Index has to start a whole batch");
+		return {
+			{ Float::LoadUnaligned(&mMinX[index]), Float::LoadUnaligned(&mMinY[index]), Float::LoadUnaligned(&mMinZ[index]) },
+			{ Float::LoadUnaligned(&mMaxX[index]), Float::LoadUnaligned(&mMaxY[index]), Float::LoadUnaligned(&mMaxZ[index]) }
+		};
+	}
+
+	template <class Volume>
+	inline size_t AABBBatch::Collect(const Volume& query, std::span<uint32_t> indices) const {
+		assert(indices.size() >= mCount && "Index span is too small");
+
+		size_t count = 0;
+		for (size_t index = 0; index < mCount; index += sBoundsBatchWidth) {
+			const uint32_t mask = Load<sBoundsBatchWidth>(index).Overlaps(query).MoveMask();
+			count = SIMD::AppendLaneIndices(mask, static_cast<uint32_t>(index), indices.data(), count);
+		}
+		return count;
+	}
+
+	inline size_t AABBBatch::Overlapping(const AABB<float>& aabb, std::span<uint32_t> indices) const {
+		return Collect(aabb, indices);
+	}
+
+	inline size_t AABBBatch::Overlapping(const Sphere<float>& sphere, std::span<uint32_t> indices) const {
+		return Collect(sphere, indices);
+	}
+
+	inline void AABBBatch::Pad() {
+		const size_t padded = (mCount + sPadding - 1) / sPadding * sPadding;
+		if (mMinX.size() < padded) {
+			const AABB<float> empty;
+			mMinX.resize(padded, empty.mMin.mX);
+			mMinY.resize(padded, empty.mMin.mY);
+			mMinZ.resize(padded, empty.mMin.mZ);
+			mMaxX.resize(padded, empty.mMax.mX);
+			mMaxY.resize(padded, empty.mMax.mY);
+			mMaxZ.resize(padded, empty.mMax.mZ);
+		}
+	}
+
+	/*	Many Sphere<float> kept as structure of arrays so the queries stream sBoundsBatchWidth spheres per instruction.
+		The arrays are padded with empty spheres to a whole number of the widest batch */
+	class SphereBatch {
+	public:
+		static constexpr size_t sPadding = 16;
+
+		SphereBatch() = default;
+
+		void Reserve(const size_t count);
+		void Clear();
+		size_t Size() const;
+
+		// Returns the index of the added sphere
+		uint32_t Add(const Sphere<float>& sphere);
+		void Set(const uint32_t index, const Sphere<float>& sphere);
+		Sphere<float> Get(const uint32_t index) const;
+
+		// Loads the Width spheres starting at index, index must be a multiple of Width
+		template <int Width>
+		SphereWide<Width> Load(const size_t index) const;
+
+		// Writes the indices of every sphere that overlaps the query, returns how many were written.
+		// indices.size() must be >= Size()
+		size_t Overlapping(const Sphere<float>& sphere, std::span<uint32_t> indices) const;
+		size_t Overlapping(const AABB<float>& aabb, std::span<uint32_t> indices) const;
+
+	private:
+		template <class Volume>
+		size_t Collect(const Volume& query, std::span<uint32_t> indices) const;
+
+		void Pad();
+
+		std::vector<float> mCenterX;
+		std::vector<float> mCenterY;
+		std::vector<float> mCenterZ;
+		std::vector<float> mRadius;
+		size_t mCount = 0;
+	};
+
+	inline void SphereBatch::Reserve(const size_t count) {
+		const size_t padded = (count + sPadding - 1) / sPadding * sPadding;
+		for (std::vector<float>* component : { &mCenterX, &mCenterY, &mCenterZ, &mRadius }) {
+			component->reserve(padded);
+		}
+	}
+
+	inline void SphereBatch::Clear() {
+		for (std::vector<float>* component : { &mCenterX, &mCenterY, &mCenterZ, &mRadius }) {
+			component->clear();
+		}
+		mCount = 0;
+	}
+
+	inline size_t SphereBatch::Size() const {
+		return mCount;
+	}
+
+	inline uint32_t SphereBatch::Add(const Sphere<float>& sphere) {
+		const uint32_t index = static_cast<uint32_t>(mCount++);
+		Pad();
+		Set(index, sphere);
+		return index;
+	}
+
+	inline void SphereBatch::Set(const uint32_t index, const Sphere<float>& sphere) {
+		assert(index < mCount && "Index out of range");
+		mCenterX[index] = sphere.mCenter.mX;
+		mCenterY[index] = sphere.mCenter.mY;
+		mCenterZ[index] = sphere.mCenter.mZ;
+		mRadius[index] = sphere.mRadius;
+	}
+
+	inline Sphere<float> SphereBatch::Get(const uint32_t index) const {
+		assert(index < mCount && "Index out of range");
+		return { { mCenterX[index], mCenterY[index], mCenterZ[index] }, mRadius[index] };
+	}
+
+	template <int Width>
+	inline SphereWide<Width> SphereBatch::Load(const size_t index) const {
+		using Float = FloatWide<Width>;
+		assert(index % Width == 0 && index < mCenterX.size() && "Index has to start a whole batch");
+		return {
+			{ Float::LoadUnaligned(&mCenterX[index]), Float::LoadUnaligned(&mCenterY[index]), Float::LoadUnaligned(&mCenterZ[index]) },
+			Float::LoadUnaligned(&mRadius[index])
+		};
+	}
+
+	template <class Volume>
+	inline size_t SphereBatch::Collect(const Volume& query, std::span<uint32_t> indices) const {
+		assert(indices.size() >= mCount && "Index span is too small");
+
+		size_t count = 0;
+		for (size_t index = 0; index < mCount; index += sBoundsBatchWidth) {
+			const uint32_t mask = Load<sBoundsBatchWidth>(index).Overlaps(query).MoveMask();
+			count = SIMD::AppendLaneIndices(mask, static_cast<uint32_t>(index), indices.data(), count);
+		}
+		return count;
+	}
+
+	inline size_t SphereBatch::Overlapping(const Sphere<float>& sphere, std::span<uint32_t> indices) const {
+		return Collect(sphere, indices);
+	}
+
+	inline size_t SphereBatch::Overlapping(const AABB<float>& aabb, std::span<uint32_t> indices) const {
+		return Collect(aabb, indices);
+	}
+
+	inline void SphereBatch::Pad() {
+		const size_t padded = (mCount + sPadding - 1) / sPadding * sPadding;
+		if (mCenterX.size() < padded) {
+			const Sphere<float> empty;
+			mCenterX.resize(padded, empty.mCenter.mX);
+			mCenterY.resize(padded, empty.mCenter.mY);
+			mCenterZ.resize(padded, empty.mCenter.mZ);
+			mRadius.resize(padded, empty.mRadius);
+		}
+	}
+
+	typedef AABBWide<4> AABBfx4;
+	typedef AABBWide<8> AABBfx8;
+	typedef AABBWide<16> AABBfx16;
+	typedef SphereWide<4> Spherefx4;
+	typedef SphereWide<8> Spherefx8;
+	typedef SphereWide<16> Spherefx16;
+}
@@ -0,0 +1,301 @@
+#pragma once
+#include <assert.h>
+#include <cmath>
+#include <span>
+#include "FloatWide.h"
+#include "Matrix4x4.h"
+#include "TransformBatch.h"
+#include "VectorWide.h"
+
+// Polynomial sin/cos for float angles. Both share one range reduction so SinCos costs little more than one of them.
+// The angle is reduced to r in [-pi/4, pi/4] around the nearest multiple of pi/2, the quadrant picks which
+// polynomial and sign ends up in sine and cosine. The error bounds hold for |angle| < 8192, after that the
+// float angle itself is too coarse for the reduction and the error grows with the angle.
+namespace OMath::Fast {
+	enum class Precision {
+		Fast,		// Degree 5/4 polynomials, max error 1.3e-5
+		Accurate	// Degree 7/8 polynomials, max error 1e-7, about one ulp of std::sin/std::cos
+	};
+
+	namespace Detail {
+		constexpr float sTwoOverPi = 0.636619772367581343f;
+
+		// pi / 2 split in three parts (Cody-Waite), the first two have short mantissas so quadrant * part stays exact
+		constexpr float sHalfPi0 = 1.5703125f;
+		constexpr float sHalfPi1 = 4.837512969970703125e-4f;
+		constexpr float sHalfPi2 = 7.54978995489188216e-8f;
+
+		inline float MulAdd(const float a, const float b, const float c) {
+			return a * b + c;
+		}
+
+		// Minimax fits on [-pi/4, pi/4], Float is float or FloatWide
+		template <Precision P, class Float>
+		inline void SinCosPolynomial(const Float& r, Float& sine, Float& cosine) {
+			const Float rSqrd = r * r;
+			if constexpr (P == Precision::Fast) {
+				sine = MulAdd(r * rSqrd, MulAdd(rSqrd, Float(8.152992341813778e-3f), Float(-1.6662833806931746e-1f)), r);
+				cosine = MulAdd(rSqrd, MulAdd(rSqrd, Float(4.048893584359353e-2f), Float(-4.9977630707616877e-1f)), Float(1.0f));
+			} else {
+				Float sinePolynomial = MulAdd(rSqrd, Float(-1.9566919992485378e-4f), Float(8.332647186978275e-3f));
+				sinePolynomial = MulAdd(rSqrd, sinePolynomial, Float(-1.6666664413349797e-1f));
+				sine = MulAdd(r * rSqrd, sinePolynomial, r);
+
+				Float cosinePolynomial = MulAdd(rSqrd, Float(2.4438451607468536e-5f), Float(-1.3887367515867167e-3f));
+				cosinePolynomial = MulAdd(rSqrd, cosinePolynomial, Float(4.16666468664454e-2f));
+				cosine = MulAdd(rSqrd * rSqrd, cosinePolynomial, MulAdd(rSqrd, Float(-0.5f), Float(1.0f)));
+			}
+		}
+	}
+
+	// Writes sin(angle) and cos(angle)
+	template <Precision P = Precision::Accurate>
+	inline void SinCos(const float angleInRadians, float& sine, float& cosine) {
+		// Rounded and reduced mod 4 as floats, converting the quadrant itself to int overflows for large angles.
+		// NaN and infinity skip the conversion and give NaN either way
+		const float quadrantFloat = std::nearbyint(angleInRadians * Detail::sTwoOverPi);
+		const float quadrantMod4 = quadrantFloat - 4.0f * std::floor(quadrantFloat * 0.25f);
+		const int quadrant = quadrantMod4 >= 0.0f && quadrantMod4 < 4.0f ? static_cast<int>(quadrantMod4) : 0;
+		const float r = ((angleInRadians - quadrantFloat * Detail::sHalfPi0) - quadrantFloat * Detail::sHalfPi1) - quadrantFloat * Detail::sHalfPi2;
+
+		float s;
+		float c;
+		Detail::SinCosPolynomial<P>(r, s, c);
+
+		switch (quadrant & 3) {
+		case 0:
+			sine = s;
+			cosine = c;
+			break;
+		case 1:
+			sine = c;
+			cosine = -s;
+			break;
+		case 2:
+			sine = -s;
+			cosine = -c;
+			break;
+		default:
+			sine = -c;
+			cosine = s;
+			break;
+		}
+	}
+
+	// Writes sin(angle) and cos(angle) for every lane, only float compares and selects so every width works
+	template <Precision P = Precision::Accurate, int Width>
+	inline void SinCos(const FloatWide<Width>& angleInRadians, FloatWide<Width>& sine, FloatWide<Width>& cosine) {
+		using Float = FloatWide<Width>;
+
+		// Adding and subtracting 1.5 * 2^23 rounds to the nearest integer
+		const Float roundMagic(12582912.0f);
+		const Float quadrant = (angleInRadians * Float(Detail::sTwoOverPi) + roundMagic) - roundMagic;
+		const Float r = MulAdd(quadrant, Float(-Detail::sHalfPi2), MulAdd(quadrant, Float(-Detail::sHalfPi1), MulAdd(quadrant, Float(-Detail::sHalfPi0), angleInRadians)));
+
+		Float s;
+		Float c;
+		Detail::SinCosPolynomial<P>(r, s, c);
+
+		// quadrant mod 4 as 0, 1, 2 or 3, floor(q / 4) is round(q / 4 - 3 / 8) for integer q
+		const Float quadrantDiv4 = (MulAdd(quadrant, Float(0.25f), Float(-0.375f)) + roundMagic) - roundMagic;
+		const Float quadrantIndex = quadrant - quadrantDiv4 * Float(4.0f);
+
+		const Float swap = ((quadrantIndex > Float(0.5f)) & (quadrantIndex < Float(1.5f))) | (quadrantIndex > Float(2.5f));
+		const Float negateSine = quadrantIndex > Float(1.5f);
+		const Float negateCosine = (quadrantIndex > Float(0.5f)) & (quadrantIndex < Float(2.5f));
+
+		sine = Select(swap, c, s);
+		cosine = Select(swap, s, c);
+		sine = Select(negateSine, -sine, sine);
+		cosine = Select(negateCosine, -cosine, cosine);
+	}
+
+	template <Precision P = Precision::Accurate>
+	inline float Sin(const float angleInRadians) {
+		float sine;
+		float cosine;
+		SinCos<P>(angleInRadians, sine, cosine);
+		return sine;
+	}
+
+	template <Precision P = Precision::Accurate>
+	inline float Cos(const float angleInRadians) {
+		float sine;
+		float cosine;
+		SinCos<P>(angleInRadians, sine, cosine);
+		return cosine;
+	}
+
+	template <Precision P = Precision::Accurate, int Width>
+	inline FloatWide<Width> Sin(const FloatWide<Width>& angleInRadians) {
+		FloatWide<Width> sine;
+		FloatWide<Width> cosine;
+		SinCos<P>(angleInRadians, sine, cosine);
+		return sine;
+	}
+
+	template <Precision P = Precision::Accurate, int Width>
+	inline FloatWide<Width> Cos(const FloatWide<Width>& angleInRadians) {
+		FloatWide<Width> sine;
+		FloatWide<Width> cosine;
+		SinCos<P>(angleInRadians, sine, cosine);
+		return cosine;
+	}
+
+	// Writes sin and cos of every angle, the spans must be at least as long as angles
+	template <Precision P = Precision::Accurate>
+	inline void SinCos(std::span<const float> angles, std::span<float> sines, std::span<float> cosines) {
+		constexpr int width = sTransformBatchWidth > 1 ? sTransformBatchWidth : 4;
+		assert(sines.size() >= angles.size() && cosines.size() >= angles.size() && "Output span is too small");
+
+		const size_t count = angles.size();
+		size_t index = 0;
+		for (; index + width <= count; index += width) {
+			FloatWide<width> sine;
+			FloatWide<width> cosine;
+			SinCos<P>(FloatWide<width>::LoadUnaligned(&angles[index]), sine, cosine);
+			sine.StoreUnaligned(&sines[index]);
+			cosine.StoreUnaligned(&cosines[index]);
+		}
+		for (; index < count; ++index) {
+			SinCos<P>(angles[index], sines[index], cosines[index]);
+		}
+	}
+
+	//*********************************************************************************
+	//	Rotation builders, same results as the Matrix4x4 ones within the chosen precision
+	//*********************************************************************************
+
+	template <Precision P = Precision::Accurate>
+	inline Matrix4x4<float> CreateRotationAroundX(const float angleInRadians) {
+		float sine;
+		float cosine;
+		SinCos<P>(angleInRadians, sine, cosine);
+
+		Matrix4x4<float> temp;
+		temp(2, 2) = cosine;
+		temp(2, 3) = sine;
+		temp(3, 2) = -sine;
+		temp(3, 3) = cosine;
+
+		return temp;
+	}
+
+	template <Precision P = Precision::Accurate>
+	inline Matrix4x4<float> CreateRotationAroundY(const float angleInRadians) {
+		float sine;
+		float cosine;
+		SinCos<P>(angleInRadians, sine, cosine);
+
+		Matrix4x4<float> temp;
+		temp(1, 1) = cosine;
+		temp(1, 3) = -sine;
+		temp(3, 1) = sine;
+		temp(3, 3) = cosine;
+
+		return temp;
+	}
+
+	template <Precision P = Precision::Accurate>
+	inline Matrix4x4<float> CreateRotationAroundZ(const float angleInRadians) {
+		float sine;
+		float cosine;
+		SinCos<P>(angleInRadians, sine, cosine);
+
+		Matrix4x4<float> temp;
+		temp(1, 1) = cosine;
+		temp(1, 2) = sine;
+		temp(2, 1) = -sine;
+		temp(2, 2) = cosine;
+
+		return temp;
+	}
+
+	/*	Same order as Matrix4x4::CreateRotationMatrix
+		x - pitch
+		y - yaw
+		z - roll */
+	template <Precision P = Precision::Accurate>
+	inline Matrix4x4<float> CreateRotationMatrix(const Vector3<float>& rotationVector) {
+		// All three angles go through one 4 wide SinCos
+		FloatWide<4> sine;
+		FloatWide<4> cosine;
+		alignas(16) const float angles[4] = { rotationVector.mX, rotationVector.mY, rotationVector.mZ, 0.0f };
+		SinCos<P>(FloatWide<4>::Load(angles), sine, cosine);
+
+		const float sp = sine[0];
+		const float sy = sine[1];
+		const float sr = sine[2];
+		const float cp = cosine[0];
+		const float cy = cosine[1];
+		const float cr = cosine[2];
+
+		Matrix4x4<float> result;
+		result(1, 1) = cr * cy + sr * sp * sy;
+		result(1, 2) = sr * cp;
+		result(1, 3) = sr * sp * cy - cr * sy;
+
+		result(2, 1) = cr * sp * sy - sr * cy;
+		result(2, 2) = cr * cp;
+		result(2, 3) = sr * sy + cr * sp * cy;
+
+		result(3, 1) = cp * sy;
+		result(3, 2) = -sp;
+		result(3, 3) = cp * cy;
+
+		return result;
+	}
+
+	// Builds CreateRotationMatrix(rotations[i]) into output[i], Width rotations at a time
+	template <Precision P = Precision::Accurate>
+	inline void CreateRotationMatrices(std::span<const Vector3<float>> rotations, std::span<Matrix4x4<float>> output) {
+		constexpr int width = sTransformBatchWidth > 1 ? sTransformBatchWidth : 4;
+		using Float = FloatWide<width>;
+		assert(output.size() >= rotations.size() && "Output span is too small");
+
+		const size_t count = rotations.size();
+		for (size_t index = 0; index < count; index += width) {
+			const int lanes = static_cast<int>(count - index < width ? count - index : width);
+			const Vector3Wide<width> angles = Vector3Wide<width>::Gather(&rotations[index], lanes);
+
+			Float sp, cp, sy, cy, sr, cr;
+			SinCos<P>(angles.mX, sp, cp);
+			SinCos<P>(angles.mY, sy, cy);
+			SinCos<P>(angles.mZ, sr, cr);
+
+			const Float srsp = sr * sp;
+			const Float crsp = cr * sp;
+
+			alignas(64) float elements[9][width];
+			MulAdd(srsp, sy, cr * cy).Store(elements[0]);
+			(sr * cp).Store(elements[1]);
+			MulAdd(srsp, cy, -(cr * sy)).Store(elements[2]);
+			MulAdd(crsp, sy, -(sr * cy)).Store(elements[3]);
+			(cr * cp).Store(elements[4]);
+			MulAdd(crsp, cy, sr * sy).Store(elements[5]);
+			(cp * sy).Store(elements[6]);
+			(-sp).Store(elements[7]);
+			(cp * cy).Store(elements[8]);
+
+			for (int lane = 0; lane < lanes; ++lane) {
+				float* out = output[index + lane].Data();
+				out[0] = elements[0][lane];
+				out[1] = elements[1][lane];
+				out[2] = elements[2][lane];
+				out[3] = 0.0f;
+				out[4] = elements[3][lane];
+				out[5] = elements[4][lane];
+				out[6] = elements[5][lane];
+				out[7] = 0.0f;
+				out[8] = elements[6][lane];
+				out[9] = elements[7][lane];
+				out[10] = elements[8][lane];
+				out[11] = 0.0f;
+				out[12] = 0.0f;
+				out[13] = 0.0f;
+				out[14] = 0.0f;
+				out[15] = 1.0f;
+			}
+		}
+	}
+}
@@ -0,0 +1,400 @@
+#pragma once
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include "SIMD.h"
+
+#if defined(OMATH_SSE) && defined(__AVX512F__)
+#define OMATH_AVX512 1
+#endif
+
+namespace OMath::SIMD {
+	// Register operations for a given lane count. The generic version works on plain
+	// arrays and is left for the compiler to vectorize, the specializations below map
+	// directly onto SSE/AVX/AVX-512 registers. Comparisons return all-bits-set lanes.
+	template <int Width>
+	struct WideTraits {
+		struct Register {
+			alignas(Width * sizeof(float)) float mLanes[Width];
+		};
+
+		template <class Operation>
+		static Register Apply(const Register& a, const Register& b, Operation operation) {
+			Register result;
+			for (int lane = 0; lane < Width; ++lane) {
+				result.mLanes[lane] = operation(a.mLanes[lane], b.mLanes[lane]);
+			}
+			return result;
+		}
+
+		static float FromMask(const bool value) { return std::bit_cast<float>(value ? 0xFFFFFFFFu : 0u); }
+		static uint32_t Bits(const float value) { return std::bit_cast<uint32_t>(value); }
+
+		static Register Zero() { return Broadcast(0.0f); }
+		static Register Broadcast(const float value) {
+			Register result;
+			for (int lane = 0; lane < Width; ++lane) {
+				result.mLanes[lane] = value;
+			}
+			return result;
+		}
+		static Register Load(const float* source) { return LoadUnaligned(source); }
+		static Register LoadUnaligned(const float* source) {
+			Register result;
+			for (int lane = 0; lane < Width; ++lane) {
+				result.mLanes[lane] = source[lane];
+			}
+			return result;
+		}
+		static void Store(float* destination, const Register& value) { StoreUnaligned(destination, value); }
+		static void StoreUnaligned(float* destination, const Register& value) {
+			for (int lane = 0; lane < Width; ++lane) {
+				destination[lane] = value.mLanes[lane];
+			}
+		}
+		static float Lane(const Register& value, const int lane) { return value.mLanes[lane]; }
+
+		static Register Add(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return x + y; }); }
+		static Register Sub(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return x - y; }); }
+		static Register Mul(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return x * y; }); }
+		static Register Div(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return x / y; }); }
+		static Register MulAdd(const Register& a, const Register& b, const Register& c) { return Add(Mul(a, b), c); }
+		static Register Min(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return x < y ? x : y; }); }
+		static Register Max(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return x > y ? x : y; }); }
+		static Register Sqrt(const Register& a) {
+			Register result;
+			for (int lane = 0; lane < Width; ++lane) {
+				result.mLanes[lane] = std::sqrt(a.mLanes[lane]);
+			}
+			return result;
+		}
+
+		static Register Less(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return FromMask(x < y); }); }
+		static Register LessEqual(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return FromMask(x <= y); }); }
+		static Register Greater(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return FromMask(x > y); }); }
+		static Register GreaterEqual(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return FromMask(x >= y); }); }
+		static Register Equal(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return FromMask(x == y); }); }
+
+		static Register And(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return std::bit_cast<float>(Bits(x) & Bits(y)); }); }
+		static Register Or(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return std::bit_cast<float>(Bits(x) | Bits(y)); }); }
+		static Register Xor(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return std::bit_cast<float>(Bits(x) ^ Bits(y)); }); }
+		static Register AndNot(const Register& a, const Register& b) { return Apply(a, b, [](float x, float y) { return std::bit_cast<float>(~Bits(x) & Bits(y)); }); }
+
+		static uint32_t MoveMask(const Register& value) {
+			uint32_t mask = 0;
+			for (int lane = 0; lane < Width; ++lane) {
+				mask |= (Bits(value.mLanes[lane]) >> 31) << lane;
+			}
+			return mask;
+		}
+	};
+
+#ifdef OMATH_SSE
+	template <>
+	struct WideTraits<4> {
+		using Register = __m128;
+
+		static Register Zero() { return _mm_setzero_ps(); }
+		static Register Broadcast(const float value) { return _mm_set1_ps(value); }
+		static Register Load(const float* source) { return _mm_load_ps(source); }
+		static Register LoadUnaligned(const float* source) { return _mm_loadu_ps(source); }
+		static void Store(float* destination, const Register value) { _mm_store_ps(destination, value); }
+		static void StoreUnaligned(float* destination, const Register value) { _mm_storeu_ps(destination, value); }
+		static float Lane(const Register value, const int lane) {
+			alignas(16) float lanes[4];
+			_mm_store_ps(lanes, value);
+			return lanes[lane];
+		}
+
+		static Register Add(const Register a, const Register b) { return _mm_add_ps(a, b); }
+		static Register Sub(const Register a, const Register b) { return _mm_sub_ps(a, b); }
+		static Register Mul(const Register a, const Register b) { return _mm_mul_ps(a, b); }
+		static Register Div(const Register a, const Register b) { return _mm_div_ps(a, b); }
+		static Register MulAdd(const Register a, const Register b, const Register c) { return SIMD::MulAdd(a, b, c); }
+		static Register Min(const Register a, const Register b) { return _mm_min_ps(a, b); }
+		static Register Max(const Register a, const Register b) { return _mm_max_ps(a, b); }
+		static Register Sqrt(const Register a) { return _mm_sqrt_ps(a); }
+
+		static Register Less(const Register a, const Register b) { return _mm_cmplt_ps(a, b); }
+		static Register LessEqual(const Register a, const Register b) { return _mm_cmple_ps(a, b); }
+		static Register Greater(const Register a, const Register b) { return _mm_cmpgt_ps(a, b); }
+		static Register GreaterEqual(const Register a, const Register b) { return _mm_cmpge_ps(a, b); }
+		static Register Equal(const Register a, const Register b) { return _mm_cmpeq_ps(a, b); }
+
+		static Register And(const Register a, const Register b) { return _mm_and_ps(a, b); }
+		static Register Or(const Register a, const Register b) { return _mm_or_ps(a, b); }
+		static Register Xor(const Register a, const Register b) { return _mm_xor_ps(a, b); }
+		static Register AndNot(const Register a, const Register b) { return _mm_andnot_ps(a, b); }
+
+		static uint32_t MoveMask(const Register value) { return static_cast<uint32_t>(_mm_movemask_ps(value)); }
+	};
+#endif
+
+#ifdef OMATH_AVX
+	template <>
+	struct WideTraits<8> {
+		using Register = __m256;
+
+		static Register Zero() { return _mm256_setzero_ps(); }
+		static Register Broadcast(const float value) { return _mm256_set1_ps(value); }
+		static Register Load(const float* source) { return _mm256_load_ps(source); }
+		static Register LoadUnaligned(const float* source) { return _mm256_loadu_ps(source); }
+		static void Store(float* destination, const Register value) { _mm256_store_ps(destination, value); }
+		static void StoreUnaligned(float* destination, const Register value) { _mm256_storeu_ps(destination, value); }
+		static float Lane(const Register value, const int lane) {
+			alignas(32) float lanes[8];
+			_mm256_store_ps(lanes, value);
+			return lanes[lane];
+		}
+
+		static Register Add(const Register a, const Register b) { return _mm256_add_ps(a, b); }
+		static Register Sub(const Register a, const Register b) { return _mm256_sub_ps(a, b); }
+		static Register Mul(const Register a, const Register b) { return _mm256_mul_ps(a, b); }
+		static Register Div(const Register a, const Register b) { return _mm256_div_ps(a, b); }
+		static Register MulAdd(const Register a, const Register b, const Register c) { return SIMD::MulAdd(a, b, c); }
+		static Register Min(const Register a, const Register b) { return _mm256_min_ps(a, b); }
+		static Register Max(const Register a, const Register b) { return _mm256_max_ps(a, b); }
+		static Register Sqrt(const Register a) { return _mm256_sqrt_ps(a); }
+
+		static Register Less(const Register a, const Register b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		static Register LessEqual(const Register a, const Register b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+		static Register Greater(const Register a, const Register b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+		static Register GreaterEqual(const Register a, const Register b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+		static Register Equal(const Register a, const Register b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+
+		static Register And(const Register a, const Register b) { return _mm256_and_ps(a, b); }
+		static Register Or(const Register a, const Register b) { return _mm256_or_ps(a, b); }
+		static Register Xor(const Register a, const Register b) { return _mm256_xor_ps(a, b); }
+		static Register AndNot(const Register a, const Register b) { return _mm256_andnot_ps(a, b); }
+
+		static uint32_t MoveMask(const Register value) { return static_cast<uint32_t>(_mm256_movemask_ps(value)); }
+	};
+#endif
+
+#ifdef OMATH_AVX512
+	template <>
+	struct WideTraits<16> {
+		using Register = __m512;
+
+		static Register FromMask(const __mmask16 mask) { return _mm512_castsi512_ps(_mm512_maskz_set1_epi32(mask, -1)); }
+		static __mmask16 ToMask(const Register value) { return _mm512_cmplt_epi32_mask(_mm512_castps_si512(value), _mm512_setzero_si512()); }
+
+		static Register Zero() { return _mm512_setzero_ps(); }
+		static Register Broadcast(const float value) { return _mm512_set1_ps(value); }
+		static Register Load(const float* source) { return _mm512_load_ps(source); }
+		static Register LoadUnaligned(const float* source) { return _mm512_loadu_ps(source); }
+		static void Store(float* destination, const Register value) { _mm512_store_ps(destination, value); }
+		static void StoreUnaligned(float* destination, const Register value) { _mm512_storeu_ps(destination, value); }
+		static float Lane(const Register value, const int lane) {
+			alignas(64) float lanes[16];
+			_mm512_store_ps(lanes, value);
+			return lanes[lane];
+		}
+
+		static Register Add(const Register a, const Register b) { return _mm512_add_ps(a, b); }
+		static Register Sub(const Register a, const Register b) { return _mm512_sub_ps(a, b); }
+		static Register Mul(const Register a, const Register b) { return _mm512_mul_ps(a, b); }
+		static Register Div(const Register a, const Register b) { return _mm512_div_ps(a, b); }
+		static Register MulAdd(const Register a, const Register b, const Register c) { return _mm512_fmadd_ps(a, b, c); }
+		static Register Min(const Register a, const Register b) { return _mm512_min_ps(a, b); }
+		static Register Max(const Register a, const Register b) { return _mm512_max_ps(a, b); }
+		static Register Sqrt(const Register a) { return _mm512_sqrt_ps(a); }
+
+		static Register Less(const Register a, const Register b) { return FromMask(_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ)); }
+		static Register LessEqual(const Register a, const Register b) { return FromMask(_mm512_cmp_ps_mask(a, b, _CMP_LE_OQ)); }
+		static Register Greater(const Register a, const Register b) { return FromMask(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ)); }
+		static Register GreaterEqual(const Register a, const Register b) { return FromMask(_mm512_cmp_ps_mask(a, b, _CMP_GE_OQ)); }
+		static Register Equal(const Register a, const Register b) { return FromMask(_mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ)); }
+
+		static Register And(const Register a, const Register b) { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a), _mm512_castps_si512(b))); }
+		static Register Or(const Register a, const Register b) { return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(a), _mm512_castps_si512(b))); }
+		static Register Xor(const Register a, const Register b) { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_castps_si512(b))); }
+		static Register AndNot(const Register a, const Register b) { return _mm512_castsi512_ps(_mm512_andnot_si512(_mm512_castps_si512(a), _mm512_castps_si512(b))); }
+
+		static uint32_t MoveMask(const Register value) { return static_cast<uint32_t>(ToMask(value)); }
+	};
+#endif
+}
+
+namespace OMath {
+	// Width floats processed as one value. Maps to a single register when the
+	// target supports that width, otherwise to a plain array.
+	template <int Width>
+	class FloatWide {
+	public:
+		using Traits = SIMD::WideTraits<Width>;
+		using Register = typename Traits::Register;
+
+		static constexpr int sWidth = Width;
+
+		FloatWide();
+		FloatWide(const float value);
+		explicit FloatWide(const Register& value);
+		FloatWide(const FloatWide<Width>& value) = default;
+		~FloatWide() = default;
+
+		FloatWide<Width>& operator=(const FloatWide<Width>& value) = default;
+
+		// Loads Width floats from an address aligned to Width * sizeof(float)
+		static FloatWide<Width> Load(const float* source);
+		static FloatWide<Width> LoadUnaligned(const float* source);
+
+		// Stores Width floats to an address aligned to Width * sizeof(float)
+		void Store(float* destination) const;
+		void StoreUnaligned(float* destination) const;
+
+		// Returns a single lane, slow, meant for tails and debugging
+		float operator[](const int lane) const;
+
+		// Returns a bit per lane, set where the sign bit (or comparison mask) is set
+		uint32_t MoveMask() const;
+
+		Register mValue;
+	};
+
+	template <int Width>
+	inline FloatWide<Width>::FloatWide() : mValue(Traits::Zero()) {}
+
+	template <int Width>
+	inline FloatWide<Width>::FloatWide(const float value) : mValue(Traits::Broadcast(value)) {}
+
+	template <int Width>
+	inline FloatWide<Width>::FloatWide(const Register& value) : mValue(value) {}
+
+	template <int Width>
+	inline FloatWide<Width> FloatWide<Width>::Load(const float* source) {
+		return FloatWide<Width>(Traits::Load(source));
+	}
+
+	template <int Width>
+	inline FloatWide<Width> FloatWide<Width>::LoadUnaligned(const float* source) {
+		return FloatWide<Width>(Traits::LoadUnaligned(source));
+	}
+
+	template <int Width>
+	inline void FloatWide<Width>::Store(float* destination) const {
+		Traits::Store(destination, mValue);
+	}
+
+	template <int Width>
+	inline void FloatWide<Width>::StoreUnaligned(float* destination) const {
+		Traits::StoreUnaligned(destination, mValue);
+	}
+
+	template <int Width>
+	inline float FloatWide<Width>::operator[](const int lane) const {
+		return Traits::Lane(mValue, lane);
+	}
+
+	template <int Width>
+	inline uint32_t FloatWide<Width>::MoveMask() const {
+		return Traits::MoveMask(mValue);
+	}
+
+	template <int Width>
+	FloatWide<Width> operator+(const FloatWide<Width>& value0, const FloatWide<Width>& value1) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::Add(value0.mValue, value1.mValue));
+	}
+
+	template <int Width>
+	FloatWide<Width> operator-(const FloatWide<Width>& value0, const FloatWide<Width>& value1) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::Sub(value0.mValue, value1.mValue));
+	}
+
+	template <int Width>
+	FloatWide<Width> operator-(const FloatWide<Width>& value) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::Xor(value.mValue, FloatWide<Width>(-0.0f).mValue));
+	}
+
+	template <int Width>
+	FloatWide<Width> operator*(const FloatWide<Width>& value0, const FloatWide<Width>& value1) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::Mul(value0.mValue, value1.mValue));
+	}
+
+	template <int Width>
+	FloatWide<Width> operator/(const FloatWide<Width>& value0, const FloatWide<Width>& value1) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::Div(value0.mValue, value1.mValue));
+	}
+
+	template <int Width>
+	void operator+=(FloatWide<Width>& value0, const FloatWide<Width>& value1) {
+		value0 = value0 + value1;
+	}
+
+	template <int Width>
+	void operator-=(FloatWide<Width>& value0, const FloatWide<Width>& value1) {
+		value0 = value0 - value1;
+	}
+
+	template <int Width>
+	void operator*=(FloatWide<Width>& value0, const FloatWide<Width>& value1) {
+		value0 = value0 * value1;
+	}
+
+	template <int Width>
+	FloatWide<Width> operator<(const FloatWide<Width>& value0, const FloatWide<Width>& value1) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::Less(value0.mValue, value1.mValue));
+	}
+
+	template <int Width>
+	FloatWide<Width> operator<=(const FloatWide<Width>& value0, const FloatWide<Width>& value1) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::LessEqual(value0.mValue, value1.mValue));
+	}
+
+	template <int Width>
+	FloatWide<Width> operator>(const FloatWide<Width>& value0, const FloatWide<Width>& value1) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::Greater(value0.mValue, value1.mValue));
+	}
+
+	template <int Width>
+	FloatWide<Width> operator>=(const FloatWide<Width>& value0, const FloatWide<Width>& value1) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::GreaterEqual(value0.mValue, value1.mValue));
+	}
+
+	template <int Width>
+	FloatWide<Width> operator&(const FloatWide<Width>& value0, const FloatWide<Width>& value1) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::And(value0.mValue, value1.mValue));
+	}
+
+	template <int Width>
+	FloatWide<Width> operator|(const FloatWide<Width>& value0, const FloatWide<Width>& value1) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::Or(value0.mValue, value1.mValue));
+	}
+
+	// Returns a * b + c, fused where supported
+	template <int Width>
+	FloatWide<Width> MulAdd(const FloatWide<Width>& a, const FloatWide<Width>& b, const FloatWide<Width>& c) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::MulAdd(a.mValue, b.mValue, c.mValue));
+	}
+
+	template <int Width>
+	FloatWide<Width> Min(const FloatWide<Width>& first, const FloatWide<Width>& second) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::Min(first.mValue, second.mValue));
+	}
+
+	template <int Width>
+	FloatWide<Width> Max(const FloatWide<Width>& first, const FloatWide<Width>& second) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::Max(first.mValue, second.mValue));
+	}
+
+	template <int Width>
+	FloatWide<Width> Abs(const FloatWide<Width>& value) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::AndNot(FloatWide<Width>(-0.0f).mValue, value.mValue));
+	}
+
+	template <int Width>
+	FloatWide<Width> Sqrt(const FloatWide<Width>& value) {
+		return FloatWide<Width>(FloatWide<Width>::Traits::Sqrt(value.mValue));
+	}
+
+	// Picks ifTrue where the mask lane is set, otherwise ifFalse
+	template <int Width>
+	FloatWide<Width> Select(const FloatWide<Width>& mask, const FloatWide<Width>& ifTrue, const FloatWide<Width>& ifFalse) {
+		using Traits = typename FloatWide<Width>::Traits;
+		return FloatWide<Width>(Traits::Or(Traits::And(mask.mValue, ifTrue.mValue), Traits::AndNot(mask.mValue, ifFalse.mValue)));
+	}
+
+	typedef FloatWide<4> Floatx4;
+	typedef FloatWide<8> Floatx8;
+	typedef FloatWide<16> Floatx16;
+}
@@ -0,0 +1,229 @@
+#pragma once
+#include <assert.h>
+#include <span>
+#include <stdint.h>
+#include "OMath.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4x4.h"
+#include "AABB.h"
+#include "Sphere.h"
+#include "BoundsWide.h"
+
+namespace OMath {
+	// Six planes bounding a view volume. Every plane is (normal, distance) with the normal pointing inwards,
+	// a point p is inside when dot(normal, p) + distance >= 0 for all of them
+	template <class T>
+	class Frustum {
+	public:
+		enum Plane {
+			Left,
+			Right,
+			Bottom,
+			Top,
+			Near,
+			Far,
+			PlaneCount
+		};
+
+		constexpr Frustum();
+		constexpr Frustum(const Frustum<T>& frustum) = default;
+		~Frustum() = default;
+
+		constexpr Frustum<T>& operator=(const Frustum<T>& frustum) = default;
+
+		/*	Gribb/Hartmann extraction for row vectors (v * M) and D3D clip space, 0 <= z <= w.
+			The planes are normalized so distances are in world units */
+		static constexpr Frustum<T> CreateFromViewProjection(const Matrix4x4<T>& viewProjection);
+
+		// Signed distance from the plane to the point, negative outside
+		constexpr T Distance(const Plane plane, const Vector3<T>& point) const;
+
+		constexpr bool Contains(const Vector3<T>& point) const;
+
+		// Conservative, volumes near a corner of the frustum can pass without being inside
+		constexpr bool Intersects(const Sphere<T>& sphere) const;
+		constexpr bool Intersects(const AABB<T>& aabb) const;
+
+		Vector4<T> mPlanes[PlaneCount];
+	};
+
+	template <class T>
+	constexpr Frustum<T>::Frustum() : mPlanes{} {}
+
+	template <class T>
+	constexpr Frustum<T> Frustum<T>::CreateFromViewProjection(const Matrix4x4<T>& viewProjection) {
+		// Clip coordinate c is dot((x, y, z, 1), column c)
+		const Matrix4x4<T>& m = viewProjection;
+		const Vector4<T> columnX(m(1, 1), m(2, 1), m(3, 1), m(4, 1));
+		const Vector4<T> columnY(m(1, 2), m(2, 2), m(3, 2), m(4, 2));
+		const Vector4<T> columnZ(m(1, 3), m(2, 3), m(3, 3), m(4, 3));
+		const Vector4<T> columnW(m(1, 4), m(2, 4), m(3, 4), m(4, 4));
+
+		Frustum<T> result;
+		result.mPlanes[Left] = columnW + columnX;
+		result.mPlanes[Right] = columnW - columnX;
+		result.mPlanes[Bottom] = columnW + columnY;
+		result.mPlanes[Top] = columnW - columnY;
+		result.mPlanes[Near] = columnZ;
+		result.mPlanes[Far] = columnW - columnZ;
+
+		for (Vector4<T>& plane : result.mPlanes) {
+			const T length = Sqrt(plane.mX * plane.mX + plane.mY * plane.mY + plane.mZ * plane.mZ);
+			if (length != 0) {
+				plane = { plane.mX / length, plane.mY / length, plane.mZ / length, plane.mW / length };
+			}
+		}
+		return result;
+	}
+
+	template <class T>
+	constexpr T Frustum<T>::Distance(const Plane plane, const Vector3<T>& point) const {
+		const Vector4<T>& p = mPlanes[plane];
+		return p.mX * point.mX + p.mY * point.mY + p.mZ * point.mZ + p.mW;
+	}
+
+	template <class T>
+	constexpr bool Frustum<T>::Contains(const Vector3<T>& point) const {
+		for (int plane = 0; plane < PlaneCount; ++plane) {
+			if (Distance(static_cast<Plane>(plane), point) < 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template <class T>
+	constexpr bool Frustum<T>::Intersects(const Sphere<T>& sphere) const {
+		if (!sphere.IsValid()) {
+			return false;
+		}
+		for (int plane = 0; plane < PlaneCount; ++plane) {
+			if (Distance(static_cast<Plane>(plane), sphere.mCenter) < -sphere.mRadius) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template <class T>
+	constexpr bool Frustum<T>::Intersects(const AABB<T>& aabb) const {
+		if (!aabb.IsValid()) {
+			return false;
+		}
+		// Only the corner furthest along the normal has to be checked
+		for (const Vector4<T>& plane : mPlanes) {
+			const Vector3<T> corner(
+				plane.mX >= 0 ? aabb.mMax.mX : aabb.mMin.mX,
+				plane.mY >= 0 ? aabb.mMax.mY : aabb.mMin.mY,
+				plane.mZ >= 0 ? aabb.mMax.mZ : aabb.mMin.mZ
+			);
+			if (plane.mX * corner.mX + plane.mY * corner.mY + plane.mZ * corner.mZ + plane.mW < 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	typedef Frustum<float> Frustumf;
+	typedef Frustum<double> Frustumd;
+
+	//*********************************************************************************
+	//	Batched culling, every plane is broadcast once and then tested against Width volumes at a time
+	//*********************************************************************************
+
+	namespace SIMD {
+		// Clears the lanes of the batch at index that are at or beyond end
+		inline uint32_t ClampLaneMask(const uint32_t mask, const size_t index, const size_t end, const int width) {
+			const size_t lanes = end - index;
+			return lanes < static_cast<size_t>(width) ? mask & ((1u << lanes) - 1u) : mask;
+		}
+	}
+
+	/*	Writes the index of every sphere in [begin, end) that intersects the frustum, returns how many were written.
+		begin has to start a whole batch (multiple of sBoundsBatchWidth) and visible needs room for end - begin indices */
+	inline size_t Cull(const Frustum<float>& frustum, const SphereBatch& spheres, const size_t begin, const size_t end, std::span<uint32_t> visible) {
+		constexpr int width = sBoundsBatchWidth;
+		using Float = FloatWide<width>;
+		assert(begin % width == 0 && end <= spheres.Size() && "Range has to start a whole batch");
+		assert(visible.size() >= end - begin && "Visible span is too small");
+
+		Float planes[Frustum<float>::PlaneCount][4];
+		for (int plane = 0; plane < Frustum<float>::PlaneCount; ++plane) {
+			const Vector4<float>& p = frustum.mPlanes[plane];
+			planes[plane][0] = Float(p.mX);
+			planes[plane][1] = Float(p.mY);
+			planes[plane][2] = Float(p.mZ);
+			planes[plane][3] = Float(p.mW);
+		}
+
+		const Float zero(0.0f);
+		size_t count = 0;
+		for (size_t index = begin; index < end; index += width) {
+			const SphereWide<width> batch = spheres.Load<width>(index);
+			const Float negativeRadius = -batch.mRadius;
+
+			// Padding and empty spheres have a negative radius
+			Float inside = batch.mRadius >= zero;
+			for (const Float(&plane)[4] : planes) {
+				const Float distance = MulAdd(plane[2], batch.mCenter.mZ, MulAdd(plane[1], batch.mCenter.mY, MulAdd(plane[0], batch.mCenter.mX, plane[3])));
+				inside = inside & (distance >= negativeRadius);
+			}
+
+			const uint32_t mask = SIMD::ClampLaneMask(inside.MoveMask(), index, end, width);
+			count = SIMD::AppendLaneIndices(mask, static_cast<uint32_t>(index), visible.data(), count);
+		}
+		return count;
+	}
+
+	/*	Writes the index of every box in [begin, end) that intersects the frustum, returns how many were written.
+		begin has to start a whole batch (multiple of sBoundsBatchWidth) and visible needs room for end - begin indices */
+	inline size_t Cull(const Frustum<float>& frustum, const AABBBatch& boxes, const size_t begin, const size_t end, std::span<uint32_t> visible) {
+		constexpr int width = sBoundsBatchWidth;
+		using Float = FloatWide<width>;
+		assert(begin % width == 0 && end <= boxes.Size() && "Range has to start a whole batch");
+		assert(visible.size() >= end - begin && "Visible span is too small");
+
+		// The sign of every normal component picks min or max once, so the loop only tests the furthest corner
+		Float planes[Frustum<float>::PlaneCount][4];
+		bool useMax[Frustum<float>::PlaneCount][3];
+		for (int plane = 0; plane < Frustum<float>::PlaneCount; ++plane) {
+			const Vector4<float>& p = frustum.mPlanes[plane];
+			planes[plane][0] = Float(p.mX);
+			planes[plane][1] = Float(p.mY);
+			planes[plane][2] = Float(p.mZ);
+			planes[plane][3] = Float(p.mW);
+			useMax[plane][0] = p.mX >= 0.0f;
+			useMax[plane][1] = p.mY >= 0.0f;
+			useMax[plane][2] = p.mZ >= 0.0f;
+		}
+
+		const Float zero(0.0f);
+		size_t count = 0;
+		for (size_t index = begin; index < end; index += width) {
+			const AABBWide<width> batch = boxes.Load<width>(index);
+
+			// Padding and empty boxes have min > max
+			Float inside = (batch.mMin.mX <= batch.mMax.mX) & (batch.mMin.mY <= batch.mMax.mY) & (batch.mMin.mZ <= batch.mMax.mZ);
+			for (int plane = 0; plane < Frustum<float>::PlaneCount; ++plane) {
+				const Float& x = useMax[plane][0] ? batch.mMax.mX : batch.mMin.mX;
+				const Float& y = useMax[plane][1] ? batch.mMax.mY : batch.mMin.mY;
+				const Float& z = useMax[plane][2] ? batch.mMax.mZ : batch.mMin.mZ;
+				const Float distance = MulAdd(planes[plane][2], z, MulAdd(planes[plane][1], y, MulAdd(planes[plane][0], x, planes[plane][3])));
+				inside = inside & (distance >= zero);
+			}
+
+			const uint32_t mask = SIMD::ClampLaneMask(inside.MoveMask(), index, end, width);
+			count = SIMD::AppendLaneIndices(mask, static_cast<uint32_t>(index), visible.data(), count);
+		}
+		return count;
+	}
+
+	inline size_t Cull(const Frustum<float>& frustum, const SphereBatch& spheres, std::span<uint32_t> visible) {
+		return Cull(frustum, spheres, 0, spheres.Size(), visible);
+	}
+
+	inline size_t Cull(const Frustum<float>& frustum, const AABBBatch& boxes, std::span<uint32_t> visible) {
+		return Cull(frustum, boxes, 0, boxes.Size(), visible);
+	}
+}
@@ -1,4 +1,7 @@
 #pragma once
+#include <assert.h>
+#include <cmath>
+#include "OMath.h"
 #include "Vector3.h"
 #include "Matrix4x4.h"
 
@@ -6,50 +9,61 @@ namespace OMath {
 	template <class T>
 	class Matrix3x3 {
 	public:
-		Matrix3x3<T>();
-		Matrix3x3<T>(const Matrix3x3<T>& matrix);
-		Matrix3x3<T>(const Matrix4x4<T>& matrix);
-		void operator=(const Matrix3x3<T>& matrix);
-		void operator=(const Matrix4x4<T>& matrix);
+		constexpr Matrix3x3();
+		constexpr Matrix3x3(const Matrix3x3<T>& matrix) = default;
+		constexpr Matrix3x3(const Matrix4x4<T>& matrix);
+		constexpr Matrix3x3<T>& operator=(const Matrix3x3<T>& matrix) = default;
+		constexpr Matrix3x3<T>& operator=(const Matrix4x4<T>& matrix);
 
-		const T& operator()(const unsigned int row, const unsigned int column) const;
-		T& operator()(const unsigned int row, const unsigned int column);
+		constexpr const T& operator()(const unsigned int row, const unsigned int column) const;
+		constexpr T& operator()(const unsigned int row, const unsigned int column);
 
-		static Matrix3x3<T> CreateRotationAroundX(T angleInRadians);
-		static Matrix3x3<T> CreateRotationAroundY(T angleInRadians);
-		static Matrix3x3<T> CreateRotationAroundZ(T angleInRadians);
+		static constexpr Matrix3x3<T> CreateRotationAroundX(T angleInRadians);
+		static constexpr Matrix3x3<T> CreateRotationAroundY(T angleInRadians);
+		static constexpr Matrix3x3<T> CreateRotationAroundZ(T angleInRadians);
 
-		static Matrix3x3<T> Transpose(const Matrix3x3<T>& matrixToTranspose);
+		static constexpr Matrix3x3<T> Transpose(const Matrix3x3<T>& matrixToTranspose);
+
+		// Returns the determinant of the matrix
+		static constexpr T Determinant(const Matrix3x3<T>& matrix);
+
+		// Returns the general inverse, singular matrices produce non finite values so check Determinant first
+		static constexpr Matrix3x3<T> Inverse(const Matrix3x3<T>& matrix);
+
+		/*	Splits matrix = scale * rotation, a mirrored matrix gets a negative x scale.
+			Returns false if any scale axis is zero */
+		static constexpr bool Decompose(const Matrix3x3<T>& matrix, Matrix3x3<T>& rotation, Vector3<T>& scale);
 
 	private:
-		T mmObjects[3][3];
+		T mObjects[3][3];
 	};
 
 	template <class T> 
-	T& Matrix3x3<T>::operator()(const unsigned int row, const unsigned int column) {
-		static_assert(row < 3 && column < 3 && "Trying to access elements out of range");
+	constexpr T& Matrix3x3<T>::operator()(const unsigned int row, const unsigned int column) {
+		assert(row >= 1 && row <= 3 && column >= 1 && column <= 3 && "Trying to access elements out of range");
 
-		return mmObjects[row - 1][column - 1];
+		return mObjects[row - 1][column - 1];
 	}
 
 	template <class T> 
-	const T& Matrix3x3<T>::operator()(const unsigned int row, const unsigned int column) const {
-		static_assert(row < 3 && column < 3 && "Trying to access elements out of range");
+	constexpr const T& Matrix3x3<T>::operator()(const unsigned int row, const unsigned int column) const {
+		assert(row >= 1 && row <= 3 && column >= 1 && column <= 3 && "Trying to access elements out of range");
 
-		return mmObjects[row - 1][column - 1];
+		return mObjects[row - 1][column - 1];
 	}
 
 	template <class T> 
-	void Matrix3x3<T>::operator=(const Matrix3x3<T>& matrix) {
+	constexpr Matrix3x3<T>& Matrix3x3<T>::operator=(const Matrix4x4<T>& matrix) {
 		for (int row = 1; row <= 3; row++) {
 			for (int column = 1; column <= 3; column++) {
-				mmObjects[row - 1][column - 1] = matrix(row, column);
+				mObjects[row - 1][column - 1] = matrix(row, column);
 			}
 		}
+		return *this;
 	}
 
 	template <class T> 
-	Matrix3x3<T> operator+(const Matrix3x3<T>& matrix0, const Matrix3x3<T>& matrix1) {
+	constexpr Matrix3x3<T> operator+(const Matrix3x3<T>& matrix0, const Matrix3x3<T>& matrix1) {
 		Matrix3x3<T> tempMatrix;
 		for (int row = 1; row <= 3; row++) {
 			for (int column = 1; column <= 3; column++) {
@@ -60,7 +74,7 @@ namespace OMath {
 	}
 
 	template <class T> 
-	Matrix3x3<T> operator-(const Matrix3x3<T>& matrix0, const Matrix3x3<T>& matrix1) {
+	constexpr Matrix3x3<T> operator-(const Matrix3x3<T>& matrix0, const Matrix3x3<T>& matrix1) {
 		Matrix3x3<T> tempMatrix;
 		for (int row = 1; row <= 3; row++) {
 			for (int column = 1; column <= 3; column++) {
@@ -71,12 +85,12 @@ namespace OMath {
 	}
 
 	template <class T> 
-	Matrix3x3<T> operator*(const Matrix3x3<T>& matrix0, const Matrix3x3<T>& matrix1) {
+	constexpr Matrix3x3<T> operator*(const Matrix3x3<T>& matrix0, const Matrix3x3<T>& matrix1) {
 		Matrix3x3<T> tempMatrix;
 
-		for (T i = 1; i <= 3; i++) {
-			for (T j = 1; j <= 3; j++) {
-				tempMatrix(i, j) = matrix0(i, 1) * matrix1(1, j) + matrix0(i, 2) * matrix1(2, j) + matrix0(i, 3) * matrix0(3, j);
+		for (int i = 1; i <= 3; i++) {
+			for (int j = 1; j <= 3; j++) {
+				tempMatrix(i, j) = matrix0(i, 1) * matrix1(1, j) + matrix0(i, 2) * matrix1(2, j) + matrix0(i, 3) * matrix1(3, j);
 			}
 		}
 
@@ -84,25 +98,25 @@ namespace OMath {
 	}
 
 	template <class T> 
-	Vector3<T> operator*(const Vector3<T>& aVector, const Matrix3x3<T>& matrix) {
+	constexpr Vector3<T> operator*(const Vector3<T>& aVector, const Matrix3x3<T>& matrix) {
 		Vector3<T> tempVector;
-		tempVector.x = aVector.x * matrix(1, 1) + aVector.y * matrix(2, 1) + aVector.z * matrix(3, 1);
-		tempVector.y = aVector.x * matrix(1, 2) + aVector.y * matrix(2, 2) + aVector.z * matrix(3, 2);
-		tempVector.z = aVector.x * matrix(1, 3) + aVector.y * matrix(2, 3) + aVector.z * matrix(3, 3);
+		tempVector.mX = aVector.mX * matrix(1, 1) + aVector.mY * matrix(2, 1) + aVector.mZ * matrix(3, 1);
+		tempVector.mY = aVector.mX * matrix(1, 2) + aVector.mY * matrix(2, 2) + aVector.mZ * matrix(3, 2);
+		tempVector.mZ = aVector.mX * matrix(1, 3) + aVector.mY * matrix(2, 3) + aVector.mZ * matrix(3, 3);
 		return tempVector;
 	}
 
 	template <class T> 
-	Vector3<T> operator*(const Matrix3x3<T>& matrix, const Vector3<T>& aVector) {
+	constexpr Vector3<T> operator*(const Matrix3x3<T>& matrix, const Vector3<T>& aVector) {
 		Vector3<T> tempVector;
-		tempVector.x = aVector.x * matrix(1, 1) + aVector.y * matrix(2, 1) + aVector.z * matrix(3, 1);
-		tempVector.y = aVector.x * matrix(1, 2) + aVector.y * matrix(2, 2) + aVector.z * matrix(3, 2);
-		tempVector.z = aVector.x * matrix(1, 3) + aVector.y * matrix(2, 3) + aVector.z * matrix(3, 3);
+		tempVector.mX = aVector.mX * matrix(1, 1) + aVector.mY * matrix(2, 1) + aVector.mZ * matrix(3, 1);
+		tempVector.mY = aVector.mX * matrix(1, 2) + aVector.mY * matrix(2, 2) + aVector.mZ * matrix(3, 2);
+		tempVector.mZ = aVector.mX * matrix(1, 3) + aVector.mY * matrix(2, 3) + aVector.mZ * matrix(3, 3);
 		return tempVector;
 	}
 
 	template <class T> 
-	void operator+=(Matrix3x3<T>& matrix0, const Matrix3x3<T>& matrix1) {
+	constexpr void operator+=(Matrix3x3<T>& matrix0, const Matrix3x3<T>& matrix1) {
 		for (int row = 1; row <= 3; row++) {
 			for (int column = 1; column <= 3; column++) {
 				matrix0(row, column) += matrix1(row, column);
@@ -111,7 +125,7 @@ namespace OMath {
 	}
 
 	template <class T> 
-	void operator-=(Matrix3x3<T>& matrix0, const Matrix3x3<T>& matrix1) {
+	constexpr void operator-=(Matrix3x3<T>& matrix0, const Matrix3x3<T>& matrix1) {
 		for (int row = 1; row <= 3; row++) {
 			for (int column = 1; column <= 3; column++) {
 				matrix0(row, column) -= matrix1(row, column);
@@ -120,11 +134,11 @@ namespace OMath {
 	}
 
 	template <class T> 
-	void operator*=(Matrix3x3<T>& matrix0, const Matrix3x3<T>& matrix1) {
+	constexpr void operator*=(Matrix3x3<T>& matrix0, const Matrix3x3<T>& matrix1) {
 		Matrix3x3<T> tempMatrix;
 
-		for (T row = 1; row <= 3; row++) {
-			for (T column = 1; column <= 3; column++) {
+		for (int row = 1; row <= 3; row++) {
+			for (int column = 1; column <= 3; column++) {
 				tempMatrix(row, column) = matrix0(row, 1) * matrix1(1, column) + matrix0(row, 2) * matrix1(2, column) + matrix0(row, 3) * matrix1(3, column);
 			}
 		}
@@ -132,7 +146,7 @@ namespace OMath {
 	}
 
 	template <class T> 
-	bool operator==(const Matrix3x3<T>& matrix0, const Matrix3x3<T>& matrix1) {
+	constexpr bool operator==(const Matrix3x3<T>& matrix0, const Matrix3x3<T>& matrix1) {
 		for (int row = 1; row <= 3; row++) {
 			for (int column = 1; column <= 3; column++) {
 				if (matrix0(row, column) != matrix1(row, column)) {
@@ -144,7 +158,7 @@ namespace OMath {
 	}
 
 	template<class T> 
-	inline Matrix3x3<T>::Matrix3x3() {
+	constexpr Matrix3x3<T>::Matrix3x3() : mObjects{} {
 		for (int row = 1; row <= 3; row++) {
 			for (int column = 1; column <= 3; column++) {
 				if (row == column) {
@@ -156,7 +170,7 @@ namespace OMath {
 		}
 	}
 	template<class T> 
-	inline Matrix3x3<T>::Matrix3x3(const Matrix3x3<T>& matrix) {
+	constexpr Matrix3x3<T>::Matrix3x3(const Matrix4x4<T>& matrix) : mObjects{} {
 		for (int row = 1; row <= 3; row++) {
 			for (int column = 1; column <= 3; column++) {
 				mObjects[row - 1][column - 1] = matrix(row, column);
@@ -165,47 +179,47 @@ namespace OMath {
 	}
 
 	template<class T> 
-	inline Matrix3x3<T>::Matrix3x3(const Matrix4x4<T>& matrix) {
-		for (int row = 1; row <= 3; row++) {
-			for (int column = 1; column <= 3; column++) {
-				mObjects[row - 1][column - 1] = matrix(row, column);
-			}
-		}
-	}
+	constexpr Matrix3x3<T> Matrix3x3<T>::CreateRotationAroundX(T angleInRadians) {
+		const T sine = Sin(angleInRadians);
+		const T cosine = Cos(angleInRadians);
 
-	template<class T> 
-	inline Matrix3x3<T> Matrix3x3<T>::CreateRotationAroundX(T angleInRadians) {
 		Matrix3x3<T> temp;
-		temp(2, 2) = std::cos(angleInRadians);
-		temp(2, 3) = std::sin(angleInRadians);
-		temp(3, 2) = -std::sin(angleInRadians);
-		temp(3, 3) = std::cos(angleInRadians);
+		temp(2, 2) = cosine;
+		temp(2, 3) = sine;
+		temp(3, 2) = -sine;
+		temp(3, 3) = cosine;
 
 		return temp;
 	}
 	template<class T> 
-	inline Matrix3x3<T> Matrix3x3<T>::CreateRotationAroundY(T angleInRadians) {
+	constexpr Matrix3x3<T> Matrix3x3<T>::CreateRotationAroundY(T angleInRadians) {
+		const T sine = Sin(angleInRadians);
+		const T cosine = Cos(angleInRadians);
+
 		Matrix3x3<T> temp;
-		temp(1, 1) = std::cos(angleInRadians);
-		temp(1, 3) = -std::sin(angleInRadians);
-		temp(3, 1) = std::sin(angleInRadians);
-		temp(3, 3) = std::cos(angleInRadians);
+		temp(1, 1) = cosine;
+		temp(1, 3) = -sine;
+		temp(3, 1) = sine;
+		temp(3, 3) = cosine;
 
 		return temp;
 	}
 	template<class T> 
-	inline Matrix3x3<T> Matrix3x3<T>::CreateRotationAroundZ(T angleInRadians) {
+	constexpr Matrix3x3<T> Matrix3x3<T>::CreateRotationAroundZ(T angleInRadians) {
+		const T sine = Sin(angleInRadians);
+		const T cosine = Cos(angleInRadians);
+
 		Matrix3x3<T> temp;
-		temp(1, 1) = std::cos(angleInRadians);
-		temp(1, 2) = std::sin(angleInRadians);
-		temp(2, 1) = -std::sin(angleInRadians);
-		temp(2, 2) = std::cos(angleInRadians);
+		temp(1, 1) = cosine;
+		temp(1, 2) = sine;
+		temp(2, 1) = -sine;
+		temp(2, 2) = cosine;
 
 		return temp;
 	}
 
 	template<class T> 
-	inline Matrix3x3<T> Matrix3x3<T>::Transpose(const Matrix3x3<T>& matrixToTranspose) {
+	constexpr Matrix3x3<T> Matrix3x3<T>::Transpose(const Matrix3x3<T>& matrixToTranspose) {
 		Matrix3x3<T> temp = Matrix3x3<T>(matrixToTranspose);
 
 		temp(2, 1) = matrixToTranspose(1, 2);
@@ -220,6 +234,61 @@ namespace OMath {
 		return temp;
 	}
 
+	template<class T>
+	constexpr T Matrix3x3<T>::Determinant(const Matrix3x3<T>& matrix) {
+		const Matrix3x3<T>& m = matrix;
+		return m(1, 1) * (m(2, 2) * m(3, 3) - m(2, 3) * m(3, 2)) -
+			m(1, 2) * (m(2, 1) * m(3, 3) - m(2, 3) * m(3, 1)) +
+			m(1, 3) * (m(2, 1) * m(3, 2) - m(2, 2) * m(3, 1));
+	}
+
+	template<class T>
+	constexpr Matrix3x3<T> Matrix3x3<T>::Inverse(const Matrix3x3<T>& matrix) {
+		const Matrix3x3<T>& m = matrix;
+		const T inverseDeterminant = static_cast<T>(1) / Determinant(matrix);
+
+		Matrix3x3<T> result;
+		result(1, 1) = (m(2, 2) * m(3, 3) - m(2, 3) * m(3, 2)) * inverseDeterminant;
+		result(1, 2) = (m(1, 3) * m(3, 2) - m(1, 2) * m(3, 3)) * inverseDeterminant;
+		result(1, 3) = (m(1, 2) * m(2, 3) - m(1, 3) * m(2, 2)) * inverseDeterminant;
+
+		result(2, 1) = (m(2, 3) * m(3, 1) - m(2, 1) * m(3, 3)) * inverseDeterminant;
+		result(2, 2) = (m(1, 1) * m(3, 3) - m(1, 3) * m(3, 1)) * inverseDeterminant;
+		result(2, 3) = (m(1, 3) * m(2, 1) - m(1, 1) * m(2, 3)) * inverseDeterminant;
+
+		result(3, 1) = (m(2, 1) * m(3, 2) - m(2, 2) * m(3, 1)) * inverseDeterminant;
+		result(3, 2) = (m(1, 2) * m(3, 1) - m(1, 1) * m(3, 2)) * inverseDeterminant;
+		result(3, 3) = (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1)) * inverseDeterminant;
+
+		return result;
+	}
+
+	template<class T>
+	constexpr bool Matrix3x3<T>::Decompose(const Matrix3x3<T>& matrix, Matrix3x3<T>& rotation, Vector3<T>& scale) {
+		// Row vectors, so every row is one rotated axis multiplied by its scale
+		Vector3<T> axes[3];
+		for (int row = 1; row <= 3; row++) {
+			axes[row - 1] = { matrix(row, 1), matrix(row, 2), matrix(row, 3) };
+		}
+
+		scale = { axes[0].Length(), axes[1].Length(), axes[2].Length() };
+		if (Determinant(matrix) < static_cast<T>(0)) {
+			scale.mX = -scale.mX;
+		}
+
+		if (scale.mX == static_cast<T>(0) || scale.mY == static_cast<T>(0) || scale.mZ == static_cast<T>(0)) {
+			return false;
+		}
+
+		const T scales[3] = { scale.mX, scale.mY, scale.mZ };
+		for (int row = 1; row <= 3; row++) {
+			rotation(row, 1) = axes[row - 1].mX / scales[row - 1];
+			rotation(row, 2) = axes[row - 1].mY / scales[row - 1];
+			rotation(row, 3) = axes[row - 1].mZ / scales[row - 1];
+		}
+		return true;
+	}
+
 	typedef Matrix3x3<float> Matrix3x3f;
 	typedef Matrix3x3<double> Matrix3x3d;
 	typedef Matrix3x3<int> Matrix3x3i;
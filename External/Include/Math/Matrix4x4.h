@@ -1,4 +1,9 @@
 #pragma once
+#include <assert.h>
+#include <cmath>
+#include <span>
+#include "OMath.h"
+#include "SIMD.h"
 #include "Vector3.h"
 #include "Vector4.h"
 
@@ -6,57 +11,77 @@ namespace OMath {
 	template <class T>
 	class Matrix4x4 {
 	public:
-		Matrix4x4<T>();
-		Matrix4x4<T>(const Matrix4x4<T>& matrix);
-		void operator=(const Matrix4x4<T>& matrix);
+		constexpr Matrix4x4();
+		constexpr Matrix4x4(const Matrix4x4<T>& matrix) = default;
+		constexpr Matrix4x4<T>& operator=(const Matrix4x4<T>& matrix) = default;
 
-		const T& operator()(const unsigned int row, const unsigned int column) const;
-		T& operator()(const unsigned int row, const unsigned int column);
+		constexpr const T& operator()(const unsigned int row, const unsigned int column) const;
+		constexpr T& operator()(const unsigned int row, const unsigned int column);
 
-		static Matrix4x4<T> CreateRotationAroundX(T angleInRadians);
-		static Matrix4x4<T> CreateRotationAroundY(T angleInRadians);
-		static Matrix4x4<T> CreateRotationAroundZ(T angleInRadians);
+		// Returns the first element, the rows are stored contiguously
+		constexpr const T* Data() const;
+		constexpr T* Data();
 
-		static Matrix4x4<T> Transpose(const Matrix4x4<T>& matrixToTranspose);
+		static constexpr Matrix4x4<T> CreateRotationAroundX(T angleInRadians);
+		static constexpr Matrix4x4<T> CreateRotationAroundY(T angleInRadians);
+		static constexpr Matrix4x4<T> CreateRotationAroundZ(T angleInRadians);
 
-		static Matrix4x4<T> GetFastInverse(const Matrix4x4<T>& transform);
+		static constexpr Matrix4x4<T> Transpose(const Matrix4x4<T>& matrixToTranspose);
 
-		static Matrix4x4<T> CreateScaleMatrix(const Vector3<T>& scaleVector);
-		static Matrix4x4<T> CreateTranslationMatrix(const Vector3<T>& translationVector);
+		static constexpr Matrix4x4<T> GetFastInverse(const Matrix4x4<T>& transform);
+
+		// Returns the determinant of the matrix
+		static constexpr T Determinant(const Matrix4x4<T>& matrix);
+
+		// Returns the general inverse, works for projections and scaled transforms.
+		// Singular matrices produce non finite values so check Determinant first
+		static constexpr Matrix4x4<T> Inverse(const Matrix4x4<T>& matrix);
+
+		// Inverts every matrix, output.size() must be >= matrices.size()
+		static void Inverse(std::span<const Matrix4x4<T>> matrices, std::span<Matrix4x4<T>> output);
+
+		/*	Splits transform = scale * rotation * translation, a mirrored transform gets a negative x scale.
+			Returns false if any scale axis is zero */
+		static constexpr bool Decompose(const Matrix4x4<T>& transform, Vector3<T>& translation, Matrix4x4<T>& rotation, Vector3<T>& scale);
+
+		static constexpr Matrix4x4<T> CreateScaleMatrix(const Vector3<T>& scaleVector);
+		static constexpr Matrix4x4<T> CreateTranslationMatrix(const Vector3<T>& translationVector);
 
 		/*	x - Roll
 			y - pitch
 			z - yaw */
-		static Matrix4x4<T> CreateRotationMatrix(const Vector3<T>& rotationVector);
+		static constexpr Matrix4x4<T> CreateRotationMatrix(const Vector3<T>& rotationVector);
 	private:
-		T mObjects[4][4];
+		// Row major and flat so Data() can index every element, also in constant expressions
+		alignas(16) T mObjects[16];
 	};
 
 	template <class T>
-	T& Matrix4x4<T>::operator()(const unsigned int row, const unsigned int column) {
-		static_assert(row < 4 && column < 4 && "Trying to access elements out of range");
+	constexpr T& Matrix4x4<T>::operator()(const unsigned int row, const unsigned int column) {
+		assert(row >= 1 && row <= 4 && column >= 1 && column <= 4 && "Trying to access elements out of range");
 
-		return mObjects[row - 1][column - 1];
+		return mObjects[(row - 1) * 4 + column - 1];
 	}
 
 	template <class T>
-	const T& Matrix4x4<T>::operator()(const unsigned int row, const unsigned int column) const {
-		static_assert(row < 4 && column < 4 && "Trying to access elements out of range");
+	constexpr const T& Matrix4x4<T>::operator()(const unsigned int row, const unsigned int column) const {
+		assert(row >= 1 && row <= 4 && column >= 1 && column <= 4 && "Trying to access elements out of range");
 
-		return mObjects[row - 1][column - 1];
+		return mObjects[(row - 1) * 4 + column - 1];
 	}
 
 	template <class T>
-	void Matrix4x4<T>::operator=(const Matrix4x4<T>& matrix) {
-		for (int row = 1; row <= 4; row++) {
-			for (int column = 1; column <= 4; column++) {
-				mObjects[row - 1][column - 1] = matrix(row, column);
-			}
-		}
+	constexpr const T* Matrix4x4<T>::Data() const {
+		return mObjects;
 	}
 
 	template <class T>
-	Matrix4x4<T> operator+(const Matrix4x4<T>& matrix0, const Matrix4x4<T>& matrix1) {
+	constexpr T* Matrix4x4<T>::Data() {
+		return mObjects;
+	}
+
+	template <class T>
+	constexpr Matrix4x4<T> operator+(const Matrix4x4<T>& matrix0, const Matrix4x4<T>& matrix1) {
 		Matrix4x4<T> tempMatrix;
 
 		for (int row = 1; row <= 4; row++) {
@@ -68,7 +93,7 @@ namespace OMath {
 	}
 
 	template <class T>
-	Matrix4x4<T> operator-(const Matrix4x4<T>& matrix0, const Matrix4x4<T>& matrix1) {
+	constexpr Matrix4x4<T> operator-(const Matrix4x4<T>& matrix0, const Matrix4x4<T>& matrix1) {
 		Matrix4x4<T> tempMatrix;
 		for (int row = 1; row <= 4; row++) {
 			for (int column = 1; column <= 4; column++) {
@@ -79,7 +104,7 @@ namespace OMath {
 	}
 
 	template <class T>
-	Matrix4x4<T> operator*(const Matrix4x4<T>& matrix0, const Matrix4x4<T>& matrix1) {
+	constexpr Matrix4x4<T> operator*(const Matrix4x4<T>& matrix0, const Matrix4x4<T>& matrix1) {
 		Matrix4x4<T> tempMatrix;
 
 		for (int i = 1; i <= 4; i++) {
@@ -92,37 +117,37 @@ namespace OMath {
 	}
 
 	template <class T>
-	Vector4<T> operator*(const Vector4<T>& aVector, const Matrix4x4<T>& matrix) {
+	constexpr Vector4<T> operator*(const Vector4<T>& aVector, const Matrix4x4<T>& matrix) {
 		Vector4<T> tempVector;
-		tempVector.x = aVector.x * matrix(1, 1) + aVector.y * matrix(2, 1) + aVector.z * matrix(3, 1) + aVector.w *
+		tempVector.mX = aVector.mX * matrix(1, 1) + aVector.mY * matrix(2, 1) + aVector.mZ * matrix(3, 1) + aVector.mW *
 			matrix(4, 1);
-		tempVector.y = aVector.x * matrix(1, 2) + aVector.y * matrix(2, 2) + aVector.z * matrix(3, 2) + aVector.w *
+		tempVector.mY = aVector.mX * matrix(1, 2) + aVector.mY * matrix(2, 2) + aVector.mZ * matrix(3, 2) + aVector.mW *
 			matrix(4, 2);
-		tempVector.z = aVector.x * matrix(1, 3) + aVector.y * matrix(2, 3) + aVector.z * matrix(3, 3) + aVector.w *
+		tempVector.mZ = aVector.mX * matrix(1, 3) + aVector.mY * matrix(2, 3) + aVector.mZ * matrix(3, 3) + aVector.mW *
 			matrix(4, 3);
-		tempVector.w = aVector.x * matrix(1, 4) + aVector.y * matrix(2, 4) + aVector.z * matrix(3, 4) + aVector.w *
+		tempVector.mW = aVector.mX * matrix(1, 4) + aVector.mY * matrix(2, 4) + aVector.mZ * matrix(3, 4) + aVector.mW *
 			matrix(4, 4);
 
 		return tempVector;
 	}
 
 	template <class T>
-	Vector4<T> operator*(const Matrix4x4<T>& matrix, const Vector4<T>& aVector) {
+	constexpr Vector4<T> operator*(const Matrix4x4<T>& matrix, const Vector4<T>& aVector) {
 		Vector4<T> tempVector;
-		tempVector.x = aVector.x * matrix(1, 1) + aVector.y * matrix(2, 1) + aVector.z * matrix(3, 1) + aVector.w *
+		tempVector.mX = aVector.mX * matrix(1, 1) + aVector.mY * matrix(2, 1) + aVector.mZ * matrix(3, 1) + aVector.mW *
 			matrix(4, 1);
-		tempVector.y = aVector.x * matrix(1, 2) + aVector.y * matrix(2, 2) + aVector.z * matrix(3, 2) + aVector.w *
+		tempVector.mY = aVector.mX * matrix(1, 2) + aVector.mY * matrix(2, 2) + aVector.mZ * matrix(3, 2) + aVector.mW *
 			matrix(4, 2);
-		tempVector.z = aVector.x * matrix(1, 3) + aVector.y * matrix(2, 3) + aVector.z * matrix(3, 3) + aVector.w *
+		tempVector.mZ = aVector.mX * matrix(1, 3) + aVector.mY * matrix(2, 3) + aVector.mZ * matrix(3, 3) + aVector.mW *
 			matrix(4, 3);
-		tempVector.w = aVector.x * matrix(1, 4) + aVector.y * matrix(2, 4) + aVector.z * matrix(3, 4) + aVector.w *
+		tempVector.mW = aVector.mX * matrix(1, 4) + aVector.mY * matrix(2, 4) + aVector.mZ * matrix(3, 4) + aVector.mW *
 			matrix(4, 4);
 
 		return tempVector;
 	}
 
 	template <class T>
-	void operator+=(Matrix4x4<T>& matrix0, const Matrix4x4<T>& matrix1) {
+	constexpr void operator+=(Matrix4x4<T>& matrix0, const Matrix4x4<T>& matrix1) {
 		for (int row = 1; row <= 4; row++) {
 			for (int column = 1; column <= 4; column++) {
 				matrix0(row, column) += matrix1(row, column);
@@ -131,7 +156,7 @@ namespace OMath {
 	}
 
 	template <class T>
-	void operator-=(Matrix4x4<T>& matrix0, const Matrix4x4<T>& matrix1) {
+	constexpr void operator-=(Matrix4x4<T>& matrix0, const Matrix4x4<T>& matrix1) {
 		for (int row = 1; row <= 4; row++) {
 			for (int column = 1; column <= 4; column++) {
 				matrix0(row, column) -= matrix1(row, column);
@@ -140,7 +165,7 @@ namespace OMath {
 	}
 
 	template <class T>
-	void operator*=(Matrix4x4<T>& matrix0, const Matrix4x4<T>& matrix1) {
+	constexpr void operator*=(Matrix4x4<T>& matrix0, const Matrix4x4<T>& matrix1) {
 		Matrix4x4<T> tempMatrix;
 
 		for (int i = 1; i <= 4; i++) {
@@ -153,7 +178,7 @@ namespace OMath {
 	}
 
 	template <class T>
-	bool operator==(const Matrix4x4<T>& matrix0, const Matrix4x4<T>& matrix1) {
+	constexpr bool operator==(const Matrix4x4<T>& matrix0, const Matrix4x4<T>& matrix1) {
 		for (int row = 1; row <= 4; row++) {
 			for (int column = 1; column <= 4; column++) {
 				if (matrix0(row, column) != matrix1(row, column)) {
@@ -165,164 +190,496 @@ namespace OMath {
 	}
 
 	template <class T>
-	inline Matrix4x4<T>::Matrix4x4(const Matrix4x4<T>& matrix) {
-		for (int row = 1; row <= 4; row++) {
-			for (int column = 1; column <= 4; column++) {
-				mObjects[row - 1][column - 1] = matrix(row, column);
-			}
+	constexpr Matrix4x4<T>::Matrix4x4() : mObjects{} {
+		for (int diagonal = 0; diagonal < 4; diagonal++) {
+			mObjects[diagonal * 5] = 1;
 		}
 	}
 
 	template <class T>
-	inline Matrix4x4<T>::Matrix4x4() {
-		for (int row = 1; row <= 4; row++) {
-			for (int column = 1; column <= 4; column++) {
-				if (row == column) {
-					mObjects[row - 1][column - 1] = 1;
-				} else {
-					mObjects[row - 1][column - 1] = 0;
-				}
-			}
-		}
-	}
+	constexpr Matrix4x4<T> Matrix4x4<T>::CreateRotationAroundX(T angleInRadians) {
+		const T sine = Sin(angleInRadians);
+		const T cosine = Cos(angleInRadians);
 
-	template <class T>
-	inline Matrix4x4<T> Matrix4x4<T>::CreateRotationAroundX(T angleInRadians) {
 		Matrix4x4<T> temp;
-		temp(2, 2) = std::cos(angleInRadians);
-		temp(2, 3) = std::sin(angleInRadians);
-		temp(3, 2) = -std::sin(angleInRadians);
-		temp(3, 3) = std::cos(angleInRadians);
+		temp(2, 2) = cosine;
+		temp(2, 3) = sine;
+		temp(3, 2) = -sine;
+		temp(3, 3) = cosine;
 
 		return temp;
 	}
 
 	template <class T>
-	inline Matrix4x4<T> Matrix4x4<T>::CreateRotationAroundY(T angleInRadians) {
+	constexpr Matrix4x4<T> Matrix4x4<T>::CreateRotationAroundY(T angleInRadians) {
+		const T sine = Sin(angleInRadians);
+		const T cosine = Cos(angleInRadians);
+
 		Matrix4x4<T> temp;
-		temp(1, 1) = std::cos(angleInRadians);
-		temp(1, 3) = -std::sin(angleInRadians);
-		temp(3, 1) = std::sin(angleInRadians);
-		temp(3, 3) = std::cos(angleInRadians);
+		temp(1, 1) = cosine;
+		temp(1, 3) = -sine;
+		temp(3, 1) = sine;
+		temp(3, 3) = cosine;
 
 		return temp;
 	}
 
 	template <class T>
-	inline Matrix4x4<T> Matrix4x4<T>::CreateRotationAroundZ(T angleInRadians) {
+	constexpr Matrix4x4<T> Matrix4x4<T>::CreateRotationAroundZ(T angleInRadians) {
+		const T sine = Sin(angleInRadians);
+		const T cosine = Cos(angleInRadians);
+
 		Matrix4x4<T> temp;
-		temp(1, 1) = std::cos(angleInRadians);
-		temp(1, 2) = std::sin(angleInRadians);
-		temp(2, 1) = -std::sin(angleInRadians);
-		temp(2, 2) = std::cos(angleInRadians);
+		temp(1, 1) = cosine;
+		temp(1, 2) = sine;
+		temp(2, 1) = -sine;
+		temp(2, 2) = cosine;
 
 		return temp;
 	}
 
-	template <class T>
-	inline Matrix4x4<T> Matrix4x4<T>::Transpose(const Matrix4x4<T>& matrixToTranspose) {
-		Matrix4x4<T> temp = Matrix4x4<T>(matrixToTranspose);
+	// Plain scalar versions, the SSE specializations use them in constant expressions
+	namespace Scalar {
+		template <class T>
+		constexpr Matrix4x4<T> Transpose(const Matrix4x4<T>& matrixToTranspose) {
+			Matrix4x4<T> temp = Matrix4x4<T>(matrixToTranspose);
 
-		temp(2, 1) = matrixToTranspose(1, 2);
-		temp(1, 2) = matrixToTranspose(2, 1);
+			temp(2, 1) = matrixToTranspose(1, 2);
+			temp(1, 2) = matrixToTranspose(2, 1);
 
-		temp(3, 1) = matrixToTranspose(1, 3);
-		temp(1, 3) = matrixToTranspose(3, 1);
+			temp(3, 1) = matrixToTranspose(1, 3);
+			temp(1, 3) = matrixToTranspose(3, 1);
 
-		temp(3, 2) = matrixToTranspose(2, 3);
-		temp(2, 3) = matrixToTranspose(3, 2);
+			temp(3, 2) = matrixToTranspose(2, 3);
+			temp(2, 3) = matrixToTranspose(3, 2);
 
-		temp(4, 1) = matrixToTranspose(1, 4);
-		temp(1, 4) = matrixToTranspose(4, 1);
+			temp(4, 1) = matrixToTranspose(1, 4);
+			temp(1, 4) = matrixToTranspose(4, 1);
 
-		temp(4, 2) = matrixToTranspose(2, 4);
-		temp(2, 4) = matrixToTranspose(4, 2);
+			temp(4, 2) = matrixToTranspose(2, 4);
+			temp(2, 4) = matrixToTranspose(4, 2);
 
-		temp(4, 3) = matrixToTranspose(3, 4);
-		temp(3, 4) = matrixToTranspose(4, 3);
+			temp(4, 3) = matrixToTranspose(3, 4);
+			temp(3, 4) = matrixToTranspose(4, 3);
 
-		return temp;
+			return temp;
+		}
+
+		template <class T>
+		constexpr Matrix4x4<T> GetFastInverse(const Matrix4x4<T>& transform) {
+			Matrix4x4<T> newMatrix = transform;
+
+			newMatrix(2, 1) = transform(1, 2);
+			newMatrix(1, 2) = transform(2, 1);
+
+			newMatrix(3, 1) = transform(1, 3);
+			newMatrix(1, 3) = transform(3, 1);
+
+			newMatrix(3, 2) = transform(2, 3);
+			newMatrix(2, 3) = transform(3, 2);
+
+			newMatrix(4, 1) = -transform(4, 1) * newMatrix(1, 1) - transform(4, 2) * newMatrix(2, 1) - transform(4, 3) *
+				newMatrix(3, 1);
+			newMatrix(4, 2) = -transform(4, 1) * newMatrix(1, 2) - transform(4, 2) * newMatrix(2, 2) - transform(4, 3) *
+				newMatrix(3, 2);
+			newMatrix(4, 3) = -transform(4, 1) * newMatrix(1, 3) - transform(4, 2) * newMatrix(2, 3) - transform(4, 3) *
+				newMatrix(3, 3);
+
+			return newMatrix;
+		}
+
+		template <class T>
+		constexpr Matrix4x4<T> Inverse(const Matrix4x4<T>& matrix) {
+			const T* m = matrix.Data();
+
+			const T s0 = m[0] * m[5] - m[4] * m[1];
+			const T s1 = m[0] * m[6] - m[4] * m[2];
+			const T s2 = m[0] * m[7] - m[4] * m[3];
+			const T s3 = m[1] * m[6] - m[5] * m[2];
+			const T s4 = m[1] * m[7] - m[5] * m[3];
+			const T s5 = m[2] * m[7] - m[6] * m[3];
+
+			const T c5 = m[10] * m[15] - m[14] * m[11];
+			const T c4 = m[9] * m[15] - m[13] * m[11];
+			const T c3 = m[9] * m[14] - m[13] * m[10];
+			const T c2 = m[8] * m[15] - m[12] * m[11];
+			const T c1 = m[8] * m[14] - m[12] * m[10];
+			const T c0 = m[8] * m[13] - m[12] * m[9];
+
+			const T inverseDeterminant = static_cast<T>(1) / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+			Matrix4x4<T> result;
+			T* out = result.Data();
+			out[0] = (m[5] * c5 - m[6] * c4 + m[7] * c3) * inverseDeterminant;
+			out[1] = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * inverseDeterminant;
+			out[2] = (m[13] * s5 - m[14] * s4 + m[15] * s3) * inverseDeterminant;
+			out[3] = (-m[9] * s5 + m[10] * s4 - m[11] * s3) * inverseDeterminant;
+
+			out[4] = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * inverseDeterminant;
+			out[5] = (m[0] * c5 - m[2] * c2 + m[3] * c1) * inverseDeterminant;
+			out[6] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * inverseDeterminant;
+			out[7] = (m[8] * s5 - m[10] * s2 + m[11] * s1) * inverseDeterminant;
+
+			out[8] = (m[4] * c4 - m[5] * c2 + m[7] * c0) * inverseDeterminant;
+			out[9] = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * inverseDeterminant;
+			out[10] = (m[12] * s4 - m[13] * s2 + m[15] * s0) * inverseDeterminant;
+			out[11] = (-m[8] * s4 + m[9] * s2 - m[11] * s0) * inverseDeterminant;
+
+			out[12] = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * inverseDeterminant;
+			out[13] = (m[0] * c3 - m[1] * c1 + m[2] * c0) * inverseDeterminant;
+			out[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * inverseDeterminant;
+			out[15] = (m[8] * s3 - m[9] * s1 + m[10] * s0) * inverseDeterminant;
+
+			return result;
+		}
 	}
 
 	template <class T>
-	inline Matrix4x4<T> Matrix4x4<T>::GetFastInverse(const Matrix4x4<T>& transform) {
-		Matrix4x4<T> newMatrix = transform;
+	constexpr Matrix4x4<T> Matrix4x4<T>::Transpose(const Matrix4x4<T>& matrixToTranspose) {
+		return Scalar::Transpose(matrixToTranspose);
+	}
 
-		newMatrix(2, 1) = transform(1, 2);
-		newMatrix(1, 2) = transform(2, 1);
+	template <class T>
+	constexpr Matrix4x4<T> Matrix4x4<T>::GetFastInverse(const Matrix4x4<T>& transform) {
+		return Scalar::GetFastInverse(transform);
+	}
 
-		newMatrix(3, 1) = transform(1, 3);
-		newMatrix(1, 3) = transform(3, 1);
+	template <class T>
+	constexpr T Matrix4x4<T>::Determinant(const Matrix4x4<T>& matrix) {
+		const T* m = matrix.Data();
+
+		// 2x2 determinants of the upper and lower row pairs
+		const T s0 = m[0] * m[5] - m[4] * m[1];
+		const T s1 = m[0] * m[6] - m[4] * m[2];
+		const T s2 = m[0] * m[7] - m[4] * m[3];
+		const T s3 = m[1] * m[6] - m[5] * m[2];
+		const T s4 = m[1] * m[7] - m[5] * m[3];
+		const T s5 = m[2] * m[7] - m[6] * m[3];
+
+		const T c5 = m[10] * m[15] - m[14] * m[11];
+		const T c4 = m[9] * m[15] - m[13] * m[11];
+		const T c3 = m[9] * m[14] - m[13] * m[10];
+		const T c2 = m[8] * m[15] - m[12] * m[11];
+		const T c1 = m[8] * m[14] - m[12] * m[10];
+		const T c0 = m[8] * m[13] - m[12] * m[9];
+
+		return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	}
 
-		newMatrix(3, 2) = transform(2, 3);
-		newMatrix(2, 3) = transform(3, 2);
+	template <class T>
+	constexpr Matrix4x4<T> Matrix4x4<T>::Inverse(const Matrix4x4<T>& matrix) {
+		return Scalar::Inverse(matrix);
+	}
 
-		newMatrix(4, 1) = -transform(4, 1) * newMatrix(1, 1) - transform(4, 2) * newMatrix(2, 1) - transform(4, 3) *
-			newMatrix(3, 1);
-		newMatrix(4, 2) = -transform(4, 1) * newMatrix(1, 2) - transform(4, 2) * newMatrix(2, 2) - transform(4, 3) *
-			newMatrix(3, 2);
-		newMatrix(4, 3) = -transform(4, 1) * newMatrix(1, 3) - transform(4, 2) * newMatrix(2, 3) - transform(4, 3) *
-			newMatrix(3, 3);
+	template <class T>
+	inline void Matrix4x4<T>::Inverse(std::span<const Matrix4x4<T>> matrices, std::span<Matrix4x4<T>> output) {
+		assert(output.size() >= matrices.size() && "Output span is too small");
 
-		return newMatrix;
+		// Every inverse is branch free and independent, so consecutive iterations overlap in the pipeline
+		for (size_t index = 0; index < matrices.size(); ++index) {
+			output[index] = Inverse(matrices[index]);
+		}
 	}
 
 	template <class T>
-	inline Matrix4x4<T> Matrix4x4<T>::CreateScaleMatrix(const Vector3<T>& aScaleVector) {
+	constexpr bool Matrix4x4<T>::Decompose(const Matrix4x4<T>& transform, Vector3<T>& translation, Matrix4x4<T>& rotation, Vector3<T>& scale) {
+		translation = { transform(4, 1), transform(4, 2), transform(4, 3) };
+
+		// Row vectors, so every row of the upper 3x3 is one rotated axis multiplied by its scale
+		Vector3<T> axes[3];
+		for (int row = 1; row <= 3; row++) {
+			axes[row - 1] = { transform(row, 1), transform(row, 2), transform(row, 3) };
+		}
+
+		scale = { axes[0].Length(), axes[1].Length(), axes[2].Length() };
+		if (axes[0].Dot(axes[1].Cross(axes[2])) < static_cast<T>(0)) {
+			scale.mX = -scale.mX;
+		}
+
+		if (scale.mX == static_cast<T>(0) || scale.mY == static_cast<T>(0) || scale.mZ == static_cast<T>(0)) {
+			return false;
+		}
+
+		rotation = Matrix4x4<T>();
+		const T scales[3] = { scale.mX, scale.mY, scale.mZ };
+		for (int row = 1; row <= 3; row++) {
+			rotation(row, 1) = axes[row - 1].mX / scales[row - 1];
+			rotation(row, 2) = axes[row - 1].mY / scales[row - 1];
+			rotation(row, 3) = axes[row - 1].mZ / scales[row - 1];
+		}
+		return true;
+	}
+
+	template <class T>
+	constexpr Matrix4x4<T> Matrix4x4<T>::CreateScaleMatrix(const Vector3<T>& aScaleVector) {
 		Matrix4x4<T> result;
-		result(1, 1) = aScaleVector.x;
-		result(2, 2) = aScaleVector.y;
-		result(3, 3) = aScaleVector.z;
+		result(1, 1) = aScaleVector.mX;
+		result(2, 2) = aScaleVector.mY;
+		result(3, 3) = aScaleVector.mZ;
 
 		return result;
 	}
 
 	template <class T>
-	inline Matrix4x4<T> Matrix4x4<T>::CreateTranslationMatrix(const Vector3<T>& aTranslationVector) {
+	constexpr Matrix4x4<T> Matrix4x4<T>::CreateTranslationMatrix(const Vector3<T>& aTranslationVector) {
 		Matrix4x4<T> result;
 
-		result(4, 1) = aTranslationVector.x;
-		result(4, 2) = aTranslationVector.y;
-		result(4, 3) = aTranslationVector.z;
+		result(4, 1) = aTranslationVector.mX;
+		result(4, 2) = aTranslationVector.mY;
+		result(4, 3) = aTranslationVector.mZ;
 
 		return result;
 	}
 
 	template <class T>
-	inline Matrix4x4<T> Matrix4x4<T>::CreateRotationMatrix(const Vector3<T>& rotationVector) {
+	constexpr Matrix4x4<T> Matrix4x4<T>::CreateRotationMatrix(const Vector3<T>& rotationVector) {
 		Matrix4x4<T> result;
 
-		float cp = cosf(rotationVector.x);
-		float sp = sinf(rotationVector.x);
+		const T cp = Cos(rotationVector.mX);
+		const T sp = Sin(rotationVector.mX);
 
-		float cy = cosf(rotationVector.y);
-		float sy = sinf(rotationVector.y);
+		const T cy = Cos(rotationVector.mY);
+		const T sy = Sin(rotationVector.mY);
 
-		float cr = cosf(rotationVector.z);
-		float sr = sinf(rotationVector.z);
+		const T cr = Cos(rotationVector.mZ);
+		const T sr = Sin(rotationVector.mZ);
 
 		result(1, 1) = cr * cy + sr * sp * sy;
 		result(1, 2) = sr * cp;
 		result(1, 3) = sr * sp * cy - cr * sy;
-		result(1, 4) = 0.0f;
+		result(1, 4) = 0;
 
 		result(2, 1) = cr * sp * sy - sr * cy;
 		result(2, 2) = cr * cp;
 		result(2, 3) = sr * sy + cr * sp * cy;
-		result(2, 4) = 0.0f;
+		result(2, 4) = 0;
 
 		result(3, 1) = cp * sy;
 		result(3, 2) = -sp;
 		result(3, 3) = cp * cy;
-		result(3, 4) = 0.0f;
+		result(3, 4) = 0;
+
+		result(4, 1) = 0;
+		result(4, 2) = 0;
+		result(4, 3) = 0;
+		result(4, 4) = 1;
+
+		return result;
+	}
+
+#ifdef OMATH_SSE
+	//*********************************************************************************
+	//	Matrix4x4<float> specializations, each row is kept in one SSE register.
+	//	Intrinsics are not constexpr, so constant evaluation takes the generic path
+	//*********************************************************************************
+
+	// Returns row * matrix, where row is a single row vector held in a register
+	inline __m128 MultiplyRow(const __m128 row, const Matrix4x4<float>& matrix) {
+		const float* data = matrix.Data();
+		__m128 result = _mm_mul_ps(SIMD::Splat<0>(row), _mm_load_ps(data));
+		result = SIMD::MulAdd(SIMD::Splat<1>(row), _mm_load_ps(data + 4), result);
+		result = SIMD::MulAdd(SIMD::Splat<2>(row), _mm_load_ps(data + 8), result);
+		return SIMD::MulAdd(SIMD::Splat<3>(row), _mm_load_ps(data + 12), result);
+	}
+
+	constexpr Matrix4x4<float> operator*(const Matrix4x4<float>& matrix0, const Matrix4x4<float>& matrix1) {
+		if (std::is_constant_evaluated()) {
+			return operator*<float>(matrix0, matrix1);
+		}
+
+		Matrix4x4<float> tempMatrix;
+		const float* left = matrix0.Data();
+		float* out = tempMatrix.Data();
+
+#ifdef OMATH_AVX
+		// Two rows per iteration, the right hand rows are duplicated into both halves
+		const float* right = matrix1.Data();
+		const __m256 row0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(right));
+		const __m256 row1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(right + 4));
+		const __m256 row2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(right + 8));
+		const __m256 row3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(right + 12));
+
+		for (int row = 0; row < 16; row += 8) {
+			const __m256 rows = _mm256_loadu_ps(left + row);
+			__m256 result = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x00), row0);
+			result = SIMD::MulAdd(_mm256_shuffle_ps(rows, rows, 0x55), row1, result);
+			result = SIMD::MulAdd(_mm256_shuffle_ps(rows, rows, 0xAA), row2, result);
+			result = SIMD::MulAdd(_mm256_shuffle_ps(rows, rows, 0xFF), row3, result);
+			_mm256_storeu_ps(out + row, result);
+		}
+#else
+		for (int row = 0; row < 16; row += 4) {
+			_mm_store_ps(out + row, MultiplyRow(_mm_load_ps(left + row), matrix1));
+		}
+#endif
+		return tempMatrix;
+	}
+
+	constexpr void operator*=(Matrix4x4<float>& matrix0, const Matrix4x4<float>& matrix1) {
+		matrix0 = matrix0 * matrix1;
+	}
+
+	constexpr Vector4<float> operator*(const Vector4<float>& aVector, const Matrix4x4<float>& matrix) {
+		if (std::is_constant_evaluated()) {
+			return operator*<float>(aVector, matrix);
+		}
+		return Vector4<float>(MultiplyRow(aVector.Load(), matrix));
+	}
+
+	constexpr Vector4<float> operator*(const Matrix4x4<float>& matrix, const Vector4<float>& aVector) {
+		if (std::is_constant_evaluated()) {
+			return operator*<float>(matrix, aVector);
+		}
+		return Vector4<float>(MultiplyRow(aVector.Load(), matrix));
+	}
+
+	template <>
+	constexpr Matrix4x4<float> Matrix4x4<float>::Transpose(const Matrix4x4<float>& matrixToTranspose) {
+		if (std::is_constant_evaluated()) {
+			return Scalar::Transpose(matrixToTranspose);
+		}
+
+		const float* data = matrixToTranspose.Data();
+		__m128 row0 = _mm_load_ps(data);
+		__m128 row1 = _mm_load_ps(data + 4);
+		__m128 row2 = _mm_load_ps(data + 8);
+		__m128 row3 = _mm_load_ps(data + 12);
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+		Matrix4x4<float> temp;
+		float* out = temp.Data();
+		_mm_store_ps(out, row0);
+		_mm_store_ps(out + 4, row1);
+		_mm_store_ps(out + 8, row2);
+		_mm_store_ps(out + 12, row3);
+
+		return temp;
+	}
+
+	template <>
+	constexpr Matrix4x4<float> Matrix4x4<float>::GetFastInverse(const Matrix4x4<float>& transform) {
+		if (std::is_constant_evaluated()) {
+			return Scalar::GetFastInverse(transform);
+		}
+
+		const float* data = transform.Data();
+		const __m128 row0 = _mm_load_ps(data);
+		const __m128 row1 = _mm_load_ps(data + 4);
+		const __m128 row2 = _mm_load_ps(data + 8);
+		const __m128 row3 = _mm_load_ps(data + 12);
+		const __m128 maskW = SIMD::MaskW();
+
+		// Transpose the rotation part, the w column of the zero row leaves the w lanes cleared
+		__m128 axis0 = row0;
+		__m128 axis1 = row1;
+		__m128 axis2 = row2;
+		__m128 axis3 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(axis0, axis1, axis2, axis3);
+
+		// Translation is the negated original translation rotated into the new basis
+		__m128 translation = _mm_mul_ps(SIMD::Splat<0>(row3), axis0);
+		translation = SIMD::MulAdd(SIMD::Splat<1>(row3), axis1, translation);
+		translation = SIMD::MulAdd(SIMD::Splat<2>(row3), axis2, translation);
+		translation = _mm_sub_ps(_mm_setzero_ps(), translation);
+
+		Matrix4x4<float> newMatrix;
+		float* out = newMatrix.Data();
+		_mm_store_ps(out, _mm_or_ps(axis0, _mm_and_ps(maskW, row0)));
+		_mm_store_ps(out + 4, _mm_or_ps(axis1, _mm_and_ps(maskW, row1)));
+		_mm_store_ps(out + 8, _mm_or_ps(axis2, _mm_and_ps(maskW, row2)));
+		_mm_store_ps(out + 12, _mm_or_ps(_mm_andnot_ps(maskW, translation), _mm_and_ps(maskW, row3)));
+
+		return newMatrix;
+	}
+
+	namespace SIMD {
+		// Shuffle with the lane order written left to right, x and y from a, z and w from b
+		template <int x, int y, int z, int w>
+		inline __m128 Shuffle(const __m128 a, const __m128 b) {
+			return _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x));
+		}
+
+		template <int x, int y, int z, int w>
+		inline __m128 Swizzle(const __m128 value) {
+			return _mm_shuffle_ps(value, value, _MM_SHUFFLE(w, z, y, x));
+		}
+
+		// 2x2 matrices packed as (m11, m12, m21, m22)
+		// Returns a * b
+		inline __m128 Matrix2Multiply(const __m128 a, const __m128 b) {
+			return MulAdd(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b), _mm_mul_ps(a, Swizzle<0, 3, 0, 3>(b)));
+		}
+
+		// Returns adjugate(a) * b
+		inline __m128 Matrix2AdjugateMultiply(const __m128 a, const __m128 b) {
+			return _mm_sub_ps(_mm_mul_ps(Swizzle<3, 3, 0, 0>(a), b), _mm_mul_ps(Swizzle<1, 1, 2, 2>(a), Swizzle<2, 3, 0, 1>(b)));
+		}
+
+		// Returns a * adjugate(b)
+		inline __m128 Matrix2MultiplyAdjugate(const __m128 a, const __m128 b) {
+			return _mm_sub_ps(_mm_mul_ps(a, Swizzle<3, 0, 3, 0>(b)), _mm_mul_ps(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b)));
+		}
+	}
+
+	template <>
+	constexpr Matrix4x4<float> Matrix4x4<float>::Inverse(const Matrix4x4<float>& matrix) {
+		if (std::is_constant_evaluated()) {
+			return Scalar::Inverse(matrix);
+		}
 
-		result(4, 1) = 0.0f;
-		result(4, 2) = 0.0f;
-		result(4, 3) = 0.0f;
-		result(4, 4) = 1.0f;
+		// Block inverse of | A B |, where every block is a 2x2 matrix in one register
+		//                  | C D |
+		const float* data = matrix.Data();
+		const __m128 row0 = _mm_load_ps(data);
+		const __m128 row1 = _mm_load_ps(data + 4);
+		const __m128 row2 = _mm_load_ps(data + 8);
+		const __m128 row3 = _mm_load_ps(data + 12);
+
+		const __m128 a = _mm_movelh_ps(row0, row1);
+		const __m128 b = _mm_movehl_ps(row1, row0);
+		const __m128 c = _mm_movelh_ps(row2, row3);
+		const __m128 d = _mm_movehl_ps(row3, row2);
+
+		// (|A|, |B|, |C|, |D|)
+		const __m128 blockDeterminants = _mm_sub_ps(
+			_mm_mul_ps(SIMD::Shuffle<0, 2, 0, 2>(row0, row2), SIMD::Shuffle<1, 3, 1, 3>(row1, row3)),
+			_mm_mul_ps(SIMD::Shuffle<1, 3, 1, 3>(row0, row2), SIMD::Shuffle<0, 2, 0, 2>(row1, row3)));
+		const __m128 determinantA = SIMD::Splat<0>(blockDeterminants);
+		const __m128 determinantB = SIMD::Splat<1>(blockDeterminants);
+		const __m128 determinantC = SIMD::Splat<2>(blockDeterminants);
+		const __m128 determinantD = SIMD::Splat<3>(blockDeterminants);
+
+		const __m128 adjugateDC = SIMD::Matrix2AdjugateMultiply(d, c);
+		const __m128 adjugateAB = SIMD::Matrix2AdjugateMultiply(a, b);
+
+		// Adjugates of the result blocks X, Y, Z and W
+		__m128 x = _mm_sub_ps(_mm_mul_ps(determinantD, a), SIMD::Matrix2Multiply(b, adjugateDC));
+		__m128 w = _mm_sub_ps(_mm_mul_ps(determinantA, d), SIMD::Matrix2Multiply(c, adjugateAB));
+		__m128 y = _mm_sub_ps(_mm_mul_ps(determinantB, c), SIMD::Matrix2MultiplyAdjugate(d, adjugateAB));
+		__m128 z = _mm_sub_ps(_mm_mul_ps(determinantC, b), SIMD::Matrix2MultiplyAdjugate(a, adjugateDC));
+
+		// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+		__m128 determinant = _mm_add_ps(_mm_mul_ps(determinantA, determinantD), _mm_mul_ps(determinantB, determinantC));
+		const __m128 trace = SIMD::HorizontalSum(_mm_mul_ps(adjugateAB, SIMD::Swizzle<0, 2, 1, 3>(adjugateDC)));
+		determinant = _mm_sub_ps(determinant, trace);
+
+		const __m128 inverseDeterminant = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), determinant);
+		x = _mm_mul_ps(x, inverseDeterminant);
+		y = _mm_mul_ps(y, inverseDeterminant);
+		z = _mm_mul_ps(z, inverseDeterminant);
+		w = _mm_mul_ps(w, inverseDeterminant);
+
+		// The adjugate shuffle and the block to row shuffle in one step
+		Matrix4x4<float> result;
+		float* out = result.Data();
+		_mm_store_ps(out, SIMD::Shuffle<3, 1, 3, 1>(x, y));
+		_mm_store_ps(out + 4, SIMD::Shuffle<2, 0, 2, 0>(x, y));
+		_mm_store_ps(out + 8, SIMD::Shuffle<3, 1, 3, 1>(z, w));
+		_mm_store_ps(out + 12, SIMD::Shuffle<2, 0, 2, 0>(z, w));
 
 		return result;
 	}
+#endif
 
 	typedef Matrix4x4<float> Matrix4x4f;
 	typedef Matrix4x4<double> Matrix4x4d;
@@ -0,0 +1,265 @@
+#pragma once
+#include "OMath.h"
+#include "Vector3.h"
+#include "Matrix4x4.h"
+#include "AABB.h"
+#include "Sphere.h"
+
+namespace OMath {
+	// Oriented bounding box, a center, three orthonormal axes and the half size along each of them
+	template <class T>
+	class OBB {
+	public:
+		constexpr OBB();
+		constexpr OBB(const Vector3<T>& center, const Vector3<T>& axisX, const Vector3<T>& axisY, const Vector3<T>& axisZ, const Vector3<T>& extents);
+		constexpr OBB(const OBB<T>& obb) = default;
+		~OBB() = default;
+
+		constexpr OBB<T>& operator=(const OBB<T>& obb) = default;
+
+		// Returns the box transformed by the matrix, scale ends up in the extents. Sheared matrices are not supported
+		static constexpr OBB<T> CreateFromAABB(const AABB<T>& aabb, const Matrix4x4<T>& transform = Matrix4x4<T>());
+
+		// Returns false for the empty box
+		constexpr bool IsValid() const;
+
+		// Writes the 8 corners
+		constexpr void GetCorners(Vector3<T> (&corners)[8]) const;
+
+		// Returns the axis aligned box around this box
+		constexpr AABB<T> GetAABB() const;
+
+		// Returns the box transformed by the matrix, sheared matrices are not supported
+		constexpr OBB<T> GetTransformed(const Matrix4x4<T>& transform) const;
+
+		// Grows the box along its own axes to contain the given box
+		constexpr void Merge(const OBB<T>& obb);
+
+		// Returns the point in or on the box closest to the given point
+		constexpr Vector3<T> ClosestPoint(const Vector3<T>& point) const;
+
+		// Returns the squared distance from the point to the box, zero inside
+		constexpr T DistanceSqrd(const Vector3<T>& point) const;
+
+		constexpr bool Contains(const Vector3<T>& point) const;
+
+		// Separating axis test over the 15 candidate axes, touching volumes overlap
+		constexpr bool Overlaps(const OBB<T>& obb) const;
+		constexpr bool Overlaps(const AABB<T>& aabb) const;
+		constexpr bool Overlaps(const Sphere<T>& sphere) const;
+
+		Vector3<T> mCenter;
+		Vector3<T> mAxes[3];
+		Vector3<T> mExtents;
+	};
+
+	template <class T>
+	constexpr OBB<T>::OBB() : mCenter(), mAxes{ { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } }, mExtents(-1, -1, -1) {}
+
+	template <class T>
+	constexpr OBB<T>::OBB(const Vector3<T>& center, const Vector3<T>& axisX, const Vector3<T>& axisY, const Vector3<T>& axisZ, const Vector3<T>& extents) :
+		mCenter(center), mAxes{ axisX, axisY, axisZ }, mExtents(extents) {}
+
+	template <class T>
+	constexpr OBB<T> OBB<T>::CreateFromAABB(const AABB<T>& aabb, const Matrix4x4<T>& transform) {
+		if (!aabb.IsValid()) {
+			return OBB<T>();
+		}
+		const Vector3<T> extents = aabb.GetExtents();
+		return OBB<T>(aabb.GetCenter(), { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, extents).GetTransformed(transform);
+	}
+
+	template <class T>
+	constexpr bool OBB<T>::IsValid() const {
+		return mExtents.mX >= 0 && mExtents.mY >= 0 && mExtents.mZ >= 0;
+	}
+
+	template <class T>
+	constexpr void OBB<T>::GetCorners(Vector3<T> (&corners)[8]) const {
+		for (int corner = 0; corner < 8; ++corner) {
+			const T signX = (corner & 1) ? 1 : -1;
+			const T signY = (corner & 2) ? 1 : -1;
+			const T signZ = (corner & 4) ? 1 : -1;
+			const Vector3<T> x = mAxes[0] * Vector3<T>(signX * mExtents.mX, signX * mExtents.mX, signX * mExtents.mX);
+			const Vector3<T> y = mAxes[1] * Vector3<T>(signY * mExtents.mY, signY * mExtents.mY, signY * mExtents.mY);
+			const Vector3<T> z = mAxes[2] * Vector3<T>(signZ * mExtents.mZ, signZ * mExtents.mZ, signZ * mExtents.mZ);
+			corners[corner] = mCenter + x + y + z;
+		}
+	}
+
+	template <class T>
+	constexpr AABB<T> OBB<T>::GetAABB() const {
+		if (!IsValid()) {
+			return AABB<T>();
+		}
+
+		const Vector3<T> extents(
+			mExtents.mX * Abs(mAxes[0].mX) + mExtents.mY * Abs(mAxes[1].mX) + mExtents.mZ * Abs(mAxes[2].mX),
+			mExtents.mX * Abs(mAxes[0].mY) + mExtents.mY * Abs(mAxes[1].mY) + mExtents.mZ * Abs(mAxes[2].mY),
+			mExtents.mX * Abs(mAxes[0].mZ) + mExtents.mY * Abs(mAxes[1].mZ) + mExtents.mZ * Abs(mAxes[2].mZ)
+		);
+		return AABB<T>::CreateFromCenterExtents(mCenter, extents);
+	}
+
+	template <class T>
+	constexpr OBB<T> OBB<T>::GetTransformed(const Matrix4x4<T>& transform) const {
+		if (!IsValid()) {
+			return *this;
+		}
+
+		const Matrix4x4<T>& m = transform;
+		OBB<T> result;
+		result.mCenter = {
+			mCenter.mX * m(1, 1) + mCenter.mY * m(2, 1) + mCenter.mZ * m(3, 1) + m(4, 1),
+			mCenter.mX * m(1, 2) + mCenter.mY * m(2, 2) + mCenter.mZ * m(3, 2) + m(4, 2),
+			mCenter.mX * m(1, 3) + mCenter.mY * m(2, 3) + mCenter.mZ * m(3, 3) + m(4, 3)
+		};
+
+		T extents[3] = { mExtents.mX, mExtents.mY, mExtents.mZ };
+		for (int axis = 0; axis < 3; ++axis) {
+			const Vector3<T>& a = mAxes[axis];
+			Vector3<T> transformed(
+				a.mX * m(1, 1) + a.mY * m(2, 1) + a.mZ * m(3, 1),
+				a.mX * m(1, 2) + a.mY * m(2, 2) + a.mZ * m(3, 2),
+				a.mX * m(1, 3) + a.mY * m(2, 3) + a.mZ * m(3, 3)
+			);
+
+			const T scale = transformed.Length();
+			extents[axis] *= scale;
+			if (scale != 0) {
+				transformed = transformed * Vector3<T>(1 / scale, 1 / scale, 1 / scale);
+			}
+			result.mAxes[axis] = transformed;
+		}
+		result.mExtents = { extents[0], extents[1], extents[2] };
+		return result;
+	}
+
+	template <class T>
+	constexpr void OBB<T>::Merge(const OBB<T>& obb) {
+		if (!obb.IsValid()) {
+			return;
+		}
+		if (!IsValid()) {
+			*this = obb;
+			return;
+		}
+
+		// Project both boxes onto the own axes and take the union of the intervals
+		Vector3<T> corners[8];
+		obb.GetCorners(corners);
+
+		T min[3] = { -mExtents.mX, -mExtents.mY, -mExtents.mZ };
+		T max[3] = { mExtents.mX, mExtents.mY, mExtents.mZ };
+		for (const Vector3<T>& corner : corners) {
+			const Vector3<T> offset = corner - mCenter;
+			for (int axis = 0; axis < 3; ++axis) {
+				const T distance = offset.Dot(mAxes[axis]);
+				min[axis] = Min(min[axis], distance);
+				max[axis] = Max(max[axis], distance);
+			}
+		}
+
+		for (int axis = 0; axis < 3; ++axis) {
+			const T shift = (min[axis] + max[axis]) / 2;
+			mCenter = mCenter + mAxes[axis] * Vector3<T>(shift, shift, shift);
+		}
+		mExtents = { (max[0] - min[0]) / 2, (max[1] - min[1]) / 2, (max[2] - min[2]) / 2 };
+	}
+
+	template <class T>
+	constexpr Vector3<T> OBB<T>::ClosestPoint(const Vector3<T>& point) const {
+		const Vector3<T> offset = point - mCenter;
+		const T extents[3] = { mExtents.mX, mExtents.mY, mExtents.mZ };
+
+		Vector3<T> result = mCenter;
+		for (int axis = 0; axis < 3; ++axis) {
+			const T distance = Clamp(offset.Dot(mAxes[axis]), -extents[axis], extents[axis]);
+			result = result + mAxes[axis] * Vector3<T>(distance, distance, distance);
+		}
+		return result;
+	}
+
+	template <class T>
+	constexpr T OBB<T>::DistanceSqrd(const Vector3<T>& point) const {
+		return (point - ClosestPoint(point)).LengthSqrd();
+	}
+
+	template <class T>
+	constexpr bool OBB<T>::Contains(const Vector3<T>& point) const {
+		const Vector3<T> offset = point - mCenter;
+		return Abs(offset.Dot(mAxes[0])) <= mExtents.mX &&
+			Abs(offset.Dot(mAxes[1])) <= mExtents.mY &&
+			Abs(offset.Dot(mAxes[2])) <= mExtents.mZ;
+	}
+
+	template <class T>
+	constexpr bool OBB<T>::Overlaps(const OBB<T>& obb) const {
+		if (!IsValid() || !obb.IsValid()) {
+			return false;
+		}
+
+		// Ericson, Real-Time Collision Detection 4.4.1, everything in the space of this box
+		const T extentsA[3] = { mExtents.mX, mExtents.mY, mExtents.mZ };
+		const T extentsB[3] = { obb.mExtents.mX, obb.mExtents.mY, obb.mExtents.mZ };
+
+		// The epsilon keeps near parallel edges from producing a zero cross product axis that separates everything
+		constexpr T epsilon = static_cast<T>(1e-6);
+		T rotation[3][3] = {};
+		T absRotation[3][3] = {};
+		for (int i = 0; i < 3; ++i) {
+			for (int j = 0; j < 3; ++j) {
+				rotation[i][j] = mAxes[i].Dot(obb.mAxes[j]);
+				absRotation[i][j] = Abs(rotation[i][j]) + epsilon;
+			}
+		}
+
+		const Vector3<T> offset = obb.mCenter - mCenter;
+		const T t[3] = { offset.Dot(mAxes[0]), offset.Dot(mAxes[1]), offset.Dot(mAxes[2]) };
+
+		// The axes of this box
+		for (int i = 0; i < 3; ++i) {
+			const T radiusB = extentsB[0] * absRotation[i][0] + extentsB[1] * absRotation[i][1] + extentsB[2] * absRotation[i][2];
+			if (Abs(t[i]) > extentsA[i] + radiusB) {
+				return false;
+			}
+		}
+
+		// The axes of the other box
+		for (int j = 0; j < 3; ++j) {
+			const T radiusA = extentsA[0] * absRotation[0][j] + extentsA[1] * absRotation[1][j] + extentsA[2] * absRotation[2][j];
+			if (Abs(t[0] * rotation[0][j] + t[1] * rotation[1][j] + t[2] * rotation[2][j]) > radiusA + extentsB[j]) {
+				return false;
+			}
+		}
+
+		// The 9 cross products of one axis from each box
+		for (int i = 0; i < 3; ++i) {
+			const int i1 = (i + 1) % 3;
+			const int i2 = (i + 2) % 3;
+			for (int j = 0; j < 3; ++j) {
+				const int j1 = (j + 1) % 3;
+				const int j2 = (j + 2) % 3;
+				const T radiusA = extentsA[i1] * absRotation[i2][j] + extentsA[i2] * absRotation[i1][j];
+				const T radiusB = extentsB[j1] * absRotation[i][j2] + extentsB[j2] * absRotation[i][j1];
+				if (Abs(t[i2] * rotation[i1][j] - t[i1] * rotation[i2][j]) > radiusA + radiusB) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	template <class T>
+	constexpr bool OBB<T>::Overlaps(const AABB<T>& aabb) const {
+		return Overlaps(CreateFromAABB(aabb));
+	}
+
+	template <class T>
+	constexpr bool OBB<T>::Overlaps(const Sphere<T>& sphere) const {
+		return IsValid() && sphere.IsValid() && DistanceSqrd(sphere.mCenter) <= sphere.mRadius * sphere.mRadius;
+	}
+
+	typedef OBB<float> OBBf;
+	typedef OBB<double> OBBd;
+}
@@ -1,4 +1,7 @@
 #pragma once
+#include <cmath>
+#include <type_traits>
+
 namespace OMath {
 	constexpr float pi_f = 3.14159265f;					// PI float
 	constexpr double pi_d = 3.1415926535897932;			// PI double
@@ -12,7 +15,7 @@ namespace OMath {
 	constexpr double sqrt2 = 1.41421356237309504880;	// sqrt(2)
 
 	template <typename T>
-	inline T Clamp(const T& value, const T& min, const T& max) {
+	constexpr T Clamp(const T& value, const T& min, const T& max) {
 		if (value < min) { 
 			return min; 
 		}
@@ -24,30 +27,86 @@ namespace OMath {
 	}
 
 	template <typename T>
-	inline auto Squared(const T& value) noexcept {
+	constexpr auto Squared(const T& value) noexcept {
 		return value * value;
 	}
 
 	template <typename T>
-	T Lerp(const T& start, const T& end, const T& percentage) {
-		return start + percentage * (end - percentage);
+	constexpr T Lerp(const T& start, const T& end, const T& percentage) {
+		return start + percentage * (end - start);
 	}
 
 	template <typename T>
-	T Min(const T& first, const T& second) {
+	constexpr T Min(const T& first, const T& second) {
 		return first < second ? first : second;
 	}
 
 	template <typename T>
-	T Max(const T& first, const T& second) {
+	constexpr T Max(const T& first, const T& second) {
 		return first > second ? first : second;
 	}
 
 	template <typename T>
-	T Abs(const T& value) {
+	constexpr T Abs(const T& value) {
 		if (value < 0) {
 			return value * -1;
 		}
 		return value;
 	}
+
+	// Square root that is usable in constant expressions, std::sqrt at runtime
+	template <typename T>
+	constexpr T Sqrt(const T& value) {
+		if (std::is_constant_evaluated()) {
+			const double target = static_cast<double>(value);
+			if (target <= 0.0) {
+				return static_cast<T>(0);
+			}
+
+			double estimate = target < 1.0 ? 1.0 : target;
+			for (int iteration = 0; iteration < 64; ++iteration) {
+				const double next = 0.5 * (estimate + target / estimate);
+				if (next == estimate) {
+					break;
+				}
+				estimate = next;
+			}
+			return static_cast<T>(estimate);
+		}
+		return static_cast<T>(std::sqrt(value));
+	}
+
+	// Sine that is usable in constant expressions, std::sin at runtime
+	template <typename T>
+	constexpr T Sin(const T& angleInRadians) {
+		if (std::is_constant_evaluated()) {
+			// Reduce to [-pi, pi], then the Taylor series converges to double precision
+			constexpr double twoPi = 2.0 * pi_d;
+			double angle = static_cast<double>(angleInRadians);
+			angle -= twoPi * static_cast<double>(static_cast<long long>(angle / twoPi));
+			if (angle > pi_d) {
+				angle -= twoPi;
+			} else if (angle < -pi_d) {
+				angle += twoPi;
+			}
+
+			double term = angle;
+			double sum = angle;
+			for (int n = 1; n < 16; ++n) {
+				term *= -angle * angle / static_cast<double>((2 * n) * (2 * n + 1));
+				sum += term;
+			}
+			return static_cast<T>(sum);
+		}
+		return static_cast<T>(std::sin(angleInRadians));
+	}
+
+	// Cosine that is usable in constant expressions, std::cos at runtime
+	template <typename T>
+	constexpr T Cos(const T& angleInRadians) {
+		if (std::is_constant_evaluated()) {
+			return Sin(static_cast<T>(static_cast<double>(angleInRadians) + pi_2));
+		}
+		return static_cast<T>(std::cos(angleInRadians));
+	}
 }
\ No newline at end of file
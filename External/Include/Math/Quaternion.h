@@ -0,0 +1,320 @@
+#pragma once
+#include <cmath>
+#include "Vector3.h"
+#include "Matrix4x4.h"
+
+namespace OMath {
+	// Rotation quaternion, (mX, mY, mZ) is the vector part and mW the scalar part.
+	// Follows the Matrix4x4 conventions: row vectors, and q0 * q1 means q0 followed by q1.
+	template <class T>
+	class Quaternion {
+	public:
+		constexpr Quaternion();
+		constexpr Quaternion(const T& x, const T& y, const T& z, const T& w);
+		constexpr Quaternion(const Quaternion<T>& quaternion) = default;
+		~Quaternion() = default;
+
+		constexpr Quaternion<T>& operator=(const Quaternion<T>& quaternion) = default;
+
+		// Creates a rotation of angleInRadians around the given (normalized) axis
+		static constexpr Quaternion<T> CreateFromAxisAngle(const Vector3<T>& axis, T angleInRadians);
+
+		/*	Same order as Matrix4x4::CreateRotationMatrix
+			x - pitch
+			y - yaw
+			z - roll */
+		static constexpr Quaternion<T> CreateFromEuler(const Vector3<T>& rotationVector);
+
+		// Creates the rotation of a pure rotation matrix, see Matrix4x4::Decompose for scaled transforms
+		static constexpr Quaternion<T> CreateFromMatrix(const Matrix4x4<T>& rotation);
+
+		// Returns the (pitch, yaw, roll) angles that CreateFromEuler would turn back into this rotation
+		Vector3<T> ToEuler() const;
+
+		// Writes the normalized rotation axis and returns the angle in radians
+		T ToAxisAngle(Vector3<T>& axis) const;
+
+		// Returns the rotation as a matrix, equal to Matrix4x4::CreateRotationMatrix(ToEuler())
+		constexpr Matrix4x4<T> ToMatrix() const;
+
+		// Returns the squared length of the quaternion
+		constexpr T LengthSqrd() const;
+
+		// Returns the length of the quaternion
+		constexpr T Length() const;
+
+		// Returns the normalized value of the quaternion
+		constexpr Quaternion<T> GetNormalized() const;
+
+		// Normalizes the quaternion
+		constexpr void Normalize();
+
+		// Returns the conjugate, which is the inverse rotation for unit quaternions
+		constexpr Quaternion<T> GetConjugate() const;
+
+		// Returns the inverse, valid for non unit quaternions as well
+		constexpr Quaternion<T> GetInverse() const;
+
+		// Returns the dot product of the current quaternion and the given quaternion
+		constexpr T Dot(const Quaternion<T>& quaternion) const;
+
+		// Rotates the given vector, same result as vector * ToMatrix()
+		constexpr Vector3<T> Rotate(const Vector3<T>& vector) const;
+
+		// Normalized linear interpolation along the shortest path, cheap but not constant speed
+		static constexpr Quaternion<T> Nlerp(const Quaternion<T>& start, const Quaternion<T>& end, const T percentage);
+
+		// Spherical linear interpolation along the shortest path
+		static Quaternion<T> Slerp(const Quaternion<T>& start, const Quaternion<T>& end, const T percentage);
+
+		T mX;
+		T mY;
+		T mZ;
+		T mW;
+	};
+
+	template<class T>
+	constexpr Quaternion<T>::Quaternion() : mX(0), mY(0), mZ(0), mW(1) {}
+
+	template<class T>
+	constexpr Quaternion<T>::Quaternion(const T& x, const T& y, const T& z, const T& w) : mX(x), mY(y), mZ(z), mW(w) {}
+
+	template<class T>
+	constexpr Quaternion<T> Quaternion<T>::CreateFromAxisAngle(const Vector3<T>& axis, T angleInRadians) {
+		const T halfAngle = angleInRadians * static_cast<T>(0.5);
+		const T sine = Sin(halfAngle);
+		return { axis.mX * sine, axis.mY * sine, axis.mZ * sine, Cos(halfAngle) };
+	}
+
+	template<class T>
+	constexpr Quaternion<T> Quaternion<T>::CreateFromEuler(const Vector3<T>& rotationVector) {
+		const T half = static_cast<T>(0.5);
+
+		const T cp = Cos(rotationVector.mX * half);
+		const T sp = Sin(rotationVector.mX * half);
+
+		const T cy = Cos(rotationVector.mY * half);
+		const T sy = Sin(rotationVector.mY * half);
+
+		const T cr = Cos(rotationVector.mZ * half);
+		const T sr = Sin(rotationVector.mZ * half);
+
+		return {
+			cy * sp * cr + sy * cp * sr,
+			sy * cp * cr - cy * sp * sr,
+			cy * cp * sr - sy * sp * cr,
+			cy * cp * cr + sy * sp * sr
+		};
+	}
+
+	template<class T>
+	constexpr Quaternion<T> Quaternion<T>::CreateFromMatrix(const Matrix4x4<T>& rotation) {
+		const Matrix4x4<T>& m = rotation;
+		const T one = static_cast<T>(1);
+		const T two = static_cast<T>(2);
+		const T quarter = static_cast<T>(0.25);
+		const T trace = m(1, 1) + m(2, 2) + m(3, 3);
+
+		// Divide by the largest component to stay away from cancellation
+		if (trace > static_cast<T>(0)) {
+			const T s = Sqrt(trace + one) * two;
+			return { (m(2, 3) - m(3, 2)) / s, (m(3, 1) - m(1, 3)) / s, (m(1, 2) - m(2, 1)) / s, s * quarter };
+		}
+		if (m(1, 1) > m(2, 2) && m(1, 1) > m(3, 3)) {
+			const T s = Sqrt(one + m(1, 1) - m(2, 2) - m(3, 3)) * two;
+			return { s * quarter, (m(1, 2) + m(2, 1)) / s, (m(1, 3) + m(3, 1)) / s, (m(2, 3) - m(3, 2)) / s };
+		}
+		if (m(2, 2) > m(3, 3)) {
+			const T s = Sqrt(one + m(2, 2) - m(1, 1) - m(3, 3)) * two;
+			return { (m(1, 2) + m(2, 1)) / s, s * quarter, (m(2, 3) + m(3, 2)) / s, (m(3, 1) - m(1, 3)) / s };
+		}
+		const T s = Sqrt(one + m(3, 3) - m(1, 1) - m(2, 2)) * two;
+		return { (m(1, 3) + m(3, 1)) / s, (m(2, 3) + m(3, 2)) / s, s * quarter, (m(1, 2) - m(2, 1)) / s };
+	}
+
+	template<class T>
+	inline Vector3<T> Quaternion<T>::ToEuler() const {
+		// Same terms as the matrix, row 3 = (cp * sy, -sp, cp * cy) and column 2 = (sr * cp, cr * cp, -sp)
+		const T sinPitch = static_cast<T>(2) * (mX * mW - mY * mZ);
+		const T pitch = std::asin(sinPitch > 1 ? static_cast<T>(1) : (sinPitch < -1 ? static_cast<T>(-1) : sinPitch));
+
+		const T yaw = std::atan2(static_cast<T>(2) * (mX * mZ + mY * mW), static_cast<T>(1) - static_cast<T>(2) * (mX * mX + mY * mY));
+		const T roll = std::atan2(static_cast<T>(2) * (mX * mY + mZ * mW), static_cast<T>(1) - static_cast<T>(2) * (mX * mX + mZ * mZ));
+
+		return { pitch, yaw, roll };
+	}
+
+	template<class T>
+	inline T Quaternion<T>::ToAxisAngle(Vector3<T>& axis) const {
+		const Quaternion<T> unit = GetNormalized();
+		const T sineSqrd = unit.mX * unit.mX + unit.mY * unit.mY + unit.mZ * unit.mZ;
+
+		if (sineSqrd <= static_cast<T>(0)) {
+			axis = { static_cast<T>(1), static_cast<T>(0), static_cast<T>(0) };
+			return static_cast<T>(0);
+		}
+
+		const T sine = static_cast<T>(std::sqrt(sineSqrd));
+		axis = { unit.mX / sine, unit.mY / sine, unit.mZ / sine };
+		return static_cast<T>(2) * std::atan2(sine, unit.mW);
+	}
+
+	template<class T>
+	constexpr Matrix4x4<T> Quaternion<T>::ToMatrix() const {
+		const T two = static_cast<T>(2);
+		const T xx = mX * mX * two;
+		const T yy = mY * mY * two;
+		const T zz = mZ * mZ * two;
+		const T xy = mX * mY * two;
+		const T xz = mX * mZ * two;
+		const T yz = mY * mZ * two;
+		const T xw = mX * mW * two;
+		const T yw = mY * mW * two;
+		const T zw = mZ * mW * two;
+
+		Matrix4x4<T> result;
+		result(1, 1) = static_cast<T>(1) - yy - zz;
+		result(1, 2) = xy + zw;
+		result(1, 3) = xz - yw;
+
+		result(2, 1) = xy - zw;
+		result(2, 2) = static_cast<T>(1) - xx - zz;
+		result(2, 3) = yz + xw;
+
+		result(3, 1) = xz + yw;
+		result(3, 2) = yz - xw;
+		result(3, 3) = static_cast<T>(1) - xx - yy;
+
+		return result;
+	}
+
+	template<class T>
+	constexpr T Quaternion<T>::LengthSqrd() const {
+		return mX * mX + mY * mY + mZ * mZ + mW * mW;
+	}
+
+	template<class T>
+	constexpr T Quaternion<T>::Length() const {
+		return Sqrt(LengthSqrd());
+	}
+
+	template<class T>
+	constexpr Quaternion<T> Quaternion<T>::GetNormalized() const {
+		Quaternion<T> quaternion(*this);
+		quaternion.Normalize();
+		return quaternion;
+	}
+
+	template<class T>
+	constexpr void Quaternion<T>::Normalize() {
+		const T lengthSqrd = LengthSqrd();
+		if (lengthSqrd > static_cast<T>(0)) {
+			const T length = Sqrt(lengthSqrd);
+			mX /= length;
+			mY /= length;
+			mZ /= length;
+			mW /= length;
+		}
+	}
+
+	template<class T>
+	constexpr Quaternion<T> Quaternion<T>::GetConjugate() const {
+		return { -mX, -mY, -mZ, mW };
+	}
+
+	template<class T>
+	constexpr Quaternion<T> Quaternion<T>::GetInverse() const {
+		const T lengthSqrd = LengthSqrd();
+		return { -mX / lengthSqrd, -mY / lengthSqrd, -mZ / lengthSqrd, mW / lengthSqrd };
+	}
+
+	template<class T>
+	constexpr T Quaternion<T>::Dot(const Quaternion<T>& quaternion) const {
+		return mX * quaternion.mX + mY * quaternion.mY + mZ * quaternion.mZ + mW * quaternion.mW;
+	}
+
+	template<class T>
+	constexpr Vector3<T> Quaternion<T>::Rotate(const Vector3<T>& vector) const {
+		// v' = v + 2w(u x v) + 2u x (u x v), with u the vector part
+		const Vector3<T> u(mX, mY, mZ);
+		const Vector3<T> uv = u.Cross(vector);
+		const Vector3<T> twoUv(uv.mX * static_cast<T>(2), uv.mY * static_cast<T>(2), uv.mZ * static_cast<T>(2));
+		const Vector3<T> uTwoUv = u.Cross(twoUv);
+
+		return {
+			vector.mX + mW * twoUv.mX + uTwoUv.mX,
+			vector.mY + mW * twoUv.mY + uTwoUv.mY,
+			vector.mZ + mW * twoUv.mZ + uTwoUv.mZ
+		};
+	}
+
+	template<class T>
+	constexpr Quaternion<T> Quaternion<T>::Nlerp(const Quaternion<T>& start, const Quaternion<T>& end, const T percentage) {
+		const T sign = start.Dot(end) < static_cast<T>(0) ? static_cast<T>(-1) : static_cast<T>(1);
+		const T startWeight = static_cast<T>(1) - percentage;
+		const T endWeight = percentage * sign;
+
+		Quaternion<T> result(
+			start.mX * startWeight + end.mX * endWeight,
+			start.mY * startWeight + end.mY * endWeight,
+			start.mZ * startWeight + end.mZ * endWeight,
+			start.mW * startWeight + end.mW * endWeight
+		);
+		result.Normalize();
+		return result;
+	}
+
+	template<class T>
+	inline Quaternion<T> Quaternion<T>::Slerp(const Quaternion<T>& start, const Quaternion<T>& end, const T percentage) {
+		T cosine = start.Dot(end);
+		T sign = static_cast<T>(1);
+		if (cosine < static_cast<T>(0)) {
+			cosine = -cosine;
+			sign = static_cast<T>(-1);
+		}
+
+		// Nearly parallel, sin(angle) goes to zero and nlerp is indistinguishable
+		if (cosine > static_cast<T>(0.9995)) {
+			return Nlerp(start, end, percentage);
+		}
+
+		const T angle = std::acos(cosine);
+		const T inverseSine = static_cast<T>(1) / std::sin(angle);
+		const T startWeight = std::sin((static_cast<T>(1) - percentage) * angle) * inverseSine;
+		const T endWeight = std::sin(percentage * angle) * inverseSine * sign;
+
+		return {
+			start.mX * startWeight + end.mX * endWeight,
+			start.mY * startWeight + end.mY * endWeight,
+			start.mZ * startWeight + end.mZ * endWeight,
+			start.mW * startWeight + end.mW * endWeight
+		};
+	}
+
+	// Returns the rotation quaternion0 followed by quaternion1
+	template <class T>
+	constexpr Quaternion<T> operator*(const Quaternion<T>& quaternion0, const Quaternion<T>& quaternion1) {
+		const Quaternion<T>& a = quaternion1;
+		const Quaternion<T>& b = quaternion0;
+		return {
+			a.mW * b.mX + a.mX * b.mW + a.mY * b.mZ - a.mZ * b.mY,
+			a.mW * b.mY - a.mX * b.mZ + a.mY * b.mW + a.mZ * b.mX,
+			a.mW * b.mZ + a.mX * b.mY - a.mY * b.mX + a.mZ * b.mW,
+			a.mW * b.mW - a.mX * b.mX - a.mY * b.mY - a.mZ * b.mZ
+		};
+	}
+
+	template <class T>
+	constexpr void operator*=(Quaternion<T>& quaternion0, const Quaternion<T>& quaternion1) {
+		quaternion0 = quaternion0 * quaternion1;
+	}
+
+	template <class T>
+	constexpr bool operator==(const Quaternion<T>& quaternion0, const Quaternion<T>& quaternion1) {
+		return quaternion0.mX == quaternion1.mX && quaternion0.mY == quaternion1.mY &&
+			quaternion0.mZ == quaternion1.mZ && quaternion0.mW == quaternion1.mW;
+	}
+
+	typedef Quaternion<float> Quaternionf;
+	typedef Quaternion<double> Quaterniond;
+}
@@ -0,0 +1,248 @@
+#pragma once
+#include <assert.h>
+#include <span>
+#include "FloatWide.h"
+#include "Quaternion.h"
+#include "TransformBatch.h"
+
+namespace OMath {
+	// Width Quaternion<float> stored as structure of arrays
+	template <int Width>
+	class QuaternionWide {
+	public:
+		using Float = FloatWide<Width>;
+
+		QuaternionWide();
+		QuaternionWide(const Float& x, const Float& y, const Float& z, const Float& w);
+		QuaternionWide(const QuaternionWide<Width>& quaternion) = default;
+		~QuaternionWide() = default;
+
+		QuaternionWide<Width>& operator=(const QuaternionWide<Width>& quaternion) = default;
+
+		// Transposes count (<= Width) consecutive quaternions into lanes, the remaining lanes are identity
+		static QuaternionWide<Width> Gather(const Quaternion<float>* source, const int count = Width);
+
+		// Writes the first count (<= Width) lanes back as consecutive quaternions
+		void Scatter(Quaternion<float>* destination, const int count = Width) const;
+
+		// Returns the dot product of every lane with the matching lane of the given quaternion
+		Float Dot(const QuaternionWide<Width>& quaternion) const;
+
+		// Normalizes every lane
+		void Normalize();
+
+		// Writes every lane as a rotation matrix, count (<= Width) matrices are written
+		void ToMatrices(Matrix4x4<float>* destination, const int count = Width) const;
+
+		// Normalized linear interpolation along the shortest path
+		static QuaternionWide<Width> Nlerp(const QuaternionWide<Width>& start, const QuaternionWide<Width>& end, const Float& percentage);
+
+		// Spherical linear interpolation along the shortest path without any trigonometry.
+		// Uses the polynomial estimate from Eberly, "A Fast and Accurate Algorithm for Computing SLERP",
+		// the weights stay within 2e-5 of the exact slerp weights for every angle and percentage.
+		static QuaternionWide<Width> Slerp(const QuaternionWide<Width>& start, const QuaternionWide<Width>& end, const Float& percentage);
+
+		Float mX;
+		Float mY;
+		Float mZ;
+		Float mW;
+	};
+
+	template <int Width>
+	inline QuaternionWide<Width>::QuaternionWide() : mW(1.0f) {}
+
+	template <int Width>
+	inline QuaternionWide<Width>::QuaternionWide(const Float& x, const Float& y, const Float& z, const Float& w) : mX(x), mY(y), mZ(z), mW(w) {}
+
+	template <int Width>
+	inline QuaternionWide<Width> QuaternionWide<Width>::Gather(const Quaternion<float>* source, const int count) {
+		alignas(64) float x[Width] = {};
+		alignas(64) float y[Width] = {};
+		alignas(64) float z[Width] = {};
+		alignas(64) float w[Width];
+
+		for (int lane = 0; lane < Width; ++lane) {
+			w[lane] = 1.0f;
+		}
+		for (int lane = 0; lane < count && lane < Width; ++lane) {
+			x[lane] = source[lane].mX;
+			y[lane] = source[lane].mY;
+			z[lane] = source[lane].mZ;
+			w[lane] = source[lane].mW;
+		}
+		return { Float::Load(x), Float::Load(y), Float::Load(z), Float::Load(w) };
+	}
+
+	template <int Width>
+	inline void QuaternionWide<Width>::Scatter(Quaternion<float>* destination, const int count) const {
+		alignas(64) float x[Width];
+		alignas(64) float y[Width];
+		alignas(64) float z[Width];
+		alignas(64) float w[Width];
+		mX.Store(x);
+		mY.Store(y);
+		mZ.Store(z);
+		mW.Store(w);
+
+		for (int lane = 0; lane < count && lane < Width; ++lane) {
+			destination[lane] = { x[lane], y[lane], z[lane], w[lane] };
+		}
+	}
+
+	template <int Width>
+	inline typename QuaternionWide<Width>::Float QuaternionWide<Width>::Dot(const QuaternionWide<Width>& quaternion) const {
+		return MulAdd(mW, quaternion.mW, MulAdd(mZ, quaternion.mZ, MulAdd(mY, quaternion.mY, mX * quaternion.mX)));
+	}
+
+	template <int Width>
+	inline void QuaternionWide<Width>::Normalize() {
+		const Float inverseLength = Float(1.0f) / Sqrt(Dot(*this));
+		mX *= inverseLength;
+		mY *= inverseLength;
+		mZ *= inverseLength;
+		mW *= inverseLength;
+	}
+
+	template <int Width>
+	inline void QuaternionWide<Width>::ToMatrices(Matrix4x4<float>* destination, const int count) const {
+		const Float two(2.0f);
+		const Float one(1.0f);
+		const Float x2 = mX * two;
+		const Float y2 = mY * two;
+		const Float z2 = mZ * two;
+
+		const Float xx = mX * x2;
+		const Float yy = mY * y2;
+		const Float zz = mZ * z2;
+		const Float xy = mX * y2;
+		const Float xz = mX * z2;
+		const Float yz = mY * z2;
+		const Float xw = mW * x2;
+		const Float yw = mW * y2;
+		const Float zw = mW * z2;
+
+		// Same layout as Quaternion::ToMatrix, one row of 9 element arrays
+		alignas(64) float elements[9][Width];
+		(one - yy - zz).Store(elements[0]);
+		(xy + zw).Store(elements[1]);
+		(xz - yw).Store(elements[2]);
+		(xy - zw).Store(elements[3]);
+		(one - xx - zz).Store(elements[4]);
+		(yz + xw).Store(elements[5]);
+		(xz + yw).Store(elements[6]);
+		(yz - xw).Store(elements[7]);
+		(one - xx - yy).Store(elements[8]);
+
+		for (int lane = 0; lane < count && lane < Width; ++lane) {
+			float* out = destination[lane].Data();
+			out[0] = elements[0][lane];
+			out[1] = elements[1][lane];
+			out[2] = elements[2][lane];
+			out[3] = 0.0f;
+			out[4] = elements[3][lane];
+			out[5] = elements[4][lane];
+			out[6] = elements[5][lane];
+			out[7] = 0.0f;
+			out[8] = elements[6][lane];
+			out[9] = elements[7][lane];
+			out[10] = elements[8][lane];
+			out[11] = 0.0f;
+			out[12] = 0.0f;
+			out[13] = 0.0f;
+			out[14] = 0.0f;
+			out[15] = 1.0f;
+		}
+	}
+
+	template <int Width>
+	inline QuaternionWide<Width> QuaternionWide<Width>::Nlerp(const QuaternionWide<Width>& start, const QuaternionWide<Width>& end, const Float& percentage) {
+		const Float sign = Select(start.Dot(end) < Float(0.0f), Float(-1.0f), Float(1.0f));
+		const Float startWeight = Float(1.0f) - percentage;
+		const Float endWeight = percentage * sign;
+
+		QuaternionWide<Width> result(
+			MulAdd(end.mX, endWeight, start.mX * startWeight),
+			MulAdd(end.mY, endWeight, start.mY * startWeight),
+			MulAdd(end.mZ, endWeight, start.mZ * startWeight),
+			MulAdd(end.mW, endWeight, start.mW * startWeight)
+		);
+		result.Normalize();
+		return result;
+	}
+
+	template <int Width>
+	inline QuaternionWide<Width> QuaternionWide<Width>::Slerp(const QuaternionWide<Width>& start, const QuaternionWide<Width>& end, const Float& percentage) {
+		// u[i] = 1 / ((i + 1)(2i + 3)), v[i] = (i + 1) / (2i + 3), last term scaled by mu to cancel the truncation error
+		constexpr float mu = 1.85298109240830f;
+		constexpr float u[8] = { 1.0f / (1 * 3), 1.0f / (2 * 5), 1.0f / (3 * 7), 1.0f / (4 * 9), 1.0f / (5 * 11), 1.0f / (6 * 13), 1.0f / (7 * 15), mu / (8 * 17) };
+		constexpr float v[8] = { 1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9, 5.0f / 11, 6.0f / 13, 7.0f / 15, mu * 8 / 17 };
+
+		Float cosine = start.Dot(end);
+		const Float sign = Select(cosine < Float(0.0f), Float(-1.0f), Float(1.0f));
+		cosine *= sign;
+
+		const Float cosineMinusOne = cosine - Float(1.0f);
+		const Float t = percentage;
+		const Float oneMinusT = Float(1.0f) - percentage;
+		const Float tSqrd = t * t;
+		const Float oneMinusTSqrd = oneMinusT * oneMinusT;
+
+		// Horner evaluation of 1 + b[0](1 + b[1](1 + ... (1 + b[7])))
+		Float endSeries(1.0f);
+		Float startSeries(1.0f);
+		for (int term = 7; term >= 0; --term) {
+			const Float endTerm = (tSqrd * Float(u[term]) - Float(v[term])) * cosineMinusOne;
+			const Float startTerm = (oneMinusTSqrd * Float(u[term]) - Float(v[term])) * cosineMinusOne;
+			endSeries = MulAdd(endTerm, endSeries, Float(1.0f));
+			startSeries = MulAdd(startTerm, startSeries, Float(1.0f));
+		}
+
+		const Float startWeight = oneMinusT * startSeries;
+		const Float endWeight = t * endSeries * sign;
+
+		return {
+			MulAdd(end.mX, endWeight, start.mX * startWeight),
+			MulAdd(end.mY, endWeight, start.mY * startWeight),
+			MulAdd(end.mZ, endWeight, start.mZ * startWeight),
+			MulAdd(end.mW, endWeight, start.mW * startWeight)
+		};
+	}
+
+	// Slerps start[i] towards end[i] by percentage[i] into output[i]
+	inline void Slerp(std::span<const Quaternion<float>> start, std::span<const Quaternion<float>> end, std::span<const float> percentage, std::span<Quaternion<float>> output) {
+		constexpr int width = sTransformBatchWidth > 1 ? sTransformBatchWidth : 4;
+		assert(end.size() >= start.size() && percentage.size() >= start.size() && output.size() >= start.size() && "Span sizes do not match");
+
+		const size_t count = start.size();
+		for (size_t index = 0; index < count; index += width) {
+			const int lanes = static_cast<int>(count - index < width ? count - index : width);
+
+			alignas(64) float t[width] = {};
+			for (int lane = 0; lane < lanes; ++lane) {
+				t[lane] = percentage[index + lane];
+			}
+
+			const QuaternionWide<width> result = QuaternionWide<width>::Slerp(
+				QuaternionWide<width>::Gather(&start[index], lanes),
+				QuaternionWide<width>::Gather(&end[index], lanes),
+				FloatWide<width>::Load(t));
+			result.Scatter(&output[index], lanes);
+		}
+	}
+
+	// Converts every quaternion to a rotation matrix
+	inline void ToMatrices(std::span<const Quaternion<float>> input, std::span<Matrix4x4<float>> output) {
+		constexpr int width = sTransformBatchWidth > 1 ? sTransformBatchWidth : 4;
+		assert(output.size() >= input.size() && "Output span is too small");
+
+		const size_t count = input.size();
+		for (size_t index = 0; index < count; index += width) {
+			const int lanes = static_cast<int>(count - index < width ? count - index : width);
+			QuaternionWide<width>::Gather(&input[index], lanes).ToMatrices(&output[index], lanes);
+		}
+	}
+
+	typedef QuaternionWide<4> Quaternionfx4;
+	typedef QuaternionWide<8> Quaternionfx8;
+	typedef QuaternionWide<16> Quaternionfx16;
+}
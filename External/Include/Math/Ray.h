@@ -0,0 +1,118 @@
+#pragma once
+#include <limits>
+#include "OMath.h"
+#include "Vector3.h"
+#include "AABB.h"
+#include "Sphere.h"
+
+namespace OMath {
+	// Half line from an origin, the direction does not have to be normalized but distances are in its length
+	template <class T>
+	class Ray {
+	public:
+		constexpr Ray();
+		constexpr Ray(const Vector3<T>& origin, const Vector3<T>& direction);
+		constexpr Ray(const Ray<T>& ray) = default;
+		~Ray() = default;
+
+		constexpr Ray<T>& operator=(const Ray<T>& ray) = default;
+
+		constexpr Vector3<T> GetPoint(const T& distance) const;
+
+		// 1 / direction per axis, infinite for zero components which the slab tests rely on
+		constexpr Vector3<T> GetInverseDirection() const;
+
+		// Writes the entry distance, zero when the origin is inside. Returns false when the box is missed or behind
+		constexpr bool Intersects(const AABB<T>& aabb, T& distance) const;
+		constexpr bool Intersects(const Sphere<T>& sphere, T& distance) const;
+
+		Vector3<T> mOrigin;
+		Vector3<T> mDirection;
+	};
+
+	template <class T>
+	constexpr Ray<T>::Ray() : mOrigin(), mDirection(0, 0, 1) {}
+
+	template <class T>
+	constexpr Ray<T>::Ray(const Vector3<T>& origin, const Vector3<T>& direction) : mOrigin(origin), mDirection(direction) {}
+
+	template <class T>
+	constexpr Vector3<T> Ray<T>::GetPoint(const T& distance) const {
+		return mOrigin + mDirection * Vector3<T>(distance, distance, distance);
+	}
+
+	template <class T>
+	constexpr Vector3<T> Ray<T>::GetInverseDirection() const {
+		constexpr T infinity = std::numeric_limits<T>::infinity();
+		return {
+			mDirection.mX != 0 ? 1 / mDirection.mX : infinity,
+			mDirection.mY != 0 ? 1 / mDirection.mY : infinity,
+			mDirection.mZ != 0 ? 1 / mDirection.mZ : infinity
+		};
+	}
+
+	template <class T>
+	constexpr bool Ray<T>::Intersects(const AABB<T>& aabb, T& distance) const {
+		if (!aabb.IsValid()) {
+			return false;
+		}
+
+		const T origin[3] = { mOrigin.mX, mOrigin.mY, mOrigin.mZ };
+		const T direction[3] = { mDirection.mX, mDirection.mY, mDirection.mZ };
+		const T min[3] = { aabb.mMin.mX, aabb.mMin.mY, aabb.mMin.mZ };
+		const T max[3] = { aabb.mMax.mX, aabb.mMax.mY, aabb.mMax.mZ };
+
+		T entry = 0;
+		T exit = std::numeric_limits<T>::max();
+		for (int axis = 0; axis < 3; ++axis) {
+			if (direction[axis] == 0) {
+				// Parallel to the slab, either always inside it or never
+				if (origin[axis] < min[axis] || origin[axis] > max[axis]) {
+					return false;
+				}
+				continue;
+			}
+			const T inverse = 1 / direction[axis];
+			T near = (min[axis] - origin[axis]) * inverse;
+			T far = (max[axis] - origin[axis]) * inverse;
+			if (near > far) {
+				const T temp = near;
+				near = far;
+				far = temp;
+			}
+			entry = Max(entry, near);
+			exit = Min(exit, far);
+			if (entry > exit) {
+				return false;
+			}
+		}
+		distance = entry;
+		return true;
+	}
+
+	template <class T>
+	constexpr bool Ray<T>::Intersects(const Sphere<T>& sphere, T& distance) const {
+		if (!sphere.IsValid()) {
+			return false;
+		}
+
+		// |origin + t * direction - center|^2 = radius^2
+		const Vector3<T> offset = mOrigin - sphere.mCenter;
+		const T a = mDirection.LengthSqrd();
+		const T b = offset.Dot(mDirection);
+		const T c = offset.LengthSqrd() - sphere.mRadius * sphere.mRadius;
+		if (c <= 0) {
+			distance = 0;
+			return true;
+		}
+		const T discriminant = b * b - a * c;
+		if (b > 0 || discriminant < 0 || a == 0) {
+			return false;
+		}
+		distance = (-b - Sqrt(discriminant)) / a;
+		return true;
+	}
+
+	typedef Ray<float> Rayf;
+	typedef Ray<double> Rayd;
+}
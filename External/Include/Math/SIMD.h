@@ -0,0 +1,63 @@
+#pragma once
+
+// Compile time instruction set selection for OMath.
+// Define OMATH_NO_SIMD to force every type back onto its scalar template path.
+#if !defined(OMATH_NO_SIMD) && (defined(_M_X64) || defined(__SSE2__))
+#define OMATH_SSE 1
+#include <immintrin.h>
+
+#if defined(__AVX__)
+#define OMATH_AVX 1
+#endif
+
+#if defined(__AVX2__)
+#define OMATH_AVX2 1
+#endif
+
+// MSVC has no __FMA__, but /arch:AVX2 guarantees FMA3
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define OMATH_FMA 1
+#endif
+#endif
+
+#ifdef OMATH_SSE
+namespace OMath::SIMD {
+	// Returns a * b + c, fused when the target supports FMA
+	inline __m128 MulAdd(const __m128 a, const __m128 b, const __m128 c) {
+#ifdef OMATH_FMA
+		return _mm_fmadd_ps(a, b, c);
+#else
+		return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+	}
+
+	// Broadcasts lane i of the register to all four lanes
+	template <int i>
+	inline __m128 Splat(const __m128 value) {
+		return _mm_shuffle_ps(value, value, _MM_SHUFFLE(i, i, i, i));
+	}
+
+	// Returns the sum of all four lanes broadcast to every lane
+	inline __m128 HorizontalSum(const __m128 value) {
+		__m128 shuffled = _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1));
+		__m128 sums = _mm_add_ps(value, shuffled);
+		shuffled = _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 0, 3, 2));
+		return _mm_add_ps(sums, shuffled);
+	}
+
+	// Mask with only the w lane set
+	inline __m128 MaskW() {
+		return _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+	}
+
+#ifdef OMATH_AVX
+	inline __m256 MulAdd(const __m256 a, const __m256 b, const __m256 c) {
+#ifdef OMATH_FMA
+		return _mm256_fmadd_ps(a, b, c);
+#else
+		return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+	}
+#endif
+}
+#endif
@@ -0,0 +1,207 @@
+#pragma once
+#include <span>
+#include "OMath.h"
+#include "Vector3.h"
+#include "Matrix4x4.h"
+#include "AABB.h"
+
+namespace OMath {
+	// Bounding sphere. The default sphere is empty (negative radius), merging anything into it gives that thing
+	template <class T>
+	class Sphere {
+	public:
+		constexpr Sphere();
+		constexpr Sphere(const Vector3<T>& center, const T& radius);
+		constexpr Sphere(const Sphere<T>& sphere) = default;
+		~Sphere() = default;
+
+		constexpr Sphere<T>& operator=(const Sphere<T>& sphere) = default;
+
+		// Returns the sphere through the corners of the box
+		static constexpr Sphere<T> CreateFromAABB(const AABB<T>& aabb);
+
+		// Ritter's approximation, a few percent larger than the minimal sphere. Empty if there are no points
+		static constexpr Sphere<T> CreateFromPoints(std::span<const Vector3<T>> points);
+
+		// Returns false for the empty sphere
+		constexpr bool IsValid() const;
+
+		constexpr AABB<T> GetAABB() const;
+
+		// Grows the sphere to contain the point
+		constexpr void Merge(const Vector3<T>& point);
+
+		// Grows the sphere to contain the given sphere
+		constexpr void Merge(const Sphere<T>& sphere);
+
+		// Returns the sphere around this and the given sphere
+		constexpr Sphere<T> GetMerged(const Sphere<T>& sphere) const;
+
+		// Returns the sphere transformed by the matrix, the radius is scaled by the largest axis scale
+		constexpr Sphere<T> GetTransformed(const Matrix4x4<T>& transform) const;
+
+		constexpr bool Contains(const Vector3<T>& point) const;
+		constexpr bool Contains(const Sphere<T>& sphere) const;
+
+		// Touching volumes overlap
+		constexpr bool Overlaps(const Sphere<T>& sphere) const;
+		constexpr bool Overlaps(const AABB<T>& aabb) const;
+
+		Vector3<T> mCenter;
+		T mRadius;
+	};
+
+	template <class T>
+	constexpr Sphere<T>::Sphere() : mCenter(), mRadius(-1) {}
+
+	template <class T>
+	constexpr Sphere<T>::Sphere(const Vector3<T>& center, const T& radius) : mCenter(center), mRadius(radius) {}
+
+	template <class T>
+	constexpr Sphere<T> Sphere<T>::CreateFromAABB(const AABB<T>& aabb) {
+		if (!aabb.IsValid()) {
+			return Sphere<T>();
+		}
+		return { aabb.GetCenter(), aabb.GetExtents().Length() };
+	}
+
+	template <class T>
+	constexpr Sphere<T> Sphere<T>::CreateFromPoints(std::span<const Vector3<T>> points) {
+		if (points.empty()) {
+			return Sphere<T>();
+		}
+
+		// Start from the points furthest apart along the axis of largest spread, then grow to cover the rest
+		size_t minIndex[3] = {};
+		size_t maxIndex[3] = {};
+		for (size_t index = 1; index < points.size(); ++index) {
+			const T components[3] = { points[index].mX, points[index].mY, points[index].mZ };
+			for (int axis = 0; axis < 3; ++axis) {
+				const Vector3<T>& min = points[minIndex[axis]];
+				const Vector3<T>& max = points[maxIndex[axis]];
+				const T minComponents[3] = { min.mX, min.mY, min.mZ };
+				const T maxComponents[3] = { max.mX, max.mY, max.mZ };
+				if (components[axis] < minComponents[axis]) {
+					minIndex[axis] = index;
+				}
+				if (components[axis] > maxComponents[axis]) {
+					maxIndex[axis] = index;
+				}
+			}
+		}
+
+		int widestAxis = 0;
+		T widestSpread = 0;
+		for (int axis = 0; axis < 3; ++axis) {
+			const T spread = (points[maxIndex[axis]] - points[minIndex[axis]]).LengthSqrd();
+			if (spread > widestSpread) {
+				widestSpread = spread;
+				widestAxis = axis;
+			}
+		}
+
+		const Vector3<T>& start = points[minIndex[widestAxis]];
+		const Vector3<T>& end = points[maxIndex[widestAxis]];
+		Sphere<T> result((start + end) * Vector3<T>(0.5, 0.5, 0.5), Sqrt(widestSpread) / 2);
+		for (const Vector3<T>& point : points) {
+			result.Merge(point);
+		}
+		return result;
+	}
+
+	template <class T>
+	constexpr bool Sphere<T>::IsValid() const {
+		return mRadius >= 0;
+	}
+
+	template <class T>
+	constexpr AABB<T> Sphere<T>::GetAABB() const {
+		if (!IsValid()) {
+			return AABB<T>();
+		}
+		return AABB<T>::CreateFromCenterExtents(mCenter, { mRadius, mRadius, mRadius });
+	}
+
+	template <class T>
+	constexpr void Sphere<T>::Merge(const Vector3<T>& point) {
+		Merge(Sphere<T>(point, 0));
+	}
+
+	template <class T>
+	constexpr void Sphere<T>::Merge(const Sphere<T>& sphere) {
+		if (!sphere.IsValid() || Contains(sphere)) {
+			return;
+		}
+		if (!IsValid() || sphere.Contains(*this)) {
+			*this = sphere;
+			return;
+		}
+
+		// Neither contains the other, the new sphere spans from the far side of one to the far side of the other
+		const Vector3<T> offset = sphere.mCenter - mCenter;
+		const T distance = offset.Length();
+		const T newRadius = (distance + mRadius + sphere.mRadius) / 2;
+		const T moveAlong = (newRadius - mRadius) / distance;
+		mCenter = mCenter + offset * Vector3<T>(moveAlong, moveAlong, moveAlong);
+		mRadius = newRadius;
+	}
+
+	template <class T>
+	constexpr Sphere<T> Sphere<T>::GetMerged(const Sphere<T>& sphere) const {
+		Sphere<T> result(*this);
+		result.Merge(sphere);
+		return result;
+	}
+
+	template <class T>
+	constexpr Sphere<T> Sphere<T>::GetTransformed(const Matrix4x4<T>& transform) const {
+		if (!IsValid()) {
+			return *this;
+		}
+
+		const Matrix4x4<T>& m = transform;
+		const Vector3<T> center(
+			mCenter.mX * m(1, 1) + mCenter.mY * m(2, 1) + mCenter.mZ * m(3, 1) + m(4, 1),
+			mCenter.mX * m(1, 2) + mCenter.mY * m(2, 2) + mCenter.mZ * m(3, 2) + m(4, 2),
+			mCenter.mX * m(1, 3) + mCenter.mY * m(2, 3) + mCenter.mZ * m(3, 3) + m(4, 3)
+		);
+
+		// Every row of the upper 3x3 is one transformed axis, its length is the scale along it
+		T largestScaleSqrd = 0;
+		for (int row = 1; row <= 3; row++) {
+			largestScaleSqrd = Max(largestScaleSqrd, Vector3<T>(m(row, 1), m(row, 2), m(row, 3)).LengthSqrd());
+		}
+		return { center, mRadius * Sqrt(largestScaleSqrd) };
+	}
+
+	template <class T>
+	constexpr bool Sphere<T>::Contains(const Vector3<T>& point) const {
+		return IsValid() && (point - mCenter).LengthSqrd() <= mRadius * mRadius;
+	}
+
+	template <class T>
+	constexpr bool Sphere<T>::Contains(const Sphere<T>& sphere) const {
+		if (!IsValid() || !sphere.IsValid() || sphere.mRadius > mRadius) {
+			return false;
+		}
+		const T radiusDifference = mRadius - sphere.mRadius;
+		return (sphere.mCenter - mCenter).LengthSqrd() <= radiusDifference * radiusDifference;
+	}
+
+	template <class T>
+	constexpr bool Sphere<T>::Overlaps(const Sphere<T>& sphere) const {
+		if (!IsValid() || !sphere.IsValid()) {
+			return false;
+		}
+		const T radiusSum = mRadius + sphere.mRadius;
+		return (sphere.mCenter - mCenter).LengthSqrd() <= radiusSum * radiusSum;
+	}
+
+	template <class T>
+	constexpr bool Sphere<T>::Overlaps(const AABB<T>& aabb) const {
+		return IsValid() && aabb.IsValid() && aabb.DistanceSqrd(mCenter) <= mRadius * mRadius;
+	}
+
+	typedef Sphere<float> Spheref;
+	typedef Sphere<double> Sphered;
+}
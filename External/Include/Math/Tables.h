@@ -0,0 +1,47 @@
+#pragma once
+#include <array>
+#include <stddef.h>
+#include "Matrix4x4.h"
+
+// Lookup tables built by the compiler, assign the result to a constexpr variable and it ends up in read only data.
+//		constexpr auto sRotations = OMath::MakeRotationTable<float, 64, OMath::Axis::Y>();
+namespace OMath {
+	enum class Axis {
+		X,
+		Y,
+		Z
+	};
+
+	// Returns { generator(0), generator(1), ..., generator(Count - 1) }
+	template <size_t Count, class Generator>
+	consteval auto MakeTable(Generator generator) {
+		std::array<decltype(generator(size_t())), Count> table{};
+		for (size_t index = 0; index < Count; ++index) {
+			table[index] = generator(index);
+		}
+		return table;
+	}
+
+	// Count evenly spaced steps of one full turn, table[i] = sin(i * 2pi / Count)
+	template <class T, size_t Count>
+	consteval std::array<T, Count> MakeSineTable() {
+		return MakeTable<Count>([](const size_t index) {
+			return Sin(static_cast<T>(2.0 * pi_d * static_cast<double>(index) / static_cast<double>(Count)));
+		});
+	}
+
+	// Count evenly spaced steps of one full turn around the axis, table[i] rotates by i * 2pi / Count
+	template <class T, size_t Count, Axis RotationAxis>
+	consteval std::array<Matrix4x4<T>, Count> MakeRotationTable() {
+		return MakeTable<Count>([](const size_t index) {
+			const T angle = static_cast<T>(2.0 * pi_d * static_cast<double>(index) / static_cast<double>(Count));
+			if constexpr (RotationAxis == Axis::X) {
+				return Matrix4x4<T>::CreateRotationAroundX(angle);
+			} else if constexpr (RotationAxis == Axis::Y) {
+				return Matrix4x4<T>::CreateRotationAroundY(angle);
+			} else {
+				return Matrix4x4<T>::CreateRotationAroundZ(angle);
+			}
+		});
+	}
+}
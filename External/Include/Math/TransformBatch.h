@@ -0,0 +1,195 @@
+#pragma once
+#include <assert.h>
+#include <span>
+#include "Matrix4x4.h"
+#include "VectorWide.h"
+
+// Bulk vector * matrix transforms. Every kernel broadcasts the matrix once and then
+// streams the input through the widest lane count the target supports (8 with AVX,
+// 4 with SSE), the remainder goes through the scalar reference path.
+namespace OMath {
+	enum class TransformKind {
+		Point,		// w = 1
+		Direction,	// w = 0, translation is ignored
+		Projected	// w = 1, result divided by the transformed w
+	};
+
+	namespace Scalar {
+		// Reference implementation, matches operator*(const Vector4<T>&, const Matrix4x4<T>&)
+		inline Vector3<float> Transform(const Vector3<float>& vector, const Matrix4x4<float>& matrix, const TransformKind kind) {
+			const float* m = matrix.Data();
+			const float w = kind == TransformKind::Direction ? 0.0f : 1.0f;
+
+			Vector3<float> result(
+				vector.mX * m[0] + vector.mY * m[4] + vector.mZ * m[8] + w * m[12],
+				vector.mX * m[1] + vector.mY * m[5] + vector.mZ * m[9] + w * m[13],
+				vector.mX * m[2] + vector.mY * m[6] + vector.mZ * m[10] + w * m[14]
+			);
+
+			if (kind == TransformKind::Projected) {
+				const float inverseW = 1.0f / (vector.mX * m[3] + vector.mY * m[7] + vector.mZ * m[11] + m[15]);
+				result.mX *= inverseW;
+				result.mY *= inverseW;
+				result.mZ *= inverseW;
+			}
+			return result;
+		}
+
+		inline Vector4<float> Transform(const Vector4<float>& vector, const Matrix4x4<float>& matrix) {
+			const float* m = matrix.Data();
+			return {
+				vector.mX * m[0] + vector.mY * m[4] + vector.mZ * m[8] + vector.mW * m[12],
+				vector.mX * m[1] + vector.mY * m[5] + vector.mZ * m[9] + vector.mW * m[13],
+				vector.mX * m[2] + vector.mY * m[6] + vector.mZ * m[10] + vector.mW * m[14],
+				vector.mX * m[3] + vector.mY * m[7] + vector.mZ * m[11] + vector.mW * m[15]
+			};
+		}
+
+		inline void Transform(const Matrix4x4<float>& matrix, std::span<const Vector3<float>> input, std::span<Vector3<float>> output, const TransformKind kind) {
+			assert(output.size() >= input.size() && "Output span is too small");
+			for (size_t index = 0; index < input.size(); ++index) {
+				output[index] = Transform(input[index], matrix, kind);
+			}
+		}
+
+		inline void Transform(const Matrix4x4<float>& matrix, std::span<const Vector4<float>> input, std::span<Vector4<float>> output) {
+			assert(output.size() >= input.size() && "Output span is too small");
+			for (size_t index = 0; index < input.size(); ++index) {
+				output[index] = Transform(input[index], matrix);
+			}
+		}
+	}
+
+	namespace Wide {
+		// The matrix broadcast into Width lanes per element
+		template <int Width>
+		struct BroadcastMatrix {
+			explicit BroadcastMatrix(const Matrix4x4<float>& matrix) {
+				const float* data = matrix.Data();
+				for (int element = 0; element < 16; ++element) {
+					mElements[element] = FloatWide<Width>(data[element]);
+				}
+			}
+
+			FloatWide<Width> mElements[16];
+		};
+
+		template <TransformKind Kind, int Width>
+		inline Vector3Wide<Width> Transform(const Vector3Wide<Width>& vector, const BroadcastMatrix<Width>& matrix) {
+			const FloatWide<Width>* m = matrix.mElements;
+
+			FloatWide<Width> x = MulAdd(vector.mZ, m[8], MulAdd(vector.mY, m[4], vector.mX * m[0]));
+			FloatWide<Width> y = MulAdd(vector.mZ, m[9], MulAdd(vector.mY, m[5], vector.mX * m[1]));
+			FloatWide<Width> z = MulAdd(vector.mZ, m[10], MulAdd(vector.mY, m[6], vector.mX * m[2]));
+
+			if constexpr (Kind == TransformKind::Direction) {
+				return { x, y, z };
+			}
+
+			x += m[12];
+			y += m[13];
+			z += m[14];
+
+			if constexpr (Kind == TransformKind::Projected) {
+				const FloatWide<Width> w = MulAdd(vector.mZ, m[11], MulAdd(vector.mY, m[7], MulAdd(vector.mX, m[3], m[15])));
+				const FloatWide<Width> inverseW = FloatWide<Width>(1.0f) / w;
+				x *= inverseW;
+				y *= inverseW;
+				z *= inverseW;
+			}
+			return { x, y, z };
+		}
+
+		template <int Width>
+		inline Vector4Wide<Width> Transform(const Vector4Wide<Width>& vector, const BroadcastMatrix<Width>& matrix) {
+			const FloatWide<Width>* m = matrix.mElements;
+			return {
+				MulAdd(vector.mW, m[12], MulAdd(vector.mZ, m[8], MulAdd(vector.mY, m[4], vector.mX * m[0]))),
+				MulAdd(vector.mW, m[13], MulAdd(vector.mZ, m[9], MulAdd(vector.mY, m[5], vector.mX * m[1]))),
+				MulAdd(vector.mW, m[14], MulAdd(vector.mZ, m[10], MulAdd(vector.mY, m[6], vector.mX * m[2]))),
+				MulAdd(vector.mW, m[15], MulAdd(vector.mZ, m[11], MulAdd(vector.mY, m[7], vector.mX * m[3])))
+			};
+		}
+
+		template <TransformKind Kind, int Width>
+		inline void Transform(const Matrix4x4<float>& matrix, std::span<const Vector3<float>> input, std::span<Vector3<float>> output) {
+			assert(output.size() >= input.size() && "Output span is too small");
+
+			const BroadcastMatrix<Width> broadcast(matrix);
+			const size_t count = input.size();
+			size_t index = 0;
+			for (; index + Width <= count; index += Width) {
+				Transform<Kind>(Vector3Wide<Width>::Gather(&input[index]), broadcast).Scatter(&output[index]);
+			}
+			Scalar::Transform(matrix, input.subspan(index), output.subspan(index), Kind);
+		}
+
+		template <int Width>
+		inline void Transform(const Matrix4x4<float>& matrix, std::span<const Vector3<float>> input, std::span<Vector3<float>> output, const TransformKind kind) {
+			switch (kind) {
+			case TransformKind::Point:
+				Transform<TransformKind::Point, Width>(matrix, input, output);
+				break;
+			case TransformKind::Direction:
+				Transform<TransformKind::Direction, Width>(matrix, input, output);
+				break;
+			case TransformKind::Projected:
+				Transform<TransformKind::Projected, Width>(matrix, input, output);
+				break;
+			}
+		}
+
+		template <int Width>
+		inline void Transform(const Matrix4x4<float>& matrix, std::span<const Vector4<float>> input, std::span<Vector4<float>> output) {
+			assert(output.size() >= input.size() && "Output span is too small");
+
+			const BroadcastMatrix<Width> broadcast(matrix);
+			const size_t count = input.size();
+			size_t index = 0;
+			for (; index + Width <= count; index += Width) {
+				Transform(Vector4Wide<Width>::Gather(&input[index]), broadcast).Scatter(&output[index]);
+			}
+			Scalar::Transform(matrix, input.subspan(index), output.subspan(index));
+		}
+	}
+
+#if defined(OMATH_AVX)
+	constexpr int sTransformBatchWidth = 8;
+#elif defined(OMATH_SSE)
+	constexpr int sTransformBatchWidth = 4;
+#else
+	constexpr int sTransformBatchWidth = 1;
+#endif
+
+	// Transforms every input by the matrix into output, output.size() must be >= input.size()
+	inline void Transform(const Matrix4x4<float>& matrix, std::span<const Vector3<float>> input, std::span<Vector3<float>> output, const TransformKind kind) {
+		if constexpr (sTransformBatchWidth > 1) {
+			Wide::Transform<sTransformBatchWidth>(matrix, input, output, kind);
+		} else {
+			Scalar::Transform(matrix, input, output, kind);
+		}
+	}
+
+	inline void Transform(const Matrix4x4<float>& matrix, std::span<const Vector4<float>> input, std::span<Vector4<float>> output) {
+		if constexpr (sTransformBatchWidth > 1) {
+			Wide::Transform<sTransformBatchWidth>(matrix, input, output);
+		} else {
+			Scalar::Transform(matrix, input, output);
+		}
+	}
+
+	// Transforms positions (w = 1)
+	inline void TransformPoints(const Matrix4x4<float>& matrix, std::span<const Vector3<float>> input, std::span<Vector3<float>> output) {
+		Transform(matrix, input, output, TransformKind::Point);
+	}
+
+	// Transforms directions (w = 0), translation is ignored
+	inline void TransformDirections(const Matrix4x4<float>& matrix, std::span<const Vector3<float>> input, std::span<Vector3<float>> output) {
+		Transform(matrix, input, output, TransformKind::Direction);
+	}
+
+	// Transforms positions (w = 1) and divides by the resulting w, e.g. into NDC by a view projection matrix
+	inline void TransformPointsProjected(const Matrix4x4<float>& matrix, std::span<const Vector3<float>> input, std::span<Vector3<float>> output) {
+		Transform(matrix, input, output, TransformKind::Projected);
+	}
+}
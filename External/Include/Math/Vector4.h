@@ -1,29 +1,33 @@
 #pragma once
+#include <cmath>
+#include "OMath.h"
+#include "SIMD.h"
+
 namespace OMath {
 	template <class T>
 	class Vector4 {
 	public:
-		Vector4<T>();
-		Vector4<T>(const T& x, const T& y, const T& z, const T& w);
-		Vector4<T>(const Vector4<T>& vector) = default;
-		~Vector4<T>() = default;
+		constexpr Vector4();
+		constexpr Vector4(const T& x, const T& y, const T& z, const T& w);
+		constexpr Vector4(const Vector4<T>& vector) = default;
+		~Vector4() = default;
 
-		Vector4<T>& operator=(const Vector4<T>& vector) = default;
+		constexpr Vector4<T>& operator=(const Vector4<T>& vector) = default;
 
 		// Returns the squared length of the vector
-		T LengthSqrd() const;
+		constexpr T LengthSqrd() const;
 
 		// Returns the length of the vector
-		T Length() const;
+		constexpr T Length() const;
 
 		// Returns the normalized value of the vector
-		Vector4<T> GetNormalized() const;
+		constexpr Vector4<T> GetNormalized() const;
 
 		// Normalizes the vector
-		void Normalize();
+		constexpr void Normalize();
 
 		// Returns the dot product of the current vector and the given vector
-		T Dot(const Vector4<T>& vector) const;
+		constexpr T Dot(const Vector4<T>& vector) const;
 
 		T mX;
 		T mY;
@@ -31,30 +35,30 @@ namespace OMath {
 		T mW;
 	};
 	template<class T>
-	inline Vector4<T>::Vector4() : mX(0), mY(0), mZ(0), mW(0) {}
+	constexpr Vector4<T>::Vector4() : mX(0), mY(0), mZ(0), mW(0) {}
 
 	template<class T>
-	inline Vector4<T>::Vector4(const T& x, const T& y, const T& z, const T& w) : mX(x), mY(y), mZ(z), mW(w) {}
+	constexpr Vector4<T>::Vector4(const T& x, const T& y, const T& z, const T& w) : mX(x), mY(y), mZ(z), mW(w) {}
 
 	template<class T>
-	inline T Vector4<T>::LengthSqrd() const {
+	constexpr T Vector4<T>::LengthSqrd() const {
 		return mX * mX + mY * mY + mZ * mZ + mW * mW;
 	}
 
 	template<class T>
-	inline T Vector4<T>::Length() const {
-		return static_cast<T>(sqrt(LengthSqrd()));
+	constexpr T Vector4<T>::Length() const {
+		return Sqrt(LengthSqrd());
 	}
 
 	template<class T>
-	inline Vector4<T> Vector4<T>::GetNormalized() const {
+	constexpr Vector4<T> Vector4<T>::GetNormalized() const {
 		Vector4<T> vec(mX, mY, mZ, mW);
 		vec.Normalize();
 		return vec;
 	}
 
 	template<class T>
-	inline void Vector4<T>::Normalize() {
+	constexpr void Vector4<T>::Normalize() {
 		Vector4<T> vec(mX, mY, mZ, mW);
 		if (mX + mY != 0) {
 			const auto length = vec.Length();
@@ -66,17 +70,17 @@ namespace OMath {
 	}
 
 	template<class T>
-	inline T Vector4<T>::Dot(const Vector4<T>& vector) const {
+	constexpr T Vector4<T>::Dot(const Vector4<T>& vector) const {
 		return mX * vector.mX + mY * vector.mY + mZ * vector.mZ + mW * vector.mW;
 	}
 
 	template <class T>
-	Vector4<T> operator+(const Vector4<T>& vector0, const Vector4<T>& vector1) {
+	constexpr Vector4<T> operator+(const Vector4<T>& vector0, const Vector4<T>& vector1) {
 		return { vector0.mX + vector1.mX, vector0.mY + vector1.mY, vector0.mZ + vector1.mZ, vector0.mW + vector1.mW };
 	}
 
 	template <class T>
-	void operator+=(Vector4<T>& vector0, const Vector4<T>& vector1) {
+	constexpr void operator+=(Vector4<T>& vector0, const Vector4<T>& vector1) {
 		vector0.mX += vector1.mX;
 		vector0.mY += vector1.mY;
 		vector0.mZ += vector1.mZ;
@@ -85,12 +89,12 @@ namespace OMath {
 
 
 	template <class T>
-	Vector4<T> operator-(const Vector4<T>& vector0, const Vector4<T>& vector1) {
+	constexpr Vector4<T> operator-(const Vector4<T>& vector0, const Vector4<T>& vector1) {
 		return { vector0.mX - vector1.mX, vector0.mY - vector1.mY, vector0.mZ - vector1.mZ, vector0.mW - vector1.mW };
 	}
 
 	template <class T>
-	void operator-=(Vector4<T>& vector0, const Vector4<T>& vector1) {
+	constexpr void operator-=(Vector4<T>& vector0, const Vector4<T>& vector1) {
 		vector0.mX -= vector1.mX;
 		vector0.mY -= vector1.mY;
 		vector0.mZ -= vector1.mZ;
@@ -98,18 +102,149 @@ namespace OMath {
 	}
 
 	template <class T>
-	Vector4<T> operator*(const Vector4<T>& vector0, const Vector4<T>& vector1) {
+	constexpr Vector4<T> operator*(const Vector4<T>& vector0, const Vector4<T>& vector1) {
 		return { vector0.mX * vector1.mX, vector0.mY * vector1.mY, vector0.mZ * vector1.mZ, vector0.mW * vector1.mW };
 	}
 
 	template <class T>
-	void operator*=(Vector4<T>& vector0, const Vector4<T>& vector1) {
+	constexpr void operator*=(Vector4<T>& vector0, const Vector4<T>& vector1) {
 		vector0.mX *= vector1.mX;
 		vector0.mY *= vector1.mY;
 		vector0.mZ *= vector1.mZ;
 		vector0.mW *= vector1.mW;
 	}
 
+#ifdef OMATH_SSE
+	// 16 byte aligned float vector, every operation is done in one SSE register.
+	// Constant evaluation takes the scalar path since intrinsics are not constexpr.
+	template <>
+	class alignas(16) Vector4<float> {
+	public:
+		constexpr Vector4();
+		constexpr Vector4(const float& x, const float& y, const float& z, const float& w);
+		explicit Vector4(const __m128 value);
+		constexpr Vector4(const Vector4<float>& vector) = default;
+		~Vector4() = default;
+
+		constexpr Vector4<float>& operator=(const Vector4<float>& vector) = default;
+
+		// Returns the squared length of the vector
+		constexpr float LengthSqrd() const;
+
+		// Returns the length of the vector
+		constexpr float Length() const;
+
+		// Returns the normalized value of the vector
+		constexpr Vector4<float> GetNormalized() const;
+
+		// Normalizes the vector
+		constexpr void Normalize();
+
+		// Returns the dot product of the current vector and the given vector
+		constexpr float Dot(const Vector4<float>& vector) const;
+
+		// Returns the vector as an SSE register
+		__m128 Load() const;
+
+		// Overwrites the vector with the given SSE register
+		void Store(const __m128 value);
+
+		float mX;
+		float mY;
+		float mZ;
+		float mW;
+	};
+
+	constexpr Vector4<float>::Vector4() : mX(0), mY(0), mZ(0), mW(0) {}
+
+	constexpr Vector4<float>::Vector4(const float& x, const float& y, const float& z, const float& w) : mX(x), mY(y), mZ(z), mW(w) {}
+
+	inline Vector4<float>::Vector4(const __m128 value) {
+		Store(value);
+	}
+
+	inline __m128 Vector4<float>::Load() const {
+		return _mm_load_ps(&mX);
+	}
+
+	inline void Vector4<float>::Store(const __m128 value) {
+		_mm_store_ps(&mX, value);
+	}
+
+	constexpr float Vector4<float>::Dot(const Vector4<float>& vector) const {
+		if (std::is_constant_evaluated()) {
+			return mX * vector.mX + mY * vector.mY + mZ * vector.mZ + mW * vector.mW;
+		}
+		return _mm_cvtss_f32(SIMD::HorizontalSum(_mm_mul_ps(Load(), vector.Load())));
+	}
+
+	constexpr float Vector4<float>::LengthSqrd() const {
+		return Dot(*this);
+	}
+
+	constexpr float Vector4<float>::Length() const {
+		return Sqrt(LengthSqrd());
+	}
+
+	constexpr Vector4<float> Vector4<float>::GetNormalized() const {
+		Vector4<float> vec(*this);
+		vec.Normalize();
+		return vec;
+	}
+
+	constexpr void Vector4<float>::Normalize() {
+		if (std::is_constant_evaluated()) {
+			const float length = Length();
+			if (length != 0.0f) {
+				mX /= length;
+				mY /= length;
+				mZ /= length;
+				mW /= length;
+			}
+			return;
+		}
+
+		const __m128 value = Load();
+		const __m128 lengthSqrd = SIMD::HorizontalSum(_mm_mul_ps(value, value));
+		if (_mm_cvtss_f32(lengthSqrd) != 0.0f) {
+			Store(_mm_div_ps(value, _mm_sqrt_ps(lengthSqrd)));
+		}
+	}
+
+	constexpr Vector4<float> operator+(const Vector4<float>& vector0, const Vector4<float>& vector1) {
+		if (std::is_constant_evaluated()) {
+			return { vector0.mX + vector1.mX, vector0.mY + vector1.mY, vector0.mZ + vector1.mZ, vector0.mW + vector1.mW };
+		}
+		return Vector4<float>(_mm_add_ps(vector0.Load(), vector1.Load()));
+	}
+
+	constexpr void operator+=(Vector4<float>& vector0, const Vector4<float>& vector1) {
+		vector0 = vector0 + vector1;
+	}
+
+	constexpr Vector4<float> operator-(const Vector4<float>& vector0, const Vector4<float>& vector1) {
+		if (std::is_constant_evaluated()) {
+			return { vector0.mX - vector1.mX, vector0.mY - vector1.mY, vector0.mZ - vector1.mZ, vector0.mW - vector1.mW };
+		}
+		return Vector4<float>(_mm_sub_ps(vector0.Load(), vector1.Load()));
+	}
+
+	constexpr void operator-=(Vector4<float>& vector0, const Vector4<float>& vector1) {
+		vector0 = vector0 - vector1;
+	}
+
+	constexpr Vector4<float> operator*(const Vector4<float>& vector0, const Vector4<float>& vector1) {
+		if (std::is_constant_evaluated()) {
+			return { vector0.mX * vector1.mX, vector0.mY * vector1.mY, vector0.mZ * vector1.mZ, vector0.mW * vector1.mW };
+		}
+		return Vector4<float>(_mm_mul_ps(vector0.Load(), vector1.Load()));
+	}
+
+	constexpr void operator*=(Vector4<float>& vector0, const Vector4<float>& vector1) {
+		vector0 = vector0 * vector1;
+	}
+#endif
+
 	typedef Vector4<float> Vector4f;
 	typedef Vector4<double> Vector4d;
 	typedef Vector4<int> Vector4i;
@@ -0,0 +1,529 @@
+#pragma once
+#include "FloatWide.h"
+#include "Vector3.h"
+#include "Vector4.h"
+
+namespace OMath {
+	namespace SIMD {
+#ifdef OMATH_SSE
+		// Transposes four packed Vector3<float> (12 floats) into x, y and z registers
+		inline void GatherVector3x4(const float* source, __m128& x, __m128& y, __m128& z) {
+			const __m128 a = _mm_loadu_ps(source);		// x0 y0 z0 x1
+			const __m128 b = _mm_loadu_ps(source + 4);	// y1 z1 x2 y2
+			const __m128 c = _mm_loadu_ps(source + 8);	// z2 x3 y3 z3
+
+			x = _mm_shuffle_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 0, 0)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+			y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+			z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+		}
+
+		// Inverse of GatherVector3x4
+		inline void ScatterVector3x4(float* destination, const __m128 x, const __m128 y, const __m128 z) {
+			_mm_storeu_ps(destination, _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+			_mm_storeu_ps(destination + 4, _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+			_mm_storeu_ps(destination + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+		}
+#endif
+	}
+
+	// Width Vector3<float> stored as structure of arrays, one FloatWide per component
+	template <int Width>
+	class Vector3Wide {
+	public:
+		using Float = FloatWide<Width>;
+
+		Vector3Wide();
+		Vector3Wide(const Float& x, const Float& y, const Float& z);
+		explicit Vector3Wide(const Vector3<float>& vector);
+		Vector3Wide(const Vector3Wide<Width>& vector) = default;
+		~Vector3Wide() = default;
+
+		Vector3Wide<Width>& operator=(const Vector3Wide<Width>& vector) = default;
+
+		// Transposes Width consecutive vectors into lanes
+		static Vector3Wide<Width> Gather(const Vector3<float>* source);
+
+		// Transposes count (<= Width) vectors into lanes, the remaining lanes are zero
+		static Vector3Wide<Width> Gather(const Vector3<float>* source, const int count);
+
+		// Loads from separate, Width aligned component arrays
+		static Vector3Wide<Width> Load(const float* x, const float* y, const float* z);
+
+		// Writes the lanes back as Width consecutive vectors
+		void Scatter(Vector3<float>* destination) const;
+
+		// Writes the first count (<= Width) lanes back as consecutive vectors
+		void Scatter(Vector3<float>* destination, const int count) const;
+
+		// Stores to separate, Width aligned component arrays
+		void Store(float* x, float* y, float* z) const;
+
+		// Returns a single lane as a vector
+		Vector3<float> Lane(const int lane) const;
+
+		// Returns the squared length of every lane
+		Float LengthSqrd() const;
+
+		// Returns the length of every lane
+		Float Length() const;
+
+		// Returns the normalized value of every lane
+		Vector3Wide<Width> GetNormalized() const;
+
+		// Normalizes every lane, zero length lanes are left untouched
+		void Normalize();
+
+		// Returns the dot product of every lane with the matching lane of the given vector
+		Float Dot(const Vector3Wide<Width>& vector) const;
+
+		// Returns the cross product of every lane with the matching lane of the given vector
+		Vector3Wide<Width> Cross(const Vector3Wide<Width>& vector) const;
+
+		Float mX;
+		Float mY;
+		Float mZ;
+	};
+
+	template <int Width>
+	inline Vector3Wide<Width>::Vector3Wide() {}
+
+	template <int Width>
+	inline Vector3Wide<Width>::Vector3Wide(const Float& x, const Float& y, const Float& z) : mX(x), mY(y), mZ(z) {}
+
+	template <int Width>
+	inline Vector3Wide<Width>::Vector3Wide(const Vector3<float>& vector) : mX(vector.mX), mY(vector.mY), mZ(vector.mZ) {}
+
+	template <int Width>
+	inline Vector3Wide<Width> Vector3Wide<Width>::Gather(const Vector3<float>* source) {
+		alignas(64) float x[Width];
+		alignas(64) float y[Width];
+		alignas(64) float z[Width];
+
+		int lane = 0;
+#ifdef OMATH_SSE
+		for (; lane + 4 <= Width; lane += 4) {
+			__m128 xs, ys, zs;
+			SIMD::GatherVector3x4(&source[lane].mX, xs, ys, zs);
+			_mm_store_ps(x + lane, xs);
+			_mm_store_ps(y + lane, ys);
+			_mm_store_ps(z + lane, zs);
+		}
+#endif
+		for (; lane < Width; ++lane) {
+			x[lane] = source[lane].mX;
+			y[lane] = source[lane].mY;
+			z[lane] = source[lane].mZ;
+		}
+		return Load(x, y, z);
+	}
+
+	template <int Width>
+	inline Vector3Wide<Width> Vector3Wide<Width>::Gather(const Vector3<float>* source, const int count) {
+		if (count >= Width) {
+			return Gather(source);
+		}
+
+		alignas(64) float x[Width] = {};
+		alignas(64) float y[Width] = {};
+		alignas(64) float z[Width] = {};
+		for (int lane = 0; lane < count; ++lane) {
+			x[lane] = source[lane].mX;
+			y[lane] = source[lane].mY;
+			z[lane] = source[lane].mZ;
+		}
+		return Load(x, y, z);
+	}
+
+	template <int Width>
+	inline Vector3Wide<Width> Vector3Wide<Width>::Load(const float* x, const float* y, const float* z) {
+		return { Float::Load(x), Float::Load(y), Float::Load(z) };
+	}
+
+	template <int Width>
+	inline void Vector3Wide<Width>::Scatter(Vector3<float>* destination) const {
+		alignas(64) float x[Width];
+		alignas(64) float y[Width];
+		alignas(64) float z[Width];
+		Store(x, y, z);
+
+		int lane = 0;
+#ifdef OMATH_SSE
+		for (; lane + 4 <= Width; lane += 4) {
+			SIMD::ScatterVector3x4(&destination[lane].mX, _mm_load_ps(x + lane), _mm_load_ps(y + lane), _mm_load_ps(z + lane));
+		}
+#endif
+		for (; lane < Width; ++lane) {
+			destination[lane] = { x[lane], y[lane], z[lane] };
+		}
+	}
+
+	template <int Width>
+	inline void Vector3Wide<Width>::Scatter(Vector3<float>* destination, const int count) const {
+		if (count >= Width) {
+			Scatter(destination);
+			return;
+		}
+
+		alignas(64) float x[Width];
+		alignas(64) float y[Width];
+		alignas(64) float z[Width];
+		Store(x, y, z);
+		for (int lane = 0; lane < count; ++lane) {
+			destination[lane] = { x[lane], y[lane], z[lane] };
+		}
+	}
+
+	template <int Width>
+	inline void Vector3Wide<Width>::Store(float* x, float* y, float* z) const {
+		mX.Store(x);
+		mY.Store(y);
+		mZ.Store(z);
+	}
+
+	template <int Width>
+	inline Vector3<float> Vector3Wide<Width>::Lane(const int lane) const {
+		return { mX[lane], mY[lane], mZ[lane] };
+	}
+
+	template <int Width>
+	inline typename Vector3Wide<Width>::Float Vector3Wide<Width>::LengthSqrd() const {
+		return Dot(*this);
+	}
+
+	template <int Width>
+	inline typename Vector3Wide<Width>::Float Vector3Wide<Width>::Length() const {
+		return Sqrt(LengthSqrd());
+	}
+
+	template <int Width>
+	inline Vector3Wide<Width> Vector3Wide<Width>::GetNormalized() const {
+		Vector3Wide<Width> vec(*this);
+		vec.Normalize();
+		return vec;
+	}
+
+	template <int Width>
+	inline void Vector3Wide<Width>::Normalize() {
+		const Float lengthSqrd = LengthSqrd();
+		const Float nonZero = lengthSqrd > Float(0.0f);
+		const Float scale = Select(nonZero, Float(1.0f) / Sqrt(lengthSqrd), Float(1.0f));
+		mX *= scale;
+		mY *= scale;
+		mZ *= scale;
+	}
+
+	template <int Width>
+	inline typename Vector3Wide<Width>::Float Vector3Wide<Width>::Dot(const Vector3Wide<Width>& vector) const {
+		return MulAdd(mZ, vector.mZ, MulAdd(mY, vector.mY, mX * vector.mX));
+	}
+
+	template <int Width>
+	inline Vector3Wide<Width> Vector3Wide<Width>::Cross(const Vector3Wide<Width>& vector) const {
+		return {
+			mY * vector.mZ - mZ * vector.mY,
+			mZ * vector.mX - mX * vector.mZ,
+			mX * vector.mY - mY * vector.mX
+		};
+	}
+
+	template <int Width>
+	Vector3Wide<Width> operator+(const Vector3Wide<Width>& vector0, const Vector3Wide<Width>& vector1) {
+		return { vector0.mX + vector1.mX, vector0.mY + vector1.mY, vector0.mZ + vector1.mZ };
+	}
+
+	template <int Width>
+	void operator+=(Vector3Wide<Width>& vector0, const Vector3Wide<Width>& vector1) {
+		vector0.mX += vector1.mX;
+		vector0.mY += vector1.mY;
+		vector0.mZ += vector1.mZ;
+	}
+
+	template <int Width>
+	Vector3Wide<Width> operator-(const Vector3Wide<Width>& vector0, const Vector3Wide<Width>& vector1) {
+		return { vector0.mX - vector1.mX, vector0.mY - vector1.mY, vector0.mZ - vector1.mZ };
+	}
+
+	template <int Width>
+	void operator-=(Vector3Wide<Width>& vector0, const Vector3Wide<Width>& vector1) {
+		vector0.mX -= vector1.mX;
+		vector0.mY -= vector1.mY;
+		vector0.mZ -= vector1.mZ;
+	}
+
+	template <int Width>
+	Vector3Wide<Width> operator*(const Vector3Wide<Width>& vector0, const Vector3Wide<Width>& vector1) {
+		return { vector0.mX * vector1.mX, vector0.mY * vector1.mY, vector0.mZ * vector1.mZ };
+	}
+
+	template <int Width>
+	Vector3Wide<Width> operator*(const Vector3Wide<Width>& vector, const FloatWide<Width>& scalar) {
+		return { vector.mX * scalar, vector.mY * scalar, vector.mZ * scalar };
+	}
+
+	template <int Width>
+	void operator*=(Vector3Wide<Width>& vector0, const Vector3Wide<Width>& vector1) {
+		vector0.mX *= vector1.mX;
+		vector0.mY *= vector1.mY;
+		vector0.mZ *= vector1.mZ;
+	}
+
+	// Width Vector4<float> stored as structure of arrays, one FloatWide per component
+	template <int Width>
+	class Vector4Wide {
+	public:
+		using Float = FloatWide<Width>;
+
+		Vector4Wide();
+		Vector4Wide(const Float& x, const Float& y, const Float& z, const Float& w);
+		explicit Vector4Wide(const Vector4<float>& vector);
+		Vector4Wide(const Vector4Wide<Width>& vector) = default;
+		~Vector4Wide() = default;
+
+		Vector4Wide<Width>& operator=(const Vector4Wide<Width>& vector) = default;
+
+		// Transposes Width consecutive vectors into lanes
+		static Vector4Wide<Width> Gather(const Vector4<float>* source);
+
+		// Transposes count (<= Width) vectors into lanes, the remaining lanes are zero
+		static Vector4Wide<Width> Gather(const Vector4<float>* source, const int count);
+
+		// Loads from separate, Width aligned component arrays
+		static Vector4Wide<Width> Load(const float* x, const float* y, const float* z, const float* w);
+
+		// Writes the lanes back as Width consecutive vectors
+		void Scatter(Vector4<float>* destination) const;
+
+		// Writes the first count (<= Width) lanes back as consecutive vectors
+		void Scatter(Vector4<float>* destination, const int count) const;
+
+		// Stores to separate, Width aligned component arrays
+		void Store(float* x, float* y, float* z, float* w) const;
+
+		// Returns a single lane as a vector
+		Vector4<float> Lane(const int lane) const;
+
+		// Returns the squared length of every lane
+		Float LengthSqrd() const;
+
+		// Returns the length of every lane
+		Float Length() const;
+
+		// Returns the normalized value of every lane
+		Vector4Wide<Width> GetNormalized() const;
+
+		// Normalizes every lane, zero length lanes are left untouched
+		void Normalize();
+
+		// Returns the dot product of every lane with the matching lane of the given vector
+		Float Dot(const Vector4Wide<Width>& vector) const;
+
+		Float mX;
+		Float mY;
+		Float mZ;
+		Float mW;
+	};
+
+	template <int Width>
+	inline Vector4Wide<Width>::Vector4Wide() {}
+
+	template <int Width>
+	inline Vector4Wide<Width>::Vector4Wide(const Float& x, const Float& y, const Float& z, const Float& w) : mX(x), mY(y), mZ(z), mW(w) {}
+
+	template <int Width>
+	inline Vector4Wide<Width>::Vector4Wide(const Vector4<float>& vector) : mX(vector.mX), mY(vector.mY), mZ(vector.mZ), mW(vector.mW) {}
+
+	template <int Width>
+	inline Vector4Wide<Width> Vector4Wide<Width>::Gather(const Vector4<float>* source) {
+		alignas(64) float x[Width];
+		alignas(64) float y[Width];
+		alignas(64) float z[Width];
+		alignas(64) float w[Width];
+
+		int lane = 0;
+#ifdef OMATH_SSE
+		for (; lane + 4 <= Width; lane += 4) {
+			__m128 xs = _mm_loadu_ps(&source[lane].mX);
+			__m128 ys = _mm_loadu_ps(&source[lane + 1].mX);
+			__m128 zs = _mm_loadu_ps(&source[lane + 2].mX);
+			__m128 ws = _mm_loadu_ps(&source[lane + 3].mX);
+			_MM_TRANSPOSE4_PS(xs, ys, zs, ws);
+			_mm_store_ps(x + lane, xs);
+			_mm_store_ps(y + lane, ys);
+			_mm_store_ps(z + lane, zs);
+			_mm_store_ps(w + lane, ws);
+		}
+#endif
+		for (; lane < Width; ++lane) {
+			x[lane] = source[lane].mX;
+			y[lane] = source[lane].mY;
+			z[lane] = source[lane].mZ;
+			w[lane] = source[lane].mW;
+		}
+		return Load(x, y, z, w);
+	}
+
+	template <int Width>
+	inline Vector4Wide<Width> Vector4Wide<Width>::Gather(const Vector4<float>* source, const int count) {
+		if (count >= Width) {
+			return Gather(source);
+		}
+
+		alignas(64) float x[Width] = {};
+		alignas(64) float y[Width] = {};
+		alignas(64) float z[Width] = {};
+		alignas(64) float w[Width] = {};
+		for (int lane = 0; lane < count; ++lane) {
+			x[lane] = source[lane].mX;
+			y[lane] = source[lane].mY;
+			z[lane] = source[lane].mZ;
+			w[lane] = source[lane].mW;
+		}
+		return Load(x, y, z, w);
+	}
+
+	template <int Width>
+	inline Vector4Wide<Width> Vector4Wide<Width>::Load(const float* x, const float* y, const float* z, const float* w) {
+		return { Float::Load(x), Float::Load(y), Float::Load(z), Float::Load(w) };
+	}
+
+	template <int Width>
+	inline void Vector4Wide<Width>::Scatter(Vector4<float>* destination) const {
+		alignas(64) float x[Width];
+		alignas(64) float y[Width];
+		alignas(64) float z[Width];
+		alignas(64) float w[Width];
+		Store(x, y, z, w);
+
+		int lane = 0;
+#ifdef OMATH_SSE
+		for (; lane + 4 <= Width; lane += 4) {
+			__m128 xs = _mm_load_ps(x + lane);
+			__m128 ys = _mm_load_ps(y + lane);
+			__m128 zs = _mm_load_ps(z + lane);
+			__m128 ws = _mm_load_ps(w + lane);
+			_MM_TRANSPOSE4_PS(xs, ys, zs, ws);
+			_mm_storeu_ps(&destination[lane].mX, xs);
+			_mm_storeu_ps(&destination[lane + 1].mX, ys);
+			_mm_storeu_ps(&destination[lane + 2].mX, zs);
+			_mm_storeu_ps(&destination[lane + 3].mX, ws);
+		}
+#endif
+		for (; lane < Width; ++lane) {
+			destination[lane] = { x[lane], y[lane], z[lane], w[lane] };
+		}
+	}
+
+	template <int Width>
+	inline void Vector4Wide<Width>::Scatter(Vector4<float>* destination, const int count) const {
+		if (count >= Width) {
+			Scatter(destination);
+			return;
+		}
+
+		alignas(64) float x[Width];
+		alignas(64) float y[Width];
+		alignas(64) float z[Width];
+		alignas(64) float w[Width];
+		Store(x, y, z, w);
+		for (int lane = 0; lane < count; ++lane) {
+			destination[lane] = { x[lane], y[lane], z[lane], w[lane] };
+		}
+	}
+
+	template <int Width>
+	inline void Vector4Wide<Width>::Store(float* x, float* y, float* z, float* w) const {
+		mX.Store(x);
+		mY.Store(y);
+		mZ.Store(z);
+		mW.Store(w);
+	}
+
+	template <int Width>
+	inline Vector4<float> Vector4Wide<Width>::Lane(const int lane) const {
+		return { mX[lane], mY[lane], mZ[lane], mW[lane] };
+	}
+
+	template <int Width>
+	inline typename Vector4Wide<Width>::Float Vector4Wide<Width>::LengthSqrd() const {
+		return Dot(*this);
+	}
+
+	template <int Width>
+	inline typename Vector4Wide<Width>::Float Vector4Wide<Width>::Length() const {
+		return Sqrt(LengthSqrd());
+	}
+
+	template <int Width>
+	inline Vector4Wide<Width> Vector4Wide<Width>::GetNormalized() const {
+		Vector4Wide<Width> vec(*this);
+		vec.Normalize();
+		return vec;
+	}
+
+	template <int Width>
+	inline void Vector4Wide<Width>::Normalize() {
+		const Float lengthSqrd = LengthSqrd();
+		const Float nonZero = lengthSqrd > Float(0.0f);
+		const Float scale = Select(nonZero, Float(1.0f) / Sqrt(lengthSqrd), Float(1.0f));
+		mX *= scale;
+		mY *= scale;
+		mZ *= scale;
+		mW *= scale;
+	}
+
+	template <int Width>
+	inline typename Vector4Wide<Width>::Float Vector4Wide<Width>::Dot(const Vector4Wide<Width>& vector) const {
+		return MulAdd(mW, vector.mW, MulAdd(mZ, vector.mZ, MulAdd(mY, vector.mY, mX * vector.mX)));
+	}
+
+	template <int Width>
+	Vector4Wide<Width> operator+(const Vector4Wide<Width>& vector0, const Vector4Wide<Width>& vector1) {
+		return { vector0.mX + vector1.mX, vector0.mY + vector1.mY, vector0.mZ + vector1.mZ, vector0.mW + vector1.mW };
+	}
+
+	template <int Width>
+	void operator+=(Vector4Wide<Width>& vector0, const Vector4Wide<Width>& vector1) {
+		vector0.mX += vector1.mX;
+		vector0.mY += vector1.mY;
+		vector0.mZ += vector1.mZ;
+		vector0.mW += vector1.mW;
+	}
+
+	template <int Width>
+	Vector4Wide<Width> operator-(const Vector4Wide<Width>& vector0, const Vector4Wide<Width>& vector1) {
+		return { vector0.mX - vector1.mX, vector0.mY - vector1.mY, vector0.mZ - vector1.mZ, vector0.mW - vector1.mW };
+	}
+
+	template <int Width>
+	void operator-=(Vector4Wide<Width>& vector0, const Vector4Wide<Width>& vector1) {
+		vector0.mX -= vector1.mX;
+		vector0.mY -= vector1.mY;
+		vector0.mZ -= vector1.mZ;
+		vector0.mW -= vector1.mW;
+	}
+
+	template <int Width>
+	Vector4Wide<Width> operator*(const Vector4Wide<Width>& vector0, const Vector4Wide<Width>& vector1) {
+		return { vector0.mX * vector1.mX, vector0.mY * vector1.mY, vector0.mZ * vector1.mZ, vector0.mW * vector1.mW };
+	}
+
+	template <int Width>
+	Vector4Wide<Width> operator*(const Vector4Wide<Width>& vector, const FloatWide<Width>& scalar) {
+		return { vector.mX * scalar, vector.mY * scalar, vector.mZ * scalar, vector.mW * scalar };
+	}
+
+	template <int Width>
+	void operator*=(Vector4Wide<Width>& vector0, const Vector4Wide<Width>& vector1) {
+		vector0.mX *= vector1.mX;
+		vector0.mY *= vector1.mY;
+		vector0.mZ *= vector1.mZ;
+		vector0.mW *= vector1.mW;
+	}
+
+	typedef Vector3Wide<4> Vector3fx4;
+	typedef Vector3Wide<8> Vector3fx8;
+	typedef Vector3Wide<16> Vector3fx16;
+	typedef Vector4Wide<4> Vector4fx4;
+	typedef Vector4Wide<8> Vector4fx8;
+	typedef Vector4Wide<16> Vector4fx16;
+}
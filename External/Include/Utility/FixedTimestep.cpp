@@ -0,0 +1,67 @@
+#include "FixedTimestep.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Enj {
+	FixedTimestep::FixedTimestep(const float updateRate, const uint32_t maxStepsPerFrame) :
+		mStepTime(1.0 / updateRate),
+		mAccumulator(0.0),
+		mSimulationTime(0.0),
+		mDroppedTime(0.0),
+		mMaxStepsPerFrame(std::max(maxStepsPerFrame, 1u)),
+		mStepsThisFrame(0) {
+	}
+
+	void FixedTimestep::SetUpdateRate(const float updateRate) {
+		mStepTime = 1.0 / updateRate;
+	}
+
+	void FixedTimestep::SetMaxStepsPerFrame(const uint32_t maxStepsPerFrame) {
+		mMaxStepsPerFrame = std::max(maxStepsPerFrame, 1u);
+	}
+
+	void FixedTimestep::Accumulate(const float deltaTime) {
+		const double frameTime = std::clamp(static_cast<double>(deltaTime), 0.0, sMaxFrameTime);
+		mDroppedTime += std::max(static_cast<double>(deltaTime) - frameTime, 0.0);
+		mAccumulator += frameTime;
+		mStepsThisFrame = 0;
+	}
+
+	bool FixedTimestep::Step() {
+		if (mAccumulator < mStepTime) {
+			return false;
+		}
+		if (mStepsThisFrame == mMaxStepsPerFrame) {
+			// Keep the partial step so Alpha() stays continuous, drop the whole steps the frame could not afford
+			const double kept = std::fmod(mAccumulator, mStepTime);
+			mDroppedTime += mAccumulator - kept;
+			mAccumulator = kept;
+			return false;
+		}
+
+		mAccumulator -= mStepTime;
+		mSimulationTime += mStepTime;
+		++mStepsThisFrame;
+		return true;
+	}
+
+	float FixedTimestep::StepTime() const {
+		return static_cast<float>(mStepTime);
+	}
+
+	double FixedTimestep::SimulationTime() const {
+		return mSimulationTime;
+	}
+
+	float FixedTimestep::Alpha() const {
+		return static_cast<float>(std::clamp(mAccumulator / mStepTime, 0.0, 1.0));
+	}
+
+	uint32_t FixedTimestep::StepsThisFrame() const {
+		return mStepsThisFrame;
+	}
+
+	double FixedTimestep::DroppedTime() const {
+		return mDroppedTime;
+	}
+}
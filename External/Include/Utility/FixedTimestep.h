@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+
+namespace Enj {
+	/*	Accumulates real frame time and hands it out in fixed simulation steps:
+
+			timestep.Accumulate(deltaTime);
+			while (timestep.Step()) { Update(timestep.StepTime()); }
+			Render(timestep.Alpha());
+
+		Frames that would need more than the maximum steps drop the rest of their time instead of carrying it over,
+		otherwise a slow update makes the next frame slower still (spiral of death) */
+	class FixedTimestep {
+	public:
+		// Longest frame time accumulated at once, a debugger break or a window drag does not turn into seconds of steps
+		static constexpr double sMaxFrameTime = 0.25;
+
+		explicit FixedTimestep(const float updateRate = 60.0f, const uint32_t maxStepsPerFrame = 5);
+
+		void SetUpdateRate(const float updateRate);
+		void SetMaxStepsPerFrame(const uint32_t maxStepsPerFrame);
+
+		void Accumulate(const float deltaTime);
+
+		// Consumes one step, returns false once the frame has no whole step left or ran out of steps
+		bool Step();
+
+		float StepTime() const;
+
+		// Simulated seconds, advanced by StepTime() per step
+		double SimulationTime() const;
+
+		// Fraction of a step accumulated past the last simulated state, render interpolates previous to current by it
+		float Alpha() const;
+
+		uint32_t StepsThisFrame() const;
+
+		// Seconds thrown away by the frame time clamp and the step limit
+		double DroppedTime() const;
+
+	private:
+		double mStepTime;
+		double mAccumulator;
+		double mSimulationTime;
+		double mDroppedTime;
+		uint32_t mMaxStepsPerFrame;
+		uint32_t mStepsThisFrame;
+	};
+}
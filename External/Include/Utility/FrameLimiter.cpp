@@ -0,0 +1,153 @@
+#include "FrameLimiter.h"
+#include <algorithm>
+#include <thread>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#elif defined(__linux__)
+#include <errno.h>
+#include <time.h>
+#endif
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+	constexpr std::chrono::microseconds sMinSpinTime(50);
+	constexpr std::chrono::microseconds sMaxSpinTime(4000);
+	constexpr std::chrono::microseconds sInitialSpinTime(1000);
+
+	float ToMilliseconds(const std::chrono::steady_clock::duration duration) {
+		return std::chrono::duration<float, std::milli>(duration).count();
+	}
+
+	void Pause() {
+#if defined(_M_X64) || defined(__SSE2__)
+		_mm_pause();
+#else
+		std::this_thread::yield();
+#endif
+	}
+}
+
+namespace Enj {
+	FrameLimiter::FrameLimiter(const float targetFps) :
+		mTargetFps(0.0f),
+		mPeriod(0),
+		mDeadline(),
+		mSpinTime(sInitialSpinTime),
+		mTimer(nullptr) {
+#if defined(_WIN32)
+		// High resolution timers (Windows 10 1803+) wake within about 0.5ms, the fallback timer follows the scheduler tick
+		mTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+		if (mTimer == nullptr) {
+			mTimer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+		}
+#endif
+		SetTargetFps(targetFps);
+	}
+
+	FrameLimiter::~FrameLimiter() {
+#if defined(_WIN32)
+		if (mTimer != nullptr) {
+			CloseHandle(mTimer);
+		}
+#endif
+	}
+
+	void FrameLimiter::SetTargetFps(const float targetFps) {
+		mTargetFps = std::max(targetFps, 0.0f);
+		mPeriod = mTargetFps > 0.0f ?
+			std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / mTargetFps)) : Clock::duration(0);
+		mDeadline = Clock::time_point();
+	}
+
+	float FrameLimiter::GetTargetFps() const {
+		return mTargetFps;
+	}
+
+	bool FrameLimiter::IsEnabled() const {
+		return mTargetFps > 0.0f;
+	}
+
+	float FrameLimiter::Wait() {
+		if (!IsEnabled()) {
+			return 0.0f;
+		}
+
+		const Clock::time_point now = Clock::now();
+		if (mDeadline == Clock::time_point()) {
+			mDeadline = now;
+		}
+		mDeadline += mPeriod;
+
+		if (now >= mDeadline) {
+			// Missed it. Within a period the next frames absorb the difference, further behind the schedule restarts
+			const float late = ToMilliseconds(now - mDeadline);
+			if (now - mDeadline > mPeriod) {
+				mDeadline = now;
+			}
+			return late;
+		}
+
+		const Clock::time_point sleepTarget = mDeadline - mSpinTime;
+		if (sleepTarget > now) {
+			SleepUntil(sleepTarget);
+
+			// Grow the spin quickly when the timer overshoots it, shrink it slowly while it does not
+			const Clock::duration overshoot = Clock::now() - sleepTarget;
+			if (overshoot > mSpinTime) {
+				mSpinTime = std::min<Clock::duration>(overshoot + overshoot / 2, sMaxSpinTime);
+			} else {
+				mSpinTime = std::max<Clock::duration>(mSpinTime - mSpinTime / 64, sMinSpinTime);
+			}
+		}
+
+		Clock::time_point woke = Clock::now();
+		while (woke < mDeadline) {
+			Pause();
+			woke = Clock::now();
+		}
+		return ToMilliseconds(woke - mDeadline);
+	}
+
+	float FrameLimiter::GetSpinMilliseconds() const {
+		return ToMilliseconds(mSpinTime);
+	}
+
+	void FrameLimiter::SleepUntil(const Clock::time_point deadline) {
+#if defined(_WIN32)
+		if (mTimer != nullptr) {
+			// Negative due times are relative, in 100ns units
+			const auto remaining = std::chrono::duration_cast<std::chrono::duration<long long, std::ratio<1, 10000000>>>(deadline - Clock::now());
+			if (remaining.count() <= 0) {
+				return;
+			}
+			LARGE_INTEGER dueTime;
+			dueTime.QuadPart = -remaining.count();
+			if (SetWaitableTimer(mTimer, &dueTime, 0, nullptr, nullptr, FALSE)) {
+				WaitForSingleObject(mTimer, INFINITE);
+				return;
+			}
+		}
+		std::this_thread::sleep_until(deadline);
+#elif defined(__linux__)
+		// steady_clock is CLOCK_MONOTONIC, an absolute sleep does not oversleep when interrupted and restarted
+		const auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+		timespec wakeTime;
+		wakeTime.tv_sec = static_cast<time_t>(sinceEpoch / 1000000000);
+		wakeTime.tv_nsec = static_cast<long>(sinceEpoch % 1000000000);
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeTime, nullptr) == EINTR) {
+		}
+#else
+		std::this_thread::sleep_until(deadline);
+#endif
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <chrono>
+#include <stdint.h>
+
+namespace Enj {
+	/*	Holds the main loop to a target frame rate. Wait() sleeps on a high resolution timer until shortly before the
+		deadline and spins the rest, the OS wakes threads late by anything from 50us to a few ms.
+		Deadlines advance by exactly one period so rounding does not drift the rate, a frame that misses its
+		deadline by more than a period restarts the schedule instead of rushing frames to catch up */
+	class FrameLimiter {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		// 0 disables the limiter
+		explicit FrameLimiter(const float targetFps = 0.0f);
+		FrameLimiter(const FrameLimiter& limiter) = delete;
+		FrameLimiter& operator=(const FrameLimiter& limiter) = delete;
+		~FrameLimiter();
+
+		void SetTargetFps(const float targetFps);
+		float GetTargetFps() const;
+		bool IsEnabled() const;
+
+		// Blocks until the next frame is due. Returns how late it woke up in milliseconds, negative when early
+		float Wait();
+
+		// Sleep overshoot the spin currently covers, adapts to how late the timer wakes up
+		float GetSpinMilliseconds() const;
+
+	private:
+		void SleepUntil(const Clock::time_point deadline);
+
+		float mTargetFps;
+		Clock::duration mPeriod;
+		Clock::time_point mDeadline;
+		Clock::duration mSpinTime;
+
+		// Windows waitable timer handle
+		void* mTimer;
+	};
+}
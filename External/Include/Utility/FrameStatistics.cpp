@@ -0,0 +1,170 @@
+#include "FrameStatistics.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace Enj {
+	FrameStatistics::FrameStatistics(const uint32_t historySize, const float hitchBudgetMilliseconds) :
+		mHistory(std::max(historySize, 1u), 0.0f),
+		mNext(0),
+		mCount(0),
+		mHistorySum(0.0),
+		mHistogram(sBucketCount, 0),
+		mHitchBudget(hitchBudgetMilliseconds),
+		mTotalHitches(0),
+		mTotalFrames(0) {
+	}
+
+	void FrameStatistics::AddFrame(const float milliseconds) {
+		if (mCount == mHistory.size()) {
+			mHistorySum -= mHistory[mNext];
+		} else {
+			++mCount;
+		}
+		mHistory[mNext] = milliseconds;
+		mHistorySum += milliseconds;
+		mNext = (mNext + 1) % static_cast<uint32_t>(mHistory.size());
+
+		++mHistogram[GetBucket(milliseconds)];
+		++mTotalFrames;
+		if (milliseconds > mHitchBudget) {
+			++mTotalHitches;
+		}
+	}
+
+	void FrameStatistics::Reset() {
+		mNext = 0;
+		mCount = 0;
+		mHistorySum = 0.0;
+		std::fill(mHistogram.begin(), mHistogram.end(), 0);
+		mTotalHitches = 0;
+		mTotalFrames = 0;
+	}
+
+	void FrameStatistics::SetHitchBudget(const float milliseconds) {
+		mHitchBudget = milliseconds;
+	}
+
+	float FrameStatistics::GetHitchBudget() const {
+		return mHitchBudget;
+	}
+
+	FrameTimeSummary FrameStatistics::GetSummary() const {
+		FrameTimeSummary summary = {};
+		summary.mTotalHitches = mTotalHitches;
+		summary.mTotalFrames = mTotalFrames;
+		if (mCount == 0) {
+			return summary;
+		}
+
+		std::vector<float> sorted = GetHistory();
+		std::sort(sorted.begin(), sorted.end());
+
+		// Nearest rank, so p99.9 of fewer than 1000 frames is the slowest frame
+		const auto percentile = [&sorted](const float fraction) {
+			const size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<float>(sorted.size())));
+			return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+		};
+
+		summary.mFrameCount = mCount;
+		summary.mMin = sorted.front();
+		summary.mMax = sorted.back();
+		summary.mMean = GetMeanFrame();
+		summary.mP50 = percentile(0.5f);
+		summary.mP95 = percentile(0.95f);
+		summary.mP99 = percentile(0.99f);
+		summary.mP999 = percentile(0.999f);
+
+		const size_t slowCount = std::max<size_t>(sorted.size() / 100, 1);
+		double slowSum = 0.0;
+		for (size_t index = sorted.size() - slowCount; index < sorted.size(); ++index) {
+			slowSum += sorted[index];
+		}
+		summary.mOnePercentLowFps = slowSum > 0.0 ? static_cast<float>(1000.0 * slowCount / slowSum) : 0.0f;
+
+		summary.mHitches = static_cast<uint32_t>(sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), mHitchBudget));
+		return summary;
+	}
+
+	float FrameStatistics::GetLastFrame() const {
+		if (mCount == 0) {
+			return 0.0f;
+		}
+		return mHistory[(mNext + mHistory.size() - 1) % mHistory.size()];
+	}
+
+	float FrameStatistics::GetMeanFrame() const {
+		return mCount > 0 ? static_cast<float>(mHistorySum / mCount) : 0.0f;
+	}
+
+	float FrameStatistics::GetBucketStart(const uint32_t bucket) {
+		return bucket == 0 ? 0.0f : sHistogramMinimum * std::exp2(static_cast<float>(bucket) / sBucketsPerOctave);
+	}
+
+	const std::vector<uint64_t>& FrameStatistics::GetHistogram() const {
+		return mHistogram;
+	}
+
+	std::vector<float> FrameStatistics::GetHistory() const {
+		std::vector<float> history;
+		history.reserve(mCount);
+		const uint32_t first = (mNext + static_cast<uint32_t>(mHistory.size()) - mCount) % static_cast<uint32_t>(mHistory.size());
+		for (uint32_t frame = 0; frame < mCount; ++frame) {
+			history.push_back(mHistory[(first + frame) % mHistory.size()]);
+		}
+		return history;
+	}
+
+	bool FrameStatistics::WriteCsv(const std::filesystem::path& path) const {
+		std::ofstream file(path);
+		if (!file) {
+			return false;
+		}
+
+		file << "frame,milliseconds\n";
+		const std::vector<float> history = GetHistory();
+		const uint64_t firstFrame = mTotalFrames - history.size();
+		for (size_t frame = 0; frame < history.size(); ++frame) {
+			file << firstFrame + frame << ',' << history[frame] << '\n';
+		}
+		return static_cast<bool>(file);
+	}
+
+	bool FrameStatistics::WriteJson(const std::filesystem::path& path) const {
+		std::ofstream file(path);
+		if (!file) {
+			return false;
+		}
+
+		const FrameTimeSummary summary = GetSummary();
+		file << "{\n";
+		file << "\t\"frames\": " << summary.mTotalFrames << ",\n";
+		file << "\t\"hitches\": " << summary.mTotalHitches << ",\n";
+		file << "\t\"hitchBudgetMs\": " << mHitchBudget << ",\n";
+		file << "\t\"history\": { \"frames\": " << summary.mFrameCount
+			<< ", \"minMs\": " << summary.mMin
+			<< ", \"maxMs\": " << summary.mMax
+			<< ", \"meanMs\": " << summary.mMean
+			<< ", \"p50Ms\": " << summary.mP50
+			<< ", \"p95Ms\": " << summary.mP95
+			<< ", \"p99Ms\": " << summary.mP99
+			<< ", \"p999Ms\": " << summary.mP999
+			<< ", \"onePercentLowFps\": " << summary.mOnePercentLowFps
+			<< ", \"hitches\": " << summary.mHitches << " },\n";
+		file << "\t\"histogram\": [";
+		for (uint32_t bucket = 0; bucket < sBucketCount; ++bucket) {
+			file << (bucket == 0 ? "" : ", ") << "{ \"startMs\": " << GetBucketStart(bucket) << ", \"frames\": " << mHistogram[bucket] << " }";
+		}
+		file << "]\n";
+		file << "}\n";
+		return static_cast<bool>(file);
+	}
+
+	uint32_t FrameStatistics::GetBucket(const float milliseconds) {
+		if (!(milliseconds > sHistogramMinimum)) {
+			return 0;
+		}
+		const float bucket = std::log2(milliseconds / sHistogramMinimum) * sBucketsPerOctave;
+		return std::min(static_cast<uint32_t>(bucket), sBucketCount - 1);
+	}
+}
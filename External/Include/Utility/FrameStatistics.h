@@ -0,0 +1,73 @@
+#pragma once
+#include <filesystem>
+#include <stdint.h>
+#include <vector>
+
+namespace Enj {
+	struct FrameTimeSummary {
+		// Over the frames in the rolling history, in milliseconds
+		uint32_t mFrameCount;
+		float mMin;
+		float mMax;
+		float mMean;
+		float mP50;
+		float mP95;
+		float mP99;
+		float mP999;
+
+		// Average fps of the slowest 1% of frames
+		float mOnePercentLowFps;
+
+		// Frames over the hitch budget, in the history and since the statistics were created
+		uint32_t mHitches;
+		uint64_t mTotalHitches;
+		uint64_t mTotalFrames;
+	};
+
+	// Rolling frame time history plus a session long log scale histogram and hitch count
+	class FrameStatistics {
+	public:
+		// Bucket i starts at sHistogramMinimum * 2^(i / sBucketsPerOctave) milliseconds. The first bucket also holds
+		// everything faster and the last one everything slower
+		static constexpr float sHistogramMinimum = 0.25f;
+		static constexpr uint32_t sBucketsPerOctave = 4;
+		static constexpr uint32_t sBucketCount = 40;
+
+		explicit FrameStatistics(const uint32_t historySize = 1024, const float hitchBudgetMilliseconds = 1000.0f / 60.0f);
+
+		void AddFrame(const float milliseconds);
+		void Reset();
+
+		void SetHitchBudget(const float milliseconds);
+		float GetHitchBudget() const;
+
+		// Sorts a copy of the history, meant for once a second or less rather than every frame
+		FrameTimeSummary GetSummary() const;
+
+		float GetLastFrame() const;
+		float GetMeanFrame() const;
+
+		static float GetBucketStart(const uint32_t bucket);
+		const std::vector<uint64_t>& GetHistogram() const;
+
+		// Frame times in the history, oldest first
+		std::vector<float> GetHistory() const;
+
+		// Returns false when the file could not be written
+		bool WriteCsv(const std::filesystem::path& path) const;
+		bool WriteJson(const std::filesystem::path& path) const;
+
+	private:
+		static uint32_t GetBucket(const float milliseconds);
+
+		std::vector<float> mHistory;
+		uint32_t mNext;
+		uint32_t mCount;
+		double mHistorySum;
+
+		std::vector<uint64_t> mHistogram;
+		float mHitchBudget;
+		uint64_t mTotalHitches;
+		uint64_t mTotalFrames;
+	};
+}
@@ -6,7 +6,9 @@ namespace Enj {
 		mLastFrameTime(mCurrentFrameTime),
 		mDeltaTime(std::chrono::duration<float>(0.0f)),
 		mTotalTime(std::chrono::duration<double>(0.0)),
-		mFps(0) {
+		mFps(0),
+		mStatistics(),
+		mPacingStatistics(1024, 1.0f) {
 	}
 
 	void Timer::Update() {
@@ -17,7 +19,9 @@ namespace Enj {
 
 		mTotalTime = mTotalTime + mDeltaTime;
 
-		mFps = static_cast<unsigned int>(1.0f / mDeltaTime.count());
+		mStatistics.AddFrame(mDeltaTime.count() * 1000.0f);
+		const float meanFrame = mStatistics.GetMeanFrame();
+		mFps = meanFrame > 0.0f ? static_cast<unsigned int>(1000.0f / meanFrame) : 0;
 	}
 
 	float Timer::DeltaTime() const {
@@ -32,4 +36,20 @@ namespace Enj {
 		return mFps;
 	}
 
+	FrameStatistics& Timer::Statistics() {
+		return mStatistics;
+	}
+
+	const FrameStatistics& Timer::Statistics() const {
+		return mStatistics;
+	}
+
+	void Timer::AddPacingSample(const float lateMilliseconds) {
+		mPacingStatistics.AddFrame(lateMilliseconds);
+	}
+
+	const FrameStatistics& Timer::PacingStatistics() const {
+		return mPacingStatistics;
+	}
+
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include <chrono>
+#include "FrameStatistics.h"
 
 namespace Enj {
 	class Timer {
@@ -12,12 +13,23 @@ namespace Enj {
 
 		float DeltaTime() const;
 		float TotalTime() const;
+
+		// Average over the frame history, not just the last frame
 		unsigned int Fps() const;
+
+		FrameStatistics& Statistics();
+		const FrameStatistics& Statistics() const;
+
+		// How late the frame limiter woke up, in milliseconds. Its hitches are wake ups more than 1ms late
+		void AddPacingSample(const float lateMilliseconds);
+		const FrameStatistics& PacingStatistics() const;
 	private:
 		std::chrono::high_resolution_clock::time_point mCurrentFrameTime;
 		std::chrono::high_resolution_clock::time_point mLastFrameTime;
 		std::chrono::duration<float> mDeltaTime;
 		std::chrono::duration<double> mTotalTime;
 		unsigned int mFps;
+		FrameStatistics mStatistics;
+		FrameStatistics mPacingStatistics;
 	};
 }
\ No newline at end of file
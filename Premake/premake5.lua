@@ -3,6 +3,8 @@ local ENGINE_NAME = "Engine Core"
 local EDITOR_NAME = "Editor"
 local EXTERNAL_NAME = "External"
 local PROJECT_NAME_SHORT = "Enjinn"
+local BENCHMARKS_NAME = "Benchmarks"
+local HEADLESS_BENCHMARK_NAME = "HeadlessBenchmark"
 
 local DO_LOGGING = true
 
@@ -14,6 +16,7 @@ local USE_ABSOLUTE_PATHS = false
 local basePath = USE_ABSOLUTE_PATHS and os.realpath("../") or "../"
 
 local cppVersion = "C++20"
+local vectorExtensions = "AVX2" -- OMath picks its SIMD paths from this at compile time
 
 local PROJECT_KIND = "WindowedApp"
 local EDITOR_KIND = "StaticLib"
@@ -30,6 +33,13 @@ local LINKER_OPTIONS =  {
     "/ignore:4099", -- linking object as if no debug info
 }
 
+-- Profiler zones are always on in Debug, --profile turns them on in Release as well
+newoption {
+    trigger = "profile",
+    description = "Define ENJ_PROFILE in Release builds"
+}
+local PROFILE_DEFINES = { "ENJ_PROFILE" }
+
 local USE_PCH = true
 local function UsePrecompiled()
     if not USE_PCH then return end
@@ -59,6 +69,11 @@ local directories = {
     editor          = basePath .. "Editor/",
     editorSource    = basePath .. "Editor/Source/",
 
+    -- Benchmarks
+    benchmarks      = basePath .. "Benchmarks/",
+    benchmarksSource = basePath .. "Benchmarks/Source/",
+    benchmarksHeadless = basePath .. "Benchmarks/Headless/",
+
     -- External
     external        = basePath .. "External/",
     externalDLL     = basePath .. "/External/dll/",
@@ -101,6 +116,7 @@ project(EXTERNAL_NAME)
     location(directories.temp)
     language("C++")
     cppdialect(cppVersion)
+    vectorextensions(vectorExtensions)
     kind("StaticLib")
 
     debugdir(directories.intermediateLib)
@@ -148,6 +164,7 @@ project(ENGINE_NAME)
     location(directories.temp)
     language("C++")
     cppdialect(cppVersion)
+    vectorextensions(vectorExtensions)
     kind("StaticLib")
 
     debugdir(directories.intermediateLib)
@@ -178,9 +195,11 @@ project(ENGINE_NAME)
     filter (CONFIG_FILTERS.DEBUG)
         runtime "Debug"
         symbols "on"
+        defines(PROFILE_DEFINES)
     filter (CONFIG_FILTERS.RELEASE)
         runtime "Release"
         optimize "on"
+        if _OPTIONS["profile"] then defines(PROFILE_DEFINES) end
 
     filter "system:windows"
         staticruntime "off"
@@ -228,6 +247,7 @@ project(PROJECT_NAME_SHORT)
     kind("WindowedApp")
     language "C++"
     cppdialect(cppVersion)
+    vectorextensions(vectorExtensions)
 
     debugdir(directories.bin)
     targetdir(directories.bin)
@@ -265,12 +285,14 @@ project(PROJECT_NAME_SHORT)
         runtime "Debug"
         symbols "on"
         defines {[[_ENJINN_BUILD=L"]]..tostring(DEBUG_BUILD_NAME)..[["]]}
+        defines(PROFILE_DEFINES)
         libdirs {directories.debugLib}
 
     filter (CONFIG_FILTERS.RELEASE)
         runtime "Release"
         optimize "on"
         defines {[[_ENJINN_BUILD=L"]]..tostring(RELEASE_BUILD_NAME)..[["]]}
+        if _OPTIONS["profile"] then defines(PROFILE_DEFINES) end
         libdirs {directories.releaseLib}
 
     filter "system:windows"
@@ -289,4 +311,112 @@ project(PROJECT_NAME_SHORT)
         end
     end
     
-    MakeFolderStructure()
\ No newline at end of file
+    MakeFolderStructure()
+
+-- OMath microbenchmarks, header only and platform independent so it also builds with gmake2 on Linux
+-- Run from Bin: Benchmarks_Release -out results.json -commit <hash>
+project(BENCHMARKS_NAME)
+    location(directories.temp)
+    kind("ConsoleApp")
+    language "C++"
+    cppdialect(cppVersion)
+    vectorextensions(vectorExtensions)
+
+    debugdir(directories.bin)
+    targetdir(directories.bin)
+    targetname(BENCHMARKS_NAME.."_%{cfg.buildcfg}")
+    objdir(directories.temp.."/"..BENCHMARKS_NAME.."/%{cfg.buildcfg}")
+
+    files {
+        directories.benchmarksSource.."**.h",
+        directories.benchmarksSource.."**.cpp",
+    }
+
+    includedirs {
+        directories.externalInclude,
+        directories.benchmarksSource
+    }
+
+    filter (CONFIG_FILTERS.DEBUG)
+        runtime "Debug"
+        symbols "on"
+
+    filter (CONFIG_FILTERS.RELEASE)
+        runtime "Release"
+        optimize "Speed"
+
+    filter "system:windows"
+        staticruntime "off"
+        systemversion "latest"
+        warnings "Extra"
+        flags {
+            "MultiProcessorCompile"
+        }
+
+    filter "system:linux"
+        warnings "Extra"
+        buildoptions { "-mfma" } -- MSVC implies FMA with AVX2, gcc and clang need it spelled out
+        links { "pthread" }
+
+    filter {}
+
+-- The engine's CPU frame without window or GPU, builds on any platform for CI regression runs
+project(HEADLESS_BENCHMARK_NAME)
+    location(directories.temp)
+    kind("ConsoleApp")
+    language "C++"
+    cppdialect(cppVersion)
+    vectorextensions(vectorExtensions)
+
+    debugdir(directories.bin)
+    targetdir(directories.bin)
+    targetname(HEADLESS_BENCHMARK_NAME.."_%{cfg.buildcfg}")
+    objdir(directories.temp.."/"..HEADLESS_BENCHMARK_NAME.."/%{cfg.buildcfg}")
+
+    files {
+        directories.benchmarksHeadless.."**.cpp",
+        directories.coreSource.."Benchmark/**.h",
+        directories.coreSource.."Benchmark/**.cpp",
+        directories.coreSource.."Scene/**.h",
+        directories.coreSource.."Scene/**.cpp",
+        directories.coreSource.."Threading/**.h",
+        directories.coreSource.."Threading/**.cpp",
+        directories.coreSource.."Profiling/**.h",
+        directories.coreSource.."Profiling/**.cpp",
+        directories.coreSource.."Memory/**.h",
+        directories.coreSource.."Memory/**.cpp",
+        directories.coreSource.."Graphics/FrustumCuller.h",
+        directories.coreSource.."Graphics/FrustumCuller.cpp",
+        directories.externalInclude.."Utility/FrameStatistics.h",
+        directories.externalInclude.."Utility/FrameStatistics.cpp",
+    }
+
+    includedirs {
+        directories.externalInclude,
+        directories.coreSource
+    }
+
+    filter (CONFIG_FILTERS.DEBUG)
+        runtime "Debug"
+        symbols "on"
+        defines(PROFILE_DEFINES)
+
+    filter (CONFIG_FILTERS.RELEASE)
+        runtime "Release"
+        optimize "Speed"
+        if _OPTIONS["profile"] then defines(PROFILE_DEFINES) end
+
+    filter "system:windows"
+        staticruntime "off"
+        systemversion "latest"
+        warnings "Extra"
+        flags {
+            "MultiProcessorCompile"
+        }
+
+    filter "system:linux"
+        warnings "Extra"
+        buildoptions { "-mfma" }
+        links { "pthread" }
+
+    filter {}